@@ -0,0 +1,244 @@
+package no.ntnu.ais.fmu4j.processor
+
+import javax.annotation.processing.AbstractProcessor
+import javax.annotation.processing.RoundEnvironment
+import javax.annotation.processing.SupportedAnnotationTypes
+import javax.lang.model.SourceVersion
+import javax.lang.model.element.*
+import javax.lang.model.type.DeclaredType
+import javax.lang.model.type.TypeKind
+import javax.lang.model.type.TypeMirror
+import javax.lang.model.util.ElementFilter
+import javax.tools.Diagnostic
+
+/**
+ * Generates `<SlaveClass>_Accessors`, implementing `GeneratedAccessors`, for each class declaring
+ * `@ScalarVariable` fields. The fields of the class and its superclasses are read and written through a switch,
+ * directly or using their (Kotlin) property accessors. Fields that are not accessible from the package of the
+ * slave are left out, and accessed reflectively at runtime.
+ */
+@SupportedAnnotationTypes(AccessorProcessor.SCALAR_VARIABLE)
+class AccessorProcessor : AbstractProcessor() {
+
+    override fun getSupportedSourceVersion(): SourceVersion = SourceVersion.latestSupported()
+
+    override fun process(annotations: Set<TypeElement>, roundEnv: RoundEnvironment): Boolean {
+        val annotation = annotations.firstOrNull() ?: return false
+        roundEnv.getElementsAnnotatedWith(annotation)
+            .mapNotNull { it.enclosingElement as? TypeElement }
+            .distinct()
+            .forEach { cls ->
+                if (cls.nestingKind != NestingKind.TOP_LEVEL) {
+                    processingEnv.messager.printMessage(
+                        Diagnostic.Kind.NOTE,
+                        "Accessors are only generated for top level classes, ${cls.qualifiedName} is accessed reflectively.",
+                        cls
+                    )
+                } else {
+                    generate(cls)
+                }
+            }
+        return false
+    }
+
+    private fun generate(cls: TypeElement) {
+
+        val pkg = processingEnv.elementUtils.getPackageOf(cls).qualifiedName.toString()
+        val fields = collectFields(cls, pkg)
+
+        val name = cls.simpleName.toString() + SUFFIX
+        val qualifiedName = if (pkg.isEmpty()) name else "$pkg.$name"
+        val source = buildString {
+            if (pkg.isNotEmpty()) {
+                appendLine("package $pkg;")
+                appendLine()
+            }
+            appendLine("// Generated by fmi-export-processor from ${cls.qualifiedName}, do not edit.")
+            appendLine("public final class $name implements $GENERATED_ACCESSORS {")
+            appendLine()
+            appendLine("    private static final String[] FIELDS = {")
+            fields.forEach { f -> appendLine("        \"${f.key}\",") }
+            appendLine("    };")
+            appendLine()
+            appendLine("    @Override")
+            appendLine("    public String[] getFields() {")
+            appendLine("        return FIELDS.clone();")
+            appendLine("    }")
+            Kind.values().forEach { kind ->
+                appendAccessors(this, cls, kind, fields.withIndex().filter { it.value.kind == kind })
+            }
+            appendLine()
+            appendLine("}")
+        }
+
+        processingEnv.filer.createSourceFile(qualifiedName, cls).openWriter().use { it.write(source) }
+
+    }
+
+    private fun appendAccessors(sb: StringBuilder, cls: TypeElement, kind: Kind, fields: List<IndexedValue<Slot>>) {
+        val slaveType = cls.qualifiedName.toString()
+        with(sb) {
+            appendLine()
+            appendLine("    @Override")
+            appendLine("    public ${kind.javaType} get${kind.suffix}($FMI2_SLAVE slave, int field, int index) {")
+            if (fields.isNotEmpty()) {
+                appendLine("        $slaveType s = ($slaveType) slave;")
+                appendLine("        switch (field) {")
+                fields.forEach { (i, f) -> appendLine("            case $i: return ${f.read};") }
+                appendLine("        }")
+            }
+            appendLine("        throw new IllegalArgumentException(\"No ${kind.javaType} field \" + field);")
+            appendLine("    }")
+            appendLine()
+            appendLine("    @Override")
+            appendLine("    public void set${kind.suffix}($FMI2_SLAVE slave, int field, int index, ${kind.javaType} value) {")
+            val writable = fields.filter { it.value.write != null }
+            if (writable.isNotEmpty()) {
+                appendLine("        $slaveType s = ($slaveType) slave;")
+                appendLine("        switch (field) {")
+                writable.forEach { (i, f) -> appendLine("            case $i: ${f.write}; return;") }
+                appendLine("        }")
+            }
+            appendLine("        throw new IllegalArgumentException(\"No writable ${kind.javaType} field \" + field);")
+            appendLine("    }")
+        }
+    }
+
+    // the accessible annotated fields of cls and its superclasses
+    private fun collectFields(cls: TypeElement, pkg: String): List<Slot> {
+        val slots = mutableListOf<Slot>()
+        var current: TypeElement? = cls
+        while (current != null && current.qualifiedName.toString() != FMI2_SLAVE) {
+            val type = current
+            // array fields are registered as array variables, and copied in bulk rather than element by element
+            ElementFilter.fields(type).filter { isAnnotated(it) && it.asType().kind != TypeKind.ARRAY }.forEach { field ->
+                val slot = slotOf(type, field, pkg)
+                if (slot != null) {
+                    slots.add(slot)
+                } else {
+                    processingEnv.messager.printMessage(
+                        Diagnostic.Kind.NOTE,
+                        "${field.simpleName} is not accessible from $pkg, and is accessed reflectively.",
+                        field
+                    )
+                }
+            }
+            current = (type.superclass as? DeclaredType)?.asElement() as? TypeElement
+        }
+        return slots
+    }
+
+    private fun slotOf(owner: TypeElement, field: VariableElement, pkg: String): Slot? {
+        if (field.modifiers.contains(Modifier.STATIC)) return null
+
+        val type = field.asType()
+        val (kind, shape) = kindOf(type) ?: return null
+        val name = field.simpleName.toString()
+        val final = field.modifiers.contains(Modifier.FINAL)
+        val methods = ElementFilter.methods(owner)
+
+        val getter = when {
+            isAccessible(field, pkg) -> "s.$name"
+            else -> getterNames(name, kind)
+                .firstOrNull { g -> methods.any { m -> m.simpleName.contentEquals(g) && m.parameters.isEmpty() && isAccessible(m, pkg) } }
+                ?.let { g -> "s.$g()" }
+        } ?: return null
+
+        val key = processingEnv.elementUtils.getBinaryName(owner).toString() + "#" + name
+        return when (shape) {
+            Shape.VECTOR -> Slot(key, kind, "$getter.get(index)", "$getter.set(index, value)")
+            Shape.SCALAR -> {
+                val setter = when {
+                    final -> null
+                    isAccessible(field, pkg) -> "s.$name = value"
+                    else -> setterNames(name)
+                        .firstOrNull { n -> methods.any { m -> m.simpleName.contentEquals(n) && m.parameters.size == 1 && isAccessible(m, pkg) } }
+                        ?.let { n -> "s.$n(value)" }
+                        // a non-final field that cannot be written from generated code is left to reflection
+                        ?: return null
+                }
+                Slot(key, kind, getter, setter)
+            }
+        }
+    }
+
+    private fun kindOf(type: TypeMirror): Pair<Kind, Shape>? {
+        scalarKindOf(type)?.also { return it to Shape.SCALAR }
+        if (type.kind == TypeKind.DECLARED) {
+            val types = processingEnv.typeUtils
+            Kind.values().forEach { kind ->
+                val vector = processingEnv.elementUtils.getTypeElement(kind.vectorType) ?: return@forEach
+                if (types.isAssignable(type, vector.asType())) return kind to Shape.VECTOR
+            }
+        }
+        return null
+    }
+
+    private fun scalarKindOf(type: TypeMirror): Kind? {
+        return when (type.kind) {
+            TypeKind.INT -> Kind.INTEGER
+            TypeKind.DOUBLE -> Kind.REAL
+            TypeKind.BOOLEAN -> Kind.BOOLEAN
+            TypeKind.DECLARED -> {
+                val element = (type as DeclaredType).asElement() as TypeElement
+                if (element.qualifiedName.contentEquals("java.lang.String")) Kind.STRING else null
+            }
+            else -> null
+        }
+    }
+
+    private fun isAnnotated(field: VariableElement): Boolean {
+        return field.annotationMirrors.any { it.annotationType.toString() == SCALAR_VARIABLE }
+    }
+
+    // public, or package private/protected within the package of the generated class
+    private fun isAccessible(element: Element, pkg: String): Boolean {
+        val modifiers = element.modifiers
+        if (modifiers.contains(Modifier.PRIVATE) || modifiers.contains(Modifier.STATIC)) return false
+        if (modifiers.contains(Modifier.PUBLIC)) return true
+        return processingEnv.elementUtils.getPackageOf(element).qualifiedName.contentEquals(pkg)
+    }
+
+    private fun getterNames(name: String, kind: Kind): List<String> {
+        val capitalized = name.replaceFirstChar { it.uppercaseChar() }
+        return when {
+            // Kotlin properties named isX keep their name as getter
+            kind == Kind.BOOLEAN && isPrefixed(name) -> listOf(name, "get$capitalized")
+            kind == Kind.BOOLEAN -> listOf("get$capitalized", "is$capitalized")
+            else -> listOf("get$capitalized")
+        }
+    }
+
+    private fun setterNames(name: String): List<String> {
+        val capitalized = name.replaceFirstChar { it.uppercaseChar() }
+        return if (isPrefixed(name)) listOf("set${name.substring(2)}", "set$capitalized") else listOf("set$capitalized")
+    }
+
+    private fun isPrefixed(name: String) = name.length > 2 && name.startsWith("is") && name[2].isUpperCase()
+
+    private enum class Kind(val suffix: String, val javaType: String, val vectorType: String) {
+        INTEGER("Integer", "int", "no.ntnu.ais.fmu4j.export.IntVector"),
+        REAL("Real", "double", "no.ntnu.ais.fmu4j.export.RealVector"),
+        BOOLEAN("Boolean", "boolean", "no.ntnu.ais.fmu4j.export.BooleanVector"),
+        STRING("String", "String", "no.ntnu.ais.fmu4j.export.StringVector")
+    }
+
+    private enum class Shape {
+        SCALAR, VECTOR
+    }
+
+    private class Slot(
+        val key: String,
+        val kind: Kind,
+        val read: String,
+        val write: String?
+    )
+
+    companion object {
+        const val SCALAR_VARIABLE = "no.ntnu.ais.fmu4j.export.fmi2.ScalarVariable"
+        const val SUFFIX = "_Accessors"
+        private const val FMI2_SLAVE = "no.ntnu.ais.fmu4j.export.fmi2.Fmi2Slave"
+        private const val GENERATED_ACCESSORS = "no.ntnu.ais.fmu4j.export.fmi2.GeneratedAccessors"
+    }
+
+}
@@ -0,0 +1,76 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2Slave
+import no.ntnu.ais.fmu4j.export.fmi2.ScalarVariable
+import no.ntnu.ais.fmu4j.export.fmi2.SlaveInfo
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2Causality
+import org.openjdk.jmh.annotations.*
+import java.lang.reflect.Field
+import java.util.concurrent.TimeUnit
+
+/**
+ * Per-variable cost of reading and writing an annotated field through getReal/setReal, which use the method handles
+ * bound by [Fmi2Slave] (the jmh source set is not processed by fmi-export-processor), compared to
+ * java.lang.reflect.Field as previously used. Run using `./gradlew :fmi-export:jmh`.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+open class AccessorBenchmark {
+
+    private lateinit var slave: BenchmarkSlave
+    private lateinit var field: Field
+    private val vr = LongArray(1)
+    private val values = DoubleArray(1)
+
+    @Setup
+    fun setup() {
+        slave = BenchmarkSlave(mapOf("instanceName" to "benchmark")).apply {
+            __define__()
+        }
+        field = BenchmarkSlave::class.java.getDeclaredField("value").apply {
+            isAccessible = true
+        }
+        vr[0] = slave.getValueRef("value")
+    }
+
+    // the reflective accessors previously registered for annotated fields, used in the same way as getReal/setReal
+
+    @Benchmark
+    fun reflectiveGet(): DoubleArray = DoubleArray(vr.size) { field.getDouble(slave) }
+
+    @Benchmark
+    fun reflectiveSet() {
+        for (i in vr.indices) {
+            field.setDouble(slave, values[i])
+        }
+    }
+
+    @Benchmark
+    fun getReal(): DoubleArray = slave.getReal(vr)
+
+    // without allocating the result, as the native layer reads
+    @Benchmark
+    fun getRealInto(): DoubleArray {
+        slave.getReal(vr, values)
+        return values
+    }
+
+    @Benchmark
+    fun setReal() {
+        slave.setReal(vr, values)
+    }
+
+    @SlaveInfo(modelName = "BenchmarkSlave")
+    class BenchmarkSlave(
+        args: Map<String, Any>
+    ) : Fmi2Slave(args) {
+
+        @ScalarVariable(causality = Fmi2Causality.input)
+        var value = 1.0
+
+        override fun doStep(currentTime: Double, dt: Double) {}
+
+    }
+
+}
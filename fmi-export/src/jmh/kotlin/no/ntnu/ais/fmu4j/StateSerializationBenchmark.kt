@@ -0,0 +1,46 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.export.fmi2.FieldSnapshot
+import no.ntnu.ais.fmu4j.export.fmi2.StateSerializer
+import org.openjdk.jmh.annotations.*
+import java.nio.ByteBuffer
+import java.util.concurrent.TimeUnit
+
+/**
+ * Cost of serializing and deserializing an 8 MB FMU state, written in full or as deltas touching a single block.
+ * Run using `./gradlew :fmi-export:jmh`.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+open class StateSerializationBenchmark {
+
+    // 0 writes every state in full
+    @Param("0", "2147483647")
+    var fullInterval = 0
+
+    private lateinit var state: FieldSnapshot
+    private lateinit var writer: StateSerializer
+    private lateinit var reader: StateSerializer
+    private lateinit var buffer: ByteBuffer
+    private var i = 0
+
+    @Setup
+    fun setup() {
+        state = FieldSnapshot(DoubleArray(1 shl 20) { it * 0.5 }, IntArray(0), BooleanArray(0), arrayOf())
+        writer = StateSerializer(fullInterval)
+        reader = StateSerializer(fullInterval)
+        buffer = ByteBuffer.allocateDirect(writer.size(state))
+    }
+
+    @Benchmark
+    fun roundTrip(): FieldSnapshot {
+        state.reals[(i++ and 0xFF) * 4096] += 1.0
+        buffer.clear()
+        writer.size(state)
+        writer.write(state, buffer)
+        buffer.flip()
+        return reader.read(buffer)
+    }
+
+}
@@ -0,0 +1,17 @@
+package no.ntnu.ais.fmu4j.export.fmi2;
+
+/**
+ * A {@link Getter} of boolean values, read without boxing by the native layer.
+ * Lambdas passed to {@code boolean(name, getter)} are converted to it rather than to {@code Getter<Boolean>}.
+ */
+@FunctionalInterface
+public interface BooleanGetter extends Getter<Boolean> {
+
+    boolean getBoolean();
+
+    @Override
+    default Boolean get() {
+        return getBoolean();
+    }
+
+}
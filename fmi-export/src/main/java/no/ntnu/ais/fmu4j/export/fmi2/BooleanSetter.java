@@ -0,0 +1,16 @@
+package no.ntnu.ais.fmu4j.export.fmi2;
+
+/**
+ * A {@link Setter} of boolean values, written without boxing by the native layer.
+ */
+@FunctionalInterface
+public interface BooleanSetter extends Setter<Boolean> {
+
+    void setBoolean(boolean value);
+
+    @Override
+    default void set(Boolean value) {
+        setBoolean(value);
+    }
+
+}
@@ -0,0 +1,17 @@
+package no.ntnu.ais.fmu4j.export.fmi2;
+
+/**
+ * A {@link Getter} of real values, read without boxing by the native layer.
+ * Lambdas passed to {@code real(name, getter)} are converted to it rather than to {@code Getter<Double>}.
+ */
+@FunctionalInterface
+public interface DoubleGetter extends Getter<Double> {
+
+    double getDouble();
+
+    @Override
+    default Double get() {
+        return getDouble();
+    }
+
+}
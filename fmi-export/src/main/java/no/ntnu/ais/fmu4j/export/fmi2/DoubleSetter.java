@@ -0,0 +1,16 @@
+package no.ntnu.ais.fmu4j.export.fmi2;
+
+/**
+ * A {@link Setter} of real values, written without boxing by the native layer.
+ */
+@FunctionalInterface
+public interface DoubleSetter extends Setter<Double> {
+
+    void setDouble(double value);
+
+    @Override
+    default void set(Double value) {
+        setDouble(value);
+    }
+
+}
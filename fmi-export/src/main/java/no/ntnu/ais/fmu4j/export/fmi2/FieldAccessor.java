@@ -0,0 +1,112 @@
+package no.ntnu.ais.fmu4j.export.fmi2;
+
+import java.lang.invoke.MethodHandle;
+import java.lang.invoke.MethodHandles;
+import java.lang.reflect.Field;
+import java.lang.reflect.Modifier;
+
+/**
+ * Reads and writes an annotated field of a slave through method handles bound at registration time.
+ * <p>
+ * Unlike {@code Field.getDouble}/{@code setDouble}, the handles perform no access checks when invoked,
+ * and are invoked with their exact (primitive) type, so values are not boxed.
+ * As they are bound per instance and held in instance fields, the JIT does not treat them as constants,
+ * so each access remains an invocation of a handle rather than a plain field read. The accessors generated
+ * by fmi-export-processor read fields directly.
+ */
+final class FieldAccessor {
+
+    private static final MethodHandles.Lookup LOOKUP = MethodHandles.lookup();
+
+    private final MethodHandle getter;
+    private final MethodHandle setter;
+
+    FieldAccessor(Field field, Object owner) {
+        field.setAccessible(true);
+        try {
+            getter = LOOKUP.unreflectGetter(field).bindTo(owner);
+            setter = Modifier.isFinal(field.getModifiers()) ? null : LOOKUP.unreflectSetter(field).bindTo(owner);
+        } catch (IllegalAccessException ex) {
+            throw new IllegalStateException(ex);
+        }
+    }
+
+    boolean isSettable() {
+        return setter != null;
+    }
+
+    int getInt() {
+        try {
+            return (int) getter.invokeExact();
+        } catch (Throwable t) {
+            throw rethrow(t);
+        }
+    }
+
+    void setInt(int value) {
+        try {
+            setter.invokeExact(value);
+        } catch (Throwable t) {
+            throw rethrow(t);
+        }
+    }
+
+    double getDouble() {
+        try {
+            return (double) getter.invokeExact();
+        } catch (Throwable t) {
+            throw rethrow(t);
+        }
+    }
+
+    void setDouble(double value) {
+        try {
+            setter.invokeExact(value);
+        } catch (Throwable t) {
+            throw rethrow(t);
+        }
+    }
+
+    boolean getBoolean() {
+        try {
+            return (boolean) getter.invokeExact();
+        } catch (Throwable t) {
+            throw rethrow(t);
+        }
+    }
+
+    void setBoolean(boolean value) {
+        try {
+            setter.invokeExact(value);
+        } catch (Throwable t) {
+            throw rethrow(t);
+        }
+    }
+
+    String getString() {
+        try {
+            return (String) getter.invokeExact();
+        } catch (Throwable t) {
+            throw rethrow(t);
+        }
+    }
+
+    void setString(String value) {
+        try {
+            setter.invokeExact(value);
+        } catch (Throwable t) {
+            throw rethrow(t);
+        }
+    }
+
+    private static RuntimeException rethrow(Throwable t) {
+        if (t instanceof RuntimeException) {
+            return (RuntimeException) t;
+        }
+        if (t instanceof Error) {
+            throw (Error) t;
+        }
+        return new IllegalStateException(t);
+    }
+
+}
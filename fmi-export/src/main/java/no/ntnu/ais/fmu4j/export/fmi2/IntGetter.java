@@ -0,0 +1,17 @@
+package no.ntnu.ais.fmu4j.export.fmi2;
+
+/**
+ * A {@link Getter} of integer values, read without boxing by the native layer.
+ * Lambdas passed to {@code integer(name, getter)} are converted to it rather than to {@code Getter<Integer>}.
+ */
+@FunctionalInterface
+public interface IntGetter extends Getter<Integer> {
+
+    int getInt();
+
+    @Override
+    default Integer get() {
+        return getInt();
+    }
+
+}
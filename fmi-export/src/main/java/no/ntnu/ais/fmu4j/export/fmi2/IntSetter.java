@@ -0,0 +1,16 @@
+package no.ntnu.ais.fmu4j.export.fmi2;
+
+/**
+ * A {@link Setter} of integer values, written without boxing by the native layer.
+ */
+@FunctionalInterface
+public interface IntSetter extends Setter<Integer> {
+
+    void setInt(int value);
+
+    @Override
+    default void set(Integer value) {
+        setInt(value);
+    }
+
+}
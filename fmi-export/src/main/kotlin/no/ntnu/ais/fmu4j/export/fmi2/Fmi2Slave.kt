@@ -1,33 +1,105 @@
 package no.ntnu.ais.fmu4j.export.fmi2
 
 import no.ntnu.ais.fmu4j.export.*
+import no.ntnu.ais.fmu4j.export.fmi3.Fmi3ModelDescription
+import no.ntnu.ais.fmu4j.export.fmi3.Fmi3Variables
 import no.ntnu.ais.fmu4j.modeldescription.fmi2.*
 import java.io.ByteArrayOutputStream
 import java.io.Closeable
 import java.io.File
+import java.io.OutputStream
 import java.lang.reflect.Field
 import java.lang.reflect.Modifier
+import java.nio.ByteBuffer
 import java.time.LocalDateTime
 import java.time.format.DateTimeFormatter
 import java.util.*
+import java.util.function.DoubleSupplier
 import java.util.logging.Logger
 
 abstract class Fmi2Slave(
     args: Map<String, Any>
 ) : Closeable {
 
+    /**
+     * The model description built by [__define__].
+     * Not available on slaves defined by [__defineFromIndex__], which build none.
+     */
     val modelDescription = Fmi2ModelDescription()
-    val instanceName: String = args["instanceName"] as? String
+        get() {
+            checkDescribed("modelDescription")
+            return field
+        }
+    var instanceName: String = args["instanceName"] as? String
         ?: throw IllegalStateException("Missing 'instanceName'")
+        private set
     private val resourceLocation: String? = args["resourceLocation"] as? String
 
-    private val intAccessors: MutableList<IntVariable> = mutableListOf()
-    private val realAccessors: MutableList<RealVariable> = mutableListOf()
-    private val boolAccessors: MutableList<BooleanVariable> = mutableListOf()
-    private val stringAccessors: MutableList<StringVariable> = mutableListOf()
+    // scalar or array variables of each type, by slot
+    private val intAccessors: MutableList<Variable<*>> = mutableListOf()
+    private val realAccessors: MutableList<Variable<*>> = mutableListOf()
+    private val boolAccessors: MutableList<Variable<*>> = mutableListOf()
+    private val stringAccessors: MutableList<Variable<*>> = mutableListOf()
+    // slots of the variables in the accessor lists above, by value reference
+    private val intSlots = ValueReferenceTable()
+    private val realSlots = ValueReferenceTable()
+    private val boolSlots = ValueReferenceTable()
+    private val stringSlots = ValueReferenceTable()
+    private val valueReferences: MutableMap<String, Long> = HashMap()
+    // first value reference and size of the array variables, by name
+    private val arrayReferences: MutableMap<String, Pair<Long, Int>> = HashMap()
 
     protected open val automaticallyAssignStartValues = true
 
+    /**
+     * If true, the state right after [__define__] is captured using [saveState],
+     * and fmi2Reset restores it in place rather than constructing a new instance.
+     */
+    protected open val resetFromSnapshot = false
+
+    private val annotatedFields: MutableList<Field> = mutableListOf()
+    private val stateLayout: StateLayout by lazy { StateLayout(this, annotatedFields) }
+    private var initialState: Any? = null
+    private val inputDerivatives: MutableMap<Long, DoubleArray> = HashMap()
+    // real inputs connected to outputs of slaves in the same JVM, by value reference, read ahead of each step
+    private val connections: MutableMap<Long, DoubleSupplier> = LinkedHashMap()
+    // handed out by __realSourceHandle__, by value reference
+    private val realSources: MutableMap<Long, Pair<Long, RealSource>> = HashMap()
+    private var stepEnd = Double.NaN
+    private var preferredStepSize = Double.NaN
+    private val stateSerializer: StateSerializer by lazy { StateSerializer(stateDeltaInterval) }
+
+    private val definedVariables: MutableList<VariableIndex.Entry> = mutableListOf()
+    // declared (or probed) dependency names and kinds, by variable name
+    private val declaredDependencies: MutableMap<String, Pair<List<String>, List<Fmi2DependencyKind>?>> = HashMap()
+    // blocks of the continuous state vector and their derivatives, see registerContinuousStates
+    private val continuousStates: MutableList<Pair<DoubleArray, DoubleArray>> = mutableListOf()
+    private var numberOfContinuousStates = 0
+    // (1 based) indices of the state derivative variables
+    private val stateDerivatives: MutableList<Long> = mutableListOf()
+    // primitive array fields by variable name, exposed as array variables through FMI 3.0
+    private val arrayFields: MutableMap<String, Any> = HashMap()
+    private var currentField: Field? = null
+    // accessors generated for the annotated fields by fmi-export-processor, if any, see GeneratedAccessors
+    private val generatedAccessors: GeneratedAccessors? = GeneratedAccessors.find(javaClass)
+    private val readOverrides: ReadOverrides = ReadOverrides.of(javaClass)
+    private val generatedFields: Map<String, Int> by lazy {
+        generatedAccessors?.fields?.withIndex()?.associate { (i, key) -> key to i } ?: emptyMap()
+    }
+    private var lightweight = false
+    // whether __defineFromIndex__ succeeded, leaving the model description empty
+    private var definedFromIndex = false
+
+    private val warmupStepSize: Double by lazy {
+        javaClass.getAnnotation(DefaultExperiment::class.java)?.stepSize?.takeIf { it > 0 } ?: DEFAULT_WARMUP_STEP_SIZE
+    }
+
+    private val hasAnalyticDirectionalDerivative: Boolean by lazy {
+        javaClass.getMethod(
+            "directionalDerivative", LongArray::class.java, LongArray::class.java, DoubleArray::class.java
+        ).declaringClass != Fmi2Slave::class.java
+    }
+
     val modelDescriptionXml: String by lazy {
         String(ByteArrayOutputStream().use { baos ->
             modelDescription.toXml(baos)
@@ -35,20 +107,85 @@ abstract class Fmi2Slave(
         })
     }
 
+    private val fmi3Variables: Fmi3Variables by lazy {
+        checkDescribed("The FMI 3.0 variables")
+        Fmi3Variables(this, modelDescription.modelVariables.scalarVariable, arrayFields)
+    }
+
+    /**
+     * The FMI 3.0 co-simulation model description, in which annotated primitive array fields are array variables.
+     */
+    val fmi3ModelDescriptionXml: String by lazy {
+        Fmi3ModelDescription.toXml(this, fmi3Variables)
+    }
+
+    /**
+     * The time reached by the last step, or the start time before the first one.
+     */
+    var simulationTime: Double = 0.0
+        private set
+
     fun getFmuResource(name: String): File {
         return File(resourceLocation, name)
     }
 
-    fun getVariableName(vr: Long, type: Fmi2VariableType): Long {
-        return modelDescription.modelVariables.scalarVariable
-            .firstOrNull { it.valueReference == vr && it.type() == type }?.valueReference
-            ?: throw IllegalArgumentException("No such variable with valueReference $vr!")
+    fun getVariableName(vr: Long, type: Fmi2VariableType): String {
+        val slots = slotsOf(type)
+        return slots.nameOf(slotOf(slots, vr), vr)
     }
 
     fun getValueRef(name: String): Long {
-        return modelDescription.modelVariables.scalarVariable
-            .firstOrNull { it.name == name }?.valueReference
-            ?: throw IllegalArgumentException("No such variable with name $name!")
+        valueReferences[name]?.also { return it }
+        // elements of array variables, named name[i]
+        val open = name.lastIndexOf('[')
+        if (open > 0 && name.endsWith("]")) {
+            val array = arrayReferences[name.substring(0, open)]
+            val index = name.substring(open + 1, name.length - 1).toIntOrNull()
+            if (array != null && index != null && index >= 0 && index < array.second) {
+                return array.first + index
+            }
+        }
+        throw IllegalArgumentException("No such variable with name $name!")
+    }
+
+    private fun slotsOf(type: Fmi2VariableType): ValueReferenceTable {
+        return when (type) {
+            Fmi2VariableType.INTEGER, Fmi2VariableType.ENUMERATION -> intSlots
+            Fmi2VariableType.REAL -> realSlots
+            Fmi2VariableType.BOOLEAN -> boolSlots
+            Fmi2VariableType.STRING -> stringSlots
+        }
+    }
+
+    private fun slotOf(slots: ValueReferenceTable, vr: Long): Int {
+        val slot = slots.slotOf(vr)
+        require(slot >= 0) { "No such variable with valueReference $vr!" }
+        return slot
+    }
+
+    // the number of value references from vr[i] on that are consecutive elements of the array variable in slot
+    private fun runLength(slots: ValueReferenceTable, slot: Int, vr: LongArray, i: Int): Int {
+        val remaining = slots.remaining(slot, vr[i])
+        var n = 1
+        while (n < remaining && i + n < vr.size && vr[i + n] == vr[i] + n) {
+            n++
+        }
+        return n
+    }
+
+    private fun realAt(vr: Long): Double {
+        val slot = slotOf(realSlots, vr)
+        return when (val v = realAccessors[slot]) {
+            is RealArrayVariable -> v.values[realSlots.offsetOf(slot, vr)]
+            else -> (v as RealVariable).doubleGetter.getDouble()
+        }
+    }
+
+    /**
+     * Writes the [VariableIndex] of the variables registered by [__define__].
+     */
+    fun writeVariableIndex(out: OutputStream) {
+        VariableIndex(definedVariables).write(out)
     }
 
     open fun setupExperiment(startTime: Double, stopTime: Double, tolerance: Double) {}
@@ -56,31 +193,353 @@ abstract class Fmi2Slave(
     open fun exitInitialisationMode() {}
 
     abstract fun doStep(currentTime: Double, dt: Double)
+
+    /**
+     * Ends the ongoing [doStep] early, having reached [time] rather than the end of the communication step.
+     * The master is answered fmi2Discard with [time] as the last successful time, and may retry with a shorter step.
+     * Unlike throwing from [doStep], which reports the start of the step, the progress made is kept.
+     */
+    protected fun endStepAt(time: Double) {
+        stepEnd = time
+    }
+
+    /**
+     * Suggests the size of the next communication step, e.g. to land on an upcoming event,
+     * available to masters through the fmi2GetPreferredStepSize vendor function until the next step.
+     */
+    protected fun preferStepSize(stepSize: Double) {
+        preferredStepSize = stepSize
+    }
+
     open fun terminate() {}
     override fun close() {}
 
-    open fun getInteger(vr: LongArray): IntArray {
-        return IntArray(vr.size) { i ->
-            intAccessors[vr[i].toInt()].getter.get()
+    /**
+     * Invoked when the instance is freed while instance pooling is enabled (FMU4J_INSTANCE_POOL_SIZE > 0).
+     * Return true if the slave has been restored to the state it had right after [__define__],
+     * so that it may be handed out to a later instantiation of the same FMU.
+     * [close] is not invoked on recycled instances.
+     * By default, slaves using [resetFromSnapshot] are recycled.
+     */
+    open fun recycle(): Boolean = __reset__()
+
+    /**
+     * Captures the current state of the slave.
+     * The default implementation copies the values of all fields annotated with [ScalarVariable].
+     * Override together with [restoreState] if the slave holds state elsewhere.
+     */
+    open fun saveState(): Any {
+        return stateLayout.capture(this)
+    }
+
+    /**
+     * Captures the current state into [state], previously returned by [saveState], and returns the updated state.
+     * Used when fmi2GetFMUstate overwrites an existing FMU state, typically once per step,
+     * so the default implementation refills the arrays of the default snapshot instead of allocating new ones.
+     * Falls back to [saveState] for custom states.
+     */
+    open fun saveStateInto(state: Any): Any {
+        val snapshot = state as? FieldSnapshot ?: return saveState()
+        stateSerializer.invalidate(snapshot)
+        stateLayout.captureInto(this, snapshot)
+        return snapshot
+    }
+
+    /**
+     * Restores a state previously returned by [saveState].
+     */
+    open fun restoreState(state: Any) {
+        val snapshot = state as? FieldSnapshot
+            ?: throw IllegalArgumentException("Unsupported state type: ${state.javaClass.name}")
+        stateLayout.restore(this, snapshot)
+    }
+
+    /**
+     * Number of bytes [serializeState] will write for [state], previously returned by [saveState].
+     * Always invoked right before [serializeState].
+     */
+    open fun serializedStateSize(state: Any): Int {
+        return stateSerializer.size(state.asFieldSnapshot())
+    }
+
+    /**
+     * Writes [state] into [buffer], backed by the memory of the host for fmi2SerializeFMUstate.
+     * The default implementation writes the values of the default snapshot in a compact binary layout,
+     * or only the values changed since the previous serialization if FMU4J_STATE_DELTAS is set.
+     */
+    open fun serializeState(state: Any, buffer: ByteBuffer) {
+        stateSerializer.write(state.asFieldSnapshot(), buffer)
+    }
+
+    /**
+     * Reads a state written by [serializeState], to be passed to [restoreState].
+     */
+    open fun deserializeState(buffer: ByteBuffer): Any {
+        return stateSerializer.read(buffer)
+    }
+
+    private fun Any.asFieldSnapshot(): FieldSnapshot {
+        return this as? FieldSnapshot
+            ?: throw IllegalArgumentException("Unsupported state type: ${javaClass.name}")
+    }
+
+    /**
+     * Invoked repeatedly after [exitInitialisationMode] while JIT warmup is enabled (FMU4J_WARMUP_MS > 0),
+     * so that the hot paths of the slave are compiled before the first real step.
+     * Must leave the slave in the state it was found in. Return false once there is nothing (more) to warm up.
+     * By default, slaves using [resetFromSnapshot] perform a dry [doStep] that is rolled back using [restoreState].
+     */
+    open fun warmup(startTime: Double): Boolean {
+        if (!resetFromSnapshot) return false
+        val state = saveState()
+        try {
+            doStep(startTime, warmupStepSize)
+        } finally {
+            restoreState(state)
         }
+        return true
     }
 
-    open fun getReal(vr: LongArray): DoubleArray {
-        return DoubleArray(vr.size) { i ->
-            realAccessors[vr[i].toInt()].getter.get()
+    /**
+     * Directional derivative of the [unknowns] with respect to the [knowns] along [seed],
+     * i.e. the partial derivatives of the unknowns times [seed], backing fmi2GetDirectionalDerivative.
+     * Override to provide analytic derivatives, which also declares providesDirectionalDerivative.
+     * The default implementation uses forward differences, see [SlaveInfo.providesDirectionalDerivative].
+     */
+    open fun directionalDerivative(unknowns: LongArray, knowns: LongArray, seed: DoubleArray): DoubleArray {
+        return finiteDifferences(unknowns, knowns, seed)
+    }
+
+    /**
+     * Forward differences of the [unknowns] along each seed in [seeds], [knowns].size values per seed.
+     * The knowns are perturbed using [setReal], and restored together with the state captured by [saveState].
+     */
+    private fun finiteDifferences(unknowns: LongArray, knowns: LongArray, seeds: DoubleArray): DoubleArray {
+        val n = knowns.size
+        val nSeeds = if (n == 0) 0 else seeds.size / n
+        val derivatives = DoubleArray(nSeeds * unknowns.size)
+        if (nSeeds == 0 || unknowns.isEmpty()) return derivatives
+
+        val state = saveState()
+        val x = getReal(knowns)
+        val y = getReal(unknowns)
+        val perturbed = DoubleArray(n)
+        try {
+            for (s in 0 until nSeeds) {
+                var norm = 0.0
+                var scale = 1.0
+                for (i in 0 until n) {
+                    norm = maxOf(norm, Math.abs(seeds[s * n + i]))
+                    scale = maxOf(scale, Math.abs(x[i]))
+                }
+                if (norm == 0.0) continue
+                val h = FINITE_DIFFERENCE_STEP * scale / norm
+                for (i in 0 until n) {
+                    perturbed[i] = x[i] + h * seeds[s * n + i]
+                }
+                setReal(knowns, perturbed)
+                val yh = getReal(unknowns)
+                for (j in unknowns.indices) {
+                    derivatives[s * unknowns.size + j] = (yh[j] - y[j]) / h
+                }
+            }
+        } finally {
+            setReal(knowns, x)
+            restoreState(state)
         }
+        return derivatives
     }
 
-    open fun getBoolean(vr: LongArray): BooleanArray {
-        return BooleanArray(vr.size) { i ->
-            boolAccessors[vr[i].toInt()].getter.get()
+    /**
+     * Value of the real input [vr] at [elapsed] seconds into the current communication step,
+     * extrapolated from its current value using the time derivatives provided by the master through
+     * fmi2SetRealInputDerivatives (see [SlaveInfo.canInterpolateInputs]).
+     * Returns the current value if no derivatives are set.
+     */
+    fun interpolateReal(vr: Long, elapsed: Double): Double {
+        val value = realAt(vr)
+        val derivatives = inputDerivatives[vr] ?: return value
+        var result = value
+        var term = 1.0
+        for (k in derivatives.indices) {
+            term *= elapsed / (k + 1)
+            result += derivatives[k] * term
         }
+        return result
     }
 
-    open fun getString(vr: LongArray): Array<String> {
-        return Array(vr.size) { i ->
-            stringAccessors[vr[i].toInt()].getter.get()
+    fun interpolateReal(name: String, elapsed: Double): Double {
+        return interpolateReal(getValueRef(name), elapsed)
+    }
+
+    /**
+     * Time derivatives of the real outputs [vr] of the given [order] at the current communication point,
+     * backing fmi2GetRealOutputDerivatives. Returns null (the default) to have the native layer
+     * estimate them by backward differences over the last communication points, up to the second order.
+     * Declare the highest supported order using [SlaveInfo.maxOutputDerivativeOrder].
+     */
+    open fun getRealOutputDerivatives(vr: LongArray, order: IntArray): DoubleArray? {
+        return null
+    }
+
+    /**
+     * Number of event indicators of a Model Exchange model, evaluated by [eventIndicators].
+     */
+    protected open val numberOfEventIndicators = 0
+
+    /**
+     * Computes the time derivatives of the continuous states at [time], from the state arrays into the derivative
+     * arrays passed to [registerContinuousStates]. Called by fmi2GetDerivatives once the states set by the solver
+     * have been copied in.
+     */
+    open fun computeDerivatives(time: Double) {}
+
+    /**
+     * Writes the [numberOfEventIndicators] event indicators at [time] into [indicators].
+     * A change of sign of an indicator makes the solver locate the event and enter event mode.
+     */
+    open fun eventIndicators(time: Double, indicators: DoubleArray) {}
+
+    /**
+     * Handles an event at [time] in event mode (fmi2NewDiscreteStates), e.g. by re-initializing states.
+     * Returns true if the values of the continuous states have changed.
+     */
+    open fun handleEvent(time: Double): Boolean = false
+
+    /**
+     * Writes the values of the integer variables [vr] into [values], which must hold at least `vr.size` values.
+     * Used by the native layer with arrays reused across calls, so that reading variables allocates nothing.
+     * Slaves customizing how variables are read should override these rather than the allocating variants.
+     * Overrides of the allocating variants are still called, in which case reading the variables allocates.
+     */
+    open fun getInteger(vr: LongArray, values: IntArray) {
+        if (readOverrides.integer) getInteger(vr).copyInto(values) else readInteger(vr, values)
+    }
+
+    open fun getReal(vr: LongArray, values: DoubleArray) {
+        if (readOverrides.real) getReal(vr).copyInto(values) else readReal(vr, values)
+    }
+
+    open fun getBoolean(vr: LongArray, values: BooleanArray) {
+        if (readOverrides.boolean) getBoolean(vr).copyInto(values) else readBoolean(vr, values)
+    }
+
+    open fun getString(vr: LongArray, values: Array<String?>) {
+        if (readOverrides.string) getString(vr).copyInto(values) else readString(vr, values)
+    }
+
+    private fun readInteger(vr: LongArray, values: IntArray) {
+        val accessors = generatedAccessors
+        var i = 0
+        while (i < vr.size) {
+            val slot = slotOf(intSlots, vr[i])
+            val v = intAccessors[slot]
+            if (v is IntArrayVariable) {
+                val n = runLength(intSlots, slot, vr, i)
+                System.arraycopy(v.values, intSlots.offsetOf(slot, vr[i]), values, i, n)
+                i += n
+            } else {
+                v as IntVariable
+                values[i++] = if (v.field >= 0) accessors!!.getInteger(this, v.field, v.index) else v.intGetter.getInt()
+            }
+        }
+    }
+
+    private fun readReal(vr: LongArray, values: DoubleArray) {
+        val accessors = generatedAccessors
+        var i = 0
+        while (i < vr.size) {
+            val slot = slotOf(realSlots, vr[i])
+            val v = realAccessors[slot]
+            if (v is RealArrayVariable) {
+                val n = runLength(realSlots, slot, vr, i)
+                System.arraycopy(v.values, realSlots.offsetOf(slot, vr[i]), values, i, n)
+                i += n
+            } else {
+                v as RealVariable
+                values[i++] = if (v.field >= 0) accessors!!.getReal(this, v.field, v.index) else v.doubleGetter.getDouble()
+            }
+        }
+    }
+
+    private fun readBoolean(vr: LongArray, values: BooleanArray) {
+        val accessors = generatedAccessors
+        var i = 0
+        while (i < vr.size) {
+            val slot = slotOf(boolSlots, vr[i])
+            val v = boolAccessors[slot]
+            if (v is BooleanArrayVariable) {
+                val n = runLength(boolSlots, slot, vr, i)
+                System.arraycopy(v.values, boolSlots.offsetOf(slot, vr[i]), values, i, n)
+                i += n
+            } else {
+                v as BooleanVariable
+                values[i++] = if (v.field >= 0) accessors!!.getBoolean(this, v.field, v.index) else v.booleanGetter.getBoolean()
+            }
+        }
+    }
+
+    private fun readString(vr: LongArray, values: Array<String?>) {
+        val accessors = generatedAccessors
+        var i = 0
+        while (i < vr.size) {
+            val slot = slotOf(stringSlots, vr[i])
+            val v = stringAccessors[slot]
+            if (v is StringArrayVariable) {
+                val n = runLength(stringSlots, slot, vr, i)
+                System.arraycopy(v.values, stringSlots.offsetOf(slot, vr[i]), values, i, n)
+                i += n
+            } else {
+                v as StringVariable
+                values[i++] = if (v.field >= 0) accessors!!.getString(this, v.field, v.index) else v.getter.get()
+            }
+        }
+    }
+
+    /**
+     * Reads all four kinds of variables at once, see [getReal].
+     */
+    open fun getAll(
+        intVr: LongArray, intValues: IntArray,
+        realVr: LongArray, realValues: DoubleArray,
+        boolVr: LongArray, boolValues: BooleanArray,
+        strVr: LongArray, strValues: Array<String?>
+    ) {
+        if (readOverrides.all) {
+            val read = getAll(intVr, realVr, boolVr, strVr)
+            read.intValues.copyInto(intValues)
+            read.realValues.copyInto(realValues)
+            read.boolValues.copyInto(boolValues)
+            read.strValues.copyInto(strValues)
+            return
         }
+        getInteger(intVr, intValues)
+        getReal(realVr, realValues)
+        getBoolean(boolVr, boolValues)
+        getString(strVr, strValues)
+    }
+
+    /*
+     * The allocating variants, which delegate to the variants above unless overridden themselves.
+     */
+
+    open fun getInteger(vr: LongArray): IntArray {
+        return IntArray(vr.size).also { if (readOverrides.integer) readInteger(vr, it) else getInteger(vr, it) }
+    }
+
+    open fun getReal(vr: LongArray): DoubleArray {
+        return DoubleArray(vr.size).also { if (readOverrides.real) readReal(vr, it) else getReal(vr, it) }
+    }
+
+    open fun getBoolean(vr: LongArray): BooleanArray {
+        return BooleanArray(vr.size).also { if (readOverrides.boolean) readBoolean(vr, it) else getBoolean(vr, it) }
+    }
+
+    @Suppress("UNCHECKED_CAST")
+    open fun getString(vr: LongArray): Array<String> {
+        val values = arrayOfNulls<String>(vr.size)
+        if (readOverrides.string) readString(vr, values) else getString(vr, values)
+        return values as Array<String>
     }
 
     open fun getAll(intVr: LongArray, realVr: LongArray, boolVr: LongArray, strVr: LongArray): BulkRead {
@@ -115,50 +574,98 @@ abstract class Fmi2Slave(
     }
 
     open fun setInteger(vr: LongArray, values: IntArray) {
-        for (i in vr.indices) {
-            intAccessors[vr[i].toInt()].apply {
-                setter?.set(values[i]) ?: LOG.warning(
-                    "Trying to assign value=${values[i]} to variable '${
-                        getVariableName(vr[i], Fmi2VariableType.INTEGER)
-                    }' without a specified setter!"
-                )
+        var i = 0
+        while (i < vr.size) {
+            val slot = slotOf(intSlots, vr[i])
+            val v = intAccessors[slot]
+            if (v is IntArrayVariable) {
+                val n = runLength(intSlots, slot, vr, i)
+                System.arraycopy(values, i, v.values, intSlots.offsetOf(slot, vr[i]), n)
+                i += n
+                continue
             }
+            v as IntVariable
+            val setter = v.setter
+            if (v.field >= 0 && setter != null) {
+                generatedAccessors!!.setInteger(this, v.field, v.index, values[i])
+            } else setter?.setInt(values[i]) ?: LOG.warning(
+                "Trying to assign value=${values[i]} to variable '${
+                    getVariableName(vr[i], Fmi2VariableType.INTEGER)
+                }' without a specified setter!"
+            )
+            i++
         }
     }
 
     open fun setReal(vr: LongArray, values: DoubleArray) {
-        for (i in vr.indices) {
-            realAccessors[vr[i].toInt()].apply {
-                setter?.set(values[i]) ?: LOG.warning(
-                    "Trying to assign value=${values[i]} to variable '${
-                        getVariableName(vr[i], Fmi2VariableType.REAL)
-                    }' without a specified setter!"
-                )
+        var i = 0
+        while (i < vr.size) {
+            val slot = slotOf(realSlots, vr[i])
+            val v = realAccessors[slot]
+            if (v is RealArrayVariable) {
+                val n = runLength(realSlots, slot, vr, i)
+                System.arraycopy(values, i, v.values, realSlots.offsetOf(slot, vr[i]), n)
+                i += n
+                continue
             }
+            v as RealVariable
+            val setter = v.setter
+            if (v.field >= 0 && setter != null) {
+                generatedAccessors!!.setReal(this, v.field, v.index, values[i])
+            } else setter?.setDouble(values[i]) ?: LOG.warning(
+                "Trying to assign value=${values[i]} to variable '${
+                    getVariableName(vr[i], Fmi2VariableType.REAL)
+                }' without a specified setter!"
+            )
+            i++
         }
     }
 
     open fun setBoolean(vr: LongArray, values: BooleanArray) {
-        for (i in vr.indices) {
-            boolAccessors[vr[i].toInt()].apply {
-                setter?.set(values[i]) ?: LOG.warning(
-                    "Trying to assign value=${values[i]} to variable '${
-                        getVariableName(vr[i], Fmi2VariableType.BOOLEAN)
-                    }' without a specified setter!"
-                )
+        var i = 0
+        while (i < vr.size) {
+            val slot = slotOf(boolSlots, vr[i])
+            val v = boolAccessors[slot]
+            if (v is BooleanArrayVariable) {
+                val n = runLength(boolSlots, slot, vr, i)
+                System.arraycopy(values, i, v.values, boolSlots.offsetOf(slot, vr[i]), n)
+                i += n
+                continue
             }
+            v as BooleanVariable
+            val setter = v.setter
+            if (v.field >= 0 && setter != null) {
+                generatedAccessors!!.setBoolean(this, v.field, v.index, values[i])
+            } else setter?.setBoolean(values[i]) ?: LOG.warning(
+                "Trying to assign value=${values[i]} to variable '${
+                    getVariableName(vr[i], Fmi2VariableType.BOOLEAN)
+                }' without a specified setter!"
+            )
+            i++
         }
     }
 
     open fun setString(vr: LongArray, values: Array<String>) {
-        for (i in vr.indices) {
-            stringAccessors[vr[i].toInt()].apply {
-                setter?.set(values[i]) ?: LOG.warning(
-                    "Trying to assign value=${values[i]} to variable '${
-                        getVariableName(vr[i], Fmi2VariableType.STRING)
-                    }' without a specified setter!"
-                )
+        var i = 0
+        while (i < vr.size) {
+            val slot = slotOf(stringSlots, vr[i])
+            val v = stringAccessors[slot]
+            if (v is StringArrayVariable) {
+                val n = runLength(stringSlots, slot, vr, i)
+                System.arraycopy(values, i, v.values, stringSlots.offsetOf(slot, vr[i]), n)
+                i += n
+                continue
             }
+            v as StringVariable
+            val setter = v.setter
+            if (v.field >= 0 && setter != null) {
+                generatedAccessors!!.setString(this, v.field, v.index, values[i])
+            } else setter?.set(values[i]) ?: LOG.warning(
+                "Trying to assign value=${values[i]} to variable '${
+                    getVariableName(vr[i], Fmi2VariableType.STRING)
+                }' without a specified setter!"
+            )
+            i++
         }
     }
 
@@ -173,12 +680,64 @@ abstract class Fmi2Slave(
     protected fun integer(name: String, getter: Getter<Int>) = IntVariable(name, getter)
     protected fun real(name: String, getter: Getter<Double>) = RealVariable(name, getter)
     protected fun boolean(name: String, getter: Getter<Boolean>) = BooleanVariable(name, getter)
+
+    /*
+     * Lambdas are converted to the primitive getters rather than to Getter, as these are more specific,
+     * so that reading the variables does not box.
+     */
+
+    protected fun integer(name: String, getter: IntGetter) = IntVariable(name, getter)
+    protected fun real(name: String, getter: DoubleGetter) = RealVariable(name, getter)
+    protected fun boolean(name: String, getter: BooleanGetter) = BooleanVariable(name, getter)
     protected fun string(name: String, getter: Getter<String>) = StringVariable(name, getter)
 
+    protected fun integers(name: String, values: IntArray) = IntArrayVariable(name, values)
+    protected fun reals(name: String, values: DoubleArray) = RealArrayVariable(name, values)
+    protected fun booleans(name: String, values: BooleanArray) = BooleanArrayVariable(name, values)
+    protected fun strings(name: String, values: Array<String>) = StringArrayVariable(name, values)
+
+
+    private fun internalRegister(v: Variable<*>, vr: Long, type: Fmi2VariableType): Fmi2ScalarVariable? {
+        val field = currentField
+        valueReferences.putIfAbsent(v.name, vr)
+        definedVariables.add(
+            VariableIndex.Entry(
+                v.name, vr, type, v.causality, v.variability,
+                field?.declaringClass?.name, field?.name
+            )
+        )
+        if (lightweight) return null
+
+        return describe(v, v.name, vr)
+    }
+
+    /**
+     * Registers the array variable [v] covering the value references [vr] until `vr + size`. As FMI 2.0 has no arrays,
+     * the model description lists each element, which is skipped when defining from a [VariableIndex].
+     */
+    private fun internalRegisterArray(v: Variable<*>, vr: Long, size: Int, type: Fmi2VariableType): List<Fmi2ScalarVariable>? {
+        val field = currentField
+        arrayReferences.putIfAbsent(v.name, vr to size)
+        definedVariables.add(
+            VariableIndex.Entry(
+                v.name, vr, type, v.causality, v.variability,
+                field?.declaringClass?.name, field?.name, size
+            )
+        )
+        if (lightweight) return null
+
+        return (0 until size).map { i -> describe(v, "${v.name}[$i]", vr + i) }
+    }
+
+    private fun describe(v: Variable<*>, name: String, vr: Long): Fmi2ScalarVariable {
+        val dependsOn = currentField?.getAnnotation(DependsOn::class.java)
+        (v.dependencies ?: dependsOn?.value?.toList())?.also { dependencies ->
+            val kinds = v.dependenciesKind ?: dependsOn?.kinds?.takeIf { it.isNotEmpty() }?.toList()
+            declaredDependencies[name] = dependencies to kinds
+        }
 
-    private fun internalRegister(v: Variable<*>, vr: Long): Fmi2ScalarVariable {
         return Fmi2ScalarVariable().also { s ->
-            s.name = v.name
+            s.name = name
             s.valueReference = vr
             s.description = v.description
 
@@ -192,10 +751,11 @@ abstract class Fmi2Slave(
 
     protected fun register(v: IntVariable) {
 
-        val vr = v.__overrideValueReference ?: intAccessors.size.toLong()
+        val vr = v.__overrideValueReference ?: intSlots.valueReferenceCount.toLong()
         intAccessors.add(v)
+        intSlots.add(vr, v.name)
 
-        internalRegister(v, vr).apply {
+        internalRegister(v, vr, Fmi2VariableType.INTEGER)?.apply {
             integer = Fmi2ScalarVariable.Integer().also { type ->
                 if (automaticallyAssignStartValues && requiresStart()) {
                     type.start = getInteger(longArrayOf(vr)).first()
@@ -211,10 +771,11 @@ abstract class Fmi2Slave(
 
     protected fun register(v: RealVariable) {
 
-        val vr = v.__overrideValueReference ?: realAccessors.size.toLong()
+        val vr = v.__overrideValueReference ?: realSlots.valueReferenceCount.toLong()
         realAccessors.add(v)
+        realSlots.add(vr, v.name)
 
-        internalRegister(v, vr).apply {
+        internalRegister(v, vr, Fmi2VariableType.REAL)?.apply {
             real = Fmi2ScalarVariable.Real().also { type ->
                 if (automaticallyAssignStartValues && requiresStart()) {
                     type.start = getReal(longArrayOf(vr)).first()
@@ -231,10 +792,11 @@ abstract class Fmi2Slave(
 
     protected fun register(v: BooleanVariable) {
 
-        val vr = v.__overrideValueReference ?: boolAccessors.size.toLong()
+        val vr = v.__overrideValueReference ?: boolSlots.valueReferenceCount.toLong()
         boolAccessors.add(v)
+        boolSlots.add(vr, v.name)
 
-        internalRegister(v, vr).apply {
+        internalRegister(v, vr, Fmi2VariableType.BOOLEAN)?.apply {
             boolean = Fmi2ScalarVariable.Boolean().also { type ->
                 if (automaticallyAssignStartValues && requiresStart()) {
                     type.isStart = getBoolean(longArrayOf(vr)).first()
@@ -247,10 +809,11 @@ abstract class Fmi2Slave(
 
     protected fun register(v: StringVariable) {
 
-        val vr = v.__overrideValueReference ?: stringAccessors.size.toLong()
+        val vr = v.__overrideValueReference ?: stringSlots.valueReferenceCount.toLong()
         stringAccessors.add(v)
+        stringSlots.add(vr, v.name)
 
-        internalRegister(v, vr).apply {
+        internalRegister(v, vr, Fmi2VariableType.STRING)?.apply {
             string = Fmi2ScalarVariable.String().also { type ->
                 if (automaticallyAssignStartValues && requiresStart()) {
                     type.start = getString(longArrayOf(vr)).first()
@@ -262,142 +825,280 @@ abstract class Fmi2Slave(
 
     }
 
-    protected open fun registerVariables() {}
+    protected fun register(v: IntArrayVariable) {
 
-    private fun registerAnnotatedVariables() {
+        val vr = v.__overrideValueReference ?: intSlots.valueReferenceCount.toLong()
+        intAccessors.add(v)
+        intSlots.addArray(vr, v.name, v.values.size)
 
-        fun processAnnotatedField(field: Field, annotation: ScalarVariable) {
+        internalRegisterArray(v, vr, v.values.size, Fmi2VariableType.INTEGER)?.forEachIndexed { i, s ->
+            s.integer = Fmi2ScalarVariable.Integer().also { type ->
+                if (automaticallyAssignStartValues && s.requiresStart()) {
+                    type.start = v.values[i]
+                }
+            }
+        }
 
-            field.isAccessible = true
-            val name = if (annotation.name.isNotEmpty()) annotation.name else field.name
+    }
 
-            when (val type = field.type) {
-                Int::class, Int::class.java -> {
-                    register(integer(name) { field.getInt(this) }.also { iv ->
-                        if (!Modifier.isFinal(field.modifiers)) {
-                            iv.setter { field.setInt(this, it) }
-                        }
-                        iv.applyAnnotation(annotation)
-                    })
+    protected fun register(v: RealArrayVariable) {
+
+        val vr = v.__overrideValueReference ?: realSlots.valueReferenceCount.toLong()
+        realAccessors.add(v)
+        realSlots.addArray(vr, v.name, v.values.size)
+
+        internalRegisterArray(v, vr, v.values.size, Fmi2VariableType.REAL)?.forEachIndexed { i, s ->
+            s.real = Fmi2ScalarVariable.Real().also { type ->
+                if (automaticallyAssignStartValues && s.requiresStart()) {
+                    type.start = v.values[i]
                 }
-                IntArray::class.java -> {
-                    val values = field.get(this) as? IntArray
-                        ?: throw IllegalStateException("Field ${field.name} cannot be null!")
-                    for (index in values.indices) {
-                        register(integer("${name}[$index]") { values[index] }.also { iv ->
-                            iv.setter { values[index] = it }
-                            iv.applyAnnotation(annotation)
-                        })
-                    }
+            }
+        }
+
+    }
+
+    protected fun register(v: BooleanArrayVariable) {
+
+        val vr = v.__overrideValueReference ?: boolSlots.valueReferenceCount.toLong()
+        boolAccessors.add(v)
+        boolSlots.addArray(vr, v.name, v.values.size)
+
+        internalRegisterArray(v, vr, v.values.size, Fmi2VariableType.BOOLEAN)?.forEachIndexed { i, s ->
+            s.boolean = Fmi2ScalarVariable.Boolean().also { type ->
+                if (automaticallyAssignStartValues && s.requiresStart()) {
+                    type.isStart = v.values[i]
                 }
-                Double::class, Double::class.java -> {
-                    register(real(name) { field.getDouble(this) }.also { iv ->
-                        if (!Modifier.isFinal(field.modifiers)) {
-                            iv.setter { field.setDouble(this, it) }
-                        }
-                        iv.applyAnnotation(annotation)
-                    })
+            }
+        }
+
+    }
+
+    protected fun register(v: StringArrayVariable) {
+
+        val vr = v.__overrideValueReference ?: stringSlots.valueReferenceCount.toLong()
+        stringAccessors.add(v)
+        stringSlots.addArray(vr, v.name, v.values.size)
+
+        internalRegisterArray(v, vr, v.values.size, Fmi2VariableType.STRING)?.forEachIndexed { i, s ->
+            s.string = Fmi2ScalarVariable.String().also { type ->
+                if (automaticallyAssignStartValues && s.requiresStart()) {
+                    type.start = v.values[i]
                 }
-                DoubleArray::class.java -> {
-                    val values = field.get(this) as? DoubleArray
-                        ?: throw IllegalStateException("Field ${field.name} cannot be null!")
-                    for (index in values.indices) {
-                        register(real("${name}[$index]") { values[index] }.also { iv ->
-                            iv.setter { values[index] = it }
-                            iv.applyAnnotation(annotation)
-                        })
+            }
+        }
+
+    }
+
+    protected open fun registerVariables() {}
+
+    /**
+     * Declares the continuous states of a Model Exchange model, registering the elements of [states] as the real
+     * variables `name[i]`, and those of [derivatives] as their time derivatives `der(name[i])`.
+     * The state vector of the solver is the concatenation of all registered [states], which are copied
+     * from and to it in bulk. The arrays must not be replaced, as the variables refer to them.
+     */
+    protected fun registerContinuousStates(name: String, states: DoubleArray, derivatives: DoubleArray) {
+        require(states.size == derivatives.size) {
+            "Continuous states '$name' have ${states.size} states, but ${derivatives.size} derivatives!"
+        }
+        continuousStates.add(states to derivatives)
+        numberOfContinuousStates += states.size
+        for (i in states.indices) {
+            register(real("$name[$i]") { states[i] }
+                .setter { states[i] = it }
+                .causality(Fmi2Causality.local)
+                .variability(Fmi2Variability.continuous)
+                .initial(Fmi2Initial.exact))
+            register(real("der($name[$i])") { derivatives[i] }
+                .causality(Fmi2Causality.local)
+                .variability(Fmi2Variability.continuous))
+            // no model description is built when defining from a VariableIndex
+            if (!lightweight) {
+                val variables = modelDescription.modelVariables.scalarVariable
+                // (1 based) index of the state, registered right before its derivative
+                variables.last().real.derivative = variables.size - 1L
+                stateDerivatives.add(variables.size.toLong())
+            }
+        }
+    }
+
+    private fun processAnnotatedField(field: Field, annotation: ScalarVariable) {
+
+        field.isAccessible = true
+        currentField = field
+        annotatedFields.add(field)
+        val name = if (annotation.name.isNotEmpty()) annotation.name else field.name
+        val generatedField = generatedFields["${field.declaringClass.name}#${field.name}"] ?: -1
+        // fields covered by the generated accessors need no method handles of their own
+        val accessors = if (generatedField >= 0) generatedAccessors else null
+        val settable = !Modifier.isFinal(field.modifiers)
+
+        when (val type = field.type) {
+            Int::class, Int::class.java -> {
+                val variable = if (accessors != null) {
+                    integer(name) { accessors.getInteger(this, generatedField, 0) }.also { iv ->
+                        if (settable) {
+                            iv.setter { accessors.setInteger(this, generatedField, 0, it) }
+                        }
                     }
-                }
-                Boolean::class, Boolean::class.java -> {
-                    register(boolean(name) { field.getBoolean(this) }.also { iv ->
-                        if (!Modifier.isFinal(field.modifiers)) {
-                            iv.setter { field.setBoolean(this, it) }
+                } else {
+                    val accessor = FieldAccessor(field, this)
+                    integer(name) { accessor.getInt() }.also { iv ->
+                        if (accessor.isSettable) {
+                            iv.setter { accessor.setInt(it) }
                         }
-                        iv.applyAnnotation(annotation)
-                    })
+                    }
                 }
-                BooleanArray::class.java -> {
-                    val values = field.get(this) as? BooleanArray
-                        ?: throw IllegalStateException("Field ${field.name} cannot be null!")
-                    for (index in values.indices) {
-                        register(boolean("${name}[$index]") { values[index] }.also { iv ->
-                            iv.setter { values[index] = it }
-                            iv.applyAnnotation(annotation)
-                        })
+                register(variable.also { iv ->
+                    iv.applyAnnotation(annotation)
+                    iv.bindField(generatedField, 0)
+                })
+            }
+            IntArray::class.java -> {
+                val values = field.get(this) as? IntArray
+                    ?: throw IllegalStateException("Field ${field.name} cannot be null!")
+                arrayFields[name] = values
+                register(integers(name, values).also { it.applyAnnotation(annotation) })
+            }
+            Double::class, Double::class.java -> {
+                val variable = if (accessors != null) {
+                    real(name) { accessors.getReal(this, generatedField, 0) }.also { iv ->
+                        if (settable) {
+                            iv.setter { accessors.setReal(this, generatedField, 0, it) }
+                        }
+                    }
+                } else {
+                    val accessor = FieldAccessor(field, this)
+                    real(name) { accessor.getDouble() }.also { iv ->
+                        if (accessor.isSettable) {
+                            iv.setter { accessor.setDouble(it) }
+                        }
                     }
                 }
-                String::class, String::class.java -> {
-                    register(string(name) { field.get(this) as String }.also { iv ->
-                        if (!Modifier.isFinal(field.modifiers)) {
-                            iv.setter { field.set(this, it) }
+                register(variable.also { iv ->
+                    iv.applyAnnotation(annotation)
+                    iv.bindField(generatedField, 0)
+                })
+            }
+            DoubleArray::class.java -> {
+                val values = field.get(this) as? DoubleArray
+                    ?: throw IllegalStateException("Field ${field.name} cannot be null!")
+                arrayFields[name] = values
+                register(reals(name, values).also { it.applyAnnotation(annotation) })
+            }
+            Boolean::class, Boolean::class.java -> {
+                val variable = if (accessors != null) {
+                    boolean(name) { accessors.getBoolean(this, generatedField, 0) }.also { iv ->
+                        if (settable) {
+                            iv.setter { accessors.setBoolean(this, generatedField, 0, it) }
                         }
-                        iv.applyAnnotation(annotation)
-                    })
+                    }
+                } else {
+                    val accessor = FieldAccessor(field, this)
+                    boolean(name) { accessor.getBoolean() }.also { iv ->
+                        if (accessor.isSettable) {
+                            iv.setter { accessor.setBoolean(it) }
+                        }
+                    }
                 }
-                Array<String>::class.java -> {
-                    val values = field.get(this) as? Array<*>
-                        ?: throw IllegalStateException("Field ${field.name} cannot be null!")
-                    for (value in values) {
-                        require(value?.javaClass == String::class.java)
+                register(variable.also { iv ->
+                    iv.applyAnnotation(annotation)
+                    iv.bindField(generatedField, 0)
+                })
+            }
+            BooleanArray::class.java -> {
+                val values = field.get(this) as? BooleanArray
+                    ?: throw IllegalStateException("Field ${field.name} cannot be null!")
+                arrayFields[name] = values
+                register(booleans(name, values).also { it.applyAnnotation(annotation) })
+            }
+            String::class, String::class.java -> {
+                val variable = if (accessors != null) {
+                    string(name) { accessors.getString(this, generatedField, 0) }.also { iv ->
+                        if (settable) {
+                            iv.setter { accessors.setString(this, generatedField, 0, it) }
+                        }
                     }
-                    @Suppress("UNCHECKED_CAST")
-                    values as Array<String>
-                    for (index in values.indices) {
-                        register(string("${name}[$index]") { values[index] }.also { iv ->
-                            iv.setter { values[index] = it }
-                            iv.applyAnnotation(annotation)
-                        })
+                } else {
+                    val accessor = FieldAccessor(field, this)
+                    string(name) { accessor.getString() }.also { iv ->
+                        if (accessor.isSettable) {
+                            iv.setter { accessor.setString(it) }
+                        }
                     }
                 }
-                else -> {
-                    when {
-                        IntVector::class.java.isAssignableFrom(type) -> {
-                            val values = field.get(this) as? IntVector
-                                ?: throw IllegalStateException("Field ${field.name} cannot be null!")
-                            for (index in 0 until values.size) {
-                                register(integer("${name}[$index]") { values[index] }.also { iv ->
-                                    iv.setter { values[index] = it }
-                                    iv.applyAnnotation(annotation)
-                                })
-                            }
+                register(variable.also { iv ->
+                    iv.applyAnnotation(annotation)
+                    iv.bindField(generatedField, 0)
+                })
+            }
+            Array<String>::class.java -> {
+                val values = field.get(this) as? Array<*>
+                    ?: throw IllegalStateException("Field ${field.name} cannot be null!")
+                for (value in values) {
+                    require(value?.javaClass == String::class.java)
+                }
+                @Suppress("UNCHECKED_CAST")
+                values as Array<String>
+                arrayFields[name] = values
+                register(strings(name, values).also { it.applyAnnotation(annotation) })
+            }
+            else -> {
+                when {
+                    IntVector::class.java.isAssignableFrom(type) -> {
+                        val values = field.get(this) as? IntVector
+                            ?: throw IllegalStateException("Field ${field.name} cannot be null!")
+                        for (index in 0 until values.size) {
+                            register(integer("${name}[$index]") { values[index] }.also { iv ->
+                                iv.setter { values[index] = it }
+                                iv.applyAnnotation(annotation)
+                                iv.bindField(generatedField, index)
+                            })
                         }
-                        RealVector::class.java.isAssignableFrom(type) -> {
-                            val values = field.get(this) as? RealVector
-                                ?: throw IllegalStateException("Field ${field.name} cannot be null!")
-                            for (index in 0 until values.size) {
-                                register(real("${name}[$index]") { values[index] }.also { iv ->
-                                    iv.setter { values[index] = it }
-                                    iv.applyAnnotation(annotation)
-                                })
-                            }
+                    }
+                    RealVector::class.java.isAssignableFrom(type) -> {
+                        val values = field.get(this) as? RealVector
+                            ?: throw IllegalStateException("Field ${field.name} cannot be null!")
+                        for (index in 0 until values.size) {
+                            register(real("${name}[$index]") { values[index] }.also { iv ->
+                                iv.setter { values[index] = it }
+                                iv.applyAnnotation(annotation)
+                                iv.bindField(generatedField, index)
+                            })
                         }
-                        BooleanVector::class.java.isAssignableFrom(type) -> {
-                            val values = field.get(this) as? BooleanVector
-                                ?: throw IllegalStateException("Field ${field.name} cannot be null!")
-                            for (index in 0 until values.size) {
-                                register(boolean("${name}[$index]") { values[index] }.also { iv ->
-                                    iv.setter { values[index] = it }
-                                    iv.applyAnnotation(annotation)
-                                })
-                            }
+                    }
+                    BooleanVector::class.java.isAssignableFrom(type) -> {
+                        val values = field.get(this) as? BooleanVector
+                            ?: throw IllegalStateException("Field ${field.name} cannot be null!")
+                        for (index in 0 until values.size) {
+                            register(boolean("${name}[$index]") { values[index] }.also { iv ->
+                                iv.setter { values[index] = it }
+                                iv.applyAnnotation(annotation)
+                                iv.bindField(generatedField, index)
+                            })
                         }
-                        StringVector::class.java.isAssignableFrom(type) -> {
-                            val values = field.get(this) as? StringVector
-                                ?: throw IllegalStateException("Field ${field.name} cannot be null!")
-                            for (index in 0 until values.size) {
-                                register(string("${name}[$index]") { values[index] }.also { iv ->
-                                    iv.setter { values[index] = it }
-                                    iv.applyAnnotation(annotation)
-                                })
-                            }
+                    }
+                    StringVector::class.java.isAssignableFrom(type) -> {
+                        val values = field.get(this) as? StringVector
+                            ?: throw IllegalStateException("Field ${field.name} cannot be null!")
+                        for (index in 0 until values.size) {
+                            register(string("${name}[$index]") { values[index] }.also { iv ->
+                                iv.setter { values[index] = it }
+                                iv.applyAnnotation(annotation)
+                                iv.bindField(generatedField, index)
+                            })
                         }
-                        else -> throw IllegalStateException("Unsupported variable type: $type")
                     }
+                    else -> throw IllegalStateException("Unsupported variable type: $type")
                 }
             }
-
         }
 
+        currentField = null
+    }
+
+    private fun registerAnnotatedVariables() {
+
         var cls: Class<*> = javaClass
         do {
             cls.declaredFields.forEach { field ->
@@ -438,11 +1139,15 @@ abstract class Fmi2Slave(
             cs.isCanNotUseMemoryManagementFunctions = true
             cs.modelIdentifier = modelDescription.modelName
             if (slaveInfo != null) {
+                cs.isCanGetAndSetFMUstate = slaveInfo.canGetAndSetFMUstate
+                cs.isCanSerializeFMUstate = slaveInfo.canGetAndSetFMUstate && slaveInfo.canSerializeFMUstate
                 cs.isNeedsExecutionTool = slaveInfo.needsExecutionTool
                 cs.isCanInterpolateInputs = slaveInfo.canInterpolateInputs
                 cs.isCanBeInstantiatedOnlyOncePerProcess = slaveInfo.canBeInstantiatedOnlyOncePerProcess
                 cs.isCanHandleVariableCommunicationStepSize = slaveInfo.canHandleVariableCommunicationStepSize
             }
+            cs.isProvidesDirectionalDerivative =
+                hasAnalyticDirectionalDerivative || slaveInfo?.providesDirectionalDerivative == true
         }
 
         javaClass.getAnnotation(DefaultExperiment::class.java)?.also { de ->
@@ -460,25 +1165,565 @@ abstract class Fmi2Slave(
         val outputs = variables.mapIndexedNotNull { i, v ->
             if (v.causality == Fmi2Causality.output) i.toLong() else null
         }
-        modelDescription.modelStructure = Fmi2ModelDescription.ModelStructure().also { ms ->
-            if (outputs.isNotEmpty()) {
+        val maxOutputDerivativeOrder = slaveInfo?.maxOutputDerivativeOrder?.takeIf { it >= 0 }
+            ?: if (outputs.any { variables[it.toInt()].real != null }) 1 else 0
+        if (maxOutputDerivativeOrder > 0) {
+            modelDescription.coSimulation.maxOutputDerivativeOrder = maxOutputDerivativeOrder.toLong()
+        }
+
+        if (numberOfContinuousStates > 0 || numberOfEventIndicators > 0) {
+            val cs = modelDescription.coSimulation
+            modelDescription.numberOfEventIndicators = numberOfEventIndicators.toLong()
+            modelDescription.modelExchange = Fmi2ModelDescription.ModelExchange().also { me ->
+                me.modelIdentifier = cs.modelIdentifier
+                me.isNeedsExecutionTool = cs.isNeedsExecutionTool
+                me.isCompletedIntegratorStepNotNeeded = true
+                me.isCanBeInstantiatedOnlyOncePerProcess = cs.isCanBeInstantiatedOnlyOncePerProcess
+                me.isCanNotUseMemoryManagementFunctions = true
+                me.isCanGetAndSetFMUstate = cs.isCanGetAndSetFMUstate
+                me.isCanSerializeFMUstate = cs.isCanSerializeFMUstate
+                me.isProvidesDirectionalDerivative = cs.isProvidesDirectionalDerivative
+            }
+        }
+
+        modelDescription.modelStructure = buildModelStructure()
+
+        check(modelDescription.modelVariables.scalarVariable.isNotEmpty()) { "No variables has been defined!" }
+
+        onDefined()
+
+    }
+
+    /**
+     * Detects direct feedthrough for the outputs without declared dependencies, by perturbing each input, and each
+     * parameter or other variable known during initialization, in turn and observing which outputs change, without
+     * stepping. Inputs end up in `ModelStructure/Outputs`, all of them in `InitialUnknowns`.
+     * Used by FmuBuilder when building with --probe-dependencies.
+     * Only meaningful for slaves computing their outputs from the knowns when read, and only at the start values.
+     */
+    fun __probeDependencies__() {
+
+        val variables = modelDescription.modelVariables.scalarVariable
+        val knowns = variables.filter {
+            it.causality == Fmi2Causality.input || it.variability != Fmi2Variability.constant &&
+                    (it.causality == Fmi2Causality.parameter || it.initial == Fmi2Initial.exact)
+        }
+        val outputs = variables.filter { it.causality == Fmi2Causality.output && it.name !in declaredDependencies }
+        if (outputs.isEmpty()) return
+
+        val found = outputs.map { mutableListOf<String>() }
+        val before = outputs.map { probeValue(it) }
+        for (known in knowns) {
+            val value = probeValue(known)
+            perturb(known)
+            outputs.forEachIndexed { j, output ->
+                if (probeValue(output) != before[j]) {
+                    found[j].add(known.name)
+                }
+            }
+            setProbeValue(known, value)
+        }
+        outputs.forEachIndexed { j, output ->
+            declaredDependencies[output.name] = found[j] to null
+        }
+
+        modelDescription.modelStructure = buildModelStructure()
+
+    }
+
+    private fun probeValue(v: Fmi2ScalarVariable): Any {
+        val vr = longArrayOf(v.valueReference)
+        return when (v.type()) {
+            Fmi2VariableType.INTEGER, Fmi2VariableType.ENUMERATION -> getInteger(vr)[0]
+            Fmi2VariableType.REAL -> getReal(vr)[0]
+            Fmi2VariableType.BOOLEAN -> getBoolean(vr)[0]
+            Fmi2VariableType.STRING -> getString(vr)[0]
+        }
+    }
+
+    private fun setProbeValue(v: Fmi2ScalarVariable, value: Any) {
+        val vr = longArrayOf(v.valueReference)
+        when (v.type()) {
+            Fmi2VariableType.INTEGER, Fmi2VariableType.ENUMERATION -> setInteger(vr, intArrayOf(value as Int))
+            Fmi2VariableType.REAL -> setReal(vr, doubleArrayOf(value as Double))
+            Fmi2VariableType.BOOLEAN -> setBoolean(vr, booleanArrayOf(value as Boolean))
+            Fmi2VariableType.STRING -> setString(vr, arrayOf(value as String))
+        }
+    }
+
+    private fun perturb(v: Fmi2ScalarVariable) {
+        when (val value = probeValue(v)) {
+            is Int -> setProbeValue(v, value + 1)
+            is Double -> setProbeValue(v, value + Math.max(Math.abs(value), 1.0) * PROBE_PERTURBATION)
+            is Boolean -> setProbeValue(v, !value)
+            is String -> setProbeValue(v, "$value.")
+        }
+    }
+
+    /**
+     * Outputs and InitialUnknowns of the model structure. Outputs without declared dependencies
+     * are left without the dependencies attribute, meaning they depend on all knowns.
+     */
+    private fun buildModelStructure(): Fmi2ModelDescription.ModelStructure {
+
+        val structure = modelDependencies()
+        return Fmi2ModelDescription.ModelStructure().also { ms ->
+            if (structure.outputs.isNotEmpty()) {
                 ms.outputs = Fmi2VariableDependency()
-                outputs.forEach {
+                structure.outputs.forEach { unknown ->
                     ms.outputs.unknown.add(Fmi2VariableDependency.Unknown().also { u ->
-                        u.index = (it + 1)
+                        u.index = unknown.index
+                        unknown.dependencies?.also { u.dependencies.addAll(it) }
+                        unknown.dependenciesKind?.also { kinds -> u.dependenciesKind.addAll(kinds.map { it.name }) }
+                    })
+                }
+            }
+            if (structure.derivatives.isNotEmpty()) {
+                ms.derivatives = Fmi2VariableDependency()
+                structure.derivatives.forEach { unknown ->
+                    ms.derivatives.unknown.add(Fmi2VariableDependency.Unknown().also { u -> u.index = unknown.index })
+                }
+            }
+            if (structure.initialUnknowns.isNotEmpty()) {
+                ms.initialUnknowns = Fmi2ModelDescription.ModelStructure.InitialUnknowns()
+                structure.initialUnknowns.forEach { unknown ->
+                    ms.initialUnknowns.unknown.add(Fmi2ModelDescription.ModelStructure.InitialUnknowns.Unknown().also { u ->
+                        u.index = unknown.index
+                        unknown.dependencies?.also { u.dependencies.addAll(it) }
                     })
                 }
             }
         }
 
-        check(modelDescription.modelVariables.scalarVariable.isNotEmpty()) { "No variables has been defined!" }
+    }
+
+    /**
+     * The model structure in terms of (1 based) variable indices, shared by the FMI 2.0 and 3.0 model descriptions.
+     */
+    internal fun modelDependencies(): ModelDependencies {
+
+        val variables = modelDescription.modelVariables.scalarVariable
+        val indices = HashMap<String, Long>(variables.size)
+        variables.forEachIndexed { i, v -> indices[v.name] = i + 1L }
+
+        // declared dependencies as sorted (index, kind) pairs, null if undeclared
+        fun resolve(v: Fmi2ScalarVariable): List<Pair<Long, Fmi2DependencyKind>>? {
+            val (names, kinds) = declaredDependencies[v.name] ?: return null
+            check(kinds == null || kinds.size == names.size) {
+                "Variable '${v.name}' declares ${names.size} dependencies, but ${kinds?.size} kinds!"
+            }
+            return names.flatMapIndexed { i, name ->
+                val kind = kinds?.get(i) ?: Fmi2DependencyKind.dependent
+                indices[name]?.let { listOf(it to kind) }
+                    ?: variables.indices.filter { variables[it].name.startsWith("$name[") }.map { (it + 1L) to kind }
+                        .ifEmpty { throw IllegalStateException("Variable '${v.name}' depends on unknown variable '$name'!") }
+            }.sortedBy { it.first }
+        }
+
+        fun knownAt(index: Long, initialization: Boolean): Boolean {
+            val v = variables[index.toInt() - 1]
+            return when {
+                v.causality == Fmi2Causality.input -> true
+                !initialization -> false
+                v.causality == Fmi2Causality.independent || v.initial == Fmi2Initial.exact -> true
+                else -> v.initial == Fmi2Initial.undefined &&
+                        (v.causality == Fmi2Causality.parameter || v.variability == Fmi2Variability.constant)
+            }
+        }
+
+        val outputs = mutableListOf<ModelDependencies.Unknown>()
+        val initialUnknowns = mutableListOf<ModelDependencies.Unknown>()
+        variables.forEachIndexed { i, v ->
+            val initialUnknown = when (v.causality) {
+                Fmi2Causality.output -> v.initial != Fmi2Initial.exact &&
+                        !(v.initial == Fmi2Initial.undefined && v.variability == Fmi2Variability.constant)
+                Fmi2Causality.calculatedParameter -> true
+                else -> (i + 1L) in stateDerivatives
+            }
+            if (v.causality != Fmi2Causality.output && !initialUnknown) return@forEachIndexed
+
+            val dependencies = resolve(v)
+            val hasKinds = declaredDependencies[v.name]?.second != null
+            if (v.causality == Fmi2Causality.output) {
+                val known = dependencies?.filter { knownAt(it.first, false) }
+                outputs.add(ModelDependencies.Unknown(i + 1L, known?.map { it.first },
+                    known?.takeIf { hasKinds }?.map { it.second }))
+            }
+            if (initialUnknown) {
+                val known = dependencies?.filter { knownAt(it.first, true) }
+                initialUnknowns.add(ModelDependencies.Unknown(i + 1L, known?.map { it.first }, null))
+            }
+        }
+        // the derivatives of the continuous states depend on all states and inputs
+        val derivatives = stateDerivatives.map { ModelDependencies.Unknown(it, null, null) }
+        return ModelDependencies(outputs, initialUnknowns, derivatives)
 
     }
 
+    /**
+     * Lightweight alternative to [__define__], used by the native layer when the FMU contains a [VariableIndex].
+     * Annotated fields are bound directly from the index and no model description is built,
+     * so [modelDescription], [modelDescriptionXml] and the FMI 3.0 accessors fail with an IllegalStateException,
+     * and start values are not evaluated.
+     * Falls back to [__define__] if the registered variables do not match the index.
+     */
+    fun __defineFromIndex__(indexPath: String) {
+
+        try {
+            val index = File(indexPath).inputStream().use { VariableIndex.read(it) }
+            lightweight = true
+            registerIndexedFields(index)
+            registerVariables()
+            if (definedVariables.size == index.entries.size &&
+                definedVariables.indices.all { i -> definedVariables[i].matches(index.entries[i]) }
+            ) {
+                check(definedVariables.isNotEmpty()) { "No variables has been defined!" }
+                definedFromIndex = true
+                onDefined()
+                return
+            }
+            LOG.warning("Variables registered by ${javaClass.name} do not match '$indexPath', falling back to a full define.")
+        } catch (ex: Exception) {
+            LOG.warning("Unable to define ${javaClass.name} from '$indexPath': $ex, falling back to a full define.")
+        } finally {
+            lightweight = false
+            currentField = null
+        }
+
+        intAccessors.clear()
+        realAccessors.clear()
+        boolAccessors.clear()
+        stringAccessors.clear()
+        intSlots.clear()
+        realSlots.clear()
+        boolSlots.clear()
+        stringSlots.clear()
+        valueReferences.clear()
+        arrayReferences.clear()
+        annotatedFields.clear()
+        definedVariables.clear()
+        declaredDependencies.clear()
+        arrayFields.clear()
+        continuousStates.clear()
+        numberOfContinuousStates = 0
+        stateDerivatives.clear()
+
+        __define__()
+
+    }
+
+    private fun registerIndexedFields(index: VariableIndex) {
+        var previous: VariableIndex.Entry? = null
+        for (entry in index.entries) {
+            val declaringClass = entry.declaringClass ?: continue
+            // array and vector elements are listed individually, but registered per field
+            if (previous != null && previous.declaringClass == declaringClass && previous.fieldName == entry.fieldName) {
+                continue
+            }
+            previous = entry
+            val cls = Class.forName(declaringClass, false, javaClass.classLoader)
+            val field = cls.getDeclaredField(entry.fieldName!!)
+            val annotation = field.getAnnotation(ScalarVariable::class.java)
+                ?: throw IllegalStateException("Field ${field.name} is not annotated with @ScalarVariable!")
+            processAnnotatedField(field, annotation)
+        }
+    }
+
+    private fun onDefined() {
+        if (resetFromSnapshot) {
+            initialState = saveState()
+        }
+    }
+
+    fun __reset__(): Boolean {
+        inputDerivatives.clear()
+        connections.clear()
+        val state = initialState ?: return false
+        restoreState(state)
+        return true
+    }
+
+    /**
+     * Value references, grouped as integer, real, boolean and string, that the native warmup may read.
+     * Variables whose getter fails at this point are left out.
+     */
+    fun __warmupValueReferences__(): Array<LongArray> {
+        return arrayOf(
+            Fmi2VariableType.INTEGER,
+            Fmi2VariableType.REAL,
+            Fmi2VariableType.BOOLEAN,
+            Fmi2VariableType.STRING
+        ).map { type ->
+            definedVariables
+                .filter { it.type == type && canGet(it) }
+                .flatMap { v -> (0 until v.size).map { v.valueReference + it } }
+                .toLongArray()
+        }.toTypedArray()
+    }
+
+    /**
+     * The value references of the integer, real, boolean and string variables, from which the native layer builds
+     * its own value reference lookup tables. Each variable is given as its first value reference and the number of
+     * value references it covers (its size, for arrays), in the order the variables were registered in.
+     */
+    fun __valueReferences__(): Array<LongArray> {
+        return arrayOf(intSlots, realSlots, boolSlots, stringSlots)
+            .map { it.valueReferences() }
+            .toTypedArray()
+    }
+
+    private fun canGet(v: VariableIndex.Entry): Boolean {
+        val vr = longArrayOf(v.valueReference)
+        return try {
+            when (v.type) {
+                Fmi2VariableType.INTEGER -> getInteger(vr)
+                Fmi2VariableType.REAL -> getReal(vr)
+                Fmi2VariableType.BOOLEAN -> getBoolean(vr)
+                Fmi2VariableType.STRING -> getString(vr)
+                else -> return false
+            }
+            true
+        } catch (ex: Exception) {
+            false
+        }
+    }
+
+    /**
+     * Evaluates [seeds].size / [knowns].size directional derivatives at once,
+     * so that a Jacobian is assembled using a single call from native code.
+     * Slaves without analytic derivatives share the unperturbed evaluation between all seeds.
+     */
+    fun __directionalDerivatives__(unknowns: LongArray, knowns: LongArray, seeds: DoubleArray): DoubleArray {
+        if (!hasAnalyticDirectionalDerivative) {
+            return finiteDifferences(unknowns, knowns, seeds)
+        }
+        val n = knowns.size
+        val nSeeds = if (n == 0) 0 else seeds.size / n
+        val derivatives = DoubleArray(nSeeds * unknowns.size)
+        for (s in 0 until nSeeds) {
+            val seed = seeds.copyOfRange(s * n, (s + 1) * n)
+            val derivative = directionalDerivative(unknowns, knowns, seed)
+            check(derivative.size == unknowns.size) {
+                "directionalDerivative returned ${derivative.size} values for ${unknowns.size} unknowns"
+            }
+            derivative.copyInto(derivatives, s * unknowns.size)
+        }
+        return derivatives
+    }
+
+    /**
+     * Replaces the input derivatives used by [interpolateReal], invoked from native code ahead of [doStep] when they changed.
+     */
+    fun __setRealInputDerivatives__(vr: LongArray, order: IntArray, value: DoubleArray) {
+        inputDerivatives.clear()
+        for (i in vr.indices) {
+            val derivatives = inputDerivatives[vr[i]]
+                ?.let { if (it.size < order[i]) it.copyOf(order[i]) else it }
+                ?: DoubleArray(order[i])
+            derivatives[order[i] - 1] = value[i]
+            inputDerivatives[vr[i]] = derivatives
+        }
+    }
+
+    /**
+     * Performs [doStep] and returns the time reached, which is before the end of the step if it called [endStepAt].
+     */
+    fun __doStep__(currentTime: Double, dt: Double): Double {
+        for ((vr, source) in connections) {
+            val slot = slotOf(realSlots, vr)
+            when (val v = realAccessors[slot]) {
+                is RealArrayVariable -> v.values[realSlots.offsetOf(slot, vr)] = source.asDouble
+                else -> (v as RealVariable).setter!!.setDouble(source.asDouble)
+            }
+        }
+        stepEnd = Double.NaN
+        preferredStepSize = Double.NaN
+        doStep(currentTime, dt)
+        simulationTime = if (stepEnd.isNaN()) currentTime + dt else stepEnd
+        return simulationTime
+    }
+
+    /**
+     * Supplies the value of the real variable [vr], for inputs of other slaves connected to it using [__connectReal__].
+     * Being a JDK type, the supplier may be used by slaves loaded by other classloaders.
+     */
+    fun __realSource__(vr: Long): DoubleSupplier {
+        val slot = slotOf(realSlots, vr)
+        return when (val v = realAccessors[slot]) {
+            is RealArrayVariable -> {
+                val values = v.values
+                val offset = realSlots.offsetOf(slot, vr)
+                DoubleSupplier { values[offset] }
+            }
+            else -> {
+                val getter = (v as RealVariable).doubleGetter
+                DoubleSupplier { getter.getDouble() }
+            }
+        }
+    }
+
+    /**
+     * Connects the real input [vr] to [source], which is read at the beginning of each step,
+     * or disconnects it if [source] is null. Connections are dropped by [__reset__].
+     */
+    fun __connectReal__(vr: Long, source: DoubleSupplier?) {
+        if (source == null) {
+            connections.remove(vr)
+            return
+        }
+        val v = realAccessors[slotOf(realSlots, vr)]
+        require(v is RealArrayVariable || (v as RealVariable).setter != null) {
+            "Unable to connect the real variable with valueReference $vr, as it has no setter!"
+        }
+        connections[vr] = source
+    }
+
+    /**
+     * The handle of a source of the real variable [vr], registered JVM-wide for [__connectRealHandle__].
+     * Each value reference gets a single handle, valid until [__releaseRealSources__].
+     */
+    fun __realSourceHandle__(vr: Long): Long {
+        return realSources.getOrPut(vr) {
+            val source = RealSource(__realSource__(vr))
+            RealSources.register(source) to source
+        }.first
+    }
+
+    /**
+     * Connects the real input [vr] to the source with [handle], or disconnects it if [handle] is 0.
+     * Fails for handles not handed out by [__realSourceHandle__], or released since.
+     */
+    fun __connectRealHandle__(vr: Long, handle: Long) {
+        if (handle == 0L) {
+            __connectReal__(vr, null)
+            return
+        }
+        val source = requireNotNull(RealSources.lookup(handle)) {
+            "No real source with handle $handle, it was not handed out by fmi2GetRealSources or its instance was freed!"
+        }
+        __connectReal__(vr, source)
+    }
+
+    /**
+     * Releases the handles of the sources of this slave, as its instance is freed (or parked for reuse).
+     * Inputs still connected to them fail to step rather than reading a freed instance.
+     */
+    fun __releaseRealSources__() {
+        for ((handle, source) in realSources.values) {
+            RealSources.release(handle)
+            source.release()
+        }
+        realSources.clear()
+    }
+
+    /**
+     * Performs [setupExperiment], starting [simulationTime] at [startTime].
+     */
+    fun __setupExperiment__(startTime: Double, stopTime: Double, tolerance: Double) {
+        simulationTime = startTime
+        setupExperiment(startTime, stopTime, tolerance)
+    }
+
+    /**
+     * The step size suggested during the last step using [preferStepSize], or NaN.
+     */
+    fun __preferredStepSize__(): Double = preferredStepSize
+
+    /**
+     * Whether [SlaveInfo.canGetAndSetFMUstate] is declared. The native rollback ring is disabled otherwise,
+     * as [saveState] would only capture part of the state of such slaves.
+     */
+    fun __canGetAndSetFMUstate__(): Boolean = javaClass.getAnnotation(SlaveInfo::class.java)?.canGetAndSetFMUstate == true
+
+    /*
+     * Model Exchange entry points. The states [x] are null if unchanged since the previous call,
+     * so that each evaluation of the right hand side is a single call from the native layer.
+     */
+
+    fun __numberOfContinuousStates__(): Int = numberOfContinuousStates
+
+    fun __numberOfEventIndicators__(): Int = numberOfEventIndicators
+
+    fun __getContinuousStates__(x: DoubleArray) {
+        var offset = 0
+        for ((states, _) in continuousStates) {
+            System.arraycopy(states, 0, x, offset, states.size)
+            offset += states.size
+        }
+    }
+
+    fun __setContinuousStates__(time: Double, x: DoubleArray?) {
+        simulationTime = time
+        if (x == null) return
+        var offset = 0
+        for ((states, _) in continuousStates) {
+            System.arraycopy(x, offset, states, 0, states.size)
+            offset += states.size
+        }
+    }
+
+    fun __derivatives__(time: Double, x: DoubleArray?, dx: DoubleArray) {
+        __setContinuousStates__(time, x)
+        computeDerivatives(time)
+        var offset = 0
+        for ((_, derivatives) in continuousStates) {
+            System.arraycopy(derivatives, 0, dx, offset, derivatives.size)
+            offset += derivatives.size
+        }
+    }
+
+    fun __eventIndicators__(time: Double, x: DoubleArray?, indicators: DoubleArray) {
+        __setContinuousStates__(time, x)
+        eventIndicators(time, indicators)
+    }
+
+    fun __handleEvent__(time: Double, x: DoubleArray?): Boolean {
+        __setContinuousStates__(time, x)
+        return handleEvent(time)
+    }
+
+    /*
+     * FMI 3.0 accessors, addressing array variables by a single value reference.
+     * Values of array variables are laid out consecutively, in the order of [vr].
+     */
+
+    fun __getFloat64__(vr: LongArray): DoubleArray = fmi3Variables.getFloat64(vr)
+    fun __setFloat64__(vr: LongArray, values: DoubleArray) = fmi3Variables.setFloat64(vr, values)
+
+    fun __getInt32__(vr: LongArray): IntArray = fmi3Variables.getInt32(vr)
+    fun __setInt32__(vr: LongArray, values: IntArray) = fmi3Variables.setInt32(vr, values)
+
+    fun __getBoolean3__(vr: LongArray): BooleanArray = fmi3Variables.getBoolean(vr)
+    fun __setBoolean3__(vr: LongArray, values: BooleanArray) = fmi3Variables.setBoolean(vr, values)
+
+    fun __getString3__(vr: LongArray): Array<String> = fmi3Variables.getString(vr)
+    fun __setString3__(vr: LongArray, values: Array<String>) = fmi3Variables.setString(vr, values)
+
+    private fun checkDescribed(property: String) {
+        check(!definedFromIndex) {
+            "$property of ${javaClass.name} is not available, as it was defined from a variable index without building a model description"
+        }
+    }
+
+    fun __reuse__(instanceName: String) {
+        this.instanceName = instanceName
+    }
+
     private companion object {
 
         private val LOG: Logger = Logger.getLogger(Fmi2Slave::class.java.name)
 
+        private const val DEFAULT_WARMUP_STEP_SIZE = 1e-3
+
+        // relative perturbation of the finite difference fallback, sqrt of the machine epsilon
+        private val FINITE_DIFFERENCE_STEP = Math.sqrt(Math.ulp(1.0))
+
+        // relative perturbation of inputs when probing for direct feedthrough
+        private const val PROBE_PERTURBATION = 1e-3
+
+        // every n-th serialized state is written in full, the others as deltas. 0 or 1 disables deltas
+        private val stateDeltaInterval = System.getenv("FMU4J_STATE_DELTAS")?.toIntOrNull() ?: 0
+
         private fun getDateAndTime(): String {
             val now = LocalDateTime.now()
             val dateFormat = DateTimeFormatter.ofPattern("yyyy-MM-dd").format(now)
@@ -0,0 +1,64 @@
+package no.ntnu.ais.fmu4j.export.fmi2
+
+import java.util.*
+
+/**
+ * Accessors of the @ScalarVariable fields of a slave class, generated at compile time by the
+ * fmi-export-processor annotation processor as `<SlaveClass>_Accessors`.
+ *
+ * Fields are addressed by their position in [fields], and the elements of vector fields by `index`.
+ * Array fields are left out, as they are registered as array variables.
+ * Each accessor is a switch over the field calling it directly, so that [Fmi2Slave.getReal] and friends make a single
+ * monomorphic call per variable instead of going through a lambda per variable.
+ */
+interface GeneratedAccessors {
+
+    /**
+     * The fields covered, as `<binary name of the declaring class>#<field name>`.
+     * Fields that could not be accessed from generated code are left out, and accessed reflectively.
+     */
+    val fields: Array<String>
+
+    fun getInteger(slave: Fmi2Slave, field: Int, index: Int): Int
+    fun setInteger(slave: Fmi2Slave, field: Int, index: Int, value: Int)
+
+    fun getReal(slave: Fmi2Slave, field: Int, index: Int): Double
+    fun setReal(slave: Fmi2Slave, field: Int, index: Int, value: Double)
+
+    fun getBoolean(slave: Fmi2Slave, field: Int, index: Int): Boolean
+    fun setBoolean(slave: Fmi2Slave, field: Int, index: Int, value: Boolean)
+
+    fun getString(slave: Fmi2Slave, field: Int, index: Int): String
+    fun setString(slave: Fmi2Slave, field: Int, index: Int, value: String)
+
+    companion object {
+
+        const val SUFFIX = "_Accessors"
+
+        // the lookup throws ClassNotFoundException for each class without accessors, so it is done once per class.
+        // Generated accessors hold no state, and are shared by all instances of the class.
+        private val cache = object : ClassValue<Optional<GeneratedAccessors>>() {
+            override fun computeValue(type: Class<*>) = Optional.ofNullable(lookup(type))
+        }
+
+        /**
+         * The accessors generated for [cls], or for the closest superclass they were generated for, or null.
+         */
+        internal fun find(cls: Class<*>): GeneratedAccessors? = cache.get(cls).orElse(null)
+
+        private fun lookup(cls: Class<*>): GeneratedAccessors? {
+            var c: Class<*> = cls
+            while (c != Fmi2Slave::class.java) {
+                try {
+                    val generated = Class.forName(c.name + SUFFIX, true, c.classLoader)
+                    return generated.getDeclaredConstructor().newInstance() as GeneratedAccessors
+                } catch (ex: ClassNotFoundException) {
+                    c = c.superclass
+                }
+            }
+            return null
+        }
+
+    }
+
+}
@@ -0,0 +1,32 @@
+package no.ntnu.ais.fmu4j.export.fmi2
+
+/**
+ * Which of the allocating read methods of [Fmi2Slave] (`getReal(vr)` and friends, and `getAll` returning a BulkRead)
+ * a slave class overrides. The native layer calls the variants writing into caller-provided arrays,
+ * which route through such overrides, so that slaves written against the allocating variants keep working.
+ */
+internal class ReadOverrides private constructor(cls: Class<*>) {
+
+    val integer = overrides(cls, "getInteger", LONG_ARRAY)
+    val real = overrides(cls, "getReal", LONG_ARRAY)
+    val boolean = overrides(cls, "getBoolean", LONG_ARRAY)
+    val string = overrides(cls, "getString", LONG_ARRAY)
+    val all = overrides(cls, "getAll", LONG_ARRAY, LONG_ARRAY, LONG_ARRAY, LONG_ARRAY)
+
+    companion object {
+
+        private val LONG_ARRAY = LongArray::class.java
+
+        private val cache = object : ClassValue<ReadOverrides>() {
+            override fun computeValue(type: Class<*>) = ReadOverrides(type)
+        }
+
+        fun of(cls: Class<*>): ReadOverrides = cache.get(cls)
+
+        private fun overrides(cls: Class<*>, name: String, vararg parameterTypes: Class<*>): Boolean {
+            return cls.getMethod(name, *parameterTypes).declaringClass != Fmi2Slave::class.java
+        }
+
+    }
+
+}
@@ -0,0 +1,78 @@
+package no.ntnu.ais.fmu4j.export.fmi2
+
+import java.lang.management.ManagementFactory
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.ConcurrentMap
+import java.util.concurrent.ThreadLocalRandom
+import java.util.function.DoubleSupplier
+import javax.management.InstanceAlreadyExistsException
+import javax.management.ObjectName
+import javax.management.StandardMBean
+
+/**
+ * The real sources handed out to masters by [Fmi2Slave.__realSourceHandle__], by handle.
+ *
+ * Connected slaves usually belong to different FMUs, each with its own native library and copy of the fmu4j classes,
+ * so the registry is shared through an MBean of the platform MBean server, registered by the first FMU using it.
+ * Its single attribute is the registry itself, which holds JDK types only.
+ * Looking up a handle that was never handed out, or whose instance was freed, yields null,
+ * so that the native layer never has to trust a pointer passed by the master.
+ */
+internal object RealSources {
+
+    private val NAME = ObjectName("no.ntnu.ais.fmu4j:type=RealSources")
+
+    @Suppress("UNCHECKED_CAST")
+    private val registry: ConcurrentMap<Long, DoubleSupplier> = ManagementFactory.getPlatformMBeanServer().let { server ->
+        try {
+            server.registerMBean(StandardMBean(Registry(ConcurrentHashMap()), RegistryMBean::class.java), NAME)
+        } catch (ex: InstanceAlreadyExistsException) {
+            // registered by another FMU
+        }
+        server.getAttribute(NAME, "Sources") as ConcurrentMap<Long, DoubleSupplier>
+    }
+
+    interface RegistryMBean {
+        val sources: ConcurrentMap<Long, DoubleSupplier>
+    }
+
+    private class Registry(override val sources: ConcurrentMap<Long, DoubleSupplier>) : RegistryMBean
+
+    /**
+     * Registers [source], returning its handle. Handles are positive and fit in 32 bits, so that they pass as pointers.
+     */
+    fun register(source: DoubleSupplier): Long {
+        while (true) {
+            val handle = ThreadLocalRandom.current().nextInt(1, Int.MAX_VALUE).toLong()
+            if (registry.putIfAbsent(handle, source) == null) {
+                return handle
+            }
+        }
+    }
+
+    fun lookup(handle: Long): DoubleSupplier? = registry[handle]
+
+    fun release(handle: Long) {
+        registry.remove(handle)
+    }
+
+}
+
+/**
+ * A source handed out by handle, which fails to read once its instance was freed rather than reading a recycled one.
+ */
+internal class RealSource(private val source: DoubleSupplier) : DoubleSupplier {
+
+    @Volatile
+    private var released = false
+
+    fun release() {
+        released = true
+    }
+
+    override fun getAsDouble(): Double {
+        check(!released) { "The instance this input is connected to was freed!" }
+        return source.asDouble
+    }
+
+}
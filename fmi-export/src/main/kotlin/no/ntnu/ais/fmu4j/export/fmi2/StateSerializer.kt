@@ -0,0 +1,288 @@
+package no.ntnu.ais.fmu4j.export.fmi2
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.charset.StandardCharsets
+import java.util.concurrent.ThreadLocalRandom
+
+/**
+ * Compact binary encoding of [FieldSnapshot]s, backing fmi2SerializeFMUstate.
+ *
+ * Values are written as is in little endian order, straight into the buffer of the host.
+ * With deltas enabled (every [fullInterval]-th state written in full), the other states only hold
+ * the blocks of values that changed since the state previously serialized (or deserialized) by this instance.
+ * Each serialized state has a random id, and deltas record the id of the state they are based on,
+ * so that a delta can only be deserialized right after that very state.
+ *
+ * Layout: header, then per value type (real, integer, boolean, string) either all values,
+ * or a bitmap of changed blocks followed by the values of those blocks.
+ * Strings are written as a length prefixed UTF-8 sequence, with -1 for null.
+ */
+internal class StateSerializer(
+    private val fullInterval: Int
+) {
+
+    private var base: FieldSnapshot? = null
+    private var baseId = 0L
+    private var sinceFull = 0
+
+    // the plan made by size(), reused by the write() of the same state that follows
+    private var planned: Plan? = null
+
+    fun size(state: FieldSnapshot): Int {
+        return plan(state).size
+    }
+
+    fun write(state: FieldSnapshot, out: ByteBuffer) {
+        val plan = planned?.takeIf { it.state === state } ?: plan(state)
+        planned = null
+
+        val id = newId()
+
+        val buffer = out.duplicate().order(ByteOrder.LITTLE_ENDIAN)
+        buffer.putInt(MAGIC)
+        buffer.put(VERSION)
+        buffer.put(if (plan.delta) DELTA else FULL)
+        buffer.putLong(id)
+        buffer.putLong(if (plan.delta) baseId else 0L)
+        buffer.putInt(state.reals.size)
+        buffer.putInt(state.ints.size)
+        buffer.putInt(state.bools.size)
+        buffer.putInt(state.strings.size)
+
+        for (type in 0 until 4) {
+            val changed = plan.changed?.get(type)
+            if (changed != null) {
+                writeBitmap(buffer, changed)
+            }
+            val n = length(state, type)
+            forEachBlock(n, changed) { from, to -> writeValues(buffer, state, type, from, to) }
+        }
+
+        out.position(buffer.position())
+        rebase(state, id)
+        sinceFull = if (plan.delta) sinceFull + 1 else 0
+    }
+
+    /**
+     * Drops the plan made for [state], which is about to be updated in place.
+     */
+    fun invalidate(state: FieldSnapshot) {
+        if (planned?.state === state) {
+            planned = null
+        }
+    }
+
+    fun read(input: ByteBuffer): FieldSnapshot {
+        val buffer = input.duplicate().order(ByteOrder.LITTLE_ENDIAN)
+        check(buffer.int == MAGIC) { "Not a serialized FMU state" }
+        check(buffer.get() == VERSION) { "Unsupported FMU state version" }
+        val delta = buffer.get() == DELTA
+        val id = buffer.long
+        val basedOn = buffer.long
+
+        val state = FieldSnapshot(
+            DoubleArray(buffer.int),
+            IntArray(buffer.int),
+            BooleanArray(buffer.int),
+            arrayOfNulls(buffer.int)
+        )
+
+        if (delta) {
+            val previous = base
+            check(previous != null && basedOn == baseId && sameLayout(previous, state)) {
+                "FMU state delta does not apply to the previously (de)serialized state"
+            }
+            copy(previous, state)
+        }
+        for (type in 0 until 4) {
+            val changed = if (delta) readBitmap(buffer, blockCount(length(state, type))) else null
+            forEachBlock(length(state, type), changed) { from, to -> readValues(buffer, state, type, from, to) }
+        }
+
+        input.position(buffer.position())
+        rebase(state, id)
+        return state
+    }
+
+    private fun plan(state: FieldSnapshot): Plan {
+        val previous = base
+        val useDelta = fullInterval > 1 && previous != null && sinceFull + 1 < fullInterval && sameLayout(previous, state)
+
+        var size = HEADER_SIZE
+        val changed = if (useDelta) Array(4) { type -> changedBlocks(previous!!, state, type) } else null
+        for (type in 0 until 4) {
+            val blocks = changed?.get(type)
+            if (blocks != null) {
+                size += (blocks.size + 7) / 8
+            }
+            forEachBlock(length(state, type), blocks) { from, to -> size += valuesSize(state, type, from, to) }
+        }
+        return Plan(state, changed != null, changed, size).also { planned = it }
+    }
+
+    private fun rebase(state: FieldSnapshot, id: Long) {
+        val copy = base?.takeIf { sameLayout(it, state) } ?: FieldSnapshot(
+            DoubleArray(state.reals.size),
+            IntArray(state.ints.size),
+            BooleanArray(state.bools.size),
+            arrayOfNulls(state.strings.size)
+        )
+        copy(state, copy)
+        base = copy
+        baseId = id
+    }
+
+    private class Plan(
+        val state: FieldSnapshot,
+        val delta: Boolean,
+        val changed: Array<BooleanArray>?,
+        val size: Int
+    )
+
+    private companion object {
+
+        private const val MAGIC = 0x53534D46 // FMSS
+        private const val VERSION: Byte = 1
+        private const val FULL: Byte = 0
+        private const val DELTA: Byte = 1
+
+        private const val HEADER_SIZE = 4 + 1 + 1 + 8 + 8 + 4 * 4
+
+        // values per block in deltas
+        private const val BLOCK_SIZE = 64
+
+        // 0 marks full states, which are not based on another
+        private fun newId(): Long {
+            while (true) {
+                val id = ThreadLocalRandom.current().nextLong()
+                if (id != 0L) return id
+            }
+        }
+
+        private fun blockCount(n: Int) = (n + BLOCK_SIZE - 1) / BLOCK_SIZE
+
+        private fun length(state: FieldSnapshot, type: Int) = when (type) {
+            0 -> state.reals.size
+            1 -> state.ints.size
+            2 -> state.bools.size
+            else -> state.strings.size
+        }
+
+        private fun sameLayout(a: FieldSnapshot, b: FieldSnapshot): Boolean {
+            return a.reals.size == b.reals.size && a.ints.size == b.ints.size &&
+                    a.bools.size == b.bools.size && a.strings.size == b.strings.size
+        }
+
+        private fun copy(from: FieldSnapshot, to: FieldSnapshot) {
+            System.arraycopy(from.reals, 0, to.reals, 0, from.reals.size)
+            System.arraycopy(from.ints, 0, to.ints, 0, from.ints.size)
+            System.arraycopy(from.bools, 0, to.bools, 0, from.bools.size)
+            System.arraycopy(from.strings, 0, to.strings, 0, from.strings.size)
+        }
+
+        /**
+         * Invokes [block] with the value range of each block, or only those flagged in [changed] if given.
+         */
+        private inline fun forEachBlock(n: Int, changed: BooleanArray?, block: (Int, Int) -> Unit) {
+            if (changed == null) {
+                if (n > 0) block(0, n)
+                return
+            }
+            for (i in changed.indices) {
+                if (changed[i]) {
+                    val from = i * BLOCK_SIZE
+                    block(from, minOf(from + BLOCK_SIZE, n))
+                }
+            }
+        }
+
+        private fun changedBlocks(previous: FieldSnapshot, state: FieldSnapshot, type: Int): BooleanArray {
+            val n = length(state, type)
+            return BooleanArray(blockCount(n)) { i ->
+                val from = i * BLOCK_SIZE
+                val to = minOf(from + BLOCK_SIZE, n)
+                when (type) {
+                    0 -> (from until to).any {
+                        java.lang.Double.doubleToRawLongBits(previous.reals[it]) != java.lang.Double.doubleToRawLongBits(state.reals[it])
+                    }
+                    1 -> (from until to).any { previous.ints[it] != state.ints[it] }
+                    2 -> (from until to).any { previous.bools[it] != state.bools[it] }
+                    else -> (from until to).any { previous.strings[it] != state.strings[it] }
+                }
+            }
+        }
+
+        private fun valuesSize(state: FieldSnapshot, type: Int, from: Int, to: Int): Int {
+            return when (type) {
+                0 -> 8 * (to - from)
+                1 -> 4 * (to - from)
+                2 -> to - from
+                else -> (from until to).sumBy { 4 + (state.strings[it]?.toByteArray(StandardCharsets.UTF_8)?.size ?: 0) }
+            }
+        }
+
+        private fun writeValues(buffer: ByteBuffer, state: FieldSnapshot, type: Int, from: Int, to: Int) {
+            when (type) {
+                0 -> {
+                    buffer.asDoubleBuffer().put(state.reals, from, to - from)
+                    buffer.position(buffer.position() + 8 * (to - from))
+                }
+                1 -> {
+                    buffer.asIntBuffer().put(state.ints, from, to - from)
+                    buffer.position(buffer.position() + 4 * (to - from))
+                }
+                2 -> for (i in from until to) buffer.put(if (state.bools[i]) 1 else 0)
+                else -> for (i in from until to) {
+                    val bytes = state.strings[i]?.toByteArray(StandardCharsets.UTF_8)
+                    buffer.putInt(bytes?.size ?: -1)
+                    bytes?.also { buffer.put(it) }
+                }
+            }
+        }
+
+        private fun readValues(buffer: ByteBuffer, state: FieldSnapshot, type: Int, from: Int, to: Int) {
+            when (type) {
+                0 -> {
+                    buffer.asDoubleBuffer().get(state.reals, from, to - from)
+                    buffer.position(buffer.position() + 8 * (to - from))
+                }
+                1 -> {
+                    buffer.asIntBuffer().get(state.ints, from, to - from)
+                    buffer.position(buffer.position() + 4 * (to - from))
+                }
+                2 -> for (i in from until to) state.bools[i] = buffer.get() != 0.toByte()
+                else -> for (i in from until to) {
+                    val size = buffer.int
+                    state.strings[i] = if (size < 0) null else ByteArray(size).let {
+                        buffer.get(it)
+                        String(it, StandardCharsets.UTF_8)
+                    }
+                }
+            }
+        }
+
+        private fun writeBitmap(buffer: ByteBuffer, blocks: BooleanArray) {
+            for (i in 0 until (blocks.size + 7) / 8) {
+                var bits = 0
+                for (j in 0 until minOf(8, blocks.size - 8 * i)) {
+                    if (blocks[8 * i + j]) bits = bits or (1 shl j)
+                }
+                buffer.put(bits.toByte())
+            }
+        }
+
+        private fun readBitmap(buffer: ByteBuffer, n: Int): BooleanArray {
+            val blocks = BooleanArray(n)
+            for (i in 0 until (n + 7) / 8) {
+                val bits = buffer.get().toInt()
+                for (j in 0 until minOf(8, n - 8 * i)) {
+                    blocks[8 * i + j] = bits and (1 shl j) != 0
+                }
+            }
+            return blocks
+        }
+
+    }
+
+}
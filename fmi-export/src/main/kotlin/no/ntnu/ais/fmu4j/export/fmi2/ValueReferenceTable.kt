@@ -0,0 +1,170 @@
+package no.ntnu.ais.fmu4j.export.fmi2
+
+/**
+ * Maps the value references of one variable type to their slot, the position of the variable in registration order.
+ * Array variables take a single slot, covering the consecutive value references of their elements.
+ *
+ * Value references are dense unless overridden using [Variable.__overrideValueReference], so scalars below
+ * [DENSE_LIMIT] are looked up in an array. Arrays and sparse scalars are kept as ranges of value references,
+ * found using a binary search, so that adding an array takes the same time whatever its size.
+ * Variables sharing a value reference (aliases) resolve to the slot of the first one registered.
+ */
+internal class ValueReferenceTable {
+
+    private var dense = IntArray(0)
+
+    // disjoint ranges [rangeStarts[i], rangeEnds[i]) of value references, sorted, each covering part of a slot
+    private var rangeStarts = LongArray(0)
+    private var rangeEnds = LongArray(0)
+    private var rangeSlots = IntArray(0)
+    private var rangeCount = 0
+
+    private val references: MutableList<Long> = mutableListOf()
+    private val sizes: MutableList<Int> = mutableListOf()
+    private val names: MutableList<String> = mutableListOf()
+
+    /**
+     * The number of value references covered, the default value reference of the next variable.
+     */
+    var valueReferenceCount = 0
+        private set
+
+    /**
+     * Adds the scalar variable [name] with value reference [vr], returning its slot.
+     */
+    fun add(vr: Long, name: String): Int = add(vr, name, SCALAR)
+
+    /**
+     * Adds the array variable [name] of [size] elements, with the value references [vr] until `vr + size`.
+     */
+    fun addArray(vr: Long, name: String, size: Int): Int = add(vr, name, size)
+
+    private fun add(vr: Long, name: String, size: Int): Int {
+        val slot = references.size
+        references.add(vr)
+        sizes.add(size)
+        names.add(name)
+        val count = if (size == SCALAR) 1 else size
+        if (size == SCALAR && vr >= 0 && vr < DENSE_LIMIT) {
+            putDense(vr.toInt(), slot)
+        } else {
+            putRange(vr, vr + count, slot)
+        }
+        valueReferenceCount += count
+        return slot
+    }
+
+    private fun putDense(i: Int, slot: Int) {
+        if (i >= dense.size) {
+            val size = dense.size
+            dense = dense.copyOf(maxOf(i + 1, 2 * size))
+            dense.fill(-1, size)
+        }
+        if (dense[i] < 0 && rangeSlotOf(i.toLong()) < 0) dense[i] = slot
+    }
+
+    // inserts the parts of [start, end) not covered by earlier ranges
+    private fun putRange(start: Long, end: Long, slot: Int) {
+        var from = start
+        var i = rangeAfter(from)
+        while (from < end) {
+            if (i < rangeCount && rangeStarts[i] <= from) {
+                from = rangeEnds[i++]
+                continue
+            }
+            val to = if (i < rangeCount) minOf(end, rangeStarts[i]) else end
+            insertRange(i++, from, to, slot)
+            from = to
+        }
+    }
+
+    private fun insertRange(i: Int, start: Long, end: Long, slot: Int) {
+        if (rangeCount == rangeStarts.size) {
+            val capacity = maxOf(4, 2 * rangeCount)
+            rangeStarts = rangeStarts.copyOf(capacity)
+            rangeEnds = rangeEnds.copyOf(capacity)
+            rangeSlots = rangeSlots.copyOf(capacity)
+        }
+        System.arraycopy(rangeStarts, i, rangeStarts, i + 1, rangeCount - i)
+        System.arraycopy(rangeEnds, i, rangeEnds, i + 1, rangeCount - i)
+        System.arraycopy(rangeSlots, i, rangeSlots, i + 1, rangeCount - i)
+        rangeStarts[i] = start
+        rangeEnds[i] = end
+        rangeSlots[i] = slot
+        rangeCount++
+    }
+
+    // the index of the first range ending after vr, or rangeCount
+    private fun rangeAfter(vr: Long): Int {
+        var low = 0
+        var high = rangeCount
+        while (low < high) {
+            val mid = (low + high) ushr 1
+            if (rangeEnds[mid] <= vr) low = mid + 1 else high = mid
+        }
+        return low
+    }
+
+    private fun rangeSlotOf(vr: Long): Int {
+        val i = rangeAfter(vr)
+        return if (i < rangeCount && rangeStarts[i] <= vr) rangeSlots[i] else -1
+    }
+
+    /**
+     * The slot of [vr], or -1 if no variable has it.
+     */
+    fun slotOf(vr: Long): Int {
+        if (vr >= 0 && vr < dense.size) {
+            val slot = dense[vr.toInt()]
+            if (slot >= 0) return slot
+        }
+        return rangeSlotOf(vr)
+    }
+
+    fun isArray(slot: Int): Boolean = sizes[slot] != SCALAR
+
+    /**
+     * The number of elements of the array variable in [slot] from [vr] on.
+     */
+    fun remaining(slot: Int, vr: Long): Int = sizes[slot] - offsetOf(slot, vr)
+
+    /**
+     * The element of the array variable in [slot] having [vr].
+     */
+    fun offsetOf(slot: Int, vr: Long): Int = (vr - references[slot]).toInt()
+
+    fun nameOf(slot: Int, vr: Long): String {
+        return if (isArray(slot)) "${names[slot]}[${offsetOf(slot, vr)}]" else names[slot]
+    }
+
+    /**
+     * The value references covered, as the first value reference and the number of value references
+     * of each slot, in registration order.
+     */
+    fun valueReferences(): LongArray {
+        val ranges = LongArray(2 * references.size)
+        for (slot in references.indices) {
+            ranges[2 * slot] = references[slot]
+            ranges[2 * slot + 1] = if (isArray(slot)) sizes[slot].toLong() else 1L
+        }
+        return ranges
+    }
+
+    fun clear() {
+        dense = IntArray(0)
+        rangeStarts = LongArray(0)
+        rangeEnds = LongArray(0)
+        rangeSlots = IntArray(0)
+        rangeCount = 0
+        references.clear()
+        sizes.clear()
+        names.clear()
+        valueReferenceCount = 0
+    }
+
+    companion object {
+        const val DENSE_LIMIT = 1 shl 16
+        private const val SCALAR = -1
+    }
+
+}
@@ -0,0 +1,111 @@
+package no.ntnu.ais.fmu4j.export.fmi2
+
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2Causality
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2Variability
+import java.io.*
+
+/**
+ * Compact binary listing of the variables registered by a slave, in registration order.
+ * Array variables are listed once, with the number of elements as [Entry.size].
+ * Written by FmuBuilder to resources/variables.bin and used by [Fmi2Slave.__defineFromIndex__]
+ * to bind accessors without scanning the class hierarchy or building the model description.
+ */
+class VariableIndex(
+    val entries: List<Entry>
+) {
+
+    class Entry(
+        val name: String,
+        val valueReference: Long,
+        val type: Fmi2VariableType,
+        val causality: Fmi2Causality?,
+        val variability: Fmi2Variability?,
+        val declaringClass: String?,
+        val fieldName: String?,
+        val size: Int = 1
+    ) {
+
+        fun matches(other: Entry): Boolean {
+            return name == other.name && valueReference == other.valueReference && type == other.type && size == other.size
+        }
+
+    }
+
+    fun write(out: OutputStream) {
+        val dos = DataOutputStream(BufferedOutputStream(out))
+        dos.writeInt(MAGIC)
+        dos.writeInt(VERSION)
+        dos.writeInt(entries.size)
+        for (e in entries) {
+            var flags = 0
+            if (e.causality != null) flags = flags or HAS_CAUSALITY
+            if (e.variability != null) flags = flags or HAS_VARIABILITY
+            if (e.declaringClass != null) flags = flags or HAS_FIELD
+            if (e.size != 1) flags = flags or HAS_SIZE
+            dos.writeUTF(e.name)
+            dos.writeLong(e.valueReference)
+            dos.writeByte(e.type.ordinal)
+            dos.writeByte(flags)
+            e.causality?.also { dos.writeByte(it.ordinal) }
+            e.variability?.also { dos.writeByte(it.ordinal) }
+            if (e.declaringClass != null) {
+                dos.writeUTF(e.declaringClass)
+                dos.writeUTF(e.fieldName!!)
+            }
+            if (e.size != 1) dos.writeInt(e.size)
+        }
+        dos.flush()
+    }
+
+    companion object {
+
+        const val FILE_NAME = "variables.bin"
+
+        private const val MAGIC = 0x464D5649 // FMVI
+        private const val VERSION = 2
+
+        private const val HAS_CAUSALITY = 1
+        private const val HAS_VARIABILITY = 2
+        private const val HAS_FIELD = 4
+        private const val HAS_SIZE = 8
+
+        private val types = Fmi2VariableType.values()
+        private val causalities = Fmi2Causality.values()
+        private val variabilities = Fmi2Variability.values()
+
+        @JvmStatic
+        fun read(input: InputStream): VariableIndex {
+            val dis = DataInputStream(BufferedInputStream(input))
+            if (dis.readInt() != MAGIC) {
+                throw IOException("Not a variable index!")
+            }
+            val version = dis.readInt()
+            if (version != VERSION) {
+                throw IOException("Unsupported variable index version: $version")
+            }
+            val size = dis.readInt()
+            val entries = ArrayList<Entry>(size)
+            var declaringClass: String? = null
+            for (i in 0 until size) {
+                val name = dis.readUTF()
+                val vr = dis.readLong()
+                val type = types[dis.readByte().toInt()]
+                val flags = dis.readByte().toInt()
+                val causality = if (flags and HAS_CAUSALITY != 0) causalities[dis.readByte().toInt()] else null
+                val variability = if (flags and HAS_VARIABILITY != 0) variabilities[dis.readByte().toInt()] else null
+                var fieldName: String? = null
+                if (flags and HAS_FIELD != 0) {
+                    // keep a single instance per class name, consecutive entries typically share it
+                    val cls = dis.readUTF()
+                    declaringClass = if (cls == declaringClass) declaringClass else cls
+                    fieldName = dis.readUTF()
+                }
+                val count = if (flags and HAS_SIZE != 0) dis.readInt() else 1
+                entries.add(Entry(name, vr, type, causality, variability, if (fieldName != null) declaringClass else null, fieldName, count))
+            }
+            return VariableIndex(entries)
+        }
+
+    }
+
+}
@@ -13,10 +13,35 @@ annotation class SlaveInfo(
         val description: String = "",
         val copyright: String = "",
         val license: String = "",
+        /**
+         * Declares that the slave evaluates its real inputs within a step using [Fmi2Slave.interpolateReal],
+         * so that the master provides their time derivatives through fmi2SetRealInputDerivatives.
+         */
         val canInterpolateInputs: Boolean = false,
         val canHandleVariableCommunicationStepSize: Boolean = true,
         val canBeInstantiatedOnlyOncePerProcess: Boolean = false,
         val needsExecutionTool: Boolean = false,
+        /**
+         * Enables fmi2GetFMUstate/fmi2SetFMUstate, backed by [Fmi2Slave.saveState] and [Fmi2Slave.restoreState].
+         * Only declare this if all state of the slave is captured, i.e. it lives in annotated fields or the hooks are overridden.
+         */
+        val canGetAndSetFMUstate: Boolean = false,
+        /**
+         * Enables fmi2SerializeFMUstate/fmi2DeSerializeFMUstate, backed by [Fmi2Slave.serializeState] and [Fmi2Slave.deserializeState].
+         * The default hooks support the default states, slaves with custom states must override them.
+         */
+        val canSerializeFMUstate: Boolean = false,
+        /**
+         * Declares providesDirectionalDerivative for slaves relying on the finite difference fallback of
+         * [Fmi2Slave.directionalDerivative], which only captures outputs computed from the inputs when read.
+         * Implied for slaves overriding it.
+         */
+        val providesDirectionalDerivative: Boolean = false,
+        /**
+         * Highest order served by fmi2GetRealOutputDerivatives, see [Fmi2Slave.getRealOutputDerivatives].
+         * By default 1 for slaves with real outputs, served by the native backward differences (which support up to 2).
+         */
+        val maxOutputDerivativeOrder: Int = -1,
 )
 
 @Target(AnnotationTarget.CLASS)
@@ -37,6 +62,17 @@ annotation class ScalarVariable(
     val initial: Fmi2Initial = Fmi2Initial.undefined
 )
 
+/**
+ * Declares the dependencies of an annotated output, see [Variable.dependencies] and [Variable.dependenciesKind].
+ * An empty [value] declares an output without dependencies.
+ */
+@Target(AnnotationTarget.FIELD)
+@Retention(AnnotationRetention.RUNTIME)
+annotation class DependsOn(
+    vararg val value: String,
+    val kinds: Array<Fmi2DependencyKind> = []
+)
+
 internal fun Variable<*>.applyAnnotation(v: ScalarVariable) {
     this.initial(v.initial)
     this.causality(v.causality)
@@ -0,0 +1,242 @@
+package no.ntnu.ais.fmu4j.export.fmi2
+
+import no.ntnu.ais.fmu4j.export.BooleanVector
+import no.ntnu.ais.fmu4j.export.IntVector
+import no.ntnu.ais.fmu4j.export.RealVector
+import no.ntnu.ais.fmu4j.export.StringVector
+import java.lang.reflect.Field
+import java.lang.reflect.Modifier
+
+/**
+ * The values of all fields annotated with [ScalarVariable], flattened per type.
+ */
+internal class FieldSnapshot(
+    val reals: DoubleArray,
+    val ints: IntArray,
+    val bools: BooleanArray,
+    val strings: Array<String?>
+)
+
+/**
+ * Maps the annotated fields of a slave onto the flat arrays of a [FieldSnapshot].
+ * Array and vector fields are copied element-wise into (and back from) their slice,
+ * so the instances referenced by the registered accessors are kept.
+ */
+internal class StateLayout(
+    owner: Any,
+    fields: List<Field>
+) {
+
+    private val slots: List<Slot>
+
+    private var numReals = 0
+    private var numInts = 0
+    private var numBools = 0
+    private var numStrings = 0
+
+    init {
+        slots = fields.mapNotNull { field ->
+            val isFinal = Modifier.isFinal(field.modifiers)
+            when (val type = field.type) {
+                Int::class.java -> if (isFinal) null else IntSlot(field, numInts++)
+                Double::class.java -> if (isFinal) null else RealSlot(field, numReals++)
+                Boolean::class.java -> if (isFinal) null else BoolSlot(field, numBools++)
+                String::class.java -> if (isFinal) null else StringSlot(field, numStrings++)
+                IntArray::class.java -> {
+                    val size = (field.get(owner) as IntArray).size
+                    IntArraySlot(field, numInts, size).also { numInts += size }
+                }
+                DoubleArray::class.java -> {
+                    val size = (field.get(owner) as DoubleArray).size
+                    RealArraySlot(field, numReals, size).also { numReals += size }
+                }
+                BooleanArray::class.java -> {
+                    val size = (field.get(owner) as BooleanArray).size
+                    BoolArraySlot(field, numBools, size).also { numBools += size }
+                }
+                Array<String>::class.java -> {
+                    val size = (field.get(owner) as Array<*>).size
+                    StringArraySlot(field, numStrings, size).also { numStrings += size }
+                }
+                else -> when {
+                    IntVector::class.java.isAssignableFrom(type) -> {
+                        val size = (field.get(owner) as IntVector).size
+                        IntVectorSlot(field, numInts, size).also { numInts += size }
+                    }
+                    RealVector::class.java.isAssignableFrom(type) -> {
+                        val size = (field.get(owner) as RealVector).size
+                        RealVectorSlot(field, numReals, size).also { numReals += size }
+                    }
+                    BooleanVector::class.java.isAssignableFrom(type) -> {
+                        val size = (field.get(owner) as BooleanVector).size
+                        BoolVectorSlot(field, numBools, size).also { numBools += size }
+                    }
+                    StringVector::class.java.isAssignableFrom(type) -> {
+                        val size = (field.get(owner) as StringVector).size
+                        StringVectorSlot(field, numStrings, size).also { numStrings += size }
+                    }
+                    else -> throw IllegalStateException("Unsupported variable type: $type")
+                }
+            }
+        }
+    }
+
+    fun capture(owner: Any): FieldSnapshot {
+        val snapshot = FieldSnapshot(
+            DoubleArray(numReals),
+            IntArray(numInts),
+            BooleanArray(numBools),
+            arrayOfNulls(numStrings)
+        )
+        captureInto(owner, snapshot)
+        return snapshot
+    }
+
+    fun captureInto(owner: Any, snapshot: FieldSnapshot) {
+        for (slot in slots) {
+            slot.capture(owner, snapshot)
+        }
+    }
+
+    fun restore(owner: Any, snapshot: FieldSnapshot) {
+        for (slot in slots) {
+            slot.restore(owner, snapshot)
+        }
+    }
+
+    private abstract class Slot(
+        val field: Field
+    ) {
+        abstract fun capture(owner: Any, snapshot: FieldSnapshot)
+        abstract fun restore(owner: Any, snapshot: FieldSnapshot)
+    }
+
+    private class IntSlot(field: Field, val offset: Int) : Slot(field) {
+        override fun capture(owner: Any, snapshot: FieldSnapshot) {
+            snapshot.ints[offset] = field.getInt(owner)
+        }
+
+        override fun restore(owner: Any, snapshot: FieldSnapshot) {
+            field.setInt(owner, snapshot.ints[offset])
+        }
+    }
+
+    private class RealSlot(field: Field, val offset: Int) : Slot(field) {
+        override fun capture(owner: Any, snapshot: FieldSnapshot) {
+            snapshot.reals[offset] = field.getDouble(owner)
+        }
+
+        override fun restore(owner: Any, snapshot: FieldSnapshot) {
+            field.setDouble(owner, snapshot.reals[offset])
+        }
+    }
+
+    private class BoolSlot(field: Field, val offset: Int) : Slot(field) {
+        override fun capture(owner: Any, snapshot: FieldSnapshot) {
+            snapshot.bools[offset] = field.getBoolean(owner)
+        }
+
+        override fun restore(owner: Any, snapshot: FieldSnapshot) {
+            field.setBoolean(owner, snapshot.bools[offset])
+        }
+    }
+
+    private class StringSlot(field: Field, val offset: Int) : Slot(field) {
+        override fun capture(owner: Any, snapshot: FieldSnapshot) {
+            snapshot.strings[offset] = field.get(owner) as String?
+        }
+
+        override fun restore(owner: Any, snapshot: FieldSnapshot) {
+            field.set(owner, snapshot.strings[offset])
+        }
+    }
+
+    private class IntArraySlot(field: Field, val offset: Int, val size: Int) : Slot(field) {
+        override fun capture(owner: Any, snapshot: FieldSnapshot) {
+            System.arraycopy(field.get(owner) as IntArray, 0, snapshot.ints, offset, size)
+        }
+
+        override fun restore(owner: Any, snapshot: FieldSnapshot) {
+            System.arraycopy(snapshot.ints, offset, field.get(owner) as IntArray, 0, size)
+        }
+    }
+
+    private class RealArraySlot(field: Field, val offset: Int, val size: Int) : Slot(field) {
+        override fun capture(owner: Any, snapshot: FieldSnapshot) {
+            System.arraycopy(field.get(owner) as DoubleArray, 0, snapshot.reals, offset, size)
+        }
+
+        override fun restore(owner: Any, snapshot: FieldSnapshot) {
+            System.arraycopy(snapshot.reals, offset, field.get(owner) as DoubleArray, 0, size)
+        }
+    }
+
+    private class BoolArraySlot(field: Field, val offset: Int, val size: Int) : Slot(field) {
+        override fun capture(owner: Any, snapshot: FieldSnapshot) {
+            System.arraycopy(field.get(owner) as BooleanArray, 0, snapshot.bools, offset, size)
+        }
+
+        override fun restore(owner: Any, snapshot: FieldSnapshot) {
+            System.arraycopy(snapshot.bools, offset, field.get(owner) as BooleanArray, 0, size)
+        }
+    }
+
+    private class StringArraySlot(field: Field, val offset: Int, val size: Int) : Slot(field) {
+        override fun capture(owner: Any, snapshot: FieldSnapshot) {
+            System.arraycopy(field.get(owner) as Array<*>, 0, snapshot.strings, offset, size)
+        }
+
+        override fun restore(owner: Any, snapshot: FieldSnapshot) {
+            System.arraycopy(snapshot.strings, offset, field.get(owner) as Array<*>, 0, size)
+        }
+    }
+
+    private class IntVectorSlot(field: Field, val offset: Int, val size: Int) : Slot(field) {
+        override fun capture(owner: Any, snapshot: FieldSnapshot) {
+            val vector = field.get(owner) as IntVector
+            for (i in 0 until size) snapshot.ints[offset + i] = vector[i]
+        }
+
+        override fun restore(owner: Any, snapshot: FieldSnapshot) {
+            val vector = field.get(owner) as IntVector
+            for (i in 0 until size) vector[i] = snapshot.ints[offset + i]
+        }
+    }
+
+    private class RealVectorSlot(field: Field, val offset: Int, val size: Int) : Slot(field) {
+        override fun capture(owner: Any, snapshot: FieldSnapshot) {
+            val vector = field.get(owner) as RealVector
+            for (i in 0 until size) snapshot.reals[offset + i] = vector[i]
+        }
+
+        override fun restore(owner: Any, snapshot: FieldSnapshot) {
+            val vector = field.get(owner) as RealVector
+            for (i in 0 until size) vector[i] = snapshot.reals[offset + i]
+        }
+    }
+
+    private class BoolVectorSlot(field: Field, val offset: Int, val size: Int) : Slot(field) {
+        override fun capture(owner: Any, snapshot: FieldSnapshot) {
+            val vector = field.get(owner) as BooleanVector
+            for (i in 0 until size) snapshot.bools[offset + i] = vector[i]
+        }
+
+        override fun restore(owner: Any, snapshot: FieldSnapshot) {
+            val vector = field.get(owner) as BooleanVector
+            for (i in 0 until size) vector[i] = snapshot.bools[offset + i]
+        }
+    }
+
+    private class StringVectorSlot(field: Field, val offset: Int, val size: Int) : Slot(field) {
+        override fun capture(owner: Any, snapshot: FieldSnapshot) {
+            val vector = field.get(owner) as StringVector
+            for (i in 0 until size) snapshot.strings[offset + i] = vector[i]
+        }
+
+        override fun restore(owner: Any, snapshot: FieldSnapshot) {
+            val vector = field.get(owner) as StringVector
+            for (i in 0 until size) vector[i] = snapshot.strings[offset + i]!!
+        }
+    }
+
+}
@@ -14,6 +14,35 @@ fun interface Setter<E> {
     fun set(value: E)
 }
 
+/**
+ * Kind of a dependency in the ModelStructure, see the dependenciesKind attribute of the FMI 2.0 standard.
+ */
+enum class Fmi2DependencyKind {
+    dependent,
+    constant,
+    fixed,
+    tunable,
+    discrete
+}
+
+/**
+ * The Outputs, InitialUnknowns and Derivatives of a model, with their dependencies as 1 based variable indices.
+ * Dependencies are null when undeclared, meaning that the unknown depends on all knowns.
+ */
+internal class ModelDependencies(
+    val outputs: List<Unknown>,
+    val initialUnknowns: List<Unknown>,
+    val derivatives: List<Unknown> = emptyList()
+) {
+
+    class Unknown(
+        val index: Long,
+        val dependencies: List<Long>?,
+        val dependenciesKind: List<Fmi2DependencyKind>?
+    )
+
+}
+
 enum class Fmi2VariableType {
     INTEGER,
     REAL,
@@ -47,9 +76,24 @@ sealed class Variable<E>(
         private set
     internal var description: String? = null
         private set
+    internal var dependencies: List<String>? = null
+        private set
+    internal var dependenciesKind: List<Fmi2DependencyKind>? = null
+        private set
 
     var __overrideValueReference: Long? = null
 
+    // position of the annotated field in GeneratedAccessors.fields, or -1, and the element of an array field
+    internal var field = -1
+        private set
+    internal var index = 0
+        private set
+
+    internal fun bindField(field: Int, index: Int) {
+        this.field = field
+        this.index = index
+    }
+
     fun description(description: String?): E {
         this.description = description
         return this as E
@@ -70,6 +114,23 @@ sealed class Variable<E>(
         return this as E
     }
 
+    /**
+     * Names of the variables this output depends on, inputs or (during initialization) parameters.
+     * Naming an array field refers to all of its elements. Without a declaration, it depends on all inputs.
+     */
+    fun dependencies(vararg names: String): E {
+        this.dependencies = names.toList()
+        return this as E
+    }
+
+    /**
+     * Kind of each dependency declared by [dependencies], all [Fmi2DependencyKind.dependent] if not given.
+     */
+    fun dependenciesKind(vararg kinds: Fmi2DependencyKind): E {
+        this.dependenciesKind = kinds.toList()
+        return this as E
+    }
+
 }
 
 class IntVariable(
@@ -77,6 +138,8 @@ class IntVariable(
         val getter: Getter<Int>
 ) : Variable<IntVariable>(name) {
 
+    internal val intGetter: IntGetter = getter as? IntGetter ?: IntGetter { getter.get() }
+
     internal var min: Int? = null
         private set
 
@@ -86,7 +149,7 @@ class IntVariable(
     internal var start: Int? = null
         private set
 
-    internal var setter: Setter<Int>? = null
+    internal var setter: IntSetter? = null
         private set
 
     fun min(value: Int?) = apply {
@@ -101,7 +164,9 @@ class IntVariable(
         this.start = value
     }
 
-    fun setter(setter: Setter<Int>) = apply {
+    fun setter(setter: Setter<Int>): IntVariable = setter(setter as? IntSetter ?: IntSetter { setter.set(it) })
+
+    fun setter(setter: IntSetter) = apply {
         this.setter = setter
     }
 
@@ -112,6 +177,8 @@ class RealVariable(
         val getter: Getter<Double>
 ) : Variable<RealVariable>(name) {
 
+    internal val doubleGetter: DoubleGetter = getter as? DoubleGetter ?: DoubleGetter { getter.get() }
+
     internal var min: Double? = null
         private set
 
@@ -126,7 +193,7 @@ class RealVariable(
 
     internal var unit: String? = null
 
-    internal var setter: Setter<Double>? = null
+    internal var setter: DoubleSetter? = null
         private set
 
 
@@ -150,7 +217,9 @@ class RealVariable(
         this.start = value
     }
 
-    fun setter(setter: Setter<Double>) = apply {
+    fun setter(setter: Setter<Double>): RealVariable = setter(setter as? DoubleSetter ?: DoubleSetter { setter.set(it) })
+
+    fun setter(setter: DoubleSetter) = apply {
         this.setter = setter
     }
 
@@ -161,17 +230,21 @@ class BooleanVariable(
         val getter: Getter<Boolean>
 ) : Variable<BooleanVariable>(name) {
 
+    internal val booleanGetter: BooleanGetter = getter as? BooleanGetter ?: BooleanGetter { getter.get() }
+
     internal var start: Boolean? = null
         private set
 
-    internal var setter: Setter<Boolean>? = null
+    internal var setter: BooleanSetter? = null
         private set
 
     fun start(value: Boolean?) = apply {
         this.start = value
     }
 
-    fun setter(setter: Setter<Boolean>) = apply {
+    fun setter(setter: Setter<Boolean>): BooleanVariable = setter(setter as? BooleanSetter ?: BooleanSetter { setter.set(it) })
+
+    fun setter(setter: BooleanSetter) = apply {
         this.setter = setter
     }
 
@@ -197,3 +270,29 @@ class StringVariable(
     }
 
 }
+
+/*
+ * Arrays registered as a whole, as the variables name[0] until name[size - 1] with consecutive value references.
+ * Reading and writing them copies from and to the array in bulk, without a getter or setter per element.
+ * The arrays must not be replaced, as the variables refer to them.
+ */
+
+class IntArrayVariable(
+        name: String,
+        val values: IntArray
+) : Variable<IntArrayVariable>(name)
+
+class RealArrayVariable(
+        name: String,
+        val values: DoubleArray
+) : Variable<RealArrayVariable>(name)
+
+class BooleanArrayVariable(
+        name: String,
+        val values: BooleanArray
+) : Variable<BooleanArrayVariable>(name)
+
+class StringArrayVariable(
+        name: String,
+        val values: Array<String>
+) : Variable<StringArrayVariable>(name)
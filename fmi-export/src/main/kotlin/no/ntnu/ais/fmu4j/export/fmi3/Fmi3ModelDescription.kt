@@ -0,0 +1,180 @@
+package no.ntnu.ais.fmu4j.export.fmi3
+
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2Slave
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2VariableType
+import no.ntnu.ais.fmu4j.export.fmi2.ModelDependencies
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2Initial
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2ScalarVariable
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2Variability
+import java.io.StringWriter
+import javax.xml.stream.XMLOutputFactory
+import javax.xml.stream.XMLStreamWriter
+
+/**
+ * Writes the FMI 3.0 co-simulation model description of a defined slave,
+ * derived from its FMI 2.0 model description with array fields as array variables.
+ */
+internal object Fmi3ModelDescription {
+
+    fun toXml(slave: Fmi2Slave, variables: Fmi3Variables): String {
+
+        val md = slave.modelDescription
+        val cs = md.coSimulation
+        val writer = StringWriter()
+        val xml = XMLOutputFactory.newInstance().createXMLStreamWriter(writer)
+
+        xml.writeStartDocument("UTF-8", "1.0")
+        xml.newLine(0)
+        xml.writeStartElement("fmiModelDescription")
+        xml.writeAttribute("fmiVersion", "3.0")
+        xml.writeAttribute("modelName", md.modelName)
+        xml.writeAttribute("instantiationToken", md.guid)
+        xml.writeOptional("description", md.description)
+        xml.writeOptional("author", md.author)
+        xml.writeOptional("version", md.version)
+        xml.writeOptional("copyright", md.copyright)
+        xml.writeOptional("license", md.license)
+        xml.writeAttribute("generationTool", md.generationTool)
+        xml.writeAttribute("generationDateAndTime", md.generationDateAndTime)
+        xml.writeAttribute("variableNamingConvention", "structured")
+
+        xml.newLine(1)
+        xml.writeEmptyElement("CoSimulation")
+        xml.writeAttribute("modelIdentifier", cs.modelIdentifier)
+        xml.writeAttribute("needsExecutionTool", cs.isNeedsExecutionTool.toString())
+        xml.writeAttribute("canBeInstantiatedOnlyOncePerProcess", cs.isCanBeInstantiatedOnlyOncePerProcess.toString())
+        xml.writeAttribute("canGetAndSetFMUState", cs.isCanGetAndSetFMUstate.toString())
+        xml.writeAttribute("canSerializeFMUState", cs.isCanSerializeFMUstate.toString())
+        xml.writeAttribute("canHandleVariableCommunicationStepSize", cs.isCanHandleVariableCommunicationStepSize.toString())
+        xml.writeAttribute("mightReturnEarlyFromDoStep", "true")
+        xml.writeAttribute("hasEventMode", "false")
+
+        md.defaultExperiment?.also { de ->
+            xml.newLine(1)
+            xml.writeEmptyElement("DefaultExperiment")
+            xml.writeOptional("startTime", de.startTime?.toString())
+            xml.writeOptional("stopTime", de.stopTime?.toString())
+            xml.writeOptional("stepSize", de.stepSize?.toString())
+        }
+
+        xml.newLine(1)
+        xml.writeStartElement("ModelVariables")
+        xml.newLine(2)
+        xml.writeEmptyElement("Float64")
+        xml.writeAttribute("name", "time")
+        xml.writeAttribute("valueReference", Fmi3Variables.TIME.toString())
+        xml.writeAttribute("causality", "independent")
+        xml.writeAttribute("variability", "continuous")
+        for (v in variables.variables) {
+            xml.newLine(2)
+            writeVariable(xml, v)
+        }
+        xml.newLine(1)
+        xml.writeEndElement()
+
+        val dependencies = slave.modelDependencies()
+        xml.newLine(1)
+        xml.writeStartElement("ModelStructure")
+        writeUnknowns(xml, "Output", dependencies.outputs, variables)
+        writeUnknowns(xml, "InitialUnknown", dependencies.initialUnknowns, variables)
+        xml.newLine(1)
+        xml.writeEndElement()
+
+        xml.newLine(0)
+        xml.writeEndElement()
+        xml.writeEndDocument()
+        xml.close()
+
+        return writer.toString()
+    }
+
+    private fun writeVariable(xml: XMLStreamWriter, v: Fmi3Variable) {
+
+        val first = v.elements.first()
+        val hasChildren = v.isArray || v.type == Fmi2VariableType.STRING
+        if (hasChildren) {
+            xml.writeStartElement(v.type.fmi3Name)
+        } else {
+            xml.writeEmptyElement(v.type.fmi3Name)
+        }
+        xml.writeAttribute("name", v.name)
+        xml.writeAttribute("valueReference", v.valueReference.toString())
+        xml.writeOptional("description", first.description)
+        first.causality?.also { xml.writeAttribute("causality", it.name) }
+        // only floating point variables may be continuous, the others default to discrete
+        first.variability?.takeIf { v.type == Fmi2VariableType.REAL || it != Fmi2Variability.continuous }?.also {
+            xml.writeAttribute("variability", it.name)
+        }
+        first.initial?.takeIf { it != Fmi2Initial.undefined }?.also { xml.writeAttribute("initial", it.name) }
+
+        when (v.type) {
+            Fmi2VariableType.REAL -> {
+                xml.writeOptional("unit", first.real.unit)
+                xml.writeOptional("min", first.real.min?.toString())
+                xml.writeOptional("max", first.real.max?.toString())
+                xml.writeOptional("nominal", first.real.nominal?.toString())
+                xml.writeStart(v.elements) { it.real.start?.toString() }
+            }
+            Fmi2VariableType.INTEGER -> {
+                xml.writeOptional("min", first.integer.min?.toString())
+                xml.writeOptional("max", first.integer.max?.toString())
+                xml.writeStart(v.elements) { it.integer.start?.toString() }
+            }
+            Fmi2VariableType.BOOLEAN -> xml.writeStart(v.elements) { it.boolean.isStart()?.toString() }
+            else -> {}
+        }
+
+        if (v.isArray) {
+            xml.writeEmptyElement("Dimension")
+            xml.writeAttribute("start", v.size.toString())
+        }
+        if (v.type == Fmi2VariableType.STRING && v.elements.all { it.string.start != null }) {
+            for (element in v.elements) {
+                xml.writeEmptyElement("Start")
+                xml.writeAttribute("value", element.string.start)
+            }
+        }
+        if (hasChildren) {
+            xml.writeEndElement()
+        }
+    }
+
+    private fun writeUnknowns(xml: XMLStreamWriter, element: String, unknowns: List<ModelDependencies.Unknown>, variables: Fmi3Variables) {
+        // array elements collapse into their array variable, depending on the union of the dependencies of the elements
+        val byVariable = unknowns.groupBy { variables.valueReferenceOf(it.index.toInt() - 1) }
+        for ((vr, elements) in byVariable) {
+            xml.newLine(2)
+            xml.writeEmptyElement(element)
+            xml.writeAttribute("valueReference", vr.toString())
+            if (elements.any { it.dependencies == null }) continue
+            val dependencies = linkedMapOf<Long, String>()
+            for (unknown in elements) {
+                unknown.dependencies!!.forEachIndexed { i, index ->
+                    val kind = unknown.dependenciesKind?.get(i)?.name ?: "dependent"
+                    dependencies.putIfAbsent(variables.valueReferenceOf(index.toInt() - 1), kind)
+                }
+            }
+            val sorted = dependencies.toSortedMap()
+            xml.writeAttribute("dependencies", sorted.keys.joinToString(" "))
+            if (elements.any { it.dependenciesKind != null }) {
+                xml.writeAttribute("dependenciesKind", sorted.values.joinToString(" "))
+            }
+        }
+    }
+
+    private fun XMLStreamWriter.writeOptional(name: String, value: String?) {
+        if (value != null) writeAttribute(name, value)
+    }
+
+    private fun XMLStreamWriter.writeStart(elements: List<Fmi2ScalarVariable>, start: (Fmi2ScalarVariable) -> String?) {
+        val values = elements.map(start)
+        if (values.all { it != null }) {
+            writeAttribute("start", values.joinToString(" "))
+        }
+    }
+
+    private fun XMLStreamWriter.newLine(depth: Int) {
+        writeCharacters("\n" + "    ".repeat(depth))
+    }
+
+}
@@ -0,0 +1,220 @@
+package no.ntnu.ais.fmu4j.export.fmi3
+
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2Slave
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2VariableType
+import no.ntnu.ais.fmu4j.export.fmi2.type
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2ScalarVariable
+
+/**
+ * Name of the FMI 3.0 type corresponding to this FMI 2.0 type.
+ */
+internal val Fmi2VariableType.fmi3Name: String
+    get() = when (this) {
+        Fmi2VariableType.INTEGER -> "Int32"
+        Fmi2VariableType.REAL -> "Float64"
+        Fmi2VariableType.BOOLEAN -> "Boolean"
+        Fmi2VariableType.STRING -> "String"
+        Fmi2VariableType.ENUMERATION -> "Enumeration"
+    }
+
+/**
+ * A variable of the FMI 3.0 interface, made up of one or more FMI 2.0 [elements].
+ * Annotated array fields become a single array variable backed by the [array] itself,
+ * which is copied in bulk, while all other variables are scalars.
+ */
+internal class Fmi3Variable(
+    val name: String,
+    val valueReference: Long,
+    val type: Fmi2VariableType,
+    val elements: List<Fmi2ScalarVariable>,
+    val array: Any?
+) {
+
+    val size: Int
+        get() = elements.size
+
+    val isArray: Boolean
+        get() = array != null
+
+    // FMI 2.0 value references of the elements
+    val elementReferences: LongArray = LongArray(elements.size) { elements[it].valueReference }
+
+}
+
+/**
+ * The FMI 3.0 view of the variables of a [slave], with value references unique across types.
+ * Value reference 0 is the independent variable (time), the others follow the order of the FMI 2.0 variables.
+ */
+internal class Fmi3Variables(
+    private val slave: Fmi2Slave,
+    scalars: List<Fmi2ScalarVariable>,
+    arrays: Map<String, Any>
+) {
+
+    val variables: List<Fmi3Variable>
+
+    init {
+        val list = mutableListOf<Fmi3Variable>()
+        var i = 0
+        while (i < scalars.size) {
+            val scalar = scalars[i]
+            val array = scalar.name.takeIf { it.endsWith("[0]") }?.let { arrays[it.removeSuffix("[0]")] }
+            val size = when (array) {
+                is DoubleArray -> array.size
+                is IntArray -> array.size
+                is BooleanArray -> array.size
+                is Array<*> -> array.size
+                else -> 1
+            }
+            val name = if (array != null) scalar.name.removeSuffix("[0]") else scalar.name
+            list.add(Fmi3Variable(name, list.size + 1L, scalar.type(), scalars.subList(i, i + size).toList(), array))
+            i += size
+        }
+        variables = list
+    }
+
+    /**
+     * FMI 3.0 value reference of the variable holding the FMI 2.0 variable at [index] (0 based).
+     */
+    fun valueReferenceOf(index: Int): Long {
+        var offset = 0
+        for (v in variables) {
+            offset += v.size
+            if (index < offset) return v.valueReference
+        }
+        throw IndexOutOfBoundsException("No variable at index $index")
+    }
+
+    private fun variable(vr: Long, type: Fmi2VariableType): Fmi3Variable {
+        val v = variables.getOrNull(vr.toInt() - 1)
+            ?: throw IllegalArgumentException("No ${type.fmi3Name} variable with valueReference=$vr")
+        require(v.type == type) { "Variable '${v.name}' with valueReference=$vr is not a ${type.fmi3Name} variable" }
+        return v
+    }
+
+    // the variables written by a setter, which must be given exactly one value per element
+    private fun writableVariables(vr: LongArray, type: Fmi2VariableType, nValues: Int): Array<Fmi3Variable> {
+        val variables = Array(vr.size) {
+            require(vr[it] != TIME) { "The independent variable cannot be set" }
+            variable(vr[it], type)
+        }
+        val expected = variables.sumOf { it.size }
+        require(nValues == expected) { "Expected $expected ${type.fmi3Name} values, got $nValues" }
+        return variables
+    }
+
+    fun getFloat64(vr: LongArray): DoubleArray {
+        if (vr.size == 1 && vr[0] == TIME) return doubleArrayOf(slave.simulationTime)
+        val variables = Array(vr.size) { if (vr[it] == TIME) null else variable(vr[it], Fmi2VariableType.REAL) }
+        val values = DoubleArray(variables.sumOf { it?.size ?: 1 })
+        var offset = 0
+        for (v in variables) {
+            val array = v?.array
+            when {
+                v == null -> values[offset] = slave.simulationTime
+                array is DoubleArray -> System.arraycopy(array, 0, values, offset, array.size)
+                else -> slave.getReal(v.elementReferences).copyInto(values, offset)
+            }
+            offset += v?.size ?: 1
+        }
+        return values
+    }
+
+    fun setFloat64(vr: LongArray, values: DoubleArray) {
+        var offset = 0
+        for (v in writableVariables(vr, Fmi2VariableType.REAL, values.size)) {
+            val array = v.array
+            if (array is DoubleArray) {
+                System.arraycopy(values, offset, array, 0, array.size)
+            } else {
+                slave.setReal(v.elementReferences, values.copyOfRange(offset, offset + v.size))
+            }
+            offset += v.size
+        }
+    }
+
+    fun getInt32(vr: LongArray): IntArray {
+        val variables = Array(vr.size) { variable(vr[it], Fmi2VariableType.INTEGER) }
+        val values = IntArray(variables.sumOf { it.size })
+        var offset = 0
+        for (v in variables) {
+            val array = v.array
+            if (array is IntArray) {
+                System.arraycopy(array, 0, values, offset, array.size)
+            } else {
+                slave.getInteger(v.elementReferences).copyInto(values, offset)
+            }
+            offset += v.size
+        }
+        return values
+    }
+
+    fun setInt32(vr: LongArray, values: IntArray) {
+        var offset = 0
+        for (v in writableVariables(vr, Fmi2VariableType.INTEGER, values.size)) {
+            val array = v.array
+            if (array is IntArray) {
+                System.arraycopy(values, offset, array, 0, array.size)
+            } else {
+                slave.setInteger(v.elementReferences, values.copyOfRange(offset, offset + v.size))
+            }
+            offset += v.size
+        }
+    }
+
+    fun getBoolean(vr: LongArray): BooleanArray {
+        val variables = Array(vr.size) { variable(vr[it], Fmi2VariableType.BOOLEAN) }
+        val values = BooleanArray(variables.sumOf { it.size })
+        var offset = 0
+        for (v in variables) {
+            val array = v.array
+            if (array is BooleanArray) {
+                System.arraycopy(array, 0, values, offset, array.size)
+            } else {
+                slave.getBoolean(v.elementReferences).copyInto(values, offset)
+            }
+            offset += v.size
+        }
+        return values
+    }
+
+    fun setBoolean(vr: LongArray, values: BooleanArray) {
+        var offset = 0
+        for (v in writableVariables(vr, Fmi2VariableType.BOOLEAN, values.size)) {
+            val array = v.array
+            if (array is BooleanArray) {
+                System.arraycopy(values, offset, array, 0, array.size)
+            } else {
+                slave.setBoolean(v.elementReferences, values.copyOfRange(offset, offset + v.size))
+            }
+            offset += v.size
+        }
+    }
+
+    fun getString(vr: LongArray): Array<String> {
+        val variables = Array(vr.size) { variable(vr[it], Fmi2VariableType.STRING) }
+        val values = arrayOfNulls<String>(variables.sumOf { it.size })
+        var offset = 0
+        for (v in variables) {
+            slave.getString(v.elementReferences).copyInto(values, offset)
+            offset += v.size
+        }
+        @Suppress("UNCHECKED_CAST")
+        return values as Array<String>
+    }
+
+    fun setString(vr: LongArray, values: Array<String>) {
+        var offset = 0
+        for (v in writableVariables(vr, Fmi2VariableType.STRING, values.size)) {
+            slave.setString(v.elementReferences, values.copyOfRange(offset, offset + v.size))
+            offset += v.size
+        }
+    }
+
+    companion object {
+
+        const val TIME = 0L
+
+    }
+
+}
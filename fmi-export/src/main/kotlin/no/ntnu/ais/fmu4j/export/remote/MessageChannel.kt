@@ -0,0 +1,136 @@
+package no.ntnu.ais.fmu4j.export.remote
+
+import java.io.Closeable
+import java.io.EOFException
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.channels.SocketChannel
+import java.nio.charset.StandardCharsets
+
+/**
+ * Bidirectional, message oriented transport between a native proxy and a [SlaveSession].
+ */
+interface MessageChannel : Closeable {
+
+    /**
+     * Blocks until the next message arrives.
+     * The returned buffer is only valid until the next call.
+     */
+    fun receive(): ByteBuffer
+
+    /**
+     * Sends the remaining bytes of [message].
+     */
+    fun send(message: ByteBuffer)
+
+}
+
+/**
+ * Length prefixed messages over a (loopback) socket.
+ */
+class SocketMessageChannel(
+    private val socket: SocketChannel
+) : MessageChannel {
+
+    private val header = ByteBuffer.allocateDirect(4).order(ByteOrder.nativeOrder())
+    private val buffer = MessageBuffer()
+
+    init {
+        socket.socket().tcpNoDelay = true
+    }
+
+    override fun receive(): ByteBuffer {
+        header.clear()
+        readFully(header)
+        val size = header.getInt(0)
+        val message = buffer.reset(size)
+        message.limit(size)
+        readFully(message)
+        message.flip()
+        return message
+    }
+
+    override fun send(message: ByteBuffer) {
+        header.clear()
+        header.putInt(message.remaining())
+        header.flip()
+        val buffers = arrayOf(header, message)
+        while (header.hasRemaining() || message.hasRemaining()) {
+            socket.write(buffers)
+        }
+    }
+
+    override fun close() {
+        socket.close()
+    }
+
+    private fun readFully(dst: ByteBuffer) {
+        while (dst.hasRemaining()) {
+            if (socket.read(dst) < 0) {
+                throw EOFException("Connection closed")
+            }
+        }
+    }
+
+}
+
+/**
+ * Growable direct buffer in native byte order used to compose messages.
+ */
+class MessageBuffer(
+    capacity: Int = 4096
+) {
+
+    var buffer: ByteBuffer = allocate(capacity)
+        private set
+
+    /**
+     * Clears the buffer, making sure it can hold at least [capacity] bytes.
+     */
+    fun reset(capacity: Int = 0): ByteBuffer {
+        if (buffer.capacity() < capacity) {
+            buffer = allocate(capacity)
+        }
+        buffer.clear()
+        return buffer
+    }
+
+    fun ensureRemaining(size: Int): ByteBuffer {
+        if (buffer.remaining() < size) {
+            val grown = allocate(maxOf(buffer.capacity() * 2, buffer.position() + size))
+            buffer.flip()
+            grown.put(buffer)
+            buffer = grown
+        }
+        return buffer
+    }
+
+    fun putInt(value: Int) {
+        ensureRemaining(4).putInt(value)
+    }
+
+    fun putDouble(value: Double) {
+        ensureRemaining(8).putDouble(value)
+    }
+
+    fun putString(value: String) {
+        val bytes = value.toByteArray(StandardCharsets.UTF_8)
+        ensureRemaining(4 + bytes.size).putInt(bytes.size).put(bytes)
+    }
+
+    fun flip(): ByteBuffer {
+        buffer.flip()
+        return buffer
+    }
+
+    private companion object {
+        private fun allocate(capacity: Int) = ByteBuffer.allocateDirect(capacity).order(ByteOrder.nativeOrder())
+    }
+
+}
+
+internal fun ByteBuffer.getString(): String {
+    val bytes = ByteArray(int)
+    get(bytes)
+    return String(bytes, StandardCharsets.UTF_8)
+}
@@ -0,0 +1,48 @@
+package no.ntnu.ais.fmu4j.export.remote
+
+/**
+ * Message layout shared with the native proxy (fmu4j/remote.hpp).
+ * Requests start with an operation code, replies with a status followed by the result or an error message.
+ * All values are encoded in native byte order, strings as a length prefixed UTF-8 sequence.
+ */
+internal object Protocol {
+
+    const val HELLO = 0
+
+    const val INSTANTIATE = 1
+    const val SETUP_EXPERIMENT = 2
+    const val ENTER_INITIALIZATION_MODE = 3
+    const val EXIT_INITIALIZATION_MODE = 4
+    const val DO_STEP = 5
+    const val RESET = 6
+    const val TERMINATE = 7
+    const val FREE = 8
+
+    const val GET_INTEGER = 10
+    const val GET_REAL = 11
+    const val GET_BOOLEAN = 12
+    const val GET_STRING = 13
+
+    const val SET_INTEGER = 20
+    const val SET_REAL = 21
+    const val SET_BOOLEAN = 22
+    const val SET_STRING = 23
+
+    const val OPEN_SESSION = 30
+    const val SHUTDOWN = 31
+
+    const val GET_FMU_STATE = 40
+    const val SET_FMU_STATE = 41
+    const val FREE_FMU_STATE = 42
+    const val SERIALIZE_FMU_STATE = 43
+    const val DESERIALIZE_FMU_STATE = 44
+
+    const val GET_DIRECTIONAL_DERIVATIVES = 50
+    const val SET_REAL_INPUT_DERIVATIVES = 51
+    const val GET_REAL_OUTPUT_DERIVATIVES = 52
+    const val GET_PREFERRED_STEP_SIZE = 53
+
+    const val STATUS_OK = 0
+    const val STATUS_ERROR = 1
+
+}
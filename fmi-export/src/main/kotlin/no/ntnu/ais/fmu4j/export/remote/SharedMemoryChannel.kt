@@ -0,0 +1,67 @@
+package no.ntnu.ais.fmu4j.export.remote
+
+import java.io.IOException
+import java.nio.ByteBuffer
+
+/**
+ * Worker end of a shared-memory channel created by the native layer (fmu4j/SharedMemoryChannel.hpp).
+ *
+ * The rings and their futex wake-ups are driven through JNI by the same native library that hosts the master end,
+ * which [SlaveWorker] loads before opening any channel.
+ */
+class SharedMemoryChannel(
+    name: String
+) : MessageChannel {
+
+    private var handle = open0(name)
+    private val buffer = MessageBuffer()
+
+    override fun receive(): ByteBuffer {
+        var size = receive0(checkOpen(), buffer.reset())
+        if (size < 0) {
+            // too large for the current buffer, the message is kept until we come back with a larger one
+            size = receive0(handle, buffer.reset(-size))
+        }
+        return buffer.buffer.apply {
+            position(0)
+            limit(size)
+        }
+    }
+
+    override fun send(message: ByteBuffer) {
+        val direct = if (message.isDirect) message else buffer.reset(message.remaining()).put(message.duplicate()).apply { flip() }
+        send0(checkOpen(), direct, direct.position(), direct.remaining())
+        message.position(message.limit())
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            close0(handle)
+            handle = 0L
+        }
+    }
+
+    private fun checkOpen(): Long {
+        if (handle == 0L) {
+            throw IOException("Channel closed")
+        }
+        return handle
+    }
+
+    private companion object {
+
+        @JvmStatic
+        private external fun open0(name: String): Long
+
+        @JvmStatic
+        private external fun receive0(handle: Long, buffer: ByteBuffer): Int
+
+        @JvmStatic
+        private external fun send0(handle: Long, buffer: ByteBuffer, offset: Int, length: Int)
+
+        @JvmStatic
+        private external fun close0(handle: Long)
+
+    }
+
+}
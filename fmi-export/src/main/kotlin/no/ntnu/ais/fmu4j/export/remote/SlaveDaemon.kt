@@ -0,0 +1,244 @@
+package no.ntnu.ais.fmu4j.export.remote
+
+import java.io.File
+import java.io.IOException
+import java.io.RandomAccessFile
+import java.net.InetAddress
+import java.net.InetSocketAddress
+import java.net.SocketTimeoutException
+import java.net.URLClassLoader
+import java.nio.channels.ServerSocketChannel
+import java.nio.channels.SocketChannel
+import java.nio.file.Files
+import java.nio.file.StandardCopyOption
+import java.nio.file.attribute.PosixFilePermissions
+import java.security.MessageDigest
+import java.security.SecureRandom
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicInteger
+import java.util.concurrent.atomic.AtomicLong
+import java.util.logging.Level
+import java.util.logging.Logger
+import kotlin.system.exitProcess
+
+/**
+ * Long-lived JVM serving slave instances to native proxies over loopback sockets (FMU4J_MODE=daemon).
+ *
+ * Spawned by the native layer on first use. The listening port and an access token are published in a port file,
+ * and the daemon exits once it has been idle for the given number of seconds.
+ * Classloaders are kept per FMU, so that classes stay loaded and JIT compiled across simulation runs.
+ * As each load of an FMU extracts it anew, they are keyed by the contents of its jars, which are copied next to the
+ * port file. Classloaders without sessions for as long as the idle timeout are closed.
+ *
+ * Usage: SlaveDaemon <port file> <idle timeout in seconds>
+ */
+object SlaveDaemon {
+
+    private val LOG: Logger = Logger.getLogger(SlaveDaemon::class.java.name)
+
+    private const val SESSION_CLASS = "no.ntnu.ais.fmu4j.export.remote.SlaveSession"
+
+    private val classLoaders = ConcurrentHashMap<String, CachedLoader>()
+    private val activeSessions = AtomicInteger()
+    private val lastActivity = AtomicLong(System.nanoTime())
+
+    @JvmStatic
+    fun main(args: Array<String>) {
+
+        require(args.size == 2) { "Usage: SlaveDaemon <port file> <idle timeout in seconds>" }
+        val portFile = File(args[0])
+        val idleTimeout = TimeUnit.SECONDS.toNanos(args[1].toLong())
+        loaderDirectory = File(portFile.absoluteFile.parentFile, "loaders")
+
+        // only a single daemon per port file, concurrent spawns simply exit
+        val lockFile = RandomAccessFile(File(portFile.path + ".lock"), "rw")
+        val lock = lockFile.channel.tryLock() ?: exitProcess(0)
+
+        val server = ServerSocketChannel.open()
+        server.bind(InetSocketAddress(InetAddress.getLoopbackAddress(), 0))
+        server.socket().soTimeout = 1000
+
+        val token = ByteArray(16).also { SecureRandom().nextBytes(it) }.joinToString("") { "%02x".format(it) }
+        publish(portFile, server.socket().localPort, token)
+
+        LOG.info("fmu4j daemon listening on port ${server.socket().localPort}")
+
+        while (activeSessions.get() > 0 || System.nanoTime() - lastActivity.get() < idleTimeout) {
+            val socket = try {
+                server.socket().accept().channel
+            } catch (ex: SocketTimeoutException) {
+                evictIdleLoaders(idleTimeout)
+                continue
+            }
+            activeSessions.incrementAndGet()
+            Thread({
+                try {
+                    handshake(socket, token)
+                } catch (ex: Exception) {
+                    LOG.log(Level.WARNING, "Session failed", ex)
+                    socket.close()
+                } finally {
+                    lastActivity.set(System.nanoTime())
+                    activeSessions.decrementAndGet()
+                }
+            }, "fmu4j-session").start()
+        }
+
+        classLoaders.keys.toList().forEach { evict(it) }
+        portFile.delete()
+        server.close()
+        lock.release()
+        lockFile.close()
+        exitProcess(0)
+
+    }
+
+    private fun handshake(socket: SocketChannel, token: String) {
+        val channel = SocketMessageChannel(socket)
+        val hello = channel.receive()
+        val reply = MessageBuffer()
+        if (hello.int != Protocol.HELLO || hello.getString() != token) {
+            reply.putInt(Protocol.STATUS_ERROR)
+            reply.putString("Invalid token")
+            channel.send(reply.flip())
+            channel.close()
+            return
+        }
+        val resources = hello.getString()
+        val cached = try {
+            acquireLoader(resources)
+        } catch (ex: Exception) {
+            reply.putInt(Protocol.STATUS_ERROR)
+            reply.putString("Unable to load '$resources': $ex")
+            channel.send(reply.flip())
+            channel.close()
+            return
+        }
+        try {
+            val serve = cached.loader.loadClass(SESSION_CLASS)
+                .getMethod("serve", SocketChannel::class.java, String::class.java)
+            reply.putInt(Protocol.STATUS_OK)
+            channel.send(reply.flip())
+            serve.invoke(null, socket, resources)
+        } finally {
+            cached.release()
+        }
+    }
+
+    /**
+     * Each FMU gets an isolated classloader over copies of its jars, shared by all loads of jars with the same contents.
+     * The returned loader is in use until released.
+     */
+    private fun acquireLoader(resources: String): CachedLoader {
+        val modelJar = File(resources, "model.jar")
+        if (!modelJar.exists()) {
+            throw IOException("No such file: $modelJar")
+        }
+        val jars = listOf(modelJar, File(resources, "fmu4j-runtime.jar")).filter { it.exists() }
+        val key = digest(jars)
+        while (true) {
+            val cached = classLoaders.computeIfAbsent(key) {
+                val dir = File(loaderDirectory, key)
+                dir.mkdirs()
+                val copies = jars.map { jar ->
+                    File(dir, jar.name).also { copy ->
+                        if (!copy.exists()) {
+                            val tmp = File(dir, jar.name + ".tmp")
+                            Files.copy(jar.toPath(), tmp.toPath(), StandardCopyOption.REPLACE_EXISTING)
+                            Files.move(tmp.toPath(), copy.toPath(), StandardCopyOption.ATOMIC_MOVE)
+                        }
+                    }
+                }
+                val urls = copies.map { it.toURI().toURL() }
+                CachedLoader(URLClassLoader(urls.toTypedArray(), ClassLoader.getSystemClassLoader().parent), dir)
+            }
+            // retry if evicted concurrently
+            if (cached.acquire()) return cached
+            Thread.yield()
+        }
+    }
+
+    private fun evictIdleLoaders(idleTimeout: Long) {
+        val now = System.nanoTime()
+        classLoaders.forEach { (key, cached) ->
+            if (cached.isIdle(now, idleTimeout)) evict(key)
+        }
+    }
+
+    private fun evict(key: String) {
+        val cached = classLoaders[key] ?: return
+        if (!cached.close()) return
+        // removed only once the copies are gone, so that a new loader for the same key does not lose its copies
+        cached.directory.deleteRecursively()
+        classLoaders.remove(key, cached)
+        LOG.fine("Evicted the classloader of $key")
+    }
+
+    private fun digest(jars: List<File>): String {
+        val md = MessageDigest.getInstance("SHA-256")
+        val buffer = ByteArray(64 * 1024)
+        jars.forEach { jar ->
+            jar.inputStream().use { input ->
+                while (true) {
+                    val n = input.read(buffer)
+                    if (n < 0) break
+                    md.update(buffer, 0, n)
+                }
+            }
+        }
+        return md.digest().joinToString("") { "%02x".format(it) }
+    }
+
+    private fun publish(portFile: File, port: Int, token: String) {
+        val tmp = File(portFile.path + ".tmp")
+        tmp.delete()
+        tmp.createNewFile()
+        try {
+            // the token grants access to the daemon, so keep it private to the user
+            Files.setPosixFilePermissions(tmp.toPath(), PosixFilePermissions.fromString("rw-------"))
+        } catch (ex: UnsupportedOperationException) {
+            // not a POSIX file system
+        }
+        tmp.writeText("$port $token\n")
+        Files.move(tmp.toPath(), portFile.toPath(), StandardCopyOption.REPLACE_EXISTING, StandardCopyOption.ATOMIC_MOVE)
+    }
+
+    private lateinit var loaderDirectory: File
+
+    private class CachedLoader(
+        val loader: URLClassLoader,
+        val directory: File
+    ) {
+
+        // number of sessions using the loader, or -1 once closed
+        private var sessions = 0
+        private var lastUsed = System.nanoTime()
+
+        @Synchronized
+        fun acquire(): Boolean {
+            if (sessions < 0) return false
+            sessions++
+            return true
+        }
+
+        @Synchronized
+        fun release() {
+            sessions--
+            lastUsed = System.nanoTime()
+        }
+
+        @Synchronized
+        fun isIdle(now: Long, idleTimeout: Long) = sessions == 0 && now - lastUsed >= idleTimeout
+
+        @Synchronized
+        fun close(): Boolean {
+            if (sessions != 0) return false
+            sessions = -1
+            loader.close()
+            return true
+        }
+
+    }
+
+}
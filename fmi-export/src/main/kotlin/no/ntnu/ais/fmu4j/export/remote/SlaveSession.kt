@@ -0,0 +1,217 @@
+package no.ntnu.ais.fmu4j.export.remote
+
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2Slave
+import no.ntnu.ais.fmu4j.export.fmi2.VariableIndex
+import java.io.File
+import java.io.IOException
+import java.nio.ByteBuffer
+import java.nio.channels.SocketChannel
+import java.util.logging.Level
+import java.util.logging.Logger
+
+/**
+ * Serves a single slave instance to a native proxy running in another process.
+ * The session is loaded by the classloader of the FMU it serves,
+ * so that the slave is driven by the fmu4j runtime it was built against.
+ */
+class SlaveSession(
+    private val channel: MessageChannel,
+    private val resources: String
+) : Runnable {
+
+    private val reply = MessageBuffer()
+    private var instanceName: String? = null
+    private var slave: Fmi2Slave? = null
+
+    private val states = HashMap<Int, Any>()
+    private var nextStateId = 0
+
+    override fun run() {
+        try {
+            var open = true
+            while (open) {
+                val request = channel.receive()
+                reply.reset()
+                reply.putInt(Protocol.STATUS_OK)
+                open = try {
+                    handle(request.int, request)
+                } catch (ex: Throwable) {
+                    LOG.log(Level.WARNING, "Request failed", ex)
+                    reply.reset()
+                    reply.putInt(Protocol.STATUS_ERROR)
+                    reply.putString(ex.toString())
+                    true
+                }
+                channel.send(reply.flip())
+            }
+        } catch (ex: IOException) {
+            LOG.fine("Session '$instanceName' disconnected: $ex")
+        } finally {
+            slave?.close()
+            channel.close()
+        }
+    }
+
+    private fun handle(op: Int, request: ByteBuffer): Boolean {
+        when (op) {
+            Protocol.INSTANTIATE -> {
+                instanceName = request.getString()
+                slave = instantiate().also { reply.putInt(if (it.__canGetAndSetFMUstate__()) 1 else 0) }
+            }
+            Protocol.SETUP_EXPERIMENT -> slave().setupExperiment(request.double, request.double, request.double)
+            Protocol.ENTER_INITIALIZATION_MODE -> slave().enterInitialisationMode()
+            Protocol.EXIT_INITIALIZATION_MODE -> slave().exitInitialisationMode()
+            Protocol.DO_STEP -> reply.putDouble(slave().__doStep__(request.double, request.double))
+            Protocol.RESET -> {
+                if (!slave().__reset__()) {
+                    slave().close()
+                    slave = instantiate()
+                }
+            }
+            Protocol.TERMINATE -> slave().terminate()
+            Protocol.FREE -> {
+                slave?.close()
+                slave = null
+                return false
+            }
+            Protocol.GET_INTEGER -> {
+                val values = slave().getInteger(request.getValueReferences())
+                reply.ensureRemaining(4 * values.size)
+                values.forEach { reply.buffer.putInt(it) }
+            }
+            Protocol.GET_REAL -> {
+                val values = slave().getReal(request.getValueReferences())
+                reply.ensureRemaining(8 * values.size)
+                values.forEach { reply.buffer.putDouble(it) }
+            }
+            Protocol.GET_BOOLEAN -> {
+                val values = slave().getBoolean(request.getValueReferences())
+                reply.ensureRemaining(4 * values.size)
+                values.forEach { reply.buffer.putInt(if (it) 1 else 0) }
+            }
+            Protocol.GET_STRING -> {
+                slave().getString(request.getValueReferences()).forEach { reply.putString(it) }
+            }
+            Protocol.SET_INTEGER -> {
+                val vr = request.getValueReferences()
+                slave().setInteger(vr, IntArray(vr.size) { request.int })
+            }
+            Protocol.SET_REAL -> {
+                val vr = request.getValueReferences()
+                slave().setReal(vr, DoubleArray(vr.size) { request.double })
+            }
+            Protocol.SET_BOOLEAN -> {
+                val vr = request.getValueReferences()
+                slave().setBoolean(vr, BooleanArray(vr.size) { request.int != 0 })
+            }
+            Protocol.SET_STRING -> {
+                val vr = request.getValueReferences()
+                slave().setString(vr, Array(vr.size) { request.getString() })
+            }
+            Protocol.GET_FMU_STATE -> {
+                val id = request.int
+                if (id < 0) {
+                    states[nextStateId] = slave().saveState()
+                    reply.putInt(nextStateId++)
+                } else {
+                    states[id] = slave().saveStateInto(state(id))
+                    reply.putInt(id)
+                }
+            }
+            Protocol.SET_FMU_STATE -> slave().restoreState(state(request.int))
+            Protocol.FREE_FMU_STATE -> states.remove(request.int)
+            Protocol.SERIALIZE_FMU_STATE -> {
+                val state = state(request.int)
+                val size = slave().serializedStateSize(state)
+                reply.putInt(size)
+                slave().serializeState(state, reply.ensureRemaining(size))
+            }
+            Protocol.DESERIALIZE_FMU_STATE -> {
+                val size = request.int
+                val bytes = request.slice()
+                bytes.limit(size)
+                states[nextStateId] = slave().deserializeState(bytes)
+                reply.putInt(nextStateId++)
+            }
+            Protocol.GET_DIRECTIONAL_DERIVATIVES -> {
+                val unknowns = request.getValueReferences()
+                val knowns = request.getValueReferences()
+                val seeds = DoubleArray(knowns.size * request.int) { request.double }
+                slave().__directionalDerivatives__(unknowns, knowns, seeds).forEach { reply.putDouble(it) }
+            }
+            Protocol.SET_REAL_INPUT_DERIVATIVES -> {
+                val n = request.int
+                val vr = LongArray(n)
+                val order = IntArray(n)
+                val value = DoubleArray(n)
+                for (i in 0 until n) {
+                    vr[i] = request.int.toLong() and 0xFFFFFFFFL
+                    order[i] = request.int
+                    value[i] = request.double
+                }
+                slave().__setRealInputDerivatives__(vr, order, value)
+            }
+            Protocol.GET_REAL_OUTPUT_DERIVATIVES -> {
+                val vr = request.getValueReferences()
+                val derivatives = slave().getRealOutputDerivatives(vr, IntArray(vr.size) { request.int })
+                reply.putInt(if (derivatives != null) 1 else 0)
+                derivatives?.forEach { reply.putDouble(it) }
+            }
+            Protocol.GET_PREFERRED_STEP_SIZE -> reply.putDouble(slave().__preferredStepSize__())
+            else -> throw IllegalArgumentException("Unknown operation: $op")
+        }
+        return true
+    }
+
+    private fun slave(): Fmi2Slave {
+        return slave ?: throw IllegalStateException("No slave has been instantiated!")
+    }
+
+    private fun state(id: Int): Any {
+        return states[id] ?: throw IllegalArgumentException("No such FMU state: $id")
+    }
+
+    private fun instantiate(): Fmi2Slave {
+        val mainClass = File(resources, "mainclass.txt").readText().trim()
+        val slaveClass = javaClass.classLoader.loadClass(mainClass)
+        val args = mapOf(
+            "instanceName" to (instanceName ?: throw IllegalStateException("Missing 'instanceName'")),
+            "resourceLocation" to resources
+        )
+        val instance = slaveClass.getConstructor(Map::class.java).newInstance(args) as Fmi2Slave
+        val index = File(resources, VariableIndex.FILE_NAME)
+        if (index.exists()) {
+            instance.__defineFromIndex__(index.absolutePath)
+        } else {
+            instance.__define__()
+        }
+        return instance
+    }
+
+    private fun ByteBuffer.getValueReferences(): LongArray {
+        return LongArray(int) { int.toLong() and 0xFFFFFFFFL }
+    }
+
+    companion object {
+
+        private val LOG: Logger = Logger.getLogger(SlaveSession::class.java.name)
+
+        /**
+         * Entry point used by [SlaveDaemon], which invokes it reflectively through the classloader of the FMU.
+         * Blocks until the session ends.
+         */
+        @JvmStatic
+        fun serve(socket: SocketChannel, resources: String) {
+            val thread = Thread.currentThread()
+            val contextClassLoader = thread.contextClassLoader
+            thread.contextClassLoader = SlaveSession::class.java.classLoader
+            try {
+                SlaveSession(SocketMessageChannel(socket), resources).run()
+            } finally {
+                thread.contextClassLoader = contextClassLoader
+            }
+        }
+
+    }
+
+}
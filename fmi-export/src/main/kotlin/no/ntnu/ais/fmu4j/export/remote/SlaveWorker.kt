@@ -0,0 +1,71 @@
+package no.ntnu.ais.fmu4j.export.remote
+
+import java.io.IOException
+import java.util.logging.Level
+import java.util.logging.Logger
+import kotlin.system.exitProcess
+
+/**
+ * Child JVM serving the slave instances of a single FMU over shared memory (FMU4J_MODE=worker).
+ *
+ * Spawned by the native layer with the classpath of the FMU and the JVM options given in `worker-options.txt`,
+ * so that each FMU, or group of instances, gets its own heap and garbage collector.
+ * Sessions are requested over the control channel and served on threads of their own.
+ * The worker exits when told to, or as soon as the simulation process goes away.
+ *
+ * Usage: SlaveWorker <native library> <resources> <control channel>
+ */
+object SlaveWorker {
+
+    private val LOG: Logger = Logger.getLogger(SlaveWorker::class.java.name)
+
+    @JvmStatic
+    fun main(args: Array<String>) {
+
+        require(args.size == 3) { "Usage: SlaveWorker <native library> <resources> <control channel>" }
+        System.load(args[0])
+        val resources = args[1]
+
+        val control = SharedMemoryChannel(args[2])
+        val reply = MessageBuffer()
+        reply.putInt(Protocol.STATUS_OK)
+        control.send(reply.flip())
+
+        try {
+            while (true) {
+                val request = control.receive()
+                reply.reset()
+                when (val op = request.int) {
+                    Protocol.OPEN_SESSION -> {
+                        val name = request.getString()
+                        try {
+                            val channel = SharedMemoryChannel(name)
+                            Thread(SlaveSession(channel, resources), "fmu4j-session").start()
+                            reply.putInt(Protocol.STATUS_OK)
+                        } catch (ex: IOException) {
+                            reply.putInt(Protocol.STATUS_ERROR)
+                            reply.putString(ex.toString())
+                        }
+                    }
+                    Protocol.SHUTDOWN -> {
+                        reply.putInt(Protocol.STATUS_OK)
+                        control.send(reply.flip())
+                        break
+                    }
+                    else -> {
+                        reply.putInt(Protocol.STATUS_ERROR)
+                        reply.putString("Unknown operation: $op")
+                    }
+                }
+                control.send(reply.flip())
+            }
+        } catch (ex: IOException) {
+            LOG.log(Level.FINE, "Lost the simulation process", ex)
+        }
+
+        control.close()
+        exitProcess(0)
+
+    }
+
+}
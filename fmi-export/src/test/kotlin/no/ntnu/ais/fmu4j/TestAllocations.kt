@@ -0,0 +1,74 @@
+package no.ntnu.ais.fmu4j
+
+import com.sun.management.ThreadMXBean
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2Slave
+import no.ntnu.ais.fmu4j.export.fmi2.GeneratedAccessors
+import no.ntnu.ais.fmu4j.slaves.GainSlave
+import no.ntnu.ais.fmu4j.slaves.PrivateGainSlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Assumptions
+import org.junit.jupiter.api.Test
+import java.lang.management.ManagementFactory
+
+class TestAllocations {
+
+    @Test
+    fun testGetSetDoNotAllocate() {
+        val slave = GainSlave(mapOf("instanceName" to "gain")).apply {
+            __define__()
+        }
+        assertExchangeDoesNotAllocate(slave)
+    }
+
+    @Test
+    fun testGetSetOfPrivateFieldsDoNotAllocate() {
+        // the inputs are read and written through FieldAccessor
+        val accessors = GeneratedAccessors.find(PrivateGainSlave::class.java)
+        Assertions.assertTrue(accessors == null || accessors.fields.isEmpty())
+
+        val slave = PrivateGainSlave(mapOf("instanceName" to "gain")).apply {
+            __define__()
+        }
+        assertExchangeDoesNotAllocate(slave)
+    }
+
+    private fun assertExchangeDoesNotAllocate(slave: Fmi2Slave) {
+
+        val threads = ManagementFactory.getThreadMXBean() as ThreadMXBean
+        Assumptions.assumeTrue(threads.isThreadAllocatedMemorySupported)
+        threads.isThreadAllocatedMemoryEnabled = true
+
+        val inputs = longArrayOf(slave.getValueRef("u1"), slave.getValueRef("u2"))
+        val outputs = longArrayOf(slave.getValueRef("y1"), slave.getValueRef("y2"))
+        val inputValues = DoubleArray(inputs.size)
+        val outputValues = DoubleArray(outputs.size)
+        val readBack = DoubleArray(inputs.size)
+
+        fun exchange(n: Int) {
+            for (i in 0 until n) {
+                inputValues[0] = i.toDouble()
+                inputValues[1] = 1.0
+                slave.setReal(inputs, inputValues)
+                slave.getReal(inputs, readBack)
+                slave.getReal(outputs, outputValues)
+            }
+        }
+
+        // let the JIT compile the accessors first
+        exchange(100_000)
+
+        // reading the counter may allocate itself, which is not accounted to the slave
+        val threadId = Thread.currentThread().id
+        val overhead = threads.getThreadAllocatedBytes(threadId).let { threads.getThreadAllocatedBytes(threadId) - it }
+        val before = threads.getThreadAllocatedBytes(threadId)
+        exchange(10_000)
+        val allocated = threads.getThreadAllocatedBytes(threadId) - before - overhead
+
+        Assertions.assertArrayEquals(doubleArrayOf(9999.0, 1.0), readBack)
+        Assertions.assertEquals(2 * 9999.0 + 1, outputValues[0])
+        Assertions.assertEquals(3.0, outputValues[1])
+        Assertions.assertTrue(allocated <= 0L, "$allocated bytes allocated")
+
+    }
+
+}
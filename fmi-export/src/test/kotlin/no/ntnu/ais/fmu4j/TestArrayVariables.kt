@@ -0,0 +1,54 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2VariableType
+import no.ntnu.ais.fmu4j.slaves.ArraySlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+
+class TestArrayVariables {
+
+    @Test
+    fun testArrayVariables() {
+
+        val slave = ArraySlave(mapOf("instanceName" to "arrays")).apply {
+            __define__()
+        }
+
+        // annotated fields are registered first, the value references of an array are consecutive
+        Assertions.assertEquals(0L, slave.getValueRef("ys[0]"))
+        Assertions.assertEquals(3L, slave.getValueRef("xs[0]"))
+        Assertions.assertEquals(1002L, slave.getValueRef("xs[999]"))
+        Assertions.assertEquals(1003L, slave.getValueRef("gain"))
+        Assertions.assertEquals(1L, slave.getValueRef("flags[1]"))
+        Assertions.assertEquals("xs[5]", slave.getVariableName(8L, Fmi2VariableType.REAL))
+        Assertions.assertThrows(IllegalArgumentException::class.java) {
+            slave.getValueRef("xs[1000]")
+        }
+
+        val variables = slave.modelDescription.modelVariables.scalarVariable
+        Assertions.assertEquals(3 + 1000 + 1 + 2, variables.size)
+        Assertions.assertEquals(1.0, variables.first { it.name == "xs[2]" }.real.start)
+        Assertions.assertNull(variables.first { it.name == "ys[1]" }.real.start)
+
+        // a single request spanning a scalar and parts of two arrays
+        val vr = longArrayOf(3L, 4L, 5L, 1003L, 1L, 2L)
+        slave.setReal(vr, doubleArrayOf(1.0, 2.0, 3.0, 4.0, 5.0, 6.0))
+        Assertions.assertArrayEquals(doubleArrayOf(1.0, 2.0, 3.0), slave.xs.copyOf(3))
+        Assertions.assertEquals(4.0, slave.gain)
+        Assertions.assertArrayEquals(doubleArrayOf(1.0, 5.0, 6.0), slave.ys)
+
+        slave.doStep(0.0, 0.1)
+        Assertions.assertArrayEquals(
+            doubleArrayOf(4.0, 8.0, 12.0, 4.0),
+            slave.getReal(longArrayOf(0L, 1L, 2L, 1003L))
+        )
+
+        slave.setBoolean(longArrayOf(1L), booleanArrayOf(true))
+        Assertions.assertArrayEquals(booleanArrayOf(false, true), slave.getBoolean(longArrayOf(0L, 1L)))
+
+        // a range per variable rather than a value reference per element
+        Assertions.assertArrayEquals(longArrayOf(0L, 3L, 3L, 1000L, 1003L, 1L), slave.__valueReferences__()[1])
+
+    }
+
+}
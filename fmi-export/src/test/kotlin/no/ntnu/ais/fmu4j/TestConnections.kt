@@ -0,0 +1,92 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.slaves.GainSlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+import java.io.ByteArrayOutputStream
+
+class TestConnections {
+
+    @Test
+    fun testConnectReal() {
+
+        val source = GainSlave(mapOf("instanceName" to "source")).apply {
+            __define__()
+        }
+        val target = GainSlave(mapOf("instanceName" to "target")).apply {
+            __define__()
+        }
+        val u1 = target.getValueRef("u1")
+        target.__connectReal__(u1, source.__realSource__(source.getValueRef("y1")))
+
+        source.u1 = 3.0
+        target.__doStep__(0.0, 1.0)
+        Assertions.assertEquals(10.0, target.u1)
+        Assertions.assertEquals(24.0, target.getReal(longArrayOf(target.getValueRef("y1")))[0])
+
+        target.__connectReal__(u1, null)
+        source.u1 = 0.0
+        target.__doStep__(1.0, 1.0)
+        Assertions.assertEquals(10.0, target.u1)
+
+        Assertions.assertThrows(IllegalArgumentException::class.java) {
+            target.__connectReal__(target.getValueRef("y1"), source.__realSource__(source.getValueRef("y2")))
+        }
+
+    }
+
+    @Test
+    fun testResetDisconnects() {
+
+        val source = GainSlave(mapOf("instanceName" to "source")).apply {
+            __define__()
+        }
+        val target = GainSlave(mapOf("instanceName" to "target")).apply {
+            __define__()
+        }
+        target.__connectReal__(target.getValueRef("u2"), source.__realSource__(source.getValueRef("y2")))
+        target.__reset__()
+
+        target.__doStep__(0.0, 1.0)
+        Assertions.assertEquals(2.0, target.u2)
+
+    }
+
+    @Test
+    fun testSourceHandles() {
+
+        val source = GainSlave(mapOf("instanceName" to "source")).apply {
+            __define__()
+        }
+        val target = GainSlave(mapOf("instanceName" to "target")).apply {
+            __define__()
+        }
+        val y1 = source.getValueRef("y1")
+        val handle = source.__realSourceHandle__(y1)
+        Assertions.assertEquals(handle, source.__realSourceHandle__(y1))
+        // the registry of handles leaves the system properties alone
+        System.getProperties().store(ByteArrayOutputStream(), null)
+
+        val u1 = target.getValueRef("u1")
+        Assertions.assertThrows(IllegalArgumentException::class.java) {
+            target.__connectRealHandle__(u1, -1L)
+        }
+        target.__connectRealHandle__(u1, handle)
+        source.u1 = 3.0
+        target.__doStep__(0.0, 1.0)
+        Assertions.assertEquals(10.0, target.u1)
+
+        // the handle is unknown once released, and inputs still connected fail instead of reading a reused instance
+        source.__releaseRealSources__()
+        Assertions.assertThrows(IllegalArgumentException::class.java) {
+            target.__connectRealHandle__(target.getValueRef("u2"), handle)
+        }
+        Assertions.assertThrows(IllegalStateException::class.java) {
+            target.__doStep__(1.0, 1.0)
+        }
+        target.__connectRealHandle__(u1, 0L)
+        target.__doStep__(1.0, 1.0)
+
+    }
+
+}
@@ -0,0 +1,58 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.slaves.AnalyticGainSlave
+import no.ntnu.ais.fmu4j.slaves.GainSlave
+import no.ntnu.ais.fmu4j.slaves.SimpleSlave
+import no.ntnu.ais.fmu4j.slaves.TruncatedGainSlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+
+class TestDirectionalDerivative {
+
+    @Test
+    fun testJacobian() {
+
+        for (slave in listOf(
+            GainSlave(mapOf("instanceName" to "instance")),
+            AnalyticGainSlave(mapOf("instanceName" to "instance"))
+        )) {
+            slave.__define__()
+            Assertions.assertTrue(slave.modelDescription.coSimulation.isProvidesDirectionalDerivative)
+
+            val unknowns = longArrayOf(slave.getValueRef("y1"), slave.getValueRef("y2"))
+            val knowns = longArrayOf(slave.getValueRef("u1"), slave.getValueRef("u2"))
+
+            // both columns of the Jacobian at once
+            val jacobian = slave.__directionalDerivatives__(unknowns, knowns, doubleArrayOf(1.0, 0.0, 0.0, 1.0))
+            Assertions.assertArrayEquals(doubleArrayOf(2.0, 0.0, 4.0, 3.0), jacobian, 1e-6)
+
+            val derivative = slave.directionalDerivative(unknowns, knowns, doubleArrayOf(1.0, -1.0))
+            Assertions.assertArrayEquals(doubleArrayOf(-2.0, -3.0), derivative, 1e-6)
+
+            // the knowns are restored
+            Assertions.assertEquals(1.0, slave.u1)
+            Assertions.assertEquals(2.0, slave.u2)
+        }
+
+        val simple = SimpleSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+        Assertions.assertFalse(simple.modelDescription.coSimulation.isProvidesDirectionalDerivative)
+
+    }
+
+    @Test
+    fun testWrongNumberOfDerivatives() {
+
+        val slave = TruncatedGainSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+        val unknowns = longArrayOf(slave.getValueRef("y1"), slave.getValueRef("y2"))
+        val knowns = longArrayOf(slave.getValueRef("u1"))
+        Assertions.assertThrows(IllegalStateException::class.java) {
+            slave.__directionalDerivatives__(unknowns, knowns, doubleArrayOf(1.0))
+        }
+
+    }
+
+}
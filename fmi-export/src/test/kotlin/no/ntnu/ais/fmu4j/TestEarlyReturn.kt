@@ -0,0 +1,28 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.slaves.BouncingSlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+
+class TestEarlyReturn {
+
+    @Test
+    fun testEndStepAt() {
+
+        val slave = BouncingSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+
+        Assertions.assertEquals(0.5, slave.__doStep__(0.0, 0.5))
+        Assertions.assertEquals(0.5, slave.__preferredStepSize__(), 1e-12)
+
+        // the impact at t=1 ends the step early
+        Assertions.assertEquals(1.0, slave.__doStep__(0.5, 1.0), 1e-12)
+        Assertions.assertEquals(1.0, slave.velocity)
+        Assertions.assertTrue(slave.__preferredStepSize__().isNaN())
+
+        Assertions.assertEquals(1.5, slave.__doStep__(1.0, 0.5))
+
+    }
+
+}
@@ -0,0 +1,73 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.slaves.DependencySlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+
+class TestFmi3 {
+
+    @Test
+    fun testArrayVariables() {
+
+        val slave = DependencySlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+        val xml = slave.fmi3ModelDescriptionXml
+        val u1 = xml.valueReferenceOf("u1")
+        val u2 = xml.valueReferenceOf("u2")
+
+        Assertions.assertTrue(xml.contains("fmiVersion=\"3.0\""))
+        Assertions.assertFalse(xml.contains("name=\"u2[0]\""))
+        Assertions.assertTrue(xml.contains("start=\"2.0 3.0\""))
+        Assertions.assertTrue(xml.contains("<Dimension start=\"2\""))
+        Assertions.assertTrue(
+            xml.contains("<Output valueReference=\"${xml.valueReferenceOf("y2")}\" dependencies=\"$u2\" dependenciesKind=\"constant\"")
+        )
+
+        Assertions.assertArrayEquals(doubleArrayOf(2.0, 3.0, 1.0), slave.__getFloat64__(longArrayOf(u2, u1)))
+
+        val u2Values = slave.u2
+        slave.__setFloat64__(longArrayOf(u1, u2), doubleArrayOf(4.0, 5.0, 6.0))
+        Assertions.assertEquals(4.0, slave.u1)
+        Assertions.assertArrayEquals(doubleArrayOf(5.0, 6.0), slave.u2)
+        Assertions.assertSame(u2Values, slave.u2)
+
+        // one value per element, nothing is written otherwise
+        Assertions.assertThrows(IllegalArgumentException::class.java) {
+            slave.__setFloat64__(longArrayOf(u1, u2), doubleArrayOf(7.0, 8.0))
+        }
+        Assertions.assertThrows(IllegalArgumentException::class.java) {
+            slave.__setFloat64__(longArrayOf(u1), doubleArrayOf(7.0, 8.0))
+        }
+        Assertions.assertEquals(4.0, slave.u1)
+
+        Assertions.assertThrows(IllegalArgumentException::class.java) {
+            slave.__getInt32__(longArrayOf(u2))
+        }
+
+    }
+
+    @Test
+    fun testIndependentVariable() {
+
+        val slave = DependencySlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+        Assertions.assertEquals(0L, slave.fmi3ModelDescriptionXml.valueReferenceOf("time"))
+
+        slave.__setupExperiment__(1.0, 10.0, -1.0)
+        Assertions.assertArrayEquals(doubleArrayOf(1.0), slave.__getFloat64__(longArrayOf(0)))
+        slave.__doStep__(1.0, 0.5)
+        Assertions.assertArrayEquals(doubleArrayOf(1.5), slave.__getFloat64__(longArrayOf(0)))
+
+    }
+
+    private companion object {
+
+        fun String.valueReferenceOf(name: String): Long {
+            return Regex("name=\"${Regex.escape(name)}\" valueReference=\"(\\d+)\"").find(this)!!.groupValues[1].toLong()
+        }
+
+    }
+
+}
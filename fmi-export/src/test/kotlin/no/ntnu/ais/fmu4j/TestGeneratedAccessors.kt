@@ -0,0 +1,50 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.export.fmi2.GeneratedAccessors
+import no.ntnu.ais.fmu4j.slaves.AnalyticGainSlave
+import no.ntnu.ais.fmu4j.slaves.GainSlave
+import no.ntnu.ais.fmu4j.slaves.SimpleSlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+
+class TestGeneratedAccessors {
+
+    @Test
+    fun testGeneratedAccessors() {
+
+        val accessors = GeneratedAccessors.find(AnalyticGainSlave::class.java)
+        Assertions.assertNotNull(accessors)
+        Assertions.assertEquals("no.ntnu.ais.fmu4j.slaves.GainSlave_Accessors", accessors!!.javaClass.name)
+        Assertions.assertTrue("no.ntnu.ais.fmu4j.slaves.GainSlave#u1" in accessors.fields)
+        // looked up once per class
+        Assertions.assertSame(accessors, GeneratedAccessors.find(AnalyticGainSlave::class.java))
+
+        val slave = AnalyticGainSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+        val u1 = slave.getValueRef("u1")
+        val u2 = slave.getValueRef("u2")
+        slave.setReal(longArrayOf(u1, u2), doubleArrayOf(3.0, 4.0))
+        Assertions.assertEquals(3.0, slave.u1)
+        Assertions.assertEquals(4.0, slave.u2)
+        Assertions.assertArrayEquals(doubleArrayOf(4.0, 3.0), slave.getReal(longArrayOf(u2, u1)))
+        // registered using a lambda
+        Assertions.assertEquals(22.0, slave.getReal(longArrayOf(slave.getValueRef("y1")))[0])
+
+    }
+
+    @Test
+    fun testReflectiveFallback() {
+
+        // private properties have no accessors that generated code may call
+        val accessors = GeneratedAccessors.find(SimpleSlave::class.java)
+        Assertions.assertTrue(accessors == null || accessors.fields.isEmpty())
+
+        val slave = SimpleSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+        Assertions.assertArrayEquals(intArrayOf(99), slave.getInteger(longArrayOf(slave.getValueRef("myVar"))))
+
+    }
+
+}
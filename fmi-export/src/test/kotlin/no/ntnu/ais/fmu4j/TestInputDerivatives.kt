@@ -0,0 +1,30 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.slaves.GainSlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+
+class TestInputDerivatives {
+
+    @Test
+    fun testInterpolateReal() {
+
+        val slave = GainSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+
+        val u1 = slave.getValueRef("u1")
+        Assertions.assertEquals(1.0, slave.interpolateReal(u1, 0.5))
+
+        // second order derivative set ahead of the first
+        slave.__setRealInputDerivatives__(longArrayOf(u1, u1), intArrayOf(2, 1), doubleArrayOf(6.0, 2.0))
+        Assertions.assertEquals(1.0, slave.interpolateReal(u1, 0.0))
+        Assertions.assertEquals(1.0 + 2.0 * 0.5 + 6.0 * 0.25 / 2, slave.interpolateReal("u1", 0.5), 1e-12)
+        Assertions.assertEquals(2.0, slave.interpolateReal("u2", 0.5))
+
+        slave.__setRealInputDerivatives__(longArrayOf(), intArrayOf(), doubleArrayOf())
+        Assertions.assertEquals(1.0, slave.interpolateReal(u1, 0.5))
+
+    }
+
+}
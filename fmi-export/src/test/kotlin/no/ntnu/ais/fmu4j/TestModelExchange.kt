@@ -0,0 +1,70 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.slaves.OscillatorSlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+
+class TestModelExchange {
+
+    @Test
+    fun testModelDescription() {
+
+        val slave = OscillatorSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+        val xml = slave.modelDescriptionXml
+
+        Assertions.assertTrue(xml.contains("<ModelExchange"))
+        Assertions.assertTrue(xml.contains("numberOfEventIndicators=\"1\""))
+        Assertions.assertTrue(xml.contains("<Derivatives>"))
+
+        val variables = slave.modelDescription.modelVariables.scalarVariable
+        val state = variables.indexOfFirst { it.name == "x[0]" } + 1L
+        Assertions.assertEquals(state, variables.first { it.name == "der(x[0])" }.real.derivative)
+
+    }
+
+    @Test
+    fun testDerivatives() {
+
+        val slave = OscillatorSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+        Assertions.assertEquals(2, slave.__numberOfContinuousStates__())
+        Assertions.assertEquals(1, slave.__numberOfEventIndicators__())
+
+        val x = DoubleArray(2)
+        slave.__getContinuousStates__(x)
+        Assertions.assertArrayEquals(doubleArrayOf(1.0, 0.0), x)
+
+        val dx = DoubleArray(2)
+        slave.__derivatives__(0.0, doubleArrayOf(0.5, 2.0), dx)
+        Assertions.assertArrayEquals(doubleArrayOf(2.0, -2.0), dx)
+        Assertions.assertEquals(0.5, slave.getReal(longArrayOf(slave.getValueRef("x[0]")))[0])
+
+        // unchanged states are not passed again
+        slave.stiffness = 2.0
+        slave.__derivatives__(0.1, null, dx)
+        Assertions.assertArrayEquals(doubleArrayOf(2.0, -1.0), dx)
+        Assertions.assertEquals(0.1, slave.simulationTime)
+
+    }
+
+    @Test
+    fun testEvents() {
+
+        val slave = OscillatorSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+        val indicators = DoubleArray(1)
+        slave.__eventIndicators__(0.0, doubleArrayOf(-0.1, -1.0), indicators)
+        Assertions.assertEquals(-0.1, indicators[0])
+
+        Assertions.assertTrue(slave.__handleEvent__(0.0, null))
+        val x = DoubleArray(2)
+        slave.__getContinuousStates__(x)
+        Assertions.assertArrayEquals(doubleArrayOf(-0.1, 1.0), x)
+
+    }
+
+}
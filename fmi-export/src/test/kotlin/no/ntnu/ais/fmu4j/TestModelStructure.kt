@@ -0,0 +1,76 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.slaves.DependencySlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+
+class TestModelStructure {
+
+    @Test
+    fun testDeclaredDependencies() {
+
+        val slave = DependencySlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+        val index = slave.indices()
+        val ms = slave.modelDescription.modelStructure
+        // before the getters below create empty lists
+        Assertions.assertTrue(slave.modelDescriptionXml.contains("dependencies=\"${index.getValue("u1")}\""))
+
+        val outputs = ms.outputs.unknown.associateBy { it.index }
+        Assertions.assertEquals(listOf("y1", "y5", "y2", "y3", "y4").map { index.getValue(it) }.sorted(), ms.outputs.unknown.map { it.index })
+        Assertions.assertEquals(listOf(index.getValue("u1")), outputs.getValue(index.getValue("y1")).dependencies)
+        Assertions.assertEquals(
+            listOf(index.getValue("u2[0]"), index.getValue("u2[1]")),
+            outputs.getValue(index.getValue("y2")).dependencies
+        )
+        Assertions.assertEquals(listOf("constant", "constant"), outputs.getValue(index.getValue("y2")).dependenciesKind)
+        Assertions.assertTrue(outputs.getValue(index.getValue("y4")).dependencies.isEmpty())
+
+        // the parameter is known during initialization
+        val initialUnknowns = ms.initialUnknowns.unknown.associateBy { it.index }
+        Assertions.assertEquals(5, initialUnknowns.size)
+        Assertions.assertEquals(
+            listOf(index.getValue("u1"), index.getValue("k")),
+            initialUnknowns.getValue(index.getValue("y1")).dependencies
+        )
+
+    }
+
+    @Test
+    fun testProbeDependencies() {
+
+        val slave = DependencySlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+            __probeDependencies__()
+        }
+        val index = slave.indices()
+        val outputs = slave.modelDescription.modelStructure.outputs.unknown.associateBy { it.index }
+
+        Assertions.assertEquals(listOf(index.getValue("u1")), outputs.getValue(index.getValue("y3")).dependencies)
+        Assertions.assertTrue(outputs.getValue(index.getValue("y5")).dependencies.isEmpty())
+        // the parameter is perturbed as well, as it is known during initialization
+        val initialUnknowns = slave.modelDescription.modelStructure.initialUnknowns.unknown.associateBy { it.index }
+        Assertions.assertEquals(
+            listOf(index.getValue("u1"), index.getValue("k")),
+            initialUnknowns.getValue(index.getValue("y3")).dependencies
+        )
+        // declared dependencies are kept
+        Assertions.assertEquals(listOf(index.getValue("u1")), outputs.getValue(index.getValue("y1")).dependencies)
+
+        // the inputs are restored
+        Assertions.assertEquals(1.0, slave.u1)
+        Assertions.assertArrayEquals(doubleArrayOf(2.0, 3.0), slave.u2)
+        Assertions.assertEquals(2.0, slave.k)
+
+    }
+
+    private companion object {
+
+        fun DependencySlave.indices(): Map<String, Long> {
+            return modelDescription.modelVariables.scalarVariable.withIndex().associate { it.value.name to it.index + 1L }
+        }
+
+    }
+
+}
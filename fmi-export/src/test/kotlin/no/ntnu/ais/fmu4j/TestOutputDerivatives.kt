@@ -0,0 +1,28 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.slaves.SimpleSlave
+import no.ntnu.ais.fmu4j.slaves.SnapshotSlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+
+class TestOutputDerivatives {
+
+    @Test
+    fun testMaxOutputDerivativeOrder() {
+
+        val slave = SnapshotSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+        // served by the native backward differences
+        Assertions.assertEquals(1L, slave.modelDescription.coSimulation.maxOutputDerivativeOrder)
+        Assertions.assertNull(slave.getRealOutputDerivatives(longArrayOf(0), intArrayOf(1)))
+
+        // no real outputs
+        val simple = SimpleSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+        Assertions.assertEquals(0L, simple.modelDescription.coSimulation.maxOutputDerivativeOrder)
+
+    }
+
+}
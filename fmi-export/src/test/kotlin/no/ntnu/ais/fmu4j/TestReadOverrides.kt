@@ -0,0 +1,52 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.export.BulkRead
+import no.ntnu.ais.fmu4j.slaves.GainSlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+
+class TestReadOverrides {
+
+    // written against the allocating variants, which the native layer no longer calls directly
+    private class LegacySlave(args: Map<String, Any>) : GainSlave(args) {
+
+        var realCalls = 0
+        var allCalls = 0
+
+        override fun getReal(vr: LongArray): DoubleArray {
+            realCalls++
+            return super.getReal(vr).also { it[0] += 100.0 }
+        }
+
+        override fun getAll(intVr: LongArray, realVr: LongArray, boolVr: LongArray, strVr: LongArray): BulkRead {
+            allCalls++
+            return super.getAll(intVr, realVr, boolVr, strVr)
+        }
+
+    }
+
+    @Test
+    fun testAllocatingOverridesAreCalled() {
+
+        val slave = LegacySlave(mapOf("instanceName" to "legacy")).apply {
+            __define__()
+        }
+        val vr = longArrayOf(slave.getValueRef("u1"))
+
+        val values = DoubleArray(1)
+        slave.getReal(vr, values)
+        Assertions.assertEquals(101.0, values[0])
+        Assertions.assertEquals(1, slave.realCalls)
+
+        Assertions.assertEquals(101.0, slave.getReal(vr)[0])
+        Assertions.assertEquals(2, slave.realCalls)
+
+        val none = LongArray(0)
+        slave.getAll(none, IntArray(0), vr, values, none, BooleanArray(0), none, arrayOfNulls(0))
+        Assertions.assertEquals(101.0, values[0])
+        Assertions.assertEquals(1, slave.allCalls)
+        Assertions.assertEquals(3, slave.realCalls)
+
+    }
+
+}
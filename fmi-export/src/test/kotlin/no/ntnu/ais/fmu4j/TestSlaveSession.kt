@@ -0,0 +1,86 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.export.remote.MessageBuffer
+import no.ntnu.ais.fmu4j.export.remote.SlaveSession
+import no.ntnu.ais.fmu4j.export.remote.SocketMessageChannel
+import no.ntnu.ais.fmu4j.slaves.SnapshotSlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+import java.net.InetAddress
+import java.net.InetSocketAddress
+import java.nio.ByteBuffer
+import java.nio.channels.ServerSocketChannel
+import java.nio.channels.SocketChannel
+import java.nio.file.Files
+
+class TestSlaveSession {
+
+    @Test
+    fun testSession() {
+
+        val resources = Files.createTempDirectory("fmu4j").toFile().apply {
+            deleteOnExit()
+            resolve("mainclass.txt").apply {
+                writeText(SnapshotSlave::class.java.name)
+                deleteOnExit()
+            }
+        }
+
+        val server = ServerSocketChannel.open().bind(InetSocketAddress(InetAddress.getLoopbackAddress(), 0))
+        val client = SocketMessageChannel(SocketChannel.open(server.localAddress))
+        val session = Thread(SlaveSession(SocketMessageChannel(server.accept()), resources.absolutePath)).apply { start() }
+
+        val request = MessageBuffer()
+
+        fun call(op: Int, body: MessageBuffer.() -> Unit = {}): ByteBuffer {
+            request.reset()
+            request.putInt(op)
+            request.body()
+            client.send(request.flip())
+            return client.receive().also { reply ->
+                Assertions.assertEquals(0, reply.int)
+            }
+        }
+
+        call(1) { putString("instance") }
+        call(2) { putDouble(0.0); putDouble(-1.0); putDouble(-1.0) }
+        call(3)
+        call(4)
+
+        // SnapshotSlave registers 'real' first
+        call(5) { putDouble(0.0); putDouble(0.5) }
+        Assertions.assertEquals(1.5, call(11) { putInt(1); putInt(0) }.double)
+
+        call(21) { putInt(1); putInt(0); putDouble(10.0) }
+        Assertions.assertEquals(10.0, call(11) { putInt(1); putInt(0) }.double)
+
+        call(6)
+        Assertions.assertEquals(1.0, call(11) { putInt(1); putInt(0) }.double)
+
+        val state = call(40) { putInt(-1) }.int
+        call(5) { putDouble(0.0); putDouble(0.5) }
+        Assertions.assertEquals(state, call(40) { putInt(state) }.int)
+        call(5) { putDouble(0.5); putDouble(0.5) }
+        call(41) { putInt(state) }
+        Assertions.assertEquals(1.5, call(11) { putInt(1); putInt(0) }.double)
+        call(42) { putInt(state) }
+
+        val strings = call(13) { putInt(1); putInt(0) }
+        val bytes = ByteArray(strings.int).also { strings.get(it) }
+        Assertions.assertEquals("start", String(bytes))
+
+        request.reset()
+        request.putInt(99)
+        client.send(request.flip())
+        Assertions.assertEquals(1, client.receive().int)
+
+        call(8)
+        session.join(1000)
+        Assertions.assertFalse(session.isAlive)
+
+        client.close()
+        server.close()
+
+    }
+
+}
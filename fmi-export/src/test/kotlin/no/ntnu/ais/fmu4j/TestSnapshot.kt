@@ -0,0 +1,100 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.slaves.SimpleSlave
+import no.ntnu.ais.fmu4j.slaves.SnapshotSlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+
+class TestSnapshot {
+
+    @Test
+    fun testSaveAndRestore() {
+
+        val slave = SnapshotSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+
+        val state = slave.saveState()
+        slave.doStep(0.0, 0.1)
+        Assertions.assertEquals(1.1, slave.real)
+        Assertions.assertEquals(5.1, slave.vector[1], 1e-12)
+
+        slave.restoreState(state)
+        Assertions.assertEquals(1.0, slave.real)
+        Assertions.assertEquals(2, slave.integer)
+        Assertions.assertEquals(false, slave.boolean)
+        Assertions.assertEquals("start", slave.string)
+        Assertions.assertArrayEquals(doubleArrayOf(1.0, 2.0, 3.0), slave.reals)
+        Assertions.assertEquals(5.0, slave.vector[1])
+
+    }
+
+    @Test
+    fun testSaveStateInto() {
+
+        val slave = SnapshotSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+
+        val state = slave.saveState()
+        slave.doStep(0.0, 0.1)
+        Assertions.assertSame(state, slave.saveStateInto(state))
+
+        slave.doStep(0.1, 0.1)
+        slave.restoreState(state)
+        Assertions.assertEquals(1.1, slave.real, 1e-12)
+        Assertions.assertEquals(3, slave.integer)
+        Assertions.assertEquals(5.1, slave.vector[1], 1e-12)
+
+        Assertions.assertTrue(slave.modelDescription.coSimulation.isCanGetAndSetFMUstate)
+
+    }
+
+    @Test
+    fun testReset() {
+
+        val slave = SnapshotSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+
+        val vr = longArrayOf(slave.getValueRef("reals[0]"))
+        slave.setReal(vr, doubleArrayOf(99.0))
+        slave.doStep(0.0, 0.1)
+
+        Assertions.assertTrue(slave.__reset__())
+        Assertions.assertEquals(1.0, slave.getReal(vr).first())
+        Assertions.assertEquals(1.0, slave.real)
+
+        val simple = SimpleSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+        Assertions.assertFalse(simple.__reset__())
+
+    }
+
+    @Test
+    fun testWarmup() {
+
+        val slave = SnapshotSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+
+        Assertions.assertTrue(slave.warmup(0.0))
+        Assertions.assertEquals(1.0, slave.real)
+        Assertions.assertEquals(2, slave.integer)
+        Assertions.assertEquals(5.0, slave.vector[1])
+
+        val refs = slave.__warmupValueReferences__()
+        Assertions.assertEquals(1, refs[0].size)
+        Assertions.assertEquals(6, refs[1].size)
+        Assertions.assertEquals(1, refs[2].size)
+        Assertions.assertEquals(1, refs[3].size)
+
+        val simple = SimpleSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+        Assertions.assertFalse(simple.warmup(0.0))
+
+    }
+
+}
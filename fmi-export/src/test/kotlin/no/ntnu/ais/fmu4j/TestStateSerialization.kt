@@ -0,0 +1,144 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.export.fmi2.FieldSnapshot
+import no.ntnu.ais.fmu4j.export.fmi2.StateSerializer
+import no.ntnu.ais.fmu4j.slaves.SnapshotSlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+class TestStateSerialization {
+
+    @Test
+    fun testSerializeAndDeserialize() {
+
+        val slave = SnapshotSlave(mapOf("instanceName" to "instance")).apply {
+            __define__()
+        }
+
+        val state = slave.saveState()
+        val buffer = ByteBuffer.allocateDirect(slave.serializedStateSize(state))
+        slave.serializeState(state, buffer)
+        Assertions.assertFalse(buffer.hasRemaining())
+
+        slave.doStep(0.0, 0.1)
+        buffer.flip()
+        slave.restoreState(slave.deserializeState(buffer))
+
+        Assertions.assertEquals(1.0, slave.real)
+        Assertions.assertEquals(2, slave.integer)
+        Assertions.assertEquals(false, slave.boolean)
+        Assertions.assertEquals("start", slave.string)
+        Assertions.assertArrayEquals(doubleArrayOf(1.0, 2.0, 3.0), slave.reals)
+        Assertions.assertEquals(5.0, slave.vector[1])
+
+        Assertions.assertTrue(slave.modelDescription.coSimulation.isCanSerializeFMUstate)
+
+    }
+
+    @Test
+    fun testDeltas() {
+
+        val writer = StateSerializer(4)
+        val reader = StateSerializer(4)
+
+        val state = snapshot(100_000)
+        val fullSize = writer.size(state)
+        val restored = reader.read(write(writer, state))
+        Assertions.assertArrayEquals(state.reals, restored.reals)
+        Assertions.assertArrayEquals(state.strings, restored.strings)
+
+        // only the touched blocks are written
+        state.reals[12345] = -1.0
+        state.strings[1] = null
+        val delta = write(writer, state)
+        Assertions.assertTrue(delta.remaining() < fullSize / 100)
+
+        val patched = reader.read(delta)
+        Assertions.assertArrayEquals(state.reals, patched.reals)
+        Assertions.assertArrayEquals(state.ints, patched.ints)
+        Assertions.assertArrayEquals(state.bools, patched.bools)
+        Assertions.assertArrayEquals(state.strings, patched.strings)
+
+        // deltas only apply to the state they are based on
+        val other = StateSerializer(4)
+        Assertions.assertThrows(IllegalStateException::class.java) {
+            other.read(write(writer, state))
+        }
+
+        // every 4th state is written in full
+        Assertions.assertTrue(writer.size(state) < fullSize)
+        write(writer, state)
+        Assertions.assertEquals(fullSize, writer.size(state))
+
+    }
+
+    @Test
+    fun testDeltaIds() {
+
+        val writer = StateSerializer(Int.MAX_VALUE)
+        val reader = StateSerializer(Int.MAX_VALUE)
+
+        val state = snapshot(1000)
+        val full = write(writer, state)
+        reader.read(full)
+        state.reals[1] = -1.0
+        val first = write(writer, state)
+        state.reals[2] = -1.0
+        val second = write(writer, state)
+
+        // id and base id follow the magic, version and kind
+        val ids = listOf(full, first, second).map { it.duplicate().order(ByteOrder.LITTLE_ENDIAN).getLong(6) }
+        Assertions.assertEquals(3, ids.toSet().size)
+        Assertions.assertEquals(ids[1], second.duplicate().order(ByteOrder.LITTLE_ENDIAN).getLong(14))
+
+        // the second delta does not apply on the full state, even though it was written by the same instance
+        Assertions.assertThrows(IllegalStateException::class.java) {
+            reader.read(second)
+        }
+        reader.read(first)
+        Assertions.assertEquals(-1.0, reader.read(second).reals[2])
+
+    }
+
+    @Test
+    fun testPlanInvalidatedOnCapture() {
+
+        val writer = StateSerializer(Int.MAX_VALUE)
+        val reader = StateSerializer(Int.MAX_VALUE)
+
+        val state = snapshot(1000)
+        val fullSize = writer.size(state)
+        reader.read(write(writer, state))
+
+        // planned without changes, then updated in place as by saveStateInto
+        writer.size(state)
+        writer.invalidate(state)
+        state.reals[500] = -1.0
+
+        val buffer = ByteBuffer.allocate(fullSize)
+        writer.write(state, buffer)
+        Assertions.assertEquals(-1.0, reader.read(buffer.flip() as ByteBuffer).reals[500])
+
+    }
+
+    private companion object {
+
+        fun snapshot(n: Int) = FieldSnapshot(
+            DoubleArray(n) { it * 0.5 },
+            IntArray(n / 8) { it },
+            BooleanArray(n / 8) { it % 3 == 0 },
+            arrayOf("a", "b", null, "ø")
+        )
+
+        fun write(serializer: StateSerializer, state: FieldSnapshot): ByteBuffer {
+            val buffer = ByteBuffer.allocate(serializer.size(state))
+            serializer.write(state, buffer)
+            Assertions.assertFalse(buffer.hasRemaining())
+            return buffer.flip() as ByteBuffer
+        }
+
+    }
+
+}
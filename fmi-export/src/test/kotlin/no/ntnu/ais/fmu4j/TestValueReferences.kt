@@ -0,0 +1,72 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2VariableType
+import no.ntnu.ais.fmu4j.export.fmi2.ValueReferenceTable
+import no.ntnu.ais.fmu4j.slaves.SparseSlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+
+class TestValueReferences {
+
+    @Test
+    fun testSparseValueReferences() {
+
+        val slave = SparseSlave(mapOf("instanceName" to "sparse")).apply {
+            __define__()
+        }
+
+        Assertions.assertEquals(1000L, slave.getValueRef("u"))
+        Assertions.assertEquals(4_000_000_000L, slave.getValueRef("v"))
+        Assertions.assertEquals(7L, slave.getValueRef("y"))
+        // without an override, the value reference is the slot
+        Assertions.assertEquals(3L, slave.getValueRef("w"))
+        Assertions.assertEquals("v", slave.getVariableName(4_000_000_000L, Fmi2VariableType.REAL))
+
+        slave.setReal(longArrayOf(1000L, 4_000_000_000L), doubleArrayOf(3.0, 4.0))
+        Assertions.assertEquals(7.0, slave.getReal(longArrayOf(7L))[0])
+
+        Assertions.assertThrows(IllegalArgumentException::class.java) {
+            slave.getReal(longArrayOf(0L))
+        }
+        Assertions.assertThrows(IllegalArgumentException::class.java) {
+            slave.getVariableName(1000L, Fmi2VariableType.INTEGER)
+        }
+
+        Assertions.assertArrayEquals(
+            longArrayOf(1000L, 1L, 4_000_000_000L, 1L, 7L, 1L, 3L, 1L),
+            slave.__valueReferences__()[1]
+        )
+
+    }
+
+    @Test
+    fun testValueReferenceRanges() {
+
+        val table = ValueReferenceTable()
+        Assertions.assertEquals(0, table.add(5_000_000L, "alias"))
+        Assertions.assertEquals(1, table.addArray(4_000_000L, "xs", 2_000_000))
+        Assertions.assertEquals(2, table.add(4_500_000L, "inner"))
+        Assertions.assertEquals(3, table.addArray(10L, "ys", 5))
+        Assertions.assertEquals(4, table.add(12L, "y"))
+
+        // aliases resolve to the variable registered first
+        Assertions.assertEquals(0, table.slotOf(5_000_000L))
+        Assertions.assertEquals(1, table.slotOf(4_500_000L))
+        Assertions.assertEquals(3, table.slotOf(12L))
+
+        Assertions.assertEquals(1, table.slotOf(4_000_000L))
+        Assertions.assertEquals(1, table.slotOf(5_999_999L))
+        Assertions.assertEquals(-1, table.slotOf(6_000_000L))
+        Assertions.assertEquals(-1, table.slotOf(3_999_999L))
+        Assertions.assertEquals(-1, table.slotOf(15L))
+        Assertions.assertEquals(999_999, table.offsetOf(1, 4_999_999L))
+        Assertions.assertEquals("xs[999999]", table.nameOf(1, 4_999_999L))
+
+        Assertions.assertArrayEquals(
+            longArrayOf(5_000_000L, 1L, 4_000_000L, 2_000_000L, 4_500_000L, 1L, 10L, 5L, 12L, 1L),
+            table.valueReferences()
+        )
+
+    }
+
+}
@@ -0,0 +1,92 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2Slave
+import no.ntnu.ais.fmu4j.slaves.KotlinTestingFmi2Slave
+import no.ntnu.ais.fmu4j.slaves.OscillatorSlave
+import no.ntnu.ais.fmu4j.slaves.SnapshotSlave
+import org.junit.jupiter.api.Assertions
+import org.junit.jupiter.api.Test
+import java.io.File
+
+class TestVariableIndex {
+
+    private fun writeIndex(slave: Fmi2Slave): File {
+        return File.createTempFile("variables", ".bin").apply {
+            deleteOnExit()
+            outputStream().use { slave.writeVariableIndex(it) }
+        }
+    }
+
+    @Test
+    fun testDefineFromIndex() {
+
+        val reference = SnapshotSlave(mapOf("instanceName" to "reference")).apply {
+            __define__()
+        }
+        val index = writeIndex(reference)
+
+        val slave = SnapshotSlave(mapOf("instanceName" to "instance")).apply {
+            __defineFromIndex__(index.absolutePath)
+        }
+        // no model description is built
+        Assertions.assertThrows(IllegalStateException::class.java) { slave.modelDescription }
+        Assertions.assertThrows(IllegalStateException::class.java) { slave.modelDescriptionXml }
+        Assertions.assertThrows(IllegalStateException::class.java) {
+            slave.__getFloat64__(longArrayOf(1))
+        }
+
+        for (name in listOf("real", "reals[0]", "reals[2]", "vector[1]")) {
+            val vr = slave.getValueRef(name)
+            Assertions.assertEquals(reference.getValueRef(name), vr)
+            Assertions.assertEquals(reference.getReal(longArrayOf(vr)).first(), slave.getReal(longArrayOf(vr)).first())
+        }
+
+        val vr = longArrayOf(slave.getValueRef("vector[1]"))
+        slave.setReal(vr, doubleArrayOf(10.0))
+        Assertions.assertEquals(10.0, slave.vector[1])
+
+        Assertions.assertTrue(slave.__reset__())
+        Assertions.assertEquals(5.0, slave.vector[1])
+
+    }
+
+    @Test
+    fun testContinuousStates() {
+
+        val reference = OscillatorSlave(mapOf("instanceName" to "reference")).apply {
+            __define__()
+        }
+        val index = writeIndex(reference)
+
+        val slave = OscillatorSlave(mapOf("instanceName" to "instance")).apply {
+            __defineFromIndex__(index.absolutePath)
+        }
+        // defined from the index, rather than falling back to a full define
+        Assertions.assertThrows(IllegalStateException::class.java) { slave.modelDescription }
+
+        Assertions.assertEquals(2, slave.__numberOfContinuousStates__())
+        Assertions.assertEquals(reference.getValueRef("der(x[1])"), slave.getValueRef("der(x[1])"))
+        val dx = DoubleArray(2)
+        slave.__derivatives__(0.0, doubleArrayOf(0.5, 2.0), dx)
+        Assertions.assertArrayEquals(doubleArrayOf(2.0, -2.0), dx)
+
+    }
+
+    @Test
+    fun testFallbackOnMismatch() {
+
+        val other = KotlinTestingFmi2Slave(mapOf("instanceName" to "other")).apply {
+            __define__()
+        }
+        val index = writeIndex(other)
+
+        val slave = SnapshotSlave(mapOf("instanceName" to "instance")).apply {
+            __defineFromIndex__(index.absolutePath)
+        }
+        Assertions.assertNotNull(slave.modelDescription.modelVariables)
+        Assertions.assertEquals(9, slave.modelDescription.modelVariables.scalarVariable.size)
+        Assertions.assertEquals(1.0, slave.getReal(longArrayOf(slave.getValueRef("real"))).first())
+
+    }
+
+}
@@ -0,0 +1,36 @@
+package no.ntnu.ais.fmu4j.slaves
+
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2Slave
+import no.ntnu.ais.fmu4j.export.fmi2.ScalarVariable
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2Causality
+
+// an annotated array field and registered arrays, each taking a single slot
+class ArraySlave(
+    args: Map<String, Any>
+) : Fmi2Slave(args) {
+
+    @ScalarVariable(causality = Fmi2Causality.output)
+    val ys = DoubleArray(3) { it + 1.0 }
+
+    val xs = DoubleArray(1000) { it * 0.5 }
+    val flags = BooleanArray(2)
+
+    var gain = 2.0
+
+    override fun registerVariables() {
+        register(reals("xs", xs)
+            .causality(Fmi2Causality.input))
+        register(real("gain") { gain }
+            .setter { gain = it }
+            .causality(Fmi2Causality.input))
+        register(booleans("flags", flags)
+            .causality(Fmi2Causality.input))
+    }
+
+    override fun doStep(currentTime: Double, dt: Double) {
+        for (i in ys.indices) {
+            ys[i] = gain * xs[i]
+        }
+    }
+
+}
@@ -0,0 +1,34 @@
+package no.ntnu.ais.fmu4j.slaves
+
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2Slave
+import no.ntnu.ais.fmu4j.export.fmi2.ScalarVariable
+import no.ntnu.ais.fmu4j.export.fmi2.SlaveInfo
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2Causality
+
+@SlaveInfo(modelName = "BouncingSlave")
+class BouncingSlave(
+    args: Map<String, Any>
+) : Fmi2Slave(args) {
+
+    @ScalarVariable(causality = Fmi2Causality.output)
+    var height = 1.0
+
+    @ScalarVariable(causality = Fmi2Causality.output)
+    var velocity = -1.0
+
+    override fun doStep(currentTime: Double, dt: Double) {
+        // the ground is hit after height / -velocity seconds of constant speed
+        val impact = height / -velocity
+        if (velocity < 0 && impact < dt) {
+            height = 0.0
+            velocity = -velocity
+            endStepAt(currentTime + impact)
+        } else {
+            height += velocity * dt
+            if (velocity < 0) {
+                preferStepSize(height / -velocity)
+            }
+        }
+    }
+
+}
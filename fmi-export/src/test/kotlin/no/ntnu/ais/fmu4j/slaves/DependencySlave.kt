@@ -0,0 +1,48 @@
+package no.ntnu.ais.fmu4j.slaves
+
+import no.ntnu.ais.fmu4j.export.fmi2.DependsOn
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2DependencyKind
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2Slave
+import no.ntnu.ais.fmu4j.export.fmi2.ScalarVariable
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2Causality
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2Variability
+
+class DependencySlave(
+    args: Map<String, Any>
+) : Fmi2Slave(args) {
+
+    @ScalarVariable(causality = Fmi2Causality.input)
+    var u1 = 1.0
+
+    @ScalarVariable(causality = Fmi2Causality.input)
+    val u2 = doubleArrayOf(2.0, 3.0)
+
+    @ScalarVariable(causality = Fmi2Causality.parameter, variability = Fmi2Variability.fixed)
+    var k = 2.0
+
+    // computed when stepping, so only depends on the gain during initialization
+    @DependsOn("u1", "k")
+    @ScalarVariable(causality = Fmi2Causality.output)
+    var y1 = 2.0
+
+    @ScalarVariable(causality = Fmi2Causality.output)
+    var y5 = 0.0
+
+    override fun registerVariables() {
+        register(real("y2") { 3 * u2[0] + u2[1] }
+            .causality(Fmi2Causality.output)
+            .dependencies("u2")
+            .dependenciesKind(Fmi2DependencyKind.constant))
+        register(real("y3") { k * u1 }
+            .causality(Fmi2Causality.output))
+        register(integer("y4") { 4 }
+            .causality(Fmi2Causality.output)
+            .dependencies())
+    }
+
+    override fun doStep(currentTime: Double, dt: Double) {
+        y1 = k * u1
+        y5 += dt
+    }
+
+}
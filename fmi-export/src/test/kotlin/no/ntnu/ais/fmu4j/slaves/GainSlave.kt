@@ -0,0 +1,77 @@
+package no.ntnu.ais.fmu4j.slaves
+
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2Slave
+import no.ntnu.ais.fmu4j.export.fmi2.ScalarVariable
+import no.ntnu.ais.fmu4j.export.fmi2.SlaveInfo
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2Causality
+
+@SlaveInfo(modelName = "GainSlave", providesDirectionalDerivative = true)
+open class GainSlave(
+    args: Map<String, Any>
+) : Fmi2Slave(args) {
+
+    @ScalarVariable(causality = Fmi2Causality.input)
+    var u1 = 1.0
+
+    @ScalarVariable(causality = Fmi2Causality.input)
+    var u2 = 2.0
+
+    override fun registerVariables() {
+        register(real("y1") { 2 * u1 + u2 * u2 })
+        register(real("y2") { 3 * u2 })
+    }
+
+    override fun doStep(currentTime: Double, dt: Double) {}
+
+}
+
+class AnalyticGainSlave(
+    args: Map<String, Any>
+) : GainSlave(args) {
+
+    override fun directionalDerivative(unknowns: LongArray, knowns: LongArray, seed: DoubleArray): DoubleArray {
+        val du1 = knowns.indexOf(getValueRef("u1")).let { if (it < 0) 0.0 else seed[it] }
+        val du2 = knowns.indexOf(getValueRef("u2")).let { if (it < 0) 0.0 else seed[it] }
+        return DoubleArray(unknowns.size) { i ->
+            when (unknowns[i]) {
+                getValueRef("y1") -> 2 * du1 + 2 * u2 * du2
+                else -> 3 * du2
+            }
+        }
+    }
+
+}
+
+// returns a single derivative, whatever the number of unknowns
+class TruncatedGainSlave(
+    args: Map<String, Any>
+) : GainSlave(args) {
+
+    override fun directionalDerivative(unknowns: LongArray, knowns: LongArray, seed: DoubleArray): DoubleArray {
+        return DoubleArray(1)
+    }
+
+}
+
+/**
+ * Like [GainSlave], but with private inputs, which generated accessors cannot reach.
+ */
+@SlaveInfo(modelName = "PrivateGainSlave")
+class PrivateGainSlave(
+    args: Map<String, Any>
+) : Fmi2Slave(args) {
+
+    @ScalarVariable(causality = Fmi2Causality.input)
+    private var u1 = 1.0
+
+    @ScalarVariable(causality = Fmi2Causality.input)
+    private var u2 = 2.0
+
+    override fun registerVariables() {
+        register(real("y1") { 2 * u1 + u2 * u2 })
+        register(real("y2") { 3 * u2 })
+    }
+
+    override fun doStep(currentTime: Double, dt: Double) {}
+
+}
@@ -0,0 +1,43 @@
+package no.ntnu.ais.fmu4j.slaves
+
+import no.ntnu.ais.fmu4j.export.RealVectorArray
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2Slave
+import no.ntnu.ais.fmu4j.export.fmi2.ScalarVariable
+import no.ntnu.ais.fmu4j.export.fmi2.SlaveInfo
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2Causality
+
+@SlaveInfo(modelName = "SnapshotSlave", canGetAndSetFMUstate = true, canSerializeFMUstate = true)
+class SnapshotSlave(
+    args: Map<String, Any>
+) : Fmi2Slave(args) {
+
+    override val resetFromSnapshot = true
+
+    @ScalarVariable(causality = Fmi2Causality.output)
+    var real = 1.0
+
+    @ScalarVariable(causality = Fmi2Causality.output)
+    var integer = 2
+
+    @ScalarVariable(causality = Fmi2Causality.output)
+    var boolean = false
+
+    @ScalarVariable(causality = Fmi2Causality.output)
+    var string = "start"
+
+    @ScalarVariable(causality = Fmi2Causality.output)
+    val reals = doubleArrayOf(1.0, 2.0, 3.0)
+
+    @ScalarVariable(causality = Fmi2Causality.output)
+    val vector = RealVectorArray(doubleArrayOf(4.0, 5.0))
+
+    override fun doStep(currentTime: Double, dt: Double) {
+        real += dt
+        integer++
+        boolean = !boolean
+        string = "t=$currentTime"
+        reals[0] += dt
+        vector[1] += dt
+    }
+
+}
@@ -0,0 +1,32 @@
+package no.ntnu.ais.fmu4j.slaves
+
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2Slave
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2Causality
+
+// real variables with overridden, sparse value references
+class SparseSlave(
+    args: Map<String, Any>
+) : Fmi2Slave(args) {
+
+    var u = 1.0
+    var v = 2.0
+
+    override fun registerVariables() {
+        register(real("u") { u }
+            .setter { u = it }
+            .causality(Fmi2Causality.input)
+            .apply { __overrideValueReference = 1000L })
+        register(real("v") { v }
+            .setter { v = it }
+            .causality(Fmi2Causality.input)
+            .apply { __overrideValueReference = 4_000_000_000L })
+        register(real("y") { u + v }
+            .causality(Fmi2Causality.output)
+            .apply { __overrideValueReference = 7L })
+        register(real("w") { 0.0 }
+            .causality(Fmi2Causality.output))
+    }
+
+    override fun doStep(currentTime: Double, dt: Double) {}
+
+}
@@ -0,0 +1,214 @@
+#include <fmu4j/Daemon.hpp>
+
+#include <fmu4j/process.hpp>
+#include <cppfmu/cppfmu_cs.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#    include <winsock2.h>
+#    include <ws2tcpip.h>
+#else
+#    include <arpa/inet.h>
+#    include <netinet/in.h>
+#    include <netinet/tcp.h>
+#    include <sys/socket.h>
+#    include <unistd.h>
+#endif
+
+namespace fmu4j
+{
+
+namespace
+{
+
+const char* DAEMON_CLASS = "no.ntnu.ais.fmu4j.export.remote.SlaveDaemon";
+
+#ifdef _WIN32
+using socket_t = SOCKET;
+const socket_t INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+const int SEND_FLAGS = 0;
+
+void close_socket(socket_t s)
+{
+    closesocket(s);
+}
+#else
+using socket_t = int;
+const socket_t INVALID_SOCKET_HANDLE = -1;
+const int SEND_FLAGS = MSG_NOSIGNAL;
+
+void close_socket(socket_t s)
+{
+    close(s);
+}
+#endif
+
+long env_long(const char* name, long defaultValue)
+{
+    const char* value = std::getenv(name);
+    return value != nullptr ? std::strtol(value, nullptr, 10) : defaultValue;
+}
+
+// Length prefixed messages over a loopback TCP connection, see SocketMessageChannel.kt.
+class SocketChannel : public Channel
+{
+public:
+    explicit SocketChannel(socket_t socket)
+        : socket_(socket)
+    { }
+
+    void send(const std::vector<uint8_t>& message) override
+    {
+        auto size = static_cast<int32_t>(message.size());
+        write(&size, sizeof(size));
+        write(message.data(), message.size());
+    }
+
+    void receive(std::vector<uint8_t>& message) override
+    {
+        int32_t size;
+        read(&size, sizeof(size));
+        message.resize(size);
+        read(message.data(), message.size());
+    }
+
+    ~SocketChannel() override
+    {
+        close_socket(socket_);
+    }
+
+private:
+    socket_t socket_;
+
+    void write(const void* data, std::size_t size)
+    {
+        auto ptr = static_cast<const char*>(data);
+        while (size > 0) {
+            auto n = ::send(socket_, ptr, static_cast<int>(size), SEND_FLAGS);
+            if (n <= 0) {
+                throw cppfmu::FatalError("[FMU4j native] Lost connection to the fmu4j daemon!");
+            }
+            ptr += n;
+            size -= n;
+        }
+    }
+
+    void read(void* data, std::size_t size)
+    {
+        auto ptr = static_cast<char*>(data);
+        while (size > 0) {
+            auto n = ::recv(socket_, ptr, static_cast<int>(size), 0);
+            if (n <= 0) {
+                throw cppfmu::FatalError("[FMU4j native] Lost connection to the fmu4j daemon!");
+            }
+            ptr += n;
+            size -= n;
+        }
+    }
+};
+
+void init_sockets()
+{
+#ifdef _WIN32
+    static std::once_flag once;
+    std::call_once(once, [] {
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+    });
+#endif
+}
+
+std::string daemon_port_file()
+{
+    return user_directory() + "/daemon.port";
+}
+
+// Connects to the daemon published in 'portFile', or returns nullptr if it is not reachable.
+// Port files that other users could have written are ignored.
+std::unique_ptr<Channel> try_connect(const std::string& portFile, const std::string& resources)
+{
+    if (!is_private_file(portFile)) {
+        return nullptr;
+    }
+    std::ifstream infile(portFile);
+    int port = 0;
+    std::string token;
+    if (!(infile >> port >> token)) {
+        return nullptr;
+    }
+
+    socket_t s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == INVALID_SOCKET_HANDLE) {
+        return nullptr;
+    }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close_socket(s);
+        return nullptr;
+    }
+    int noDelay = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+    std::unique_ptr<Channel> channel(new SocketChannel(s));
+    MessageWriter hello;
+    hello.begin(op::HELLO).put(token).put(resources);
+    std::vector<uint8_t> reply;
+    try {
+        channel->send(hello.data);
+        channel->receive(reply);
+    } catch (const cppfmu::FatalError&) {
+        // a stale port file, the daemon went away
+        return nullptr;
+    }
+    MessageReader reader(reply);
+    if (reader.get<int32_t>() != STATUS_OK) {
+        std::string msg = "[FMU4j native] The fmu4j daemon refused the connection: " + reader.getString();
+        throw cppfmu::FatalError(msg.c_str());
+    }
+    return channel;
+}
+
+void spawn_daemon(const std::string& portFile, const std::string& resources)
+{
+    std::vector<std::string> args{java_executable()};
+    for (auto& option : split_options(std::getenv("FMU4J_DAEMON_OPTIONS"))) {
+        args.push_back(option);
+    }
+    // the daemon outlives the FMU it was spawned for, and with it the extracted resources
+    args.insert(args.end(), {"-cp", stable_classpath(resources), DAEMON_CLASS, portFile,
+                                std::to_string(env_long("FMU4J_DAEMON_IDLE_SECONDS", 300))});
+    spawn_process(args, true);
+}
+
+} // namespace
+
+std::unique_ptr<Channel> connect_daemon(const std::string& resources)
+{
+    init_sockets();
+
+    const std::string portFile = daemon_port_file();
+    if (auto channel = try_connect(portFile, resources)) {
+        return channel;
+    }
+
+    spawn_daemon(portFile, resources);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(env_long("FMU4J_DAEMON_TIMEOUT_SECONDS", 30));
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (auto channel = try_connect(portFile, resources)) {
+            return channel;
+        }
+    }
+    throw cppfmu::FatalError("[FMU4j native] Timed out waiting for the fmu4j daemon to start!");
+}
+
+} // namespace fmu4j
@@ -0,0 +1,46 @@
+#include <fmu4j/InputDerivatives.hpp>
+
+#include <stdexcept>
+#include <string>
+
+namespace fmu4j
+{
+
+void InputDerivatives::set(const cppfmu::FMIValueReference* vr, std::size_t nvr,
+    const cppfmu::FMIInteger* order, const cppfmu::FMIReal* value)
+{
+    for (std::size_t i = 0; i < nvr; i++) {
+        if (order[i] < 1) {
+            throw std::logic_error("[FMU4j native] Invalid input derivative order: " + std::to_string(order[i]));
+        }
+    }
+    for (std::size_t i = 0; i < nvr; i++) {
+        auto key = std::make_pair(vr[i], order[i]);
+        if (value[i] == 0.0) {
+            derivatives_.erase(key);
+        } else {
+            derivatives_[key] = value[i];
+        }
+    }
+    dirty_ = true;
+}
+
+void InputDerivatives::clear()
+{
+    if (!derivatives_.empty()) {
+        derivatives_.clear();
+        dirty_ = true;
+    }
+}
+
+const std::vector<InputDerivatives::Entry>& InputDerivatives::take()
+{
+    entries_.clear();
+    for (const auto& d : derivatives_) {
+        entries_.push_back(Entry{d.first.first, d.first.second, d.second});
+    }
+    dirty_ = false;
+    return entries_;
+}
+
+} // namespace fmu4j
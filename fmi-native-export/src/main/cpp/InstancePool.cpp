@@ -0,0 +1,109 @@
+#include <fmu4j/InstancePool.hpp>
+
+#include <fmu4j/jni_helper.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fmu4j
+{
+
+namespace
+{
+
+struct PooledInstance
+{
+    // Keeps the classloader alive while the instance is parked.
+    std::shared_ptr<const SlaveClass> slaveClass;
+    jobject instance;
+};
+
+std::mutex poolMutex;
+std::unordered_map<std::string, std::vector<PooledInstance>> pool;
+
+// Closes the instances parked when the FMU library is unloaded.
+// The JVM outlives the library, so parked instances would otherwise keep their classloaders until process exit.
+struct PoolDrain
+{
+    ~PoolDrain()
+    {
+        drain_instance_pool();
+    }
+};
+
+} // namespace
+
+std::size_t instance_pool_capacity()
+{
+    static const std::size_t capacity = [] {
+        const char* value = std::getenv("FMU4J_INSTANCE_POOL_SIZE");
+        if (value == nullptr) {
+            return std::size_t{0};
+        }
+        long size = std::strtol(value, nullptr, 10);
+        return size > 0 ? static_cast<std::size_t>(size) : std::size_t{0};
+    }();
+    return capacity;
+}
+
+bool park_instance(const std::shared_ptr<const SlaveClass>& slaveClass, jobject instance)
+{
+    // constructed on first use, after the pool and the SlaveClass cache, so that it is destroyed before them
+    static PoolDrain drain;
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    auto& parked = pool[slaveClass->resources];
+    if (parked.size() >= instance_pool_capacity()) {
+        return false;
+    }
+    parked.push_back(PooledInstance{slaveClass, instance});
+    return true;
+}
+
+jobject take_instance(const std::shared_ptr<const SlaveClass>& slaveClass)
+{
+    std::lock_guard<std::mutex> lock(poolMutex);
+    auto it = pool.find(slaveClass->resources);
+    if (it == pool.end()) {
+        return nullptr;
+    }
+    auto& parked = it->second;
+    if (parked.empty()) {
+        return nullptr;
+    }
+    // parked instances keep their SlaveClass alive, so it is always the one currently cached
+    jobject instance = parked.back().instance;
+    parked.pop_back();
+    return instance;
+}
+
+void drain_instance_pool()
+{
+    std::vector<PooledInstance> drained;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        for (auto& entry : pool) {
+            std::move(entry.second.begin(), entry.second.end(), std::back_inserter(drained));
+        }
+        pool.clear();
+    }
+    // close is not invoked on recycled instances, see Fmi2Slave.recycle
+    for (auto& parked : drained) {
+        jvm_invoke(parked.slaveClass->jvm, [&parked](JNIEnv* env) {
+            env->CallVoidMethod(parked.instance, parked.slaveClass->closeId);
+            if (env->ExceptionCheck()) {
+                env->ExceptionDescribe();
+                env->ExceptionClear();
+            }
+            env->DeleteGlobalRef(parked.instance);
+        });
+    }
+    // the SlaveClass handles and classloaders are released with the last parked instance holding them
+}
+
+} // namespace fmu4j
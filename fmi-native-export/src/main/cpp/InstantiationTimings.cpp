@@ -0,0 +1,78 @@
+#include <fmu4j/InstantiationTimings.hpp>
+
+#include <cstdio>
+
+namespace fmu4j
+{
+
+namespace
+{
+
+const char* PHASE_NAMES[] = {
+    "jvm",
+    "runtime classloader",
+    "classloader",
+    "find class",
+    "method lookup",
+    "constructor",
+    "define"};
+
+} // namespace
+
+void InstantiationTimings::add(Phase phase, std::chrono::steady_clock::duration duration)
+{
+    seconds[static_cast<std::size_t>(phase)] += std::chrono::duration<double>(duration).count();
+}
+
+double InstantiationTimings::total() const
+{
+    double sum = 0;
+    for (double s : seconds) {
+        sum += s;
+    }
+    return sum;
+}
+
+void InstantiationTimings::copy_to(cppfmu::FMIReal timings[], std::size_t n) const
+{
+    for (std::size_t i = 0; i < n; i++) {
+        timings[i] = i < seconds.size() ? seconds[i] : 0.0;
+    }
+}
+
+std::string InstantiationTimings::format() const
+{
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "[FMU4j native] Instantiated in %.3f ms (", total() * 1e3);
+    std::string result(buffer);
+    for (std::size_t i = 0; i < seconds.size(); i++) {
+        std::snprintf(buffer, sizeof(buffer), "%s%s %.3f ms", i == 0 ? "" : ", ", PHASE_NAMES[i], seconds[i] * 1e3);
+        result += buffer;
+    }
+    return result + ").";
+}
+
+PhaseTimer::PhaseTimer(InstantiationTimings* timings, Phase phase)
+    : timings_(timings)
+    , phase_(phase)
+    , start_(std::chrono::steady_clock::now())
+{ }
+
+void PhaseTimer::next(Phase phase)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (timings_ != nullptr) {
+        timings_->add(phase_, now - start_);
+    }
+    phase_ = phase;
+    start_ = now;
+}
+
+PhaseTimer::~PhaseTimer()
+{
+    if (timings_ != nullptr) {
+        timings_->add(phase_, std::chrono::steady_clock::now() - start_);
+    }
+}
+
+} // namespace fmu4j
@@ -0,0 +1,92 @@
+#include <fmu4j/OutputHistory.hpp>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace fmu4j
+{
+
+void OutputHistory::record(cppfmu::SlaveInstance& slave, cppfmu::FMIReal time)
+{
+    if (tracked_.empty()) {
+        return;
+    }
+    truncate(time);
+    if (!points_.empty() && points_.front().time >= time) {
+        points_.pop_front();
+    }
+    Point point;
+    if (points_.size() > static_cast<std::size_t>(MAX_ORDER)) {
+        // reuse the storage of the oldest point
+        point = std::move(points_.back());
+        points_.pop_back();
+    }
+    point.time = time;
+    point.values.resize(tracked_.size());
+    slave.GetReal(tracked_.data(), tracked_.size(), point.values.data());
+    points_.push_front(std::move(point));
+}
+
+void OutputHistory::derivatives(cppfmu::SlaveInstance& slave, cppfmu::FMIReal time,
+    const cppfmu::FMIValueReference* vr, std::size_t nvr,
+    const cppfmu::FMIInteger* order, cppfmu::FMIReal* value)
+{
+    bool added = false;
+    for (std::size_t i = 0; i < nvr; i++) {
+        if (order[i] < 1 || order[i] > MAX_ORDER) {
+            throw std::logic_error("[FMU4j native] Unsupported output derivative order: " + std::to_string(order[i]));
+        }
+        if (index_.emplace(vr[i], tracked_.size()).second) {
+            tracked_.push_back(vr[i]);
+            added = true;
+        }
+    }
+    if (added) {
+        // earlier points lack the new outputs, start over from the current one
+        points_.clear();
+        if (!std::isnan(time)) {
+            record(slave, time);
+        }
+    }
+
+    for (std::size_t i = 0; i < nvr; i++) {
+        value[i] = 0.0;
+        if (points_.size() <= static_cast<std::size_t>(order[i])) {
+            continue;
+        }
+        const auto k = index_[vr[i]];
+        const auto& p0 = points_[0];
+        const auto& p1 = points_[1];
+        const double d01 = (p0.values[k] - p1.values[k]) / (p0.time - p1.time);
+        if (order[i] == 1) {
+            value[i] = d01;
+        } else {
+            const auto& p2 = points_[2];
+            const double d12 = (p1.values[k] - p2.values[k]) / (p1.time - p2.time);
+            value[i] = 2.0 * (d01 - d12) / (p0.time - p2.time);
+        }
+    }
+}
+
+void OutputHistory::truncate(cppfmu::FMIReal time)
+{
+    while (!points_.empty() && points_.front().time > time) {
+        points_.pop_front();
+    }
+}
+
+void OutputHistory::rewind(cppfmu::FMIReal time)
+{
+    truncate(time);
+    if (!points_.empty() && points_.front().time != time) {
+        points_.clear();
+    }
+}
+
+void OutputHistory::clear()
+{
+    points_.clear();
+}
+
+} // namespace fmu4j
@@ -0,0 +1,349 @@
+#include <fmu4j/RemoteSlaveInstance.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace fmu4j
+{
+
+RemoteSlaveInstance::RemoteSlaveInstance(std::unique_ptr<Channel> channel, const std::string& instanceName,
+    const cppfmu::Logger& logger, InstantiationTimings timings)
+    : channel_(std::move(channel))
+    , logger_(logger)
+    , timings_(timings)
+{
+    {
+        PhaseTimer timer(&timings_, Phase::constructor);
+        request_.begin(op::INSTANTIATE).put(instanceName);
+        canGetAndSetFMUstate_ = call().get<int32_t>() != 0;
+    }
+    logger_.DebugLog(fmi2OK, "", "%s", timings_.format().c_str());
+}
+
+MessageReader RemoteSlaveInstance::call() const
+{
+    channel_->send(request_.data);
+    channel_->receive(reply_);
+    MessageReader reader(reply_);
+    if (reader.get<int32_t>() != STATUS_OK) {
+        throw RemoteError("[FMU4j native] " + reader.getString());
+    }
+    return reader;
+}
+
+MessageWriter& RemoteSlaveInstance::begin(int32_t operation, const cppfmu::FMIValueReference* vr, std::size_t nvr) const
+{
+    request_.begin(operation).put(static_cast<int32_t>(nvr));
+    for (std::size_t i = 0; i < nvr; i++) {
+        request_.put(static_cast<uint32_t>(vr[i]));
+    }
+    return request_;
+}
+
+void RemoteSlaveInstance::SetupExperiment(cppfmu::FMIBoolean toleranceDefined, cppfmu::FMIReal tolerance,
+    cppfmu::FMIReal tStart, cppfmu::FMIBoolean stopTimeDefined,
+    cppfmu::FMIReal tStop)
+{
+    double stop = stopTimeDefined ? tStop : -1;
+    double tol = toleranceDefined ? tolerance : -1;
+    request_.begin(op::SETUP_EXPERIMENT).put(tStart).put(stop).put(tol);
+    call();
+}
+
+void RemoteSlaveInstance::EnterInitializationMode()
+{
+    request_.begin(op::ENTER_INITIALIZATION_MODE);
+    call();
+}
+
+void RemoteSlaveInstance::ExitInitializationMode()
+{
+    request_.begin(op::EXIT_INITIALIZATION_MODE);
+    call();
+}
+
+bool RemoteSlaveInstance::DoStep(cppfmu::FMIReal currentCommunicationPoint, cppfmu::FMIReal communicationStepSize,
+    cppfmu::FMIBoolean, cppfmu::FMIReal& endOfStep)
+{
+    if (inputDerivatives_.dirty()) {
+        const auto& entries = inputDerivatives_.take();
+        request_.begin(op::SET_REAL_INPUT_DERIVATIVES).put(static_cast<int32_t>(entries.size()));
+        for (const auto& entry : entries) {
+            request_.put(static_cast<uint32_t>(entry.vr)).put(static_cast<int32_t>(entry.order)).put(static_cast<double>(entry.value));
+        }
+        call();
+    }
+    request_.begin(op::DO_STEP).put(currentCommunicationPoint).put(communicationStepSize);
+    double reached;
+    try {
+        reached = call().get<double>();
+    } catch (const RemoteError& e) {
+        logger_.Log(fmi2Discard, "", "%s", e.what());
+        return false;
+    }
+    if (reached < currentCommunicationPoint + communicationStepSize) {
+        endOfStep = reached;
+        return false;
+    }
+    return true;
+}
+
+void RemoteSlaveInstance::Reset()
+{
+    inputDerivatives_.clear();
+    request_.begin(op::RESET);
+    call();
+}
+
+void RemoteSlaveInstance::Terminate()
+{
+    request_.begin(op::TERMINATE);
+    call();
+}
+
+void RemoteSlaveInstance::SetInteger(const cppfmu::FMIValueReference* vr, std::size_t nvr, const cppfmu::FMIInteger* value)
+{
+    auto& request = begin(op::SET_INTEGER, vr, nvr);
+    for (std::size_t i = 0; i < nvr; i++) {
+        request.put(static_cast<int32_t>(value[i]));
+    }
+    call();
+}
+
+void RemoteSlaveInstance::SetReal(const cppfmu::FMIValueReference* vr, std::size_t nvr, const cppfmu::FMIReal* value)
+{
+    auto& request = begin(op::SET_REAL, vr, nvr);
+    for (std::size_t i = 0; i < nvr; i++) {
+        request.put(static_cast<double>(value[i]));
+    }
+    call();
+}
+
+void RemoteSlaveInstance::SetBoolean(const cppfmu::FMIValueReference* vr, std::size_t nvr, const cppfmu::FMIBoolean* value)
+{
+    auto& request = begin(op::SET_BOOLEAN, vr, nvr);
+    for (std::size_t i = 0; i < nvr; i++) {
+        request.put(static_cast<int32_t>(value[i] != 0));
+    }
+    call();
+}
+
+void RemoteSlaveInstance::SetString(const cppfmu::FMIValueReference* vr, std::size_t nvr, cppfmu::FMIString const* value)
+{
+    auto& request = begin(op::SET_STRING, vr, nvr);
+    for (std::size_t i = 0; i < nvr; i++) {
+        request.put(std::string(value[i]));
+    }
+    call();
+}
+
+void RemoteSlaveInstance::SetAll(
+    const cppfmu::FMIValueReference* intVr, std::size_t nIntvr, const cppfmu::FMIInteger* intValue,
+    const cppfmu::FMIValueReference* realVr, std::size_t nRealvr, const cppfmu::FMIReal* realValue,
+    const cppfmu::FMIValueReference* boolVr, std::size_t nBoolvr, const cppfmu::FMIBoolean* boolValue,
+    const cppfmu::FMIValueReference* strVr, std::size_t nStrvr, const cppfmu::FMIString* strValue)
+{
+    if (nIntvr > 0) {
+        SetInteger(intVr, nIntvr, intValue);
+    }
+    if (nRealvr > 0) {
+        SetReal(realVr, nRealvr, realValue);
+    }
+    if (nBoolvr > 0) {
+        SetBoolean(boolVr, nBoolvr, boolValue);
+    }
+    if (nStrvr > 0) {
+        SetString(strVr, nStrvr, strValue);
+    }
+}
+
+void RemoteSlaveInstance::GetInteger(const cppfmu::FMIValueReference* vr, std::size_t nvr, cppfmu::FMIInteger* value) const
+{
+    begin(op::GET_INTEGER, vr, nvr);
+    auto reader = call();
+    for (std::size_t i = 0; i < nvr; i++) {
+        value[i] = reader.get<int32_t>();
+    }
+}
+
+void RemoteSlaveInstance::GetReal(const cppfmu::FMIValueReference* vr, std::size_t nvr, cppfmu::FMIReal* value) const
+{
+    begin(op::GET_REAL, vr, nvr);
+    auto reader = call();
+    for (std::size_t i = 0; i < nvr; i++) {
+        value[i] = reader.get<double>();
+    }
+}
+
+void RemoteSlaveInstance::GetBoolean(const cppfmu::FMIValueReference* vr, std::size_t nvr, cppfmu::FMIBoolean* value) const
+{
+    begin(op::GET_BOOLEAN, vr, nvr);
+    auto reader = call();
+    for (std::size_t i = 0; i < nvr; i++) {
+        value[i] = reader.get<int32_t>() != 0;
+    }
+}
+
+void RemoteSlaveInstance::GetString(const cppfmu::FMIValueReference* vr, std::size_t nvr, cppfmu::FMIString* value) const
+{
+    begin(op::GET_STRING, vr, nvr);
+    auto reader = call();
+    // returned pointers stay valid until the next call to GetString
+    strBuffer_.clear();
+    strBuffer_.reserve(nvr);
+    for (std::size_t i = 0; i < nvr; i++) {
+        strBuffer_.push_back(reader.getString());
+        value[i] = strBuffer_.back().c_str();
+    }
+}
+
+void RemoteSlaveInstance::GetAll(
+    const cppfmu::FMIValueReference* intVr, std::size_t nIntvr, cppfmu::FMIInteger* intValue,
+    const cppfmu::FMIValueReference* realVr, std::size_t nRealvr, cppfmu::FMIReal* realValue,
+    const cppfmu::FMIValueReference* boolVr, std::size_t nBoolvr, cppfmu::FMIBoolean* boolValue,
+    const cppfmu::FMIValueReference* strVr, std::size_t nStrvr, cppfmu::FMIString* strValue) const
+{
+    if (nIntvr > 0) {
+        GetInteger(intVr, nIntvr, intValue);
+    }
+    if (nRealvr > 0) {
+        GetReal(realVr, nRealvr, realValue);
+    }
+    if (nBoolvr > 0) {
+        GetBoolean(boolVr, nBoolvr, boolValue);
+    }
+    if (nStrvr > 0) {
+        GetString(strVr, nStrvr, strValue);
+    }
+}
+
+namespace
+{
+
+int32_t state_id(cppfmu::FMIFMUstate state)
+{
+    return static_cast<int32_t>(reinterpret_cast<std::uintptr_t>(state)) - 1;
+}
+
+cppfmu::FMIFMUstate state_handle(int32_t id)
+{
+    return reinterpret_cast<cppfmu::FMIFMUstate>(static_cast<std::uintptr_t>(id) + 1);
+}
+
+} // namespace
+
+void RemoteSlaveInstance::GetFMUstate(cppfmu::FMIFMUstate& state)
+{
+    request_.begin(op::GET_FMU_STATE).put(state != nullptr ? state_id(state) : -1);
+    state = state_handle(call().get<int32_t>());
+}
+
+void RemoteSlaveInstance::SetFMUstate(cppfmu::FMIFMUstate state)
+{
+    request_.begin(op::SET_FMU_STATE).put(state_id(state));
+    call();
+}
+
+void RemoteSlaveInstance::FreeFMUstate(cppfmu::FMIFMUstate& state)
+{
+    if (state == nullptr) {
+        return;
+    }
+    request_.begin(op::FREE_FMU_STATE).put(state_id(state));
+    call();
+    state = nullptr;
+}
+
+std::size_t RemoteSlaveInstance::SerializedFMUstateSize(cppfmu::FMIFMUstate state)
+{
+    request_.begin(op::SERIALIZE_FMU_STATE).put(state_id(state));
+    serialized_ = call().getString();
+    serializedState_ = state;
+    return serialized_.size();
+}
+
+void RemoteSlaveInstance::SerializeFMUstate(cppfmu::FMIFMUstate state, fmi2Byte* data, std::size_t size)
+{
+    if (state != serializedState_) {
+        SerializedFMUstateSize(state);
+    }
+    if (size < serialized_.size()) {
+        throw std::logic_error("[FMU4j native] Buffer too small for the serialized FMU state!");
+    }
+    std::memcpy(data, serialized_.data(), serialized_.size());
+    serializedState_ = nullptr;
+    serialized_.clear();
+}
+
+void RemoteSlaveInstance::DeSerializeFMUstate(const fmi2Byte* data, std::size_t size, cppfmu::FMIFMUstate& state)
+{
+    FreeFMUstate(state);
+    request_.begin(op::DESERIALIZE_FMU_STATE).put(std::string(data, size));
+    state = state_handle(call().get<int32_t>());
+}
+
+bool RemoteSlaveInstance::GetRealOutputDerivatives(const cppfmu::FMIValueReference* vr, std::size_t nvr,
+    const cppfmu::FMIInteger* order, cppfmu::FMIReal* value)
+{
+    auto& request = begin(op::GET_REAL_OUTPUT_DERIVATIVES, vr, nvr);
+    for (std::size_t i = 0; i < nvr; i++) {
+        request.put(static_cast<int32_t>(order[i]));
+    }
+    auto reader = call();
+    if (reader.get<int32_t>() == 0) {
+        return false;
+    }
+    for (std::size_t i = 0; i < nvr; i++) {
+        value[i] = reader.get<double>();
+    }
+    return true;
+}
+
+void RemoteSlaveInstance::SetRealInputDerivatives(const cppfmu::FMIValueReference* vr, std::size_t nvr,
+    const cppfmu::FMIInteger* order, const cppfmu::FMIReal* value)
+{
+    inputDerivatives_.set(vr, nvr, order, value);
+}
+
+void RemoteSlaveInstance::GetDirectionalDerivatives(
+    const cppfmu::FMIValueReference* unknownVr, std::size_t nUnknown,
+    const cppfmu::FMIValueReference* knownVr, std::size_t nKnown,
+    const cppfmu::FMIReal* seeds, std::size_t nSeeds, cppfmu::FMIReal* derivatives)
+{
+    begin(op::GET_DIRECTIONAL_DERIVATIVES, unknownVr, nUnknown).put(static_cast<int32_t>(nKnown));
+    for (std::size_t i = 0; i < nKnown; i++) {
+        request_.put(static_cast<uint32_t>(knownVr[i]));
+    }
+    request_.put(static_cast<int32_t>(nSeeds));
+    for (std::size_t i = 0; i < nKnown * nSeeds; i++) {
+        request_.put(seeds[i]);
+    }
+    auto reader = call();
+    for (std::size_t i = 0; i < nUnknown * nSeeds; i++) {
+        derivatives[i] = reader.get<double>();
+    }
+}
+
+cppfmu::FMIReal RemoteSlaveInstance::GetPreferredStepSize()
+{
+    request_.begin(op::GET_PREFERRED_STEP_SIZE);
+    return call().get<double>();
+}
+
+void RemoteSlaveInstance::GetInstantiationTimings(cppfmu::FMIReal* timings, std::size_t n) const
+{
+    timings_.copy_to(timings, n);
+}
+
+RemoteSlaveInstance::~RemoteSlaveInstance()
+{
+    try {
+        request_.begin(op::FREE);
+        call();
+    } catch (const std::exception& e) {
+        logger_.Log(fmi2Warning, "", "%s", e.what());
+    }
+}
+
+} // namespace fmu4j
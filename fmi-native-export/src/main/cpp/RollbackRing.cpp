@@ -0,0 +1,125 @@
+#include <fmu4j/RollbackRing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace fmu4j
+{
+
+namespace
+{
+
+// relative tolerance when matching communication points, which masters tend to accumulate
+const double TIME_TOLERANCE = 1e-9;
+
+bool same_time(cppfmu::FMIReal a, cppfmu::FMIReal b)
+{
+    return std::abs(a - b) <= TIME_TOLERANCE * std::max(1.0, std::abs(b));
+}
+
+} // namespace
+
+std::size_t rollback_depth()
+{
+    static const std::size_t depth = [] {
+        const char* value = std::getenv("FMU4J_ROLLBACK_DEPTH");
+        if (value == nullptr) {
+            return std::size_t{0};
+        }
+        long size = std::strtol(value, nullptr, 10);
+        return size > 0 ? static_cast<std::size_t>(size) : std::size_t{0};
+    }();
+    return depth;
+}
+
+RollbackRing::RollbackRing(std::size_t depth)
+    : depth_(depth)
+{ }
+
+bool RollbackRing::capture(cppfmu::SlaveInstance& slave, cppfmu::FMIReal time, bool noSetFMUStatePriorToCurrentPoint)
+{
+    if (depth_ == 0) {
+        return false;
+    }
+    if (!checked_) {
+        checked_ = true;
+        // saveState() always succeeds, but only captures the whole state if the slave says so
+        if (!slave.CanGetAndSetFMUstate()) {
+            depth_ = 0;
+            unsupported_ = true;
+            return false;
+        }
+    }
+    while (!points_.empty() && (points_.back().time > time || same_time(points_.back().time, time))) {
+        release(slave, points_.back().state);
+        points_.pop_back();
+    }
+    while (!points_.empty() && (noSetFMUStatePriorToCurrentPoint || points_.size() >= depth_)) {
+        release(slave, points_.front().state);
+        points_.pop_front();
+    }
+
+    cppfmu::FMIFMUstate state = spare_;
+    spare_ = nullptr;
+    try {
+        slave.GetFMUstate(state);
+    } catch (const std::logic_error&) {
+        // FMU states are not supported by this runtime
+        clear(slave);
+        depth_ = 0;
+        unsupported_ = true;
+        return false;
+    } catch (...) {
+        spare_ = state;
+        throw;
+    }
+    points_.push_back(Point{time, state});
+    return true;
+}
+
+void RollbackRing::rollback(cppfmu::SlaveInstance& slave, cppfmu::FMIReal time)
+{
+    auto point = std::find_if(points_.begin(), points_.end(), [time](const Point& p) {
+        return same_time(p.time, time);
+    });
+    if (point == points_.end()) {
+        std::string reason;
+        if (unsupported_) {
+            reason = ", rollback is disabled as the slave does not declare canGetAndSetFMUstate";
+        } else if (depth_ == 0) {
+            reason = ", rollback is disabled (FMU4J_ROLLBACK_DEPTH)";
+        }
+        throw std::logic_error("[FMU4j native] No state to roll back to at t=" + std::to_string(time) + reason);
+    }
+    slave.SetFMUstate(point->state);
+    while (&points_.back() != &*point) {
+        release(slave, points_.back().state);
+        points_.pop_back();
+    }
+}
+
+void RollbackRing::clear(cppfmu::SlaveInstance& slave)
+{
+    for (auto& point : points_) {
+        slave.FreeFMUstate(point.state);
+    }
+    points_.clear();
+    if (spare_ != nullptr) {
+        slave.FreeFMUstate(spare_);
+    }
+}
+
+void RollbackRing::release(cppfmu::SlaveInstance& slave, cppfmu::FMIFMUstate state)
+{
+    // a single spare covers the steady state of capturing one point and releasing another per step
+    if (spare_ == nullptr) {
+        spare_ = state;
+    } else {
+        slave.FreeFMUstate(state);
+    }
+}
+
+} // namespace fmu4j
@@ -0,0 +1,490 @@
+#include <fmu4j/SharedMemoryChannel.hpp>
+
+#include <fmu4j/process.hpp>
+#include <cppfmu/cppfmu_cs.hpp>
+
+#include <jni.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#ifdef _WIN32
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#ifdef __linux__
+#    include <linux/futex.h>
+#    include <sys/syscall.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#    include <immintrin.h>
+#endif
+
+namespace fmu4j
+{
+
+namespace
+{
+
+const uint32_t MAGIC = 0x464D5352; // FMSR
+
+// Iterations spent spinning before sleeping, keeps the round-trip latency low while the peer is busy.
+// Pointless on a single core, where the peer cannot make progress while we spin.
+const int SPIN_COUNT = 20000;
+const int WAIT_TIMEOUT_MS = 100;
+
+struct alignas(64) Ring
+{
+    std::atomic<uint64_t> head; // bytes written
+    alignas(64) std::atomic<uint64_t> tail; // bytes read
+
+    // futex words, bumped after writing and reading respectively
+    alignas(64) std::atomic<uint32_t> dataSeq;
+    std::atomic<uint32_t> dataWaiters;
+    std::atomic<uint32_t> spaceSeq;
+    std::atomic<uint32_t> spaceWaiters;
+};
+
+struct RegionHeader
+{
+    uint32_t magic;
+    uint32_t capacity;
+    std::atomic<uint32_t> closed;
+    std::atomic<int64_t> masterPid;
+    std::atomic<int64_t> workerPid;
+
+    Ring toWorker;
+    Ring toMaster;
+};
+
+int spin_count()
+{
+    static const int count = std::thread::hardware_concurrency() > 1 ? SPIN_COUNT : 0;
+    return count;
+}
+
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected)
+{
+#ifdef __linux__
+    timespec timeout{0, WAIT_TIMEOUT_MS * 1000000L};
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+#else
+    // no cross-process futex available, back off instead
+    if (word.load() == expected) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+#endif
+}
+
+void futex_wake(std::atomic<uint32_t>& word)
+{
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+void notify(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiters)
+{
+    seq.fetch_add(1);
+    if (waiters.load() > 0) {
+        futex_wake(seq);
+    }
+}
+
+// Blocks until 'ready' holds. 'onTimeout' is invoked whenever a wait times out, and throws if the peer is gone.
+template<typename Ready, typename OnTimeout>
+void await(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiters, Ready ready, OnTimeout onTimeout)
+{
+    for (int i = spin_count(); i > 0; i--) {
+        if (ready()) {
+            return;
+        }
+        cpu_relax();
+    }
+    while (true) {
+        // a write after this load changes 'seq', so the futex wait below cannot miss it
+        uint32_t observed = seq.load();
+        waiters.fetch_add(1);
+        if (ready()) {
+            waiters.fetch_sub(1);
+            return;
+        }
+        futex_wait(seq, observed);
+        waiters.fetch_sub(1);
+        if (ready()) {
+            return;
+        }
+        onTimeout();
+    }
+}
+
+} // namespace
+
+struct SharedRegion
+{
+    void* base{};
+    std::size_t size{};
+#ifdef _WIN32
+    HANDLE mapping{};
+#endif
+
+    RegionHeader* header() const
+    {
+        return static_cast<RegionHeader*>(base);
+    }
+
+    uint8_t* data(const Ring& ring) const
+    {
+        auto start = static_cast<uint8_t*>(base) + sizeof(RegionHeader);
+        return &ring == &header()->toWorker ? start : start + header()->capacity;
+    }
+};
+
+namespace
+{
+
+std::size_t region_size(std::size_t capacity)
+{
+    return sizeof(RegionHeader) + 2 * capacity;
+}
+
+#ifdef _WIN32
+
+SharedRegion* map_region(const std::string& name, std::size_t size, bool create)
+{
+    std::string path = "Local\\" + name;
+    HANDLE mapping = create
+        ? CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+              static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size), path.c_str())
+        : OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, path.c_str());
+    if (mapping == nullptr) {
+        return nullptr;
+    }
+    void* base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (base == nullptr) {
+        CloseHandle(mapping);
+        return nullptr;
+    }
+    auto region = new SharedRegion();
+    region->base = base;
+    region->size = size;
+    region->mapping = mapping;
+    return region;
+}
+
+void unmap_region(SharedRegion* region)
+{
+    UnmapViewOfFile(region->base);
+    CloseHandle(region->mapping);
+    delete region;
+}
+
+void unlink_region(const std::string&)
+{
+    // named mappings disappear with their last handle
+}
+
+#else
+
+std::string region_path(const std::string& name)
+{
+    return "/dev/shm/" + name;
+}
+
+SharedRegion* map_region(const std::string& name, std::size_t size, bool create)
+{
+    int fd = ::open(region_path(name).c_str(), create ? (O_CREAT | O_EXCL | O_RDWR) : O_RDWR, 0600);
+    if (fd < 0) {
+        return nullptr;
+    }
+    if (create) {
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            return nullptr;
+        }
+    } else {
+        struct stat st{};
+        fstat(fd, &st);
+        size = static_cast<std::size_t>(st.st_size);
+    }
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        return nullptr;
+    }
+    auto region = new SharedRegion();
+    region->base = base;
+    region->size = size;
+    return region;
+}
+
+void unmap_region(SharedRegion* region)
+{
+    munmap(region->base, region->size);
+    delete region;
+}
+
+void unlink_region(const std::string& name)
+{
+    ::unlink(region_path(name).c_str());
+}
+
+#endif
+
+} // namespace
+
+SharedMemoryChannel::SharedMemoryChannel(std::string name, SharedRegion* region, bool master)
+    : name_(std::move(name))
+    , region_(region)
+    , master_(master)
+    , linked_(master)
+{ }
+
+std::unique_ptr<SharedMemoryChannel> SharedMemoryChannel::create(const std::string& name, std::size_t capacity)
+{
+    SharedRegion* region = map_region(name, region_size(capacity), true);
+    if (region == nullptr) {
+        std::string msg = "[FMU4j native] Unable to create shared memory region '" + name + "'!";
+        throw cppfmu::FatalError(msg.c_str());
+    }
+    auto header = new (region->base) RegionHeader();
+    header->capacity = static_cast<uint32_t>(capacity);
+    header->masterPid = current_process_id();
+    header->magic = MAGIC;
+    return std::unique_ptr<SharedMemoryChannel>(new SharedMemoryChannel(name, region, true));
+}
+
+std::unique_ptr<SharedMemoryChannel> SharedMemoryChannel::open(const std::string& name)
+{
+    SharedRegion* region = map_region(name, 0, false);
+    if (region == nullptr || region->header()->magic != MAGIC) {
+        if (region != nullptr) {
+            unmap_region(region);
+        }
+        std::string msg = "[FMU4j native] Unable to open shared memory region '" + name + "'!";
+        throw cppfmu::FatalError(msg.c_str());
+    }
+    region->header()->workerPid = current_process_id();
+    return std::unique_ptr<SharedMemoryChannel>(new SharedMemoryChannel(name, region, false));
+}
+
+void SharedMemoryChannel::watch(long pid)
+{
+    auto header = region_->header();
+    (master_ ? header->workerPid : header->masterPid) = pid;
+}
+
+void SharedMemoryChannel::check_peer() const
+{
+    auto header = region_->header();
+    if (header->closed.load()) {
+        throw cppfmu::FatalError("[FMU4j native] Shared memory channel closed by peer!");
+    }
+    long pid = static_cast<long>(master_ ? header->workerPid.load() : header->masterPid.load());
+    if (pid > 0 && !process_alive(pid)) {
+        throw cppfmu::FatalError("[FMU4j native] Peer process exited!");
+    }
+}
+
+void SharedMemoryChannel::send(const std::vector<uint8_t>& message)
+{
+    send(message.data(), message.size());
+}
+
+void SharedMemoryChannel::send(const void* data, std::size_t size)
+{
+    auto header = region_->header();
+    Ring& ring = master_ ? header->toWorker : header->toMaster;
+    uint8_t* buffer = region_->data(ring);
+    const uint64_t capacity = header->capacity;
+
+    auto length = static_cast<int32_t>(size);
+    const uint8_t* parts[] = {reinterpret_cast<const uint8_t*>(&length), static_cast<const uint8_t*>(data)};
+    std::size_t sizes[] = {sizeof(length), size};
+
+    for (int part = 0; part < 2; part++) {
+        const uint8_t* src = parts[part];
+        std::size_t remaining = sizes[part];
+        while (remaining > 0) {
+            const uint64_t head = ring.head.load(std::memory_order_relaxed);
+            await(
+                ring.spaceSeq, ring.spaceWaiters,
+                [&] { return head - ring.tail.load(std::memory_order_acquire) < capacity; },
+                [this] { check_peer(); });
+            const uint64_t free = capacity - (head - ring.tail.load(std::memory_order_acquire));
+            const std::size_t n = static_cast<std::size_t>(std::min<uint64_t>(remaining, free));
+            const std::size_t offset = static_cast<std::size_t>(head % capacity);
+            const std::size_t first = std::min<std::size_t>(n, static_cast<std::size_t>(capacity) - offset);
+            std::memcpy(buffer + offset, src, first);
+            std::memcpy(buffer, src + first, n - first);
+            ring.head.store(head + n, std::memory_order_release);
+            notify(ring.dataSeq, ring.dataWaiters);
+            src += n;
+            remaining -= n;
+        }
+    }
+}
+
+void SharedMemoryChannel::read(void* dst, std::size_t size)
+{
+    auto header = region_->header();
+    Ring& ring = master_ ? header->toMaster : header->toWorker;
+    uint8_t* buffer = region_->data(ring);
+    const uint64_t capacity = header->capacity;
+
+    auto out = static_cast<uint8_t*>(dst);
+    while (size > 0) {
+        const uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+        await(
+            ring.dataSeq, ring.dataWaiters,
+            [&] { return ring.head.load(std::memory_order_acquire) != tail; },
+            [this] { check_peer(); });
+        const uint64_t available = ring.head.load(std::memory_order_acquire) - tail;
+        const std::size_t n = static_cast<std::size_t>(std::min<uint64_t>(size, available));
+        const std::size_t offset = static_cast<std::size_t>(tail % capacity);
+        const std::size_t first = std::min<std::size_t>(n, static_cast<std::size_t>(capacity) - offset);
+        std::memcpy(out, buffer + offset, first);
+        std::memcpy(out + first, buffer, n - first);
+        ring.tail.store(tail + n, std::memory_order_release);
+        notify(ring.spaceSeq, ring.spaceWaiters);
+        out += n;
+        size -= n;
+    }
+}
+
+void SharedMemoryChannel::receive(std::vector<uint8_t>& message)
+{
+    if (pending_ < 0) {
+        int32_t length;
+        read(&length, sizeof(length));
+        pending_ = length;
+    }
+    message.resize(static_cast<std::size_t>(pending_));
+    read(message.data(), message.size());
+    pending_ = -1;
+}
+
+int64_t SharedMemoryChannel::receive(void* dst, std::size_t capacity)
+{
+    if (pending_ < 0) {
+        int32_t length;
+        read(&length, sizeof(length));
+        pending_ = length;
+    }
+    if (static_cast<std::size_t>(pending_) > capacity) {
+        return -pending_;
+    }
+    int64_t size = pending_;
+    read(dst, static_cast<std::size_t>(size));
+    pending_ = -1;
+    return size;
+}
+
+void SharedMemoryChannel::unlink()
+{
+    if (linked_) {
+        unlink_region(name_);
+        linked_ = false;
+    }
+}
+
+void SharedMemoryChannel::close()
+{
+    auto header = region_->header();
+    if (header->closed.exchange(1) == 0) {
+        for (Ring* ring : {&header->toWorker, &header->toMaster}) {
+            notify(ring->dataSeq, ring->dataWaiters);
+            notify(ring->spaceSeq, ring->spaceWaiters);
+        }
+    }
+}
+
+SharedMemoryChannel::~SharedMemoryChannel()
+{
+    close();
+    unlink();
+    unmap_region(region_);
+}
+
+} // namespace fmu4j
+
+namespace
+{
+
+void throw_io_exception(JNIEnv* env, const char* msg)
+{
+    env->ThrowNew(env->FindClass("java/io/IOException"), msg);
+}
+
+fmu4j::SharedMemoryChannel* from_handle(jlong handle)
+{
+    return reinterpret_cast<fmu4j::SharedMemoryChannel*>(handle);
+}
+
+} // namespace
+
+// Java end of the channel, see no.ntnu.ais.fmu4j.export.remote.SharedMemoryChannel
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_no_ntnu_ais_fmu4j_export_remote_SharedMemoryChannel_open0(JNIEnv* env, jclass, jstring name)
+{
+    const char* cName = env->GetStringUTFChars(name, nullptr);
+    std::string regionName(cName);
+    env->ReleaseStringUTFChars(name, cName);
+    try {
+        return reinterpret_cast<jlong>(fmu4j::SharedMemoryChannel::open(regionName).release());
+    } catch (const std::exception& e) {
+        throw_io_exception(env, e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT jint JNICALL Java_no_ntnu_ais_fmu4j_export_remote_SharedMemoryChannel_receive0(JNIEnv* env, jclass, jlong handle, jobject buffer)
+{
+    try {
+        void* address = env->GetDirectBufferAddress(buffer);
+        auto capacity = static_cast<std::size_t>(env->GetDirectBufferCapacity(buffer));
+        return static_cast<jint>(from_handle(handle)->receive(address, capacity));
+    } catch (const std::exception& e) {
+        throw_io_exception(env, e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT void JNICALL Java_no_ntnu_ais_fmu4j_export_remote_SharedMemoryChannel_send0(JNIEnv* env, jclass, jlong handle, jobject buffer, jint offset, jint length)
+{
+    try {
+        auto address = static_cast<const uint8_t*>(env->GetDirectBufferAddress(buffer));
+        from_handle(handle)->send(address + offset, static_cast<std::size_t>(length));
+    } catch (const std::exception& e) {
+        throw_io_exception(env, e.what());
+    }
+}
+
+JNIEXPORT void JNICALL Java_no_ntnu_ais_fmu4j_export_remote_SharedMemoryChannel_close0(JNIEnv*, jclass, jlong handle)
+{
+    delete from_handle(handle);
+}
+}
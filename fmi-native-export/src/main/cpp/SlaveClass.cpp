@@ -0,0 +1,286 @@
+#include <fmu4j/SlaveClass.hpp>
+
+#include <fmu4j/jni_helper.hpp>
+#include <fmu4j/process.hpp>
+#include <cppfmu/cppfmu_cs.hpp>
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace fmu4j
+{
+
+namespace
+{
+
+const char* RUNTIME_JAR = "fmu4j-runtime.jar";
+const char* RUNTIME_DIGEST = "runtime.txt";
+const char* VARIABLE_INDEX = "variables.bin";
+
+std::mutex cacheMutex;
+std::unordered_map<std::string, std::weak_ptr<const SlaveClass>> cache;
+
+std::mutex runtimeMutex;
+std::unordered_map<std::string, std::weak_ptr<const RuntimeClassLoader>> runtimes;
+
+void close_classloader(JNIEnv* env, jobject classLoader)
+{
+    jclass URLClassLoader = env->FindClass("java/net/URLClassLoader");
+    jmethodID closeId = env->GetMethodID(URLClassLoader, "close", "()V");
+    env->CallVoidMethod(classLoader, closeId);
+}
+
+void release_runtime(const RuntimeClassLoader* runtime)
+{
+    {
+        std::lock_guard<std::mutex> lock(runtimeMutex);
+        auto it = runtimes.find(runtime->digest);
+        if (it != runtimes.end() && it->second.expired()) {
+            runtimes.erase(it);
+        }
+    }
+
+    jvm_invoke(runtime->jvm, [runtime](JNIEnv* env) {
+        close_classloader(env, runtime->classLoader);
+        env->DeleteGlobalRef(runtime->classLoader);
+    });
+
+    delete runtime;
+}
+
+// Returns the runtime classloader for FMUs built with --shared-runtime, or nullptr for self-contained FMUs.
+// Runtimes are matched on the digest written by FmuBuilder, so FMUs built against
+// different fmu4j versions are never mixed.
+std::shared_ptr<const RuntimeClassLoader> acquire_runtime(JNIEnv* env, const std::string& resources)
+{
+    std::ifstream infile(resources + "/" + RUNTIME_DIGEST);
+    if (!infile) {
+        return nullptr;
+    }
+    std::string digest;
+    std::getline(infile, digest);
+    if (digest.empty()) {
+        std::string msg = "[FMU4j native] Invalid runtime digest in '" + resources + "/" + RUNTIME_DIGEST + "'!";
+        throw cppfmu::FatalError(msg.c_str());
+    }
+
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+
+    auto& entry = runtimes[digest];
+    if (auto runtime = entry.lock()) {
+        return runtime;
+    }
+
+    std::string classpath(resources + "/" + RUNTIME_JAR);
+    if (!std::ifstream(classpath)) {
+        std::string msg = "[FMU4j native] Missing shared runtime '" + classpath + "'!";
+        throw cppfmu::FatalError(msg.c_str());
+    }
+
+    std::unique_ptr<RuntimeClassLoader> r(new RuntimeClassLoader());
+    env->GetJavaVM(&r->jvm);
+    r->digest = digest;
+    // shared with FMUs instantiated later, so it must not read from this FMU's resources, which may be removed first
+    r->classLoader = env->NewGlobalRef(create_classloader(env, stable_copy(classpath)));
+
+    std::shared_ptr<const RuntimeClassLoader> runtime(r.release(), &release_runtime);
+    entry = runtime;
+    return runtime;
+}
+
+void release_slave_class(const SlaveClass* slaveClass)
+{
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = cache.find(slaveClass->resources);
+        if (it != cache.end() && it->second.expired()) {
+            cache.erase(it);
+        }
+    }
+
+    jvm_invoke(slaveClass->jvm, [slaveClass](JNIEnv* env) {
+        env->DeleteGlobalRef(slaveClass->mapCls);
+        env->DeleteGlobalRef(slaveClass->slaveCls);
+
+        close_classloader(env, slaveClass->classLoader);
+        env->DeleteGlobalRef(slaveClass->classLoader);
+    });
+
+    delete slaveClass;
+}
+
+// Releases the handles of a SlaveClass failing to load partway through, e.g. on a missing method.
+// Does nothing once the SlaveClass has been handed over to its shared_ptr.
+class LoadGuard
+{
+public:
+    LoadGuard(JNIEnv* env, const std::unique_ptr<SlaveClass>& slaveClass)
+        : env_(env)
+        , slaveClass_(slaveClass)
+    { }
+
+    LoadGuard(const LoadGuard&) = delete;
+    LoadGuard& operator=(const LoadGuard&) = delete;
+
+    ~LoadGuard()
+    {
+        const SlaveClass* c = slaveClass_.get();
+        if (c == nullptr) {
+            return;
+        }
+        // left pending by the failed lookup
+        env_->ExceptionClear();
+        if (c->mapCls != nullptr) {
+            env_->DeleteGlobalRef(c->mapCls);
+        }
+        if (c->slaveCls != nullptr) {
+            env_->DeleteGlobalRef(c->slaveCls);
+        }
+        if (c->classLoader != nullptr) {
+            close_classloader(env_, c->classLoader);
+            env_->ExceptionClear();
+            env_->DeleteGlobalRef(c->classLoader);
+        }
+        // the shared runtime is released along with the SlaveClass
+    }
+
+private:
+    JNIEnv* env_;
+    const std::unique_ptr<SlaveClass>& slaveClass_;
+};
+
+std::shared_ptr<const SlaveClass> load_slave_class(JNIEnv* env, const std::string& resources, InstantiationTimings* timings)
+{
+    std::unique_ptr<SlaveClass> c(new SlaveClass());
+    LoadGuard guard(env, c);
+    env->GetJavaVM(&c->jvm);
+    c->resources = resources;
+
+    std::ifstream infile(resources + "/mainclass.txt");
+    std::getline(infile, c->slaveName);
+
+    PhaseTimer timer(timings, Phase::runtimeClassLoader);
+    std::string classpath(resources + "/model.jar");
+    c->runtime = acquire_runtime(env, resources);
+    jobject parent = c->runtime ? c->runtime->classLoader : nullptr;
+
+    timer.next(Phase::classLoader);
+    c->classLoader = env->NewGlobalRef(create_classloader(env, classpath, parent));
+
+    timer.next(Phase::findClass);
+    jclass slaveCls = FindClass(env, c->classLoader, c->slaveName);
+    if (slaveCls == nullptr) {
+        std::string msg = "[FMU4j native] Unable to find class '" + c->slaveName + "'!";
+        throw cppfmu::FatalError(msg.c_str());
+    }
+    c->slaveCls = reinterpret_cast<jclass>(env->NewGlobalRef(slaveCls));
+
+    timer.next(Phase::methodLookup);
+    c->ctorId = env->GetMethodID(slaveCls, "<init>", "(Ljava/util/Map;)V");
+    if (c->ctorId == nullptr) {
+        std::string msg =
+            "Unable to locate 1 arg constructor that takes a Map for slave class '" + c->slaveName + "'!";
+        throw cppfmu::FatalError(msg.c_str());
+    }
+    c->defineId = GetMethodID(env, slaveCls, "__define__", "()V");
+
+    std::string variableIndex(resources + "/" + VARIABLE_INDEX);
+    if (std::ifstream(variableIndex)) {
+        c->defineFromIndexId = GetMethodID(env, slaveCls, "__defineFromIndex__", "(Ljava/lang/String;)V", false);
+        if (c->defineFromIndexId != nullptr) {
+            c->variableIndex = variableIndex;
+        }
+    }
+
+    c->recycleId = GetMethodID(env, slaveCls, "recycle", "()Z", false);
+    c->reuseId = GetMethodID(env, slaveCls, "__reuse__", "(Ljava/lang/String;)V", false);
+    c->resetId = GetMethodID(env, slaveCls, "__reset__", "()Z", false);
+    c->warmupId = GetMethodID(env, slaveCls, "warmup", "(D)Z", false);
+    c->warmupReferencesId = GetMethodID(env, slaveCls, "__warmupValueReferences__", "()[[J", false);
+    c->valueReferencesId = GetMethodID(env, slaveCls, "__valueReferences__", "()[[J", false);
+    c->directionalDerivativesId = GetMethodID(env, slaveCls, "__directionalDerivatives__", "([J[J[D)[D", false);
+    c->setRealInputDerivativesId = GetMethodID(env, slaveCls, "__setRealInputDerivatives__", "([J[I[D)V", false);
+    c->getRealOutputDerivativesId = GetMethodID(env, slaveCls, "getRealOutputDerivatives", "([J[I)[D", false);
+    c->saveStateId = GetMethodID(env, slaveCls, "saveState", "()Ljava/lang/Object;", false);
+    c->saveStateIntoId = GetMethodID(env, slaveCls, "saveStateInto", "(Ljava/lang/Object;)Ljava/lang/Object;", false);
+    c->restoreStateId = GetMethodID(env, slaveCls, "restoreState", "(Ljava/lang/Object;)V", false);
+    c->serializedStateSizeId = GetMethodID(env, slaveCls, "serializedStateSize", "(Ljava/lang/Object;)I", false);
+    c->serializeStateId = GetMethodID(env, slaveCls, "serializeState", "(Ljava/lang/Object;Ljava/nio/ByteBuffer;)V", false);
+    c->deserializeStateId = GetMethodID(env, slaveCls, "deserializeState", "(Ljava/nio/ByteBuffer;)Ljava/lang/Object;", false);
+
+    jclass mapCls = env->FindClass("java/util/HashMap");
+    c->mapCls = reinterpret_cast<jclass>(env->NewGlobalRef(mapCls));
+    c->mapCtorId = GetMethodID(env, mapCls, "<init>", "()V");
+    c->mapPutId = GetMethodID(env, mapCls, "put", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
+
+    c->setupExperimentId = GetMethodID(env, slaveCls, "setupExperiment", "(DDD)V");
+    c->setupId = GetMethodID(env, slaveCls, "__setupExperiment__", "(DDD)V", false);
+    c->enterInitialisationModeId = GetMethodID(env, slaveCls, "enterInitialisationMode", "()V");
+    c->exitInitializationModeId = GetMethodID(env, slaveCls, "exitInitialisationMode", "()V");
+
+    c->doStepId = GetMethodID(env, slaveCls, "doStep", "(DD)V");
+    c->stepId = GetMethodID(env, slaveCls, "__doStep__", "(DD)D", false);
+    c->preferredStepSizeId = GetMethodID(env, slaveCls, "__preferredStepSize__", "()D", false);
+    c->canGetAndSetFMUstateId = GetMethodID(env, slaveCls, "__canGetAndSetFMUstate__", "()Z", false);
+    c->terminateId = GetMethodID(env, slaveCls, "terminate", "()V");
+    c->closeId = GetMethodID(env, slaveCls, "close", "()V");
+
+    c->getRealId = GetMethodID(env, slaveCls, "getReal", "([J[D)V");
+    c->setRealId = GetMethodID(env, slaveCls, "setReal", "([J[D)V");
+
+    c->getIntegerId = GetMethodID(env, slaveCls, "getInteger", "([J[I)V");
+    c->setIntegerId = GetMethodID(env, slaveCls, "setInteger", "([J[I)V");
+
+    c->getBooleanId = GetMethodID(env, slaveCls, "getBoolean", "([J[Z)V");
+    c->setBooleanId = GetMethodID(env, slaveCls, "setBoolean", "([J[Z)V");
+
+    c->getStringId = GetMethodID(env, slaveCls, "getString", "([J[Ljava/lang/String;)V");
+    c->setStringId = GetMethodID(env, slaveCls, "setString", "([J[Ljava/lang/String;)V");
+
+    c->numberOfContinuousStatesId = GetMethodID(env, slaveCls, "__numberOfContinuousStates__", "()I", false);
+    c->numberOfEventIndicatorsId = GetMethodID(env, slaveCls, "__numberOfEventIndicators__", "()I", false);
+    c->getContinuousStatesId = GetMethodID(env, slaveCls, "__getContinuousStates__", "([D)V", false);
+    c->setContinuousStatesId = GetMethodID(env, slaveCls, "__setContinuousStates__", "(D[D)V", false);
+    c->derivativesId = GetMethodID(env, slaveCls, "__derivatives__", "(D[D[D)V", false);
+    c->eventIndicatorsId = GetMethodID(env, slaveCls, "__eventIndicators__", "(D[D[D)V", false);
+    c->handleEventId = GetMethodID(env, slaveCls, "__handleEvent__", "(D[D)Z", false);
+
+    c->realSourceId = GetMethodID(env, slaveCls, "__realSourceHandle__", "(J)J", false);
+    c->connectRealId = GetMethodID(env, slaveCls, "__connectRealHandle__", "(JJ)V", false);
+    c->releaseRealSourcesId = GetMethodID(env, slaveCls, "__releaseRealSources__", "()V", false);
+
+    c->getFloat64Id = GetMethodID(env, slaveCls, "__getFloat64__", "([J)[D", false);
+    c->setFloat64Id = GetMethodID(env, slaveCls, "__setFloat64__", "([J[D)V", false);
+    c->getInt32Id = GetMethodID(env, slaveCls, "__getInt32__", "([J)[I", false);
+    c->setInt32Id = GetMethodID(env, slaveCls, "__setInt32__", "([J[I)V", false);
+    c->getBoolean3Id = GetMethodID(env, slaveCls, "__getBoolean3__", "([J)[Z", false);
+    c->setBoolean3Id = GetMethodID(env, slaveCls, "__setBoolean3__", "([J[Z)V", false);
+    c->getString3Id = GetMethodID(env, slaveCls, "__getString3__", "([J)[Ljava/lang/String;", false);
+    c->setString3Id = GetMethodID(env, slaveCls, "__setString3__", "([J[Ljava/lang/String;)V", false);
+
+    c->getAllId = GetMethodID(env, slaveCls, "getAll", "([J[I[J[D[J[Z[J[Ljava/lang/String;)V", false);
+    c->setAllId = GetMethodID(env, slaveCls, "setAll", "([J[I[J[D[J[Z[J[Ljava/lang/String;)V", false);
+    c->canGetSetAll = c->getAllId != nullptr && c->setAllId != nullptr;
+
+    return std::shared_ptr<const SlaveClass>(c.release(), &release_slave_class);
+}
+
+} // namespace
+
+std::shared_ptr<const SlaveClass> acquire_slave_class(JNIEnv* env, const std::string& resources, InstantiationTimings* timings)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    auto& entry = cache[resources];
+    if (auto slaveClass = entry.lock()) {
+        return slaveClass;
+    }
+
+    auto slaveClass = load_slave_class(env, resources, timings);
+    entry = slaveClass;
+    return slaveClass;
+}
+
+} // namespace fmu4j
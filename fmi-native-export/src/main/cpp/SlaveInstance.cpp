@@ -1,17 +1,135 @@
 #include <fmu4j/SlaveInstance.hpp>
 
+#include <fmu4j/Daemon.hpp>
+#include <fmu4j/InstancePool.hpp>
+#include <fmu4j/RemoteSlaveInstance.hpp>
+#include <fmu4j/Worker.hpp>
 #include <fmu4j/jni_helper.hpp>
 #include <cppfmu/cppfmu_cs.hpp>
 
-#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
 #include <jni.h>
+#include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace fmu4j
 {
 
+namespace
+{
+
+const unsigned long WARMUP_CHECK_INTERVAL = 100;
+
+// Time spent warming up the JIT after ExitInitializationMode, read from FMU4J_WARMUP_MS.
+// Warmup is disabled when zero (the default).
+std::chrono::milliseconds warmup_budget()
+{
+    static const std::chrono::milliseconds budget = [] {
+        const char* value = std::getenv("FMU4J_WARMUP_MS");
+        long ms = value != nullptr ? std::strtol(value, nullptr, 10) : 0;
+        return std::chrono::milliseconds(ms > 0 ? ms : 0);
+    }();
+    return budget;
+}
+
+// Accumulated JIT compilation time in milliseconds, or -1 if not monitored by the JVM.
+jlong compilation_time(JNIEnv* env)
+{
+    jclass factoryCls = env->FindClass("java/lang/management/ManagementFactory");
+    jmethodID getBeanId = env->GetStaticMethodID(factoryCls, "getCompilationMXBean", "()Ljava/lang/management/CompilationMXBean;");
+    jobject bean = env->CallStaticObjectMethod(factoryCls, getBeanId);
+    if (bean == nullptr) {
+        return -1;
+    }
+    jclass beanCls = env->FindClass("java/lang/management/CompilationMXBean");
+    jmethodID supportedId = env->GetMethodID(beanCls, "isCompilationTimeMonitoringSupported", "()Z");
+    if (!env->CallBooleanMethod(bean, supportedId)) {
+        return -1;
+    }
+    jmethodID totalId = env->GetMethodID(beanCls, "getTotalCompilationTime", "()J");
+    jlong time = env->CallLongMethod(bean, totalId);
+
+    env->DeleteLocalRef(bean);
+    env->DeleteLocalRef(beanCls);
+    env->DeleteLocalRef(factoryCls);
+    return time;
+}
+
+jlongArray new_vr_array(JNIEnv* env, const cppfmu::FMIValueReference* vr, std::size_t nvr)
+{
+    std::vector<jlong> refs(vr, vr + nvr);
+    auto vrArray = env->NewLongArray(static_cast<jsize>(nvr));
+    env->SetLongArrayRegion(vrArray, 0, static_cast<jsize>(nvr), refs.data());
+    return vrArray;
+}
+
+// Factories of the arrays cached by SlaveInstance::cachedArray
+jarray new_long_array(JNIEnv* env, jsize n)
+{
+    return env->NewLongArray(n);
+}
+
+jarray new_int_array(JNIEnv* env, jsize n)
+{
+    return env->NewIntArray(n);
+}
+
+jarray new_double_array(JNIEnv* env, jsize n)
+{
+    return env->NewDoubleArray(n);
+}
+
+jarray new_boolean_array(JNIEnv* env, jsize n)
+{
+    return env->NewBooleanArray(n);
+}
+
+jarray new_string_array(JNIEnv* env, jsize n)
+{
+    jclass stringCls = env->FindClass("java/lang/String");
+    jarray array = env->NewObjectArray(n, stringCls, nullptr);
+    env->DeleteLocalRef(stringCls);
+    return array;
+}
+
+void require_fmi3(jmethodID id)
+{
+    if (id == nullptr) {
+        throw std::logic_error("[FMU4j native] FMI 3.0 is not supported by this runtime!");
+    }
+}
+
+// Throws if the accessor 'method' failed, or returned another number of values than the master expects.
+void check_values(JNIEnv* env, jarray values, std::size_t nValues, const char* method)
+{
+    if (env->ExceptionCheck()) {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+        throw std::runtime_error(std::string("[FMU4j native] ") + method + "() failed!");
+    }
+    if (values != nullptr && static_cast<std::size_t>(env->GetArrayLength(values)) != nValues) {
+        throw std::runtime_error(std::string("[FMU4j native] ") + method + "() returned " +
+            std::to_string(env->GetArrayLength(values)) + " values, expected " + std::to_string(nValues) + "!");
+    }
+}
+
+// Throws if the master passed another number of values than the slave declares.
+void check_count(std::size_t n, std::size_t expected, const char* what)
+{
+    if (n != expected) {
+        throw std::invalid_argument("[FMU4j native] Expected " + std::to_string(expected) + " " + what +
+            ", got " + std::to_string(n) + "!");
+    }
+}
+
+} // namespace
+
 #ifdef _MSC_VER
 #    pragma warning(push)
 #    pragma warning(disable : 4267) //conversion from 'size_t' to 'jsize', possible loss of data
@@ -20,115 +138,217 @@ namespace fmu4j
 SlaveInstance::SlaveInstance(
     JNIEnv* env,
     std::string instanceName,
-    std::string resources)
+    std::string resources,
+    const cppfmu::Logger& logger,
+    InstantiationTimings timings)
     : resources_(std::move(resources))
     , instanceName_(std::move(instanceName))
+    , logger_(logger)
+    , timings_(timings)
 {
     env->GetJavaVM(&jvm_);
 
-    std::ifstream infile(resources_ + "/mainclass.txt");
-    std::getline(infile, slaveName_);
+    class_ = acquire_slave_class(env, resources_, &timings_);
 
-    std::string classpath(resources_ + "/model.jar");
-    classLoader_ = env->NewGlobalRef(create_classloader(env, classpath));
-
-    jclass slaveCls = FindClass(env, classLoader_, slaveName_);
-    if (slaveCls == nullptr) {
-        std::string msg = "[FMU4j native] Unable to find class '" + slaveName_ + "'!";
-        throw cppfmu::FatalError(msg.c_str());
+    if (class_->reuseId != nullptr && instance_pool_capacity() > 0) {
+        slaveInstance_ = take_instance(class_);
     }
-
-    ctorId_ = env->GetMethodID(slaveCls, "<init>", "(Ljava/util/Map;)V");
-    if (ctorId_ == nullptr) {
-        std::string msg =
-            "Unable to locate 1 arg constructor that takes a Map for slave class '" + slaveName_ + "'!";
-        throw cppfmu::FatalError(msg.c_str());
+    if (slaveInstance_ != nullptr) {
+        PhaseTimer timer(&timings_, Phase::constructor);
+        jstring name = env->NewStringUTF(instanceName_.c_str());
+        env->CallVoidMethod(slaveInstance_, class_->reuseId, name);
+        env->DeleteLocalRef(name);
+        if (env->ExceptionCheck()) {
+            // the pooled instance is dropped, and a new one constructed instead
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+            env->DeleteGlobalRef(slaveInstance_);
+            slaveInstance_ = nullptr;
+        }
     }
-
-    setupExperimentId_ = GetMethodID(env, slaveCls, "setupExperiment", "(DDD)V");
-    enterInitialisationModeId_ = GetMethodID(env, slaveCls, "enterInitialisationMode", "()V");
-    exitInitializationModeId_ = GetMethodID(env, slaveCls, "exitInitialisationMode", "()V");
-
-    doStepId_ = GetMethodID(env, slaveCls, "doStep", "(DD)V");
-    terminateId_ = GetMethodID(env, slaveCls, "terminate", "()V");
-    closeId_ = GetMethodID(env, slaveCls, "close", "()V");
-
-    getRealId_ = GetMethodID(env, slaveCls, "getReal", "([J)[D");
-    setRealId_ = GetMethodID(env, slaveCls, "setReal", "([J[D)V");
-
-    getIntegerId_ = GetMethodID(env, slaveCls, "getInteger", "([J)[I");
-    setIntegerId_ = GetMethodID(env, slaveCls, "setInteger", "([J[I)V");
-
-    getBooleanId_ = GetMethodID(env, slaveCls, "getBoolean", "([J)[Z");
-    setBooleanId_ = GetMethodID(env, slaveCls, "setBoolean", "([J[Z)V");
-
-    getStringId_ = GetMethodID(env, slaveCls, "getString", "([J)[Ljava/lang/String;");
-    setStringId_ = GetMethodID(env, slaveCls, "setString", "([J[Ljava/lang/String;)V");
-
-    jclass bulkCls = FindClass(env, classLoader_, "no.ntnu.ais.fmu4j.export.BulkRead", false);
-    if (bulkCls != nullptr) {
-        canGetSetAll_ = true;
-        bulkIntValuesId_ = GetMethodID(env, bulkCls, "getIntValues", "()[I");
-        bulkRealValuesId_ = GetMethodID(env, bulkCls, "getRealValues", "()[D");
-        bulkBoolValuesId_ = GetMethodID(env, bulkCls, "getBoolValues", "()[Z");
-        bulkStrValuesId_ = GetMethodID(env, bulkCls, "getStrValues", "()[Ljava/lang/String;");
-        getAllId_ = GetMethodID(env, slaveCls, "getAll", "([J[J[J[J)Lno/ntnu/ais/fmu4j/export/BulkRead;");
-        setAllId_ = GetMethodID(env, slaveCls, "setAll", "([J[I[J[D[J[Z[J[Ljava/lang/String;)V");
+    if (slaveInstance_ != nullptr) {
+        loadValueReferences(env);
+    } else {
+        initialize(&timings_);
     }
 
-    initialize();
+    logger_.DebugLog(fmi2OK, "", "%s", timings_.format().c_str());
 }
 
-void SlaveInstance::initialize()
+void SlaveInstance::initialize(InstantiationTimings* timings)
 {
-    jvm_invoke(jvm_, [this](JNIEnv* env) {
+    jvm_invoke(jvm_, [this, timings](JNIEnv* env) {
         env->DeleteGlobalRef(slaveInstance_);
 
-        jclass slaveCls = FindClass(env, classLoader_, slaveName_);
-
-        jclass mapCls = env->FindClass("java/util/HashMap");
-        jmethodID mapCtor = GetMethodID(env, mapCls, "<init>", "()V");
-        jmethodID putId = GetMethodID(env, mapCls, "put",
-            "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
-        jobject map = env->NewObject(mapCls, mapCtor);
-        env->CallObjectMethod(map, putId, env->NewStringUTF("instanceName"),
+        PhaseTimer timer(timings, Phase::constructor);
+        jobject map = env->NewObject(class_->mapCls, class_->mapCtorId);
+        env->CallObjectMethod(map, class_->mapPutId, env->NewStringUTF("instanceName"),
             env->NewStringUTF(instanceName_.c_str()));
-        env->CallObjectMethod(map, putId, env->NewStringUTF("resourceLocation"),
+        env->CallObjectMethod(map, class_->mapPutId, env->NewStringUTF("resourceLocation"),
             env->NewStringUTF(resources_.c_str()));
 
-        slaveInstance_ = env->NewGlobalRef(env->NewObject(slaveCls, ctorId_, map));
+        slaveInstance_ = env->NewGlobalRef(env->NewObject(class_->slaveCls, class_->ctorId, map));
         if (slaveInstance_ == nullptr) {
-            std::string msg = "Unable to instantiate a new instance of '" + slaveName_ + "'!";
+            std::string msg = "Unable to instantiate a new instance of '" + class_->slaveName + "'!";
             throw cppfmu::FatalError(msg.c_str());
         }
 
-        jmethodID defineId = GetMethodID(env, slaveCls, "__define__", "()V");
-        env->CallObjectMethod(slaveInstance_, defineId);
+        timer.next(Phase::define);
+        if (!class_->variableIndex.empty()) {
+            jstring indexPath = env->NewStringUTF(class_->variableIndex.c_str());
+            env->CallVoidMethod(slaveInstance_, class_->defineFromIndexId, indexPath);
+            env->DeleteLocalRef(indexPath);
+        } else {
+            env->CallObjectMethod(slaveInstance_, class_->defineId);
+        }
+        loadValueReferences(env);
     });
 }
 
+void SlaveInstance::loadValueReferences(JNIEnv* env)
+{
+    if (class_->valueReferencesId == nullptr) {
+        return;
+    }
+    auto groups = reinterpret_cast<jobjectArray>(env->CallObjectMethod(slaveInstance_, class_->valueReferencesId));
+    if (groups == nullptr) {
+        env->ExceptionClear();
+        return;
+    }
+    ValueReferenceTable* tables[] = {&intSlots_, &realSlots_, &boolSlots_, &strSlots_};
+    for (jsize i = 0; i < 4; i++) {
+        auto group = reinterpret_cast<jlongArray>(env->GetObjectArrayElement(groups, i));
+        jsize n = env->GetArrayLength(group);
+        std::vector<jlong> ranges(n);
+        env->GetLongArrayRegion(group, 0, n, ranges.data());
+        tables[i]->assign(std::vector<cppfmu::FMIValueReference>(ranges.begin(), ranges.end()));
+        env->DeleteLocalRef(group);
+    }
+    env->DeleteLocalRef(groups);
+}
+
 void SlaveInstance::SetupExperiment(cppfmu::FMIBoolean toleranceDefined, cppfmu::FMIReal tolerance,
     cppfmu::FMIReal tStart, cppfmu::FMIBoolean stopTimeDefined,
     cppfmu::FMIReal tStop)
 {
     double stop = stopTimeDefined ? tStop : -1;
     double tol = toleranceDefined ? tolerance : -1;
+    startTime_ = tStart;
+    // Model Exchange starts at tStart until the solver calls SetTime
+    time_ = tStart;
     jvm_invoke(jvm_, [this, tStart, stop, tol](JNIEnv* env) {
-        env->CallVoidMethod(slaveInstance_, setupExperimentId_, tStart, stop, tol);
+        jmethodID setupId = class_->setupId != nullptr ? class_->setupId : class_->setupExperimentId;
+        env->CallVoidMethod(slaveInstance_, setupId, tStart, stop, tol);
     });
 }
 
 void SlaveInstance::EnterInitializationMode()
 {
     jvm_invoke(jvm_, [this](JNIEnv* env) {
-        env->CallVoidMethod(slaveInstance_, enterInitialisationModeId_);
+        env->CallVoidMethod(slaveInstance_, class_->enterInitialisationModeId);
     });
 }
 
 void SlaveInstance::ExitInitializationMode()
 {
     jvm_invoke(jvm_, [this](JNIEnv* env) {
-        env->CallVoidMethod(slaveInstance_, exitInitializationModeId_);
+        env->CallVoidMethod(slaveInstance_, class_->exitInitializationModeId);
+    });
+    if (warmup_budget().count() > 0) {
+        warmup();
+    }
+}
+
+void SlaveInstance::warmup()
+{
+    using clock = std::chrono::steady_clock;
+
+    jvm_invoke(jvm_, [this](JNIEnv* env) {
+        std::vector<cppfmu::FMIValueReference> intVr, realVr, boolVr, strVr;
+        if (class_->warmupReferencesId != nullptr) {
+            auto refs = reinterpret_cast<jobjectArray>(env->CallObjectMethod(slaveInstance_, class_->warmupReferencesId));
+            if (env->ExceptionCheck()) {
+                env->ExceptionDescribe();
+                env->ExceptionClear();
+            } else {
+                std::vector<cppfmu::FMIValueReference>* groups[] = {&intVr, &realVr, &boolVr, &strVr};
+                for (jsize i = 0; i < 4; i++) {
+                    auto group = reinterpret_cast<jlongArray>(env->GetObjectArrayElement(refs, i));
+                    jsize size = env->GetArrayLength(group);
+                    std::vector<jlong> values(size);
+                    env->GetLongArrayRegion(group, 0, size, values.data());
+                    groups[i]->assign(values.begin(), values.end());
+                    env->DeleteLocalRef(group);
+                }
+                env->DeleteLocalRef(refs);
+            }
+        }
+
+        std::vector<cppfmu::FMIInteger> intValues(intVr.size());
+        std::vector<cppfmu::FMIReal> realValues(realVr.size());
+        std::vector<cppfmu::FMIBoolean> boolValues(boolVr.size());
+        std::vector<cppfmu::FMIString> strValues(strVr.size());
+        bool readValues = !(intVr.empty() && realVr.empty() && boolVr.empty() && strVr.empty());
+        bool slaveWarmup = class_->warmupId != nullptr;
+
+        const jlong compilationStart = compilation_time(env);
+        jlong compilation = compilationStart;
+        int quietChecks = 0;
+        bool settled = false;
+        unsigned long rounds = 0;
+
+        const auto budget = warmup_budget();
+        const auto start = clock::now();
+        while ((slaveWarmup || readValues) && clock::now() - start < budget) {
+            env->PushLocalFrame(16);
+            if (slaveWarmup) {
+                slaveWarmup = env->CallBooleanMethod(slaveInstance_, class_->warmupId, startTime_);
+                if (env->ExceptionCheck()) {
+                    env->ExceptionDescribe();
+                    env->ExceptionClear();
+                    slaveWarmup = false;
+                    logger_.Log(fmi2Warning, "", "[FMU4j native] warmup() failed, continuing without it.");
+                }
+            }
+            if (readValues) {
+                if (!intVr.empty()) {
+                    GetInteger(intVr.data(), intVr.size(), intValues.data());
+                }
+                if (!realVr.empty()) {
+                    GetReal(realVr.data(), realVr.size(), realValues.data());
+                }
+                if (!boolVr.empty()) {
+                    GetBoolean(boolVr.data(), boolVr.size(), boolValues.data());
+                }
+                if (!strVr.empty()) {
+                    GetString(strVr.data(), strVr.size(), strValues.data());
+                }
+                clearStrBuffer(env);
+            }
+            env->PopLocalFrame(nullptr);
+
+            // stop early once the JIT has been idle for a couple of check intervals
+            if (++rounds % WARMUP_CHECK_INTERVAL == 0 && compilationStart >= 0) {
+                jlong now = compilation_time(env);
+                quietChecks = now == compilation ? quietChecks + 1 : 0;
+                compilation = now;
+                if (quietChecks >= 2) {
+                    settled = true;
+                    break;
+                }
+            }
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start);
+        if (compilationStart >= 0) {
+            logger_.Log(fmi2OK, "",
+                "[FMU4j native] Warmup finished after %lu rounds in %ld ms, JIT compilation time %ld ms (%s).",
+                rounds, static_cast<long>(elapsed.count()), static_cast<long>(compilation_time(env) - compilationStart),
+                settled ? "settled" : "budget exhausted");
+        } else {
+            logger_.Log(fmi2OK, "", "[FMU4j native] Warmup finished after %lu rounds in %ld ms.",
+                rounds, static_cast<long>(elapsed.count()));
+        }
     });
 }
 
@@ -136,10 +356,24 @@ bool SlaveInstance::DoStep(cppfmu::FMIReal currentCommunicationPoint, cppfmu::FM
     cppfmu::FMIBoolean, cppfmu::FMIReal& endOfStep)
 {
     bool status = true;
-    jvm_invoke(jvm_, [this, &status, currentCommunicationPoint, communicationStepSize](JNIEnv* env) {
-        env->CallVoidMethod(slaveInstance_, doStepId_, currentCommunicationPoint, communicationStepSize);
+    jvm_invoke(jvm_, [this, &status, &endOfStep, currentCommunicationPoint, communicationStepSize](JNIEnv* env) {
+        if (inputDerivatives_.dirty()) {
+            flushInputDerivatives(env);
+        }
+        if (class_->stepId == nullptr) {
+            env->CallVoidMethod(slaveInstance_, class_->doStepId, currentCommunicationPoint, communicationStepSize);
+            if (env->ExceptionCheck()) {
+                status = false;
+            }
+            return;
+        }
+        jdouble reached = env->CallDoubleMethod(slaveInstance_, class_->stepId, currentCommunicationPoint, communicationStepSize);
         if (env->ExceptionCheck()) {
             status = false;
+        } else if (reached < currentCommunicationPoint + communicationStepSize) {
+            // ended early using Fmi2Slave.endStepAt
+            endOfStep = reached;
+            status = false;
         }
     });
     return status;
@@ -147,86 +381,61 @@ bool SlaveInstance::DoStep(cppfmu::FMIReal currentCommunicationPoint, cppfmu::FM
 
 void SlaveInstance::Reset()
 {
-    onClose();
-    initialize();
+    inputDerivatives_.clear();
+    timeDirty_ = false;
+    statesDirty_ = false;
+    bool restored = false;
+    if (class_->resetId != nullptr) {
+        jvm_invoke(jvm_, [this, &restored](JNIEnv* env) {
+            clearStrBuffer(env);
+            restored = env->CallBooleanMethod(slaveInstance_, class_->resetId);
+            if (env->ExceptionCheck()) {
+                env->ExceptionDescribe();
+                env->ExceptionClear();
+                restored = false;
+            }
+        });
+    }
+    if (!restored) {
+        onClose();
+        initialize();
+    }
 }
 
 void SlaveInstance::Terminate()
 {
     jvm_invoke(jvm_, [this](JNIEnv* env) {
-        env->CallBooleanMethod(slaveInstance_, terminateId_);
+        env->CallBooleanMethod(slaveInstance_, class_->terminateId);
     });
 }
 
 void SlaveInstance::SetInteger(const cppfmu::FMIValueReference* vr, std::size_t nvr, const cppfmu::FMIInteger* value)
 {
     jvm_invoke(jvm_, [this, vr, nvr, value](JNIEnv* env) {
-        auto vrArray = env->NewLongArray(nvr);
-        auto vrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nvr));
-
-        auto valueArray = env->NewIntArray(nvr);
-        auto valueArrayElements = reinterpret_cast<jint*>(malloc(sizeof(jint) * nvr));
-
-        for (int i = 0; i < nvr; i++) {
-            vrArrayElements[i] = static_cast<jlong>(vr[i]);
-            valueArrayElements[i] = static_cast<jint>(value[i]);
-        }
-
-        env->SetLongArrayRegion(vrArray, 0, nvr, vrArrayElements);
-        env->SetIntArrayRegion(valueArray, 0, nvr, valueArrayElements);
-
-        env->CallVoidMethod(slaveInstance_, setIntegerId_, vrArray, valueArray);
+        auto vrArray = cachedVrArray(env, intSlots_, intVrArrays_, vr, nvr);
+        auto valueArray = writeIntegers(env, intArrays_, value, nvr);
 
-        free(vrArrayElements);
-        free(valueArrayElements);
+        env->CallVoidMethod(slaveInstance_, class_->setIntegerId, vrArray, valueArray);
     });
 }
 
 void SlaveInstance::SetReal(const cppfmu::FMIValueReference* vr, std::size_t nvr, const cppfmu::FMIReal* value)
 {
     jvm_invoke(jvm_, [this, vr, nvr, value](JNIEnv* env) {
-        auto vrArray = env->NewLongArray(nvr);
-        auto vrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nvr));
-
-        auto valueArray = env->NewDoubleArray(nvr);
-        auto valueArrayElements = reinterpret_cast<jdouble*>(malloc(sizeof(jdouble) * nvr));
+        auto vrArray = cachedVrArray(env, realSlots_, realVrArrays_, vr, nvr);
+        auto valueArray = writeReals(env, realArrays_, value, nvr);
 
-        for (int i = 0; i < nvr; i++) {
-            vrArrayElements[i] = static_cast<jlong>(vr[i]);
-            valueArrayElements[i] = value[i];
-        }
-
-        env->SetLongArrayRegion(vrArray, 0, nvr, vrArrayElements);
-        env->SetDoubleArrayRegion(valueArray, 0, nvr, valueArrayElements);
-
-        env->CallVoidMethod(slaveInstance_, setRealId_, vrArray, valueArray);
-
-        free(vrArrayElements);
-        free(valueArrayElements);
+        env->CallVoidMethod(slaveInstance_, class_->setRealId, vrArray, valueArray);
     });
 }
 
 void SlaveInstance::SetBoolean(const cppfmu::FMIValueReference* vr, std::size_t nvr, const cppfmu::FMIBoolean* value)
 {
     jvm_invoke(jvm_, [this, vr, nvr, value](JNIEnv* env) {
-        auto vrArray = env->NewLongArray(nvr);
-        auto vrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nvr));
-
-        auto valueArray = env->NewBooleanArray(nvr);
-        auto valueArrayElements = reinterpret_cast<jboolean*>(malloc(sizeof(jboolean) * nvr));
-
-        for (int i = 0; i < nvr; i++) {
-            vrArrayElements[i] = static_cast<jlong>(vr[i]);
-            valueArrayElements[i] = static_cast<jboolean>(value[i]);
-        }
+        auto vrArray = cachedVrArray(env, boolSlots_, boolVrArrays_, vr, nvr);
+        auto valueArray = writeBooleans(env, boolArrays_, value, nvr);
 
-        env->SetLongArrayRegion(vrArray, 0, nvr, vrArrayElements);
-        env->SetBooleanArrayRegion(valueArray, 0, nvr, valueArrayElements);
-
-        env->CallVoidMethod(slaveInstance_, setBooleanId_, vrArray, valueArray);
-
-        free(vrArrayElements);
-        free(valueArrayElements);
+        env->CallVoidMethod(slaveInstance_, class_->setBooleanId, vrArray, valueArray);
     });
 }
 
@@ -235,29 +444,10 @@ void SlaveInstance::SetString(const cppfmu::FMIValueReference* vr, std::size_t n
     jvm_invoke(jvm_, [this, vr, nvr, value](JNIEnv* env) {
         clearStrBuffer(env);
 
-        auto vrArray = env->NewLongArray(nvr);
-        auto vrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nvr));
-
-        auto valueArray = env->NewObjectArray(nvr, env->FindClass("java/lang/String"), nullptr);
-
-        for (int i = 0; i < nvr; i++) {
-            vrArrayElements[i] = static_cast<jlong>(vr[i]);
-
-            const char* cStr = value[i];
-            jstring jStr = env->NewStringUTF(cStr);
-            jstring_ref ref{
-                cStr = cStr,
-                jStr = jStr};
-            strBuffer.push_back(ref);
+        auto vrArray = cachedVrArray(env, strSlots_, strVrArrays_, vr, nvr);
+        auto valueArray = writeStrings(env, strArrays_, value, nvr);
 
-            env->SetObjectArrayElement(valueArray, i, jStr);
-        }
-
-        env->SetLongArrayRegion(vrArray, 0, nvr, vrArrayElements);
-
-        env->CallVoidMethod(slaveInstance_, setStringId_, vrArray, valueArray);
-
-        free(vrArrayElements);
+        env->CallVoidMethod(slaveInstance_, class_->setStringId, vrArray, valueArray);
     });
 }
 
@@ -268,70 +458,24 @@ void SlaveInstance::SetAll(
     const cppfmu::FMIValueReference* strVr, std::size_t nStrvr, const cppfmu::FMIString* strValue)
 {
     jvm_invoke(jvm_, [this, intVr, nIntvr, intValue, realVr, nRealvr, realValue, boolVr, nBoolvr, boolValue, strVr, nStrvr, strValue](JNIEnv* env) {
-        if (canGetSetAll_) {
-            auto intVrArray = env->NewLongArray(nIntvr);
-            auto realVrArray = env->NewLongArray(nIntvr);
-            auto boolVrArray = env->NewLongArray(nIntvr);
-            auto strVrArray = env->NewLongArray(nStrvr);
-
-            auto intValueArray = env->NewIntArray(nIntvr);
-            auto realValueArray = env->NewDoubleArray(nRealvr);
-            auto boolValueArray = env->NewBooleanArray(nBoolvr);
-            auto strValueArray = env->NewObjectArray(nStrvr, env->FindClass("java/lang/String"), nullptr);
-
-            auto intValueArrayElements = reinterpret_cast<jint*>(malloc(sizeof(jint) * nIntvr));
-            auto intVrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nIntvr));
-            for (auto i = 0; i < nIntvr; i++) {
-                intVrArrayElements[i] = static_cast<jlong>(intVr[i]);
-                intValueArrayElements[i] = static_cast<jint>(intValue[i]);
-            }
-            env->SetLongArrayRegion(intVrArray, 0, nIntvr, intVrArrayElements);
-            env->SetIntArrayRegion(intValueArray, 0, nIntvr, intValueArrayElements);
-
-            auto realValueArrayElements = reinterpret_cast<jdouble*>(malloc(sizeof(jdouble) * nRealvr));
-            auto realVrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nRealvr));
-            for (auto i = 0; i < nRealvr; i++) {
-                realVrArrayElements[i] = static_cast<jlong>(realVr[i]);
-                realValueArrayElements[i] = realValue[i];
-            }
-            env->SetLongArrayRegion(realVrArray, 0, nRealvr, realVrArrayElements);
-            env->SetDoubleArrayRegion(realValueArray, 0, nRealvr, realValueArrayElements);
-
-            auto boolValueArrayElements = reinterpret_cast<jboolean*>(malloc(sizeof(jboolean) * nBoolvr));
-            auto boolVrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nBoolvr));
-            for (auto i = 0; i < nBoolvr; i++) {
-                boolVrArrayElements[i] = static_cast<jlong>(boolVr[i]);
-                boolValueArrayElements[i] = static_cast<jboolean>(boolValue[i]);
-            }
-            env->SetLongArrayRegion(boolVrArray, 0, nBoolvr, boolVrArrayElements);
-            env->SetBooleanArrayRegion(boolValueArray, 0, nBoolvr, boolValueArrayElements);
-
+        if (class_->canGetSetAll) {
             clearStrBuffer(env);
-            auto strVrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nStrvr));
-            for (auto i = 0; i < nStrvr; i++) {
-                strVrArrayElements[i] = static_cast<jlong>(strVr[i]);
-
-                const char* cStr = strValue[i];
-                jstring jStr = env->NewStringUTF(cStr);
-                jstring_ref ref{
-                    cStr = cStr,
-                    jStr = jStr};
-                strBuffer.push_back(ref);
-
-                env->SetObjectArrayElement(strValueArray, i, jStr);
-            }
-            env->SetLongArrayRegion(strVrArray, 0, nStrvr, strVrArrayElements);
 
-            env->CallVoidMethod(slaveInstance_, setAllId_,
+            auto intVrArray = cachedVrArray(env, intSlots_, intVrArrays_, intVr, nIntvr);
+            auto realVrArray = cachedVrArray(env, realSlots_, realVrArrays_, realVr, nRealvr);
+            auto boolVrArray = cachedVrArray(env, boolSlots_, boolVrArrays_, boolVr, nBoolvr);
+            auto strVrArray = cachedVrArray(env, strSlots_, strVrArrays_, strVr, nStrvr);
+
+            auto intValueArray = writeIntegers(env, intArrays_, intValue, nIntvr);
+            auto realValueArray = writeReals(env, realArrays_, realValue, nRealvr);
+            auto boolValueArray = writeBooleans(env, boolArrays_, boolValue, nBoolvr);
+            auto strValueArray = writeStrings(env, strArrays_, strValue, nStrvr);
+
+            env->CallVoidMethod(slaveInstance_, class_->setAllId,
                                 intVrArray, intValueArray,
                                 realVrArray, realValueArray,
                                 boolVrArray, boolValueArray,
                                 strVrArray, strValueArray);
-
-            free(intVrArrayElements);
-            free(realVrArrayElements);
-            free(boolVrArrayElements);
-            free(strVrArrayElements);
         } else {
             SetInteger(intVr, nIntvr, intValue);
             SetReal(realVr, nRealvr, realValue);
@@ -344,93 +488,58 @@ void SlaveInstance::SetAll(
 void SlaveInstance::GetInteger(const cppfmu::FMIValueReference* vr, std::size_t nvr, cppfmu::FMIInteger* value) const
 {
     jvm_invoke(jvm_, [this, vr, nvr, value](JNIEnv* env) {
-        auto vrArray = env->NewLongArray(nvr);
-        auto vrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nvr));
-        for (int i = 0; i < nvr; i++) {
-            vrArrayElements[i] = static_cast<jlong>(vr[i]);
-        }
-        env->SetLongArrayRegion(vrArray, 0, nvr, vrArrayElements);
+        flushStates(env);
+        auto vrArray = cachedVrArray(env, intSlots_, intVrArrays_, vr, nvr);
+        auto valueArray = reinterpret_cast<jintArray>(cachedArray(env, intArrays_, nvr, new_int_array));
 
-        auto valueArray = reinterpret_cast<jintArray>(env->CallObjectMethod(slaveInstance_, getIntegerId_, vrArray));
-        auto valueArrayElements = env->GetIntArrayElements(valueArray, nullptr);
-
-        for (int i = 0; i < nvr; i++) {
-            value[i] = static_cast<fmi2Integer>(valueArrayElements[i]);
-        }
+        env->CallVoidMethod(slaveInstance_, class_->getIntegerId, vrArray, valueArray);
+        check_values(env, nullptr, nvr, "getInteger");
 
-        free(vrArrayElements);
-        env->ReleaseIntArrayElements(valueArray, valueArrayElements, 0);
+        readIntegers(env, valueArray, value, nvr);
     });
 }
 
 void SlaveInstance::GetReal(const cppfmu::FMIValueReference* vr, std::size_t nvr, cppfmu::FMIReal* value) const
 {
     jvm_invoke(jvm_, [this, vr, nvr, value](JNIEnv* env) {
-        auto vrArray = env->NewLongArray(nvr);
-        auto vrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nvr));
-        for (int i = 0; i < nvr; i++) {
-            vrArrayElements[i] = static_cast<jlong>(vr[i]);
-        }
-        env->SetLongArrayRegion(vrArray, 0, nvr, vrArrayElements);
+        flushStates(env);
+        auto vrArray = cachedVrArray(env, realSlots_, realVrArrays_, vr, nvr);
+        auto valueArray = reinterpret_cast<jdoubleArray>(cachedArray(env, realArrays_, nvr, new_double_array));
 
-        auto valueArray = reinterpret_cast<jdoubleArray>(env->CallObjectMethod(slaveInstance_, getRealId_, vrArray));
-        auto valueArrayElements = env->GetDoubleArrayElements(valueArray, nullptr);
+        env->CallVoidMethod(slaveInstance_, class_->getRealId, vrArray, valueArray);
+        check_values(env, nullptr, nvr, "getReal");
 
-        for (int i = 0; i < nvr; i++) {
-            value[i] = valueArrayElements[i];
-        }
-
-        free(vrArrayElements);
-        env->ReleaseDoubleArrayElements(valueArray, valueArrayElements, 0);
+        env->GetDoubleArrayRegion(valueArray, 0, static_cast<jsize>(nvr), value);
     });
 }
 
 void SlaveInstance::GetBoolean(const cppfmu::FMIValueReference* vr, std::size_t nvr, cppfmu::FMIBoolean* value) const
 {
     jvm_invoke(jvm_, [this, vr, nvr, value](JNIEnv* env) {
-        auto vrArray = env->NewLongArray(nvr);
-        auto vrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nvr));
-        for (int i = 0; i < nvr; i++) {
-            vrArrayElements[i] = static_cast<jlong>(vr[i]);
-        }
-        env->SetLongArrayRegion(vrArray, 0, nvr, vrArrayElements);
+        flushStates(env);
+        auto vrArray = cachedVrArray(env, boolSlots_, boolVrArrays_, vr, nvr);
+        auto valueArray = reinterpret_cast<jbooleanArray>(cachedArray(env, boolArrays_, nvr, new_boolean_array));
 
-        auto valueArray = reinterpret_cast<jbooleanArray>(env->CallObjectMethod(slaveInstance_, getBooleanId_, vrArray));
-        auto valueArrayElements = env->GetBooleanArrayElements(valueArray, nullptr);
+        env->CallVoidMethod(slaveInstance_, class_->getBooleanId, vrArray, valueArray);
+        check_values(env, nullptr, nvr, "getBoolean");
 
-        for (int i = 0; i < nvr; i++) {
-            value[i] = static_cast<fmi2Boolean>(valueArrayElements[i]);
-        }
-
-        free(vrArrayElements);
-        env->ReleaseBooleanArrayElements(valueArray, valueArrayElements, 0);
+        readBooleans(env, valueArray, value, nvr);
     });
 }
 
 void SlaveInstance::GetString(const cppfmu::FMIValueReference* vr, std::size_t nvr, cppfmu::FMIString* value) const
 {
     jvm_invoke(jvm_, [this, vr, nvr, value](JNIEnv* env) {
+        flushStates(env);
         clearStrBuffer(env);
 
-        auto vrArray = env->NewLongArray(nvr);
-        auto vrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nvr));
-        for (int i = 0; i < nvr; i++) {
-            vrArrayElements[i] = static_cast<jlong>(vr[i]);
-        }
-        env->SetLongArrayRegion(vrArray, 0, nvr, vrArrayElements);
+        auto vrArray = cachedVrArray(env, strSlots_, strVrArrays_, vr, nvr);
+        auto valueArray = reinterpret_cast<jobjectArray>(cachedArray(env, strArrays_, nvr, new_string_array));
 
-        auto valueArray = reinterpret_cast<jobjectArray>(env->CallObjectMethod(slaveInstance_, getStringId_, vrArray));
-        for (int i = 0; i < nvr; i++) {
-            auto jStr = reinterpret_cast<jstring>(env->GetObjectArrayElement(valueArray, i));
-            auto cStr = env->GetStringUTFChars(jStr, nullptr);
-            value[i] = cStr;
-            jstring_ref ref{
-                cStr = cStr,
-                jStr = jStr};
-            strBuffer.push_back(ref);
-        }
+        env->CallVoidMethod(slaveInstance_, class_->getStringId, vrArray, valueArray);
+        check_values(env, nullptr, nvr, "getString");
 
-        free(vrArrayElements);
+        readStrings(env, valueArray, value, nvr);
     });
 }
 
@@ -442,76 +551,31 @@ void SlaveInstance::GetAll(
 {
 
     jvm_invoke(jvm_, [this, intVr, nIntvr, intValue, realVr, nRealvr, realValue, boolVr, nBoolvr, boolValue, strVr, nStrvr, strValue](JNIEnv* env) {
-        if (canGetSetAll_) {
-            auto intVrArray = env->NewLongArray(nIntvr);
-            auto realVrArray = env->NewLongArray(nRealvr);
-            auto boolVrArray = env->NewLongArray(nBoolvr);
-            auto strVrArray = env->NewLongArray(nStrvr);
-
-            auto intVrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nIntvr));
-            for (int i = 0; i < nIntvr; i++) {
-                intVrArrayElements[i] = static_cast<jlong>(intVr[i]);
-            }
-            env->SetLongArrayRegion(intVrArray, 0, nIntvr, intVrArrayElements);
-
-            auto realVrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nRealvr));
-            for (int i = 0; i < nRealvr; i++) {
-                realVrArrayElements[i] = static_cast<jlong>(realVr[i]);
-            }
-            env->SetLongArrayRegion(realVrArray, 0, nRealvr, realVrArrayElements);
-
-            auto boolVrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nBoolvr));
-            for (int i = 0; i < nBoolvr; i++) {
-                boolVrArrayElements[i] = static_cast<jlong>(boolVr[i]);
-            }
-            env->SetLongArrayRegion(boolVrArray, 0, nBoolvr, boolVrArrayElements);
-
-            auto strVrArrayElements = reinterpret_cast<jlong*>(malloc(sizeof(jlong) * nStrvr));
-            for (int i = 0; i < nStrvr; i++) {
-                strVrArrayElements[i] = static_cast<jlong>(strVr[i]);
-            }
-            env->SetLongArrayRegion(strVrArray, 0, nStrvr, strVrArrayElements);
-
-            jobject read = env->CallObjectMethod(slaveInstance_, getAllId_, intVrArray, realVrArray, boolVrArray, strVrArray);
-            auto intValueArray = reinterpret_cast<jintArray>(env->CallObjectMethod(read, bulkIntValuesId_));
-            auto realValueArray = reinterpret_cast<jdoubleArray>(env->CallObjectMethod(read, bulkRealValuesId_));
-            auto boolValueArray = reinterpret_cast<jbooleanArray>(env->CallObjectMethod(read, bulkBoolValuesId_));
-            auto strValueArray = reinterpret_cast<jobjectArray>(env->CallObjectMethod(read, bulkStrValuesId_));
-
-            auto intArrayElements = env->GetIntArrayElements(intValueArray, nullptr);
-            for (auto i = 0; i < nIntvr; i++) {
-                intValue[i] = static_cast<fmi2Integer>(intArrayElements[i]);
-            }
+        flushStates(env);
+        if (class_->canGetSetAll) {
+            clearStrBuffer(env);
 
-            auto realArrayElements = env->GetDoubleArrayElements(realValueArray, nullptr);
-            for (auto i = 0; i < nRealvr; i++) {
-                realValue[i] = realArrayElements[i];
-            }
+            auto intVrArray = cachedVrArray(env, intSlots_, intVrArrays_, intVr, nIntvr);
+            auto realVrArray = cachedVrArray(env, realSlots_, realVrArrays_, realVr, nRealvr);
+            auto boolVrArray = cachedVrArray(env, boolSlots_, boolVrArrays_, boolVr, nBoolvr);
+            auto strVrArray = cachedVrArray(env, strSlots_, strVrArrays_, strVr, nStrvr);
 
-            auto boolArrayElements = env->GetBooleanArrayElements(boolValueArray, nullptr);
-            for (auto i = 0; i < nBoolvr; i++) {
-                boolValue[i] = static_cast<fmi2Boolean>(boolArrayElements[i]);
-            }
-
-            clearStrBuffer(env);
-            for (auto i = 0; i < nStrvr; i++) {
-                auto jStr = reinterpret_cast<jstring>(env->GetObjectArrayElement(strValueArray, i));
-                auto cStr = env->GetStringUTFChars(jStr, nullptr);
-                strValue[i] = cStr;
-                jstring_ref ref{
-                    cStr = cStr,
-                    jStr = jStr};
-                strBuffer.push_back(ref);
-            }
+            auto intValueArray = reinterpret_cast<jintArray>(cachedArray(env, intArrays_, nIntvr, new_int_array));
+            auto realValueArray = reinterpret_cast<jdoubleArray>(cachedArray(env, realArrays_, nRealvr, new_double_array));
+            auto boolValueArray = reinterpret_cast<jbooleanArray>(cachedArray(env, boolArrays_, nBoolvr, new_boolean_array));
+            auto strValueArray = reinterpret_cast<jobjectArray>(cachedArray(env, strArrays_, nStrvr, new_string_array));
 
-            free(intVrArrayElements);
-            free(realVrArrayElements);
-            free(boolVrArrayElements);
-            free(strVrArrayElements);
+            env->CallVoidMethod(slaveInstance_, class_->getAllId,
+                                intVrArray, intValueArray,
+                                realVrArray, realValueArray,
+                                boolVrArray, boolValueArray,
+                                strVrArray, strValueArray);
+            check_values(env, nullptr, 0, "getAll");
 
-            env->ReleaseIntArrayElements(intValueArray, intArrayElements, 0);
-            env->ReleaseDoubleArrayElements(realValueArray, realArrayElements, 0);
-            env->ReleaseBooleanArrayElements(boolValueArray, boolArrayElements, 0);
+            readIntegers(env, intValueArray, intValue, nIntvr);
+            env->GetDoubleArrayRegion(realValueArray, 0, static_cast<jsize>(nRealvr), realValue);
+            readBooleans(env, boolValueArray, boolValue, nBoolvr);
+            readStrings(env, strValueArray, strValue, nStrvr);
         } else {
             GetInteger(intVr, nIntvr, intValue);
             GetReal(realVr, nRealvr, realValue);
@@ -521,26 +585,708 @@ void SlaveInstance::GetAll(
     });
 }
 
+jarray SlaveInstance::cachedArray(JNIEnv* env, array_cache& cache, std::size_t n, jarray (*create)(JNIEnv*, jsize)) const
+{
+    auto& array = cache[n];
+    if (array == nullptr) {
+        jarray local = create(env, static_cast<jsize>(n));
+        array = reinterpret_cast<jarray>(env->NewGlobalRef(local));
+        env->DeleteLocalRef(local);
+    }
+    return array;
+}
+
+jlongArray SlaveInstance::cachedVrArray(JNIEnv* env, const ValueReferenceTable& slots, array_cache& cache, const cppfmu::FMIValueReference* vr, std::size_t nvr) const
+{
+    slots.check(vr, nvr);
+    auto vrArray = reinterpret_cast<jlongArray>(cachedArray(env, cache, nvr, new_long_array));
+    vrBuffer_.assign(vr, vr + nvr);
+    env->SetLongArrayRegion(vrArray, 0, static_cast<jsize>(nvr), vrBuffer_.data());
+    return vrArray;
+}
+
+jintArray SlaveInstance::writeIntegers(JNIEnv* env, array_cache& cache, const cppfmu::FMIInteger* values, std::size_t n)
+{
+    auto array = reinterpret_cast<jintArray>(cachedArray(env, cache, n, new_int_array));
+    intBuffer_.assign(values, values + n);
+    env->SetIntArrayRegion(array, 0, static_cast<jsize>(n), intBuffer_.data());
+    return array;
+}
+
+jdoubleArray SlaveInstance::writeReals(JNIEnv* env, array_cache& cache, const cppfmu::FMIReal* values, std::size_t n)
+{
+    auto array = reinterpret_cast<jdoubleArray>(cachedArray(env, cache, n, new_double_array));
+    env->SetDoubleArrayRegion(array, 0, static_cast<jsize>(n), values);
+    return array;
+}
+
+jbooleanArray SlaveInstance::writeBooleans(JNIEnv* env, array_cache& cache, const cppfmu::FMIBoolean* values, std::size_t n)
+{
+    auto array = reinterpret_cast<jbooleanArray>(cachedArray(env, cache, n, new_boolean_array));
+    boolBuffer_.resize(n);
+    for (std::size_t i = 0; i < n; i++) {
+        boolBuffer_[i] = static_cast<jboolean>(values[i] != 0);
+    }
+    env->SetBooleanArrayRegion(array, 0, static_cast<jsize>(n), boolBuffer_.data());
+    return array;
+}
+
+jobjectArray SlaveInstance::writeStrings(JNIEnv* env, array_cache& cache, const cppfmu::FMIString* values, std::size_t n)
+{
+    auto array = reinterpret_cast<jobjectArray>(cachedArray(env, cache, n, new_string_array));
+    for (std::size_t i = 0; i < n; i++) {
+        const char* cStr = values[i];
+        jstring jStr = env->NewStringUTF(cStr);
+        jstring_ref ref{
+            cStr = cStr,
+            jStr = jStr};
+        strBuffer.push_back(ref);
+
+        env->SetObjectArrayElement(array, static_cast<jsize>(i), jStr);
+    }
+    return array;
+}
+
+void SlaveInstance::readIntegers(JNIEnv* env, jintArray array, cppfmu::FMIInteger* values, std::size_t n) const
+{
+    intBuffer_.resize(n);
+    env->GetIntArrayRegion(array, 0, static_cast<jsize>(n), intBuffer_.data());
+    for (std::size_t i = 0; i < n; i++) {
+        values[i] = static_cast<cppfmu::FMIInteger>(intBuffer_[i]);
+    }
+}
+
+void SlaveInstance::readBooleans(JNIEnv* env, jbooleanArray array, cppfmu::FMIBoolean* values, std::size_t n) const
+{
+    boolBuffer_.resize(n);
+    env->GetBooleanArrayRegion(array, 0, static_cast<jsize>(n), boolBuffer_.data());
+    for (std::size_t i = 0; i < n; i++) {
+        values[i] = static_cast<cppfmu::FMIBoolean>(boolBuffer_[i]);
+    }
+}
+
+void SlaveInstance::readStrings(JNIEnv* env, jobjectArray array, cppfmu::FMIString* values, std::size_t n) const
+{
+    for (std::size_t i = 0; i < n; i++) {
+        auto jStr = reinterpret_cast<jstring>(env->GetObjectArrayElement(array, static_cast<jsize>(i)));
+        auto cStr = env->GetStringUTFChars(jStr, nullptr);
+        values[i] = cStr;
+        jstring_ref ref{
+            cStr = cStr,
+            jStr = jStr};
+        strBuffer.push_back(ref);
+    }
+}
+
 void SlaveInstance::onClose()
 {
     jvm_invoke(jvm_, [this](JNIEnv* env) {
         clearStrBuffer(env);
-        env->CallVoidMethod(slaveInstance_, closeId_);
+        env->CallVoidMethod(slaveInstance_, class_->closeId);
+    });
+}
+
+
+bool SlaveInstance::park()
+{
+    if (class_->recycleId == nullptr || instance_pool_capacity() == 0) {
+        return false;
+    }
+    bool parked = false;
+    jvm_invoke(jvm_, [this, &parked](JNIEnv* env) {
+        clearStrBuffer(env);
+        jboolean recycled = env->CallBooleanMethod(slaveInstance_, class_->recycleId);
+        if (env->ExceptionCheck()) {
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+            recycled = JNI_FALSE;
+        }
+        parked = recycled && park_instance(class_, slaveInstance_);
+    });
+    return parked;
+}
+
+void SlaveInstance::GetFloat64(const cppfmu::FMIValueReference* vr, std::size_t nvr, double* values, std::size_t nValues) const
+{
+    require_fmi3(class_->getFloat64Id);
+    jvm_invoke(jvm_, [this, vr, nvr, values, nValues](JNIEnv* env) {
+        auto vrArray = new_vr_array(env, vr, nvr);
+        auto valueArray = reinterpret_cast<jdoubleArray>(env->CallObjectMethod(slaveInstance_, class_->getFloat64Id, vrArray));
+        check_values(env, valueArray, nValues, "__getFloat64__");
+        // array variables are copied in bulk, into the array returned by the slave and from there into the buffer of the master
+        env->GetDoubleArrayRegion(valueArray, 0, static_cast<jsize>(nValues), values);
+        env->DeleteLocalRef(valueArray);
+        env->DeleteLocalRef(vrArray);
+    });
+}
+
+void SlaveInstance::SetFloat64(const cppfmu::FMIValueReference* vr, std::size_t nvr, const double* values, std::size_t nValues)
+{
+    require_fmi3(class_->setFloat64Id);
+    jvm_invoke(jvm_, [this, vr, nvr, values, nValues](JNIEnv* env) {
+        auto vrArray = new_vr_array(env, vr, nvr);
+        auto valueArray = env->NewDoubleArray(static_cast<jsize>(nValues));
+        env->SetDoubleArrayRegion(valueArray, 0, static_cast<jsize>(nValues), values);
+        env->CallVoidMethod(slaveInstance_, class_->setFloat64Id, vrArray, valueArray);
+        check_values(env, nullptr, nValues, "__setFloat64__");
+        env->DeleteLocalRef(valueArray);
+        env->DeleteLocalRef(vrArray);
+    });
+}
+
+void SlaveInstance::GetInt32(const cppfmu::FMIValueReference* vr, std::size_t nvr, std::int32_t* values, std::size_t nValues) const
+{
+    require_fmi3(class_->getInt32Id);
+    jvm_invoke(jvm_, [this, vr, nvr, values, nValues](JNIEnv* env) {
+        auto vrArray = new_vr_array(env, vr, nvr);
+        auto valueArray = reinterpret_cast<jintArray>(env->CallObjectMethod(slaveInstance_, class_->getInt32Id, vrArray));
+        check_values(env, valueArray, nValues, "__getInt32__");
+        env->GetIntArrayRegion(valueArray, 0, static_cast<jsize>(nValues), reinterpret_cast<jint*>(values));
+        env->DeleteLocalRef(valueArray);
+        env->DeleteLocalRef(vrArray);
+    });
+}
+
+void SlaveInstance::SetInt32(const cppfmu::FMIValueReference* vr, std::size_t nvr, const std::int32_t* values, std::size_t nValues)
+{
+    require_fmi3(class_->setInt32Id);
+    jvm_invoke(jvm_, [this, vr, nvr, values, nValues](JNIEnv* env) {
+        auto vrArray = new_vr_array(env, vr, nvr);
+        auto valueArray = env->NewIntArray(static_cast<jsize>(nValues));
+        env->SetIntArrayRegion(valueArray, 0, static_cast<jsize>(nValues), reinterpret_cast<const jint*>(values));
+        env->CallVoidMethod(slaveInstance_, class_->setInt32Id, vrArray, valueArray);
+        check_values(env, nullptr, nValues, "__setInt32__");
+        env->DeleteLocalRef(valueArray);
+        env->DeleteLocalRef(vrArray);
+    });
+}
+
+void SlaveInstance::GetBool(const cppfmu::FMIValueReference* vr, std::size_t nvr, bool* values, std::size_t nValues) const
+{
+    require_fmi3(class_->getBoolean3Id);
+    jvm_invoke(jvm_, [this, vr, nvr, values, nValues](JNIEnv* env) {
+        auto vrArray = new_vr_array(env, vr, nvr);
+        auto valueArray = reinterpret_cast<jbooleanArray>(env->CallObjectMethod(slaveInstance_, class_->getBoolean3Id, vrArray));
+        check_values(env, valueArray, nValues, "__getBoolean3__");
+        std::vector<jboolean> buffer(nValues);
+        env->GetBooleanArrayRegion(valueArray, 0, static_cast<jsize>(nValues), buffer.data());
+        for (std::size_t i = 0; i < nValues; i++) {
+            values[i] = buffer[i] != JNI_FALSE;
+        }
+        env->DeleteLocalRef(valueArray);
+        env->DeleteLocalRef(vrArray);
+    });
+}
+
+void SlaveInstance::SetBool(const cppfmu::FMIValueReference* vr, std::size_t nvr, const bool* values, std::size_t nValues)
+{
+    require_fmi3(class_->setBoolean3Id);
+    jvm_invoke(jvm_, [this, vr, nvr, values, nValues](JNIEnv* env) {
+        auto vrArray = new_vr_array(env, vr, nvr);
+        std::vector<jboolean> buffer(values, values + nValues);
+        auto valueArray = env->NewBooleanArray(static_cast<jsize>(nValues));
+        env->SetBooleanArrayRegion(valueArray, 0, static_cast<jsize>(nValues), buffer.data());
+        env->CallVoidMethod(slaveInstance_, class_->setBoolean3Id, vrArray, valueArray);
+        check_values(env, nullptr, nValues, "__setBoolean3__");
+        env->DeleteLocalRef(valueArray);
+        env->DeleteLocalRef(vrArray);
+    });
+}
+
+void SlaveInstance::GetUtf8String(const cppfmu::FMIValueReference* vr, std::size_t nvr, const char** values, std::size_t nValues) const
+{
+    require_fmi3(class_->getString3Id);
+    jvm_invoke(jvm_, [this, vr, nvr, values, nValues](JNIEnv* env) {
+        clearStrBuffer(env);
+
+        auto vrArray = new_vr_array(env, vr, nvr);
+        auto valueArray = reinterpret_cast<jobjectArray>(env->CallObjectMethod(slaveInstance_, class_->getString3Id, vrArray));
+        check_values(env, valueArray, nValues, "__getString3__");
+        for (std::size_t i = 0; i < nValues; i++) {
+            auto jStr = reinterpret_cast<jstring>(env->GetObjectArrayElement(valueArray, static_cast<jsize>(i)));
+            auto cStr = env->GetStringUTFChars(jStr, nullptr);
+            values[i] = cStr;
+            strBuffer.push_back(jstring_ref{cStr, jStr});
+        }
+        env->DeleteLocalRef(valueArray);
+        env->DeleteLocalRef(vrArray);
+    });
+}
+
+void SlaveInstance::SetUtf8String(const cppfmu::FMIValueReference* vr, std::size_t nvr, const char* const* values, std::size_t nValues)
+{
+    require_fmi3(class_->setString3Id);
+    jvm_invoke(jvm_, [this, vr, nvr, values, nValues](JNIEnv* env) {
+        auto vrArray = new_vr_array(env, vr, nvr);
+        auto valueArray = env->NewObjectArray(static_cast<jsize>(nValues), env->FindClass("java/lang/String"), nullptr);
+        for (std::size_t i = 0; i < nValues; i++) {
+            jstring jStr = env->NewStringUTF(values[i]);
+            env->SetObjectArrayElement(valueArray, static_cast<jsize>(i), jStr);
+            env->DeleteLocalRef(jStr);
+        }
+        env->CallVoidMethod(slaveInstance_, class_->setString3Id, vrArray, valueArray);
+        check_values(env, nullptr, nValues, "__setString3__");
+        env->DeleteLocalRef(valueArray);
+        env->DeleteLocalRef(vrArray);
+    });
+}
+
+void SlaveInstance::GetFMUstate(cppfmu::FMIFMUstate& state)
+{
+    if (class_->saveStateId == nullptr) {
+        throw std::logic_error("[FMU4j native] FMU states are not supported by this runtime!");
+    }
+    jvm_invoke(jvm_, [this, &state](JNIEnv* env) {
+        auto previous = static_cast<jobject>(state);
+        jobject captured = previous != nullptr && class_->saveStateIntoId != nullptr
+            ? env->CallObjectMethod(slaveInstance_, class_->saveStateIntoId, previous)
+            : env->CallObjectMethod(slaveInstance_, class_->saveStateId);
+        if (env->ExceptionCheck()) {
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+            throw std::runtime_error("[FMU4j native] saveState() failed!");
+        }
+        // states updated in place keep their global ref
+        if (previous == nullptr || !env->IsSameObject(previous, captured)) {
+            if (previous != nullptr) {
+                env->DeleteGlobalRef(previous);
+            }
+            state = env->NewGlobalRef(captured);
+        }
+        env->DeleteLocalRef(captured);
+    });
+}
+
+void SlaveInstance::SetFMUstate(cppfmu::FMIFMUstate state)
+{
+    if (class_->restoreStateId == nullptr) {
+        throw std::logic_error("[FMU4j native] FMU states are not supported by this runtime!");
+    }
+    jvm_invoke(jvm_, [this, state](JNIEnv* env) {
+        clearStrBuffer(env);
+        env->CallVoidMethod(slaveInstance_, class_->restoreStateId, static_cast<jobject>(state));
+        if (env->ExceptionCheck()) {
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+            throw std::runtime_error("[FMU4j native] restoreState() failed!");
+        }
+    });
+}
+
+void SlaveInstance::FreeFMUstate(cppfmu::FMIFMUstate& state)
+{
+    if (state == nullptr) {
+        return;
+    }
+    jvm_invoke(jvm_, [&state](JNIEnv* env) {
+        env->DeleteGlobalRef(static_cast<jobject>(state));
+    });
+    state = nullptr;
+}
+
+std::size_t SlaveInstance::SerializedFMUstateSize(cppfmu::FMIFMUstate state)
+{
+    if (class_->serializedStateSizeId == nullptr) {
+        throw std::logic_error("[FMU4j native] FMU state serialization is not supported by this runtime!");
+    }
+    jint size = 0;
+    jvm_invoke(jvm_, [this, state, &size](JNIEnv* env) {
+        size = env->CallIntMethod(slaveInstance_, class_->serializedStateSizeId, static_cast<jobject>(state));
+        if (env->ExceptionCheck()) {
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+            throw std::runtime_error("[FMU4j native] serializedStateSize() failed!");
+        }
+    });
+    return static_cast<std::size_t>(size);
+}
+
+void SlaveInstance::SerializeFMUstate(cppfmu::FMIFMUstate state, fmi2Byte* data, std::size_t size)
+{
+    if (class_->serializeStateId == nullptr) {
+        throw std::logic_error("[FMU4j native] FMU state serialization is not supported by this runtime!");
+    }
+    jvm_invoke(jvm_, [this, state, data, size](JNIEnv* env) {
+        jobject buffer = env->NewDirectByteBuffer(data, static_cast<jlong>(size));
+        env->CallVoidMethod(slaveInstance_, class_->serializeStateId, static_cast<jobject>(state), buffer);
+        env->DeleteLocalRef(buffer);
+        if (env->ExceptionCheck()) {
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+            throw std::runtime_error("[FMU4j native] serializeState() failed!");
+        }
     });
 }
 
+void SlaveInstance::DeSerializeFMUstate(const fmi2Byte* data, std::size_t size, cppfmu::FMIFMUstate& state)
+{
+    if (class_->deserializeStateId == nullptr) {
+        throw std::logic_error("[FMU4j native] FMU state serialization is not supported by this runtime!");
+    }
+    jvm_invoke(jvm_, [this, data, size, &state](JNIEnv* env) {
+        // only read from by deserializeState
+        jobject buffer = env->NewDirectByteBuffer(const_cast<fmi2Byte*>(data), static_cast<jlong>(size));
+        jobject restored = env->CallObjectMethod(slaveInstance_, class_->deserializeStateId, buffer);
+        env->DeleteLocalRef(buffer);
+        if (env->ExceptionCheck()) {
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+            throw std::runtime_error("[FMU4j native] deserializeState() failed!");
+        }
+        if (state != nullptr) {
+            env->DeleteGlobalRef(static_cast<jobject>(state));
+        }
+        state = env->NewGlobalRef(restored);
+        env->DeleteLocalRef(restored);
+    });
+}
+
+void SlaveInstance::SetRealInputDerivatives(const cppfmu::FMIValueReference* vr, std::size_t nvr,
+    const cppfmu::FMIInteger* order, const cppfmu::FMIReal* value)
+{
+    if (class_->setRealInputDerivativesId == nullptr) {
+        throw std::logic_error("[FMU4j native] Input derivatives are not supported by this runtime!");
+    }
+    inputDerivatives_.set(vr, nvr, order, value);
+}
+
+void SlaveInstance::flushInputDerivatives(JNIEnv* env)
+{
+    const auto& entries = inputDerivatives_.take();
+    const auto n = static_cast<jsize>(entries.size());
+    std::vector<jlong> vrElements(n);
+    std::vector<jint> orderElements(n);
+    std::vector<jdouble> valueElements(n);
+    for (jsize i = 0; i < n; i++) {
+        vrElements[i] = static_cast<jlong>(entries[i].vr);
+        orderElements[i] = static_cast<jint>(entries[i].order);
+        valueElements[i] = entries[i].value;
+    }
+    auto vrArray = env->NewLongArray(n);
+    auto orderArray = env->NewIntArray(n);
+    auto valueArray = env->NewDoubleArray(n);
+    env->SetLongArrayRegion(vrArray, 0, n, vrElements.data());
+    env->SetIntArrayRegion(orderArray, 0, n, orderElements.data());
+    env->SetDoubleArrayRegion(valueArray, 0, n, valueElements.data());
+    env->CallVoidMethod(slaveInstance_, class_->setRealInputDerivativesId, vrArray, orderArray, valueArray);
+    env->DeleteLocalRef(vrArray);
+    env->DeleteLocalRef(orderArray);
+    env->DeleteLocalRef(valueArray);
+    if (env->ExceptionCheck()) {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+        throw std::runtime_error("[FMU4j native] __setRealInputDerivatives__() failed!");
+    }
+}
+
+bool SlaveInstance::GetRealOutputDerivatives(const cppfmu::FMIValueReference* vr, std::size_t nvr,
+    const cppfmu::FMIInteger* order, cppfmu::FMIReal* value)
+{
+    if (class_->getRealOutputDerivativesId == nullptr) {
+        return false;
+    }
+    bool provided = false;
+    jvm_invoke(jvm_, [this, vr, nvr, order, value, &provided](JNIEnv* env) {
+        auto vrArray = env->NewLongArray(nvr);
+        auto orderArray = env->NewIntArray(nvr);
+        std::vector<jlong> vrElements(vr, vr + nvr);
+        std::vector<jint> orderElements(order, order + nvr);
+        env->SetLongArrayRegion(vrArray, 0, nvr, vrElements.data());
+        env->SetIntArrayRegion(orderArray, 0, nvr, orderElements.data());
+
+        auto valueArray = reinterpret_cast<jdoubleArray>(env->CallObjectMethod(
+            slaveInstance_, class_->getRealOutputDerivativesId, vrArray, orderArray));
+        env->DeleteLocalRef(vrArray);
+        env->DeleteLocalRef(orderArray);
+        if (env->ExceptionCheck()) {
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+            throw std::runtime_error("[FMU4j native] getRealOutputDerivatives() failed!");
+        }
+        if (valueArray != nullptr) {
+            env->GetDoubleArrayRegion(valueArray, 0, nvr, value);
+            env->DeleteLocalRef(valueArray);
+            provided = true;
+        }
+    });
+    return provided;
+}
+
+void SlaveInstance::GetDirectionalDerivatives(
+    const cppfmu::FMIValueReference* unknownVr, std::size_t nUnknown,
+    const cppfmu::FMIValueReference* knownVr, std::size_t nKnown,
+    const cppfmu::FMIReal* seeds, std::size_t nSeeds, cppfmu::FMIReal* derivatives)
+{
+    if (class_->directionalDerivativesId == nullptr) {
+        throw std::logic_error("[FMU4j native] Directional derivatives are not supported by this runtime!");
+    }
+    jvm_invoke(jvm_, [this, unknownVr, nUnknown, knownVr, nKnown, seeds, nSeeds, derivatives](JNIEnv* env) {
+        auto unknownArray = env->NewLongArray(nUnknown);
+        auto knownArray = env->NewLongArray(nKnown);
+        std::vector<jlong> vrElements(std::max(nUnknown, nKnown));
+        for (std::size_t i = 0; i < nUnknown; i++) {
+            vrElements[i] = static_cast<jlong>(unknownVr[i]);
+        }
+        env->SetLongArrayRegion(unknownArray, 0, nUnknown, vrElements.data());
+        for (std::size_t i = 0; i < nKnown; i++) {
+            vrElements[i] = static_cast<jlong>(knownVr[i]);
+        }
+        env->SetLongArrayRegion(knownArray, 0, nKnown, vrElements.data());
+
+        auto seedArray = env->NewDoubleArray(nKnown * nSeeds);
+        env->SetDoubleArrayRegion(seedArray, 0, nKnown * nSeeds, seeds);
+
+        auto derivativeArray = reinterpret_cast<jdoubleArray>(env->CallObjectMethod(
+            slaveInstance_, class_->directionalDerivativesId, unknownArray, knownArray, seedArray));
+        const std::size_t nValues = nUnknown * nSeeds;
+        const bool valid = !env->ExceptionCheck() && derivativeArray != nullptr &&
+            static_cast<std::size_t>(env->GetArrayLength(derivativeArray)) == nValues;
+        if (valid) {
+            env->GetDoubleArrayRegion(derivativeArray, 0, nValues, derivatives);
+        }
+
+        // released before throwing, as the thread may stay attached
+        env->DeleteLocalRef(unknownArray);
+        env->DeleteLocalRef(knownArray);
+        env->DeleteLocalRef(seedArray);
+        env->DeleteLocalRef(derivativeArray);
+
+        if (!valid) {
+            check_values(env, nullptr, nValues, "directionalDerivative");
+            throw std::runtime_error("[FMU4j native] directionalDerivative() did not return " +
+                std::to_string(nValues) + " values!");
+        }
+    });
+}
+
+void SlaveInstance::requireModelExchange() const
+{
+    if (class_->derivativesId == nullptr) {
+        throw std::logic_error("[FMU4j native] Model Exchange is not supported by this runtime!");
+    }
+}
+
+void SlaveInstance::allocateModelExchange(JNIEnv* env)
+{
+    if (statesArray_ != nullptr) {
+        return;
+    }
+    jint nStates = env->CallIntMethod(slaveInstance_, class_->numberOfContinuousStatesId);
+    jint nIndicators = env->CallIntMethod(slaveInstance_, class_->numberOfEventIndicatorsId);
+    check_values(env, nullptr, 0, "__numberOfContinuousStates__");
+    nStates_ = static_cast<std::size_t>(nStates);
+    nIndicators_ = static_cast<std::size_t>(nIndicators);
+    statesArray_ = reinterpret_cast<jdoubleArray>(env->NewGlobalRef(env->NewDoubleArray(nStates)));
+    derivativesArray_ = reinterpret_cast<jdoubleArray>(env->NewGlobalRef(env->NewDoubleArray(nStates)));
+    indicatorsArray_ = reinterpret_cast<jdoubleArray>(env->NewGlobalRef(env->NewDoubleArray(nIndicators)));
+}
+
+void SlaveInstance::allocateModelExchange()
+{
+    if (statesArray_ == nullptr) {
+        jvm_invoke(jvm_, [this](JNIEnv* env) {
+            allocateModelExchange(env);
+        });
+    }
+}
+
+jdoubleArray SlaveInstance::takeStates(JNIEnv* env)
+{
+    timeDirty_ = false;
+    if (!statesDirty_) {
+        return nullptr;
+    }
+    statesDirty_ = false;
+    env->SetDoubleArrayRegion(statesArray_, 0, static_cast<jsize>(states_.size()), states_.data());
+    return statesArray_;
+}
+
+void SlaveInstance::flushStates(JNIEnv* env) const
+{
+    if (!timeDirty_ && !statesDirty_) {
+        return;
+    }
+    jdoubleArray x = nullptr;
+    if (statesDirty_) {
+        x = env->NewDoubleArray(static_cast<jsize>(states_.size()));
+        env->SetDoubleArrayRegion(x, 0, static_cast<jsize>(states_.size()), states_.data());
+    }
+    timeDirty_ = false;
+    statesDirty_ = false;
+    env->CallVoidMethod(slaveInstance_, class_->setContinuousStatesId, time_, x);
+    if (x != nullptr) {
+        env->DeleteLocalRef(x);
+    }
+    check_values(env, nullptr, 0, "__setContinuousStates__");
+}
+
+void SlaveInstance::SetTime(cppfmu::FMIReal time)
+{
+    requireModelExchange();
+    time_ = time;
+    timeDirty_ = true;
+}
+
+void SlaveInstance::SetContinuousStates(const cppfmu::FMIReal* x, std::size_t nx)
+{
+    requireModelExchange();
+    // a mismatch would leave an exception pending when copying the states into the JVM
+    allocateModelExchange();
+    check_count(nx, nStates_, "continuous states");
+    states_.assign(x, x + nx);
+    statesDirty_ = true;
+}
+
+void SlaveInstance::GetContinuousStates(cppfmu::FMIReal* x, std::size_t nx)
+{
+    requireModelExchange();
+    allocateModelExchange();
+    check_count(nx, nStates_, "continuous states");
+    if (statesDirty_) {
+        std::copy(states_.begin(), states_.end(), x);
+        return;
+    }
+    jvm_invoke(jvm_, [this, x, nx](JNIEnv* env) {
+        allocateModelExchange(env);
+        check_values(env, statesArray_, nx, "__getContinuousStates__");
+        env->CallVoidMethod(slaveInstance_, class_->getContinuousStatesId, statesArray_);
+        check_values(env, nullptr, nx, "__getContinuousStates__");
+        env->GetDoubleArrayRegion(statesArray_, 0, static_cast<jsize>(nx), x);
+    });
+}
+
+void SlaveInstance::GetDerivatives(cppfmu::FMIReal* derivatives, std::size_t nx)
+{
+    requireModelExchange();
+    allocateModelExchange();
+    check_count(nx, nStates_, "continuous states");
+    jvm_invoke(jvm_, [this, derivatives, nx](JNIEnv* env) {
+        allocateModelExchange(env);
+        check_values(env, derivativesArray_, nx, "__derivatives__");
+        env->CallVoidMethod(slaveInstance_, class_->derivativesId, time_, takeStates(env), derivativesArray_);
+        check_values(env, nullptr, nx, "__derivatives__");
+        env->GetDoubleArrayRegion(derivativesArray_, 0, static_cast<jsize>(nx), derivatives);
+    });
+}
+
+void SlaveInstance::GetEventIndicators(cppfmu::FMIReal* eventIndicators, std::size_t ni)
+{
+    requireModelExchange();
+    allocateModelExchange();
+    check_count(ni, nIndicators_, "event indicators");
+    jvm_invoke(jvm_, [this, eventIndicators, ni](JNIEnv* env) {
+        allocateModelExchange(env);
+        check_values(env, indicatorsArray_, ni, "__eventIndicators__");
+        env->CallVoidMethod(slaveInstance_, class_->eventIndicatorsId, time_, takeStates(env), indicatorsArray_);
+        check_values(env, nullptr, ni, "__eventIndicators__");
+        env->GetDoubleArrayRegion(indicatorsArray_, 0, static_cast<jsize>(ni), eventIndicators);
+    });
+}
+
+bool SlaveInstance::NewDiscreteStates()
+{
+    requireModelExchange();
+    bool changed = false;
+    jvm_invoke(jvm_, [this, &changed](JNIEnv* env) {
+        allocateModelExchange(env);
+        changed = env->CallBooleanMethod(slaveInstance_, class_->handleEventId, time_, takeStates(env)) == JNI_TRUE;
+        check_values(env, nullptr, 0, "__handleEvent__");
+    });
+    return changed;
+}
+
+void SlaveInstance::GetRealSources(const cppfmu::FMIValueReference* vr, std::size_t nvr, void** sources)
+{
+    if (class_->realSourceId == nullptr) {
+        throw std::logic_error("[FMU4j native] Connections are not supported by this runtime!");
+    }
+    jvm_invoke(jvm_, [this, vr, nvr, sources](JNIEnv* env) {
+        for (std::size_t i = 0; i < nvr; i++) {
+            // one handle per value reference, kept by the slave in a registry shared by all FMUs in the JVM
+            jlong handle = env->CallLongMethod(slaveInstance_, class_->realSourceId, static_cast<jlong>(vr[i]));
+            check_values(env, nullptr, 0, "__realSourceHandle__");
+            realSourcesHandedOut_ = true;
+            sources[i] = reinterpret_cast<void*>(static_cast<std::intptr_t>(handle));
+        }
+    });
+}
+
+void SlaveInstance::ConnectReal(const cppfmu::FMIValueReference* vr, std::size_t nvr, void* const* sources)
+{
+    if (class_->connectRealId == nullptr) {
+        throw std::logic_error("[FMU4j native] Connections are not supported by this runtime!");
+    }
+    jvm_invoke(jvm_, [this, vr, nvr, sources](JNIEnv* env) {
+        for (std::size_t i = 0; i < nvr; i++) {
+            // handles are looked up in the registry rather than dereferenced, unknown ones are rejected
+            auto handle = static_cast<jlong>(reinterpret_cast<std::intptr_t>(sources[i]));
+            env->CallVoidMethod(slaveInstance_, class_->connectRealId, static_cast<jlong>(vr[i]), handle);
+            check_values(env, nullptr, 0, "__connectRealHandle__");
+        }
+    });
+}
+
+cppfmu::FMIReal SlaveInstance::GetPreferredStepSize()
+{
+    if (class_->preferredStepSizeId == nullptr) {
+        return cppfmu::SlaveInstance::GetPreferredStepSize();
+    }
+    jdouble stepSize = 0;
+    jvm_invoke(jvm_, [this, &stepSize](JNIEnv* env) {
+        stepSize = env->CallDoubleMethod(slaveInstance_, class_->preferredStepSizeId);
+    });
+    return stepSize;
+}
+
+void SlaveInstance::GetInstantiationTimings(cppfmu::FMIReal* timings, std::size_t n) const
+{
+    timings_.copy_to(timings, n);
+}
+
+bool SlaveInstance::CanGetAndSetFMUstate() const
+{
+    if (class_->canGetAndSetFMUstateId == nullptr) {
+        return false;
+    }
+    bool capable = false;
+    jvm_invoke(jvm_, [this, &capable](JNIEnv* env) {
+        capable = env->CallBooleanMethod(slaveInstance_, class_->canGetAndSetFMUstateId) == JNI_TRUE;
+    });
+    return capable;
+}
 
 SlaveInstance::~SlaveInstance()
 {
+    if (statesArray_ != nullptr) {
+        jvm_invoke(jvm_, [this](JNIEnv* env) {
+            env->DeleteGlobalRef(statesArray_);
+            env->DeleteGlobalRef(derivativesArray_);
+            env->DeleteGlobalRef(indicatorsArray_);
+        });
+    }
+    if (realSourcesHandedOut_) {
+        // also when parked, so that a later instance reusing the slave is not read by connected inputs
+        jvm_invoke(jvm_, [this](JNIEnv* env) {
+            env->CallVoidMethod(slaveInstance_, class_->releaseRealSourcesId);
+            if (env->ExceptionCheck()) {
+                env->ExceptionDescribe();
+                env->ExceptionClear();
+            }
+        });
+    }
+    jvm_invoke(jvm_, [this](JNIEnv* env) {
+        for (auto cache : {&intVrArrays_, &realVrArrays_, &boolVrArrays_, &strVrArrays_, &intArrays_, &realArrays_, &boolArrays_, &strArrays_}) {
+            for (auto& entry : *cache) {
+                env->DeleteGlobalRef(entry.second);
+            }
+        }
+    });
+    if (park()) {
+        return;
+    }
     onClose();
     jvm_invoke(jvm_, [this](JNIEnv* env) {
         env->DeleteGlobalRef(slaveInstance_);
-
-        jclass URLClassLoader = env->FindClass("java/net/URLClassLoader");
-        jmethodID closeId = env->GetMethodID(URLClassLoader, "close", "()V");
-        env->CallVoidMethod(classLoader_, closeId);
-
-        env->DeleteGlobalRef(classLoader_);
     });
 }
 
@@ -571,13 +1317,30 @@ cppfmu::UniquePtr<cppfmu::SlaveInstance> CppfmuInstantiateSlave(
         resources.replace(0, 6, "");
     }
 
+    fmu4j::InstantiationTimings timings;
+
+    // FMU4J_MODE overrides the mode the FMU was built for
+    const char* modeEnv = std::getenv("FMU4J_MODE");
+    const std::string mode = modeEnv != nullptr ? modeEnv : (fmu4j::prefers_worker(resources) ? "worker" : "jni");
+    if (mode == "daemon" || mode == "worker") {
+        std::unique_ptr<fmu4j::Channel> channel;
+        {
+            fmu4j::PhaseTimer timer(&timings, fmu4j::Phase::jvm);
+            channel = mode == "daemon" ? fmu4j::connect_daemon(resources) : fmu4j::connect_worker(resources);
+        }
+        return cppfmu::AllocateUnique<fmu4j::RemoteSlaveInstance>(memory, std::move(channel), instanceName, logger, timings);
+    }
+
     JNIEnv* env;
     JavaVM* jvm;
-    env = get_or_create_jvm(&jvm);
+    {
+        fmu4j::PhaseTimer timer(&timings, fmu4j::Phase::jvm);
+        env = get_or_create_jvm(&jvm);
+    }
 
     if (env == nullptr) {
         throw cppfmu::FatalError("Unable to setup the JVM!");
     }
 
-    return cppfmu::AllocateUnique<fmu4j::SlaveInstance>(memory, env, instanceName, resources);
+    return cppfmu::AllocateUnique<fmu4j::SlaveInstance>(memory, env, instanceName, resources, logger, timings);
 }
@@ -0,0 +1,70 @@
+#include <fmu4j/ValueReferenceTable.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace fmu4j
+{
+
+void ValueReferenceTable::assign(const std::vector<cppfmu::FMIValueReference>& ranges)
+{
+    dense_.clear();
+    ranges_.clear();
+    std::vector<range> sorted;
+    for (std::size_t i = 0; i + 1 < ranges.size(); i += 2) {
+        auto start = ranges[i];
+        auto count = ranges[i + 1];
+        auto slot = static_cast<long>(i / 2);
+        if (count == 1 && start < DENSE_LIMIT) {
+            if (start >= dense_.size()) {
+                dense_.resize(start + 1, -1);
+            }
+            // aliases resolve to the first variable registered
+            if (dense_[start] < 0) {
+                dense_[start] = slot;
+            }
+        } else if (count > 0) {
+            sorted.push_back({start, static_cast<std::uint64_t>(start) + count, slot});
+        }
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const range& a, const range& b) {
+        return a.start < b.start;
+    });
+    // overlapping parts belong to the range starting first, only checking for a slot is exact then
+    for (auto r : sorted) {
+        if (!ranges_.empty() && r.start < ranges_.back().end) {
+            if (r.end <= ranges_.back().end) {
+                continue;
+            }
+            r.start = ranges_.back().end;
+        }
+        ranges_.push_back(r);
+    }
+    loaded_ = true;
+}
+
+long ValueReferenceTable::slot(cppfmu::FMIValueReference vr) const
+{
+    if (vr < dense_.size() && dense_[vr] >= 0) {
+        return dense_[vr];
+    }
+    // the first range ending after vr
+    auto it = std::upper_bound(ranges_.begin(), ranges_.end(), static_cast<std::uint64_t>(vr),
+        [](std::uint64_t ref, const range& r) { return ref < r.end; });
+    return it != ranges_.end() && it->start <= vr ? it->slot : -1;
+}
+
+void ValueReferenceTable::check(const cppfmu::FMIValueReference* vr, std::size_t nvr) const
+{
+    if (!loaded_) {
+        return;
+    }
+    for (std::size_t i = 0; i < nvr; i++) {
+        if (slot(vr[i]) < 0) {
+            throw std::logic_error("[FMU4j native] No such variable with valueReference " + std::to_string(vr[i]) + "!");
+        }
+    }
+}
+
+} // namespace fmu4j
@@ -0,0 +1,218 @@
+#include <fmu4j/Worker.hpp>
+
+#include <fmu4j/SharedMemoryChannel.hpp>
+#include <fmu4j/process.hpp>
+#include <cppfmu/cppfmu_cs.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace fmu4j
+{
+
+namespace
+{
+
+const char* WORKER_CLASS = "no.ntnu.ais.fmu4j.export.remote.SlaveWorker";
+const char* WORKER_OPTIONS = "/worker-options.txt";
+
+// Size of each ring, larger messages are streamed through in chunks.
+const std::size_t CHANNEL_CAPACITY = 256 * 1024;
+
+const int SHUTDOWN_TIMEOUT_MS = 5000;
+
+std::string unique_region_name()
+{
+    static std::atomic<int> counter{0};
+    return "fmu4j-" + std::to_string(current_process_id()) + "-" + std::to_string(counter++);
+}
+
+std::size_t worker_group_size()
+{
+    static const std::size_t size = [] {
+        const char* value = std::getenv("FMU4J_WORKER_GROUP_SIZE");
+        return value != nullptr ? static_cast<std::size_t>(std::strtoul(value, nullptr, 10)) : 0;
+    }();
+    return size;
+}
+
+std::vector<std::string> worker_options(const std::string& resources)
+{
+    auto options = split_options(std::getenv("FMU4J_WORKER_OPTIONS"));
+    std::ifstream infile(resources + WORKER_OPTIONS);
+    std::string line;
+    while (std::getline(infile, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            options.push_back(line);
+        }
+    }
+    return options;
+}
+
+// A child JVM running SlaveWorker, shut down once its last session has been released.
+class Worker
+{
+public:
+    explicit Worker(const std::string& resources)
+    {
+        const std::string controlName = unique_region_name();
+        control_ = SharedMemoryChannel::create(controlName, CHANNEL_CAPACITY);
+
+        std::vector<std::string> args{java_executable()};
+        for (auto& option : worker_options(resources)) {
+            args.push_back(option);
+        }
+        args.insert(args.end(), {"-cp", fmu_classpath(resources), WORKER_CLASS, library_path(), resources, controlName});
+        pid_ = spawn_process(args, false);
+        control_->watch(pid_);
+
+        // the worker announces itself once attached, a failing launch is detected through its pid
+        std::vector<uint8_t> ready;
+        control_->receive(ready);
+        control_->unlink();
+    }
+
+    std::unique_ptr<Channel> open_session()
+    {
+        const std::string name = unique_region_name();
+        auto channel = SharedMemoryChannel::create(name, CHANNEL_CAPACITY);
+        channel->watch(pid_);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        MessageWriter request;
+        request.begin(op::OPEN_SESSION).put(name);
+        std::vector<uint8_t> reply;
+        control_->send(request.data);
+        control_->receive(reply);
+        MessageReader reader(reply);
+        if (reader.get<int32_t>() != STATUS_OK) {
+            std::string msg = "[FMU4j native] The fmu4j worker was unable to open a session: " + reader.getString();
+            throw cppfmu::FatalError(msg.c_str());
+        }
+        channel->unlink();
+        return std::unique_ptr<Channel>(channel.release());
+    }
+
+    // Claims room for a session, returning false if the worker is full.
+    bool reserve(std::size_t groupSize)
+    {
+        if (groupSize != 0 && sessions_ >= groupSize) {
+            return false;
+        }
+        sessions_++;
+        return true;
+    }
+
+    void release()
+    {
+        sessions_--;
+    }
+
+    ~Worker()
+    {
+        try {
+            MessageWriter request;
+            request.begin(op::SHUTDOWN);
+            std::vector<uint8_t> reply;
+            control_->send(request.data);
+            control_->receive(reply);
+        } catch (const cppfmu::FatalError&) {
+            // already gone
+        }
+        control_.reset();
+        if (!wait_process(pid_, SHUTDOWN_TIMEOUT_MS)) {
+            // e.g. a session thread stuck in slave code
+            kill_process(pid_);
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::unique_ptr<SharedMemoryChannel> control_;
+    long pid_ = 0;
+    std::atomic<std::size_t> sessions_{0};
+};
+
+// A session channel keeping its worker alive.
+class WorkerChannel : public Channel
+{
+public:
+    WorkerChannel(std::shared_ptr<Worker> worker, std::unique_ptr<Channel> channel)
+        : worker_(std::move(worker))
+        , channel_(std::move(channel))
+    { }
+
+    void send(const std::vector<uint8_t>& message) override
+    {
+        channel_->send(message);
+    }
+
+    void receive(std::vector<uint8_t>& message) override
+    {
+        channel_->receive(message);
+    }
+
+    ~WorkerChannel() override
+    {
+        // the session goes first, so that the worker has nothing left to serve when shut down
+        channel_.reset();
+        worker_->release();
+    }
+
+private:
+    std::shared_ptr<Worker> worker_;
+    std::unique_ptr<Channel> channel_;
+};
+
+std::mutex workersMutex;
+std::map<std::string, std::vector<std::weak_ptr<Worker>>> workers;
+
+std::shared_ptr<Worker> acquire_worker(const std::string& resources)
+{
+    std::lock_guard<std::mutex> lock(workersMutex);
+    auto& group = workers[resources];
+    const std::size_t groupSize = worker_group_size();
+    for (auto it = group.begin(); it != group.end();) {
+        if (auto worker = it->lock()) {
+            if (worker->reserve(groupSize)) {
+                return worker;
+            }
+            ++it;
+        } else {
+            it = group.erase(it);
+        }
+    }
+    auto worker = std::make_shared<Worker>(resources);
+    worker->reserve(groupSize);
+    group.push_back(worker);
+    return worker;
+}
+
+} // namespace
+
+std::unique_ptr<Channel> connect_worker(const std::string& resources)
+{
+    auto worker = acquire_worker(resources);
+    std::unique_ptr<Channel> channel;
+    try {
+        channel = worker->open_session();
+    } catch (...) {
+        worker->release();
+        throw;
+    }
+    return std::unique_ptr<Channel>(new WorkerChannel(std::move(worker), std::move(channel)));
+}
+
+bool prefers_worker(const std::string& resources)
+{
+    return static_cast<bool>(std::ifstream(resources + WORKER_OPTIONS));
+}
+
+} // namespace fmu4j
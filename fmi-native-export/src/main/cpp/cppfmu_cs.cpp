@@ -4,6 +4,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 #include <cppfmu/cppfmu_cs.hpp>
+#include <limits>
 #include <stdexcept>
 
 
@@ -155,6 +156,245 @@ void SlaveInstance::GetAll(
 }
 
 
+void SlaveInstance::GetFMUstate(FMIFMUstate& /*state*/)
+{
+    throw std::logic_error("FMI function not supported: fmi2GetFMUstate");
+}
+
+
+void SlaveInstance::SetFMUstate(FMIFMUstate /*state*/)
+{
+    throw std::logic_error("FMI function not supported: fmi2SetFMUstate");
+}
+
+
+void SlaveInstance::FreeFMUstate(FMIFMUstate& /*state*/)
+{
+    throw std::logic_error("FMI function not supported: fmi2FreeFMUstate");
+}
+
+
+std::size_t SlaveInstance::SerializedFMUstateSize(FMIFMUstate /*state*/)
+{
+    throw std::logic_error("FMI function not supported: fmi2SerializedFMUstateSize");
+}
+
+
+void SlaveInstance::SerializeFMUstate(
+    FMIFMUstate /*state*/,
+    fmi2Byte /*data*/[],
+    std::size_t /*size*/)
+{
+    throw std::logic_error("FMI function not supported: fmi2SerializeFMUstate");
+}
+
+
+void SlaveInstance::DeSerializeFMUstate(
+    const fmi2Byte /*data*/[],
+    std::size_t /*size*/,
+    FMIFMUstate& /*state*/)
+{
+    throw std::logic_error("FMI function not supported: fmi2DeSerializeFMUstate");
+}
+
+
+void SlaveInstance::SetFloat64(
+    const FMIValueReference /*vr*/[],
+    std::size_t /*nvr*/,
+    const double /*values*/[],
+    std::size_t /*nValues*/)
+{
+    throw std::logic_error("FMI function not supported: fmi3SetFloat64");
+}
+
+
+void SlaveInstance::SetInt32(
+    const FMIValueReference /*vr*/[],
+    std::size_t /*nvr*/,
+    const std::int32_t /*values*/[],
+    std::size_t /*nValues*/)
+{
+    throw std::logic_error("FMI function not supported: fmi3SetInt32");
+}
+
+
+void SlaveInstance::SetBool(
+    const FMIValueReference /*vr*/[],
+    std::size_t /*nvr*/,
+    const bool /*values*/[],
+    std::size_t /*nValues*/)
+{
+    throw std::logic_error("FMI function not supported: fmi3SetBoolean");
+}
+
+
+void SlaveInstance::SetUtf8String(
+    const FMIValueReference /*vr*/[],
+    std::size_t /*nvr*/,
+    const char* const /*values*/[],
+    std::size_t /*nValues*/)
+{
+    throw std::logic_error("FMI function not supported: fmi3SetString");
+}
+
+
+void SlaveInstance::GetFloat64(
+    const FMIValueReference /*vr*/[],
+    std::size_t /*nvr*/,
+    double /*values*/[],
+    std::size_t /*nValues*/) const
+{
+    throw std::logic_error("FMI function not supported: fmi3GetFloat64");
+}
+
+
+void SlaveInstance::GetInt32(
+    const FMIValueReference /*vr*/[],
+    std::size_t /*nvr*/,
+    std::int32_t /*values*/[],
+    std::size_t /*nValues*/) const
+{
+    throw std::logic_error("FMI function not supported: fmi3GetInt32");
+}
+
+
+void SlaveInstance::GetBool(
+    const FMIValueReference /*vr*/[],
+    std::size_t /*nvr*/,
+    bool /*values*/[],
+    std::size_t /*nValues*/) const
+{
+    throw std::logic_error("FMI function not supported: fmi3GetBoolean");
+}
+
+
+void SlaveInstance::GetUtf8String(
+    const FMIValueReference /*vr*/[],
+    std::size_t /*nvr*/,
+    const char* /*values*/[],
+    std::size_t /*nValues*/) const
+{
+    throw std::logic_error("FMI function not supported: fmi3GetString");
+}
+
+
+void SlaveInstance::SetRealInputDerivatives(
+    const FMIValueReference /*vr*/[],
+    std::size_t /*nvr*/,
+    const FMIInteger /*order*/[],
+    const FMIReal /*value*/[])
+{
+    throw std::logic_error("FMI function not supported: fmi2SetRealInputDerivatives");
+}
+
+
+bool SlaveInstance::GetRealOutputDerivatives(
+    const FMIValueReference /*vr*/[],
+    std::size_t /*nvr*/,
+    const FMIInteger /*order*/[],
+    FMIReal /*value*/[])
+{
+    return false;
+}
+
+
+void SlaveInstance::GetDirectionalDerivatives(
+    const FMIValueReference /*unknownVr*/[],
+    std::size_t /*nUnknown*/,
+    const FMIValueReference /*knownVr*/[],
+    std::size_t /*nKnown*/,
+    const FMIReal /*seeds*/[],
+    std::size_t /*nSeeds*/,
+    FMIReal /*derivatives*/[])
+{
+    throw std::logic_error("FMI function not supported: fmi2GetDirectionalDerivative");
+}
+
+
+void SlaveInstance::SetTime(FMIReal /*time*/)
+{
+    throw std::logic_error("FMI function not supported: fmi2SetTime");
+}
+
+
+void SlaveInstance::SetContinuousStates(
+    const FMIReal /*x*/[],
+    std::size_t /*nx*/)
+{
+    throw std::logic_error("FMI function not supported: fmi2SetContinuousStates");
+}
+
+
+void SlaveInstance::GetContinuousStates(
+    FMIReal /*x*/[],
+    std::size_t /*nx*/)
+{
+    throw std::logic_error("FMI function not supported: fmi2GetContinuousStates");
+}
+
+
+void SlaveInstance::GetDerivatives(
+    FMIReal /*derivatives*/[],
+    std::size_t /*nx*/)
+{
+    throw std::logic_error("FMI function not supported: fmi2GetDerivatives");
+}
+
+
+void SlaveInstance::GetEventIndicators(
+    FMIReal /*eventIndicators*/[],
+    std::size_t /*ni*/)
+{
+    throw std::logic_error("FMI function not supported: fmi2GetEventIndicators");
+}
+
+
+bool SlaveInstance::NewDiscreteStates()
+{
+    return false;
+}
+
+
+void SlaveInstance::GetRealSources(
+    const FMIValueReference /*vr*/[],
+    std::size_t /*nvr*/,
+    void* /*sources*/[])
+{
+    throw std::logic_error("FMI function not supported: fmi2GetRealSources");
+}
+
+
+void SlaveInstance::ConnectReal(
+    const FMIValueReference /*vr*/[],
+    std::size_t /*nvr*/,
+    void* const /*sources*/[])
+{
+    throw std::logic_error("FMI function not supported: fmi2ConnectReal");
+}
+
+
+FMIReal SlaveInstance::GetPreferredStepSize()
+{
+    return std::numeric_limits<FMIReal>::quiet_NaN();
+}
+
+
+void SlaveInstance::GetInstantiationTimings(
+    FMIReal timings[],
+    std::size_t n) const
+{
+    for (std::size_t i = 0; i < n; i++) {
+        timings[i] = 0.0;
+    }
+}
+
+
+bool SlaveInstance::CanGetAndSetFMUstate() const
+{
+    return false;
+}
+
+
 SlaveInstance::~SlaveInstance() CPPFMU_NOEXCEPT
 {
     // Do nothing
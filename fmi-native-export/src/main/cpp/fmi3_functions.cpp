@@ -0,0 +1,1124 @@
+/* FMI 3.0 co-simulation entry points.
+ * Instances are backed by the same cppfmu::SlaveInstance as the FMI 2.0 functions,
+ * with the FMI 3.0 callbacks adapted to the FMI 2.0 ones expected by cppfmu.
+ */
+#include "cppfmu/cppfmu_cs.hpp"
+
+extern "C" {
+#include <fmi/fmi3Functions.h>
+}
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <vector>
+
+
+namespace
+{
+
+void* allocate_memory(size_t nObj, size_t size)
+{
+    return std::calloc(nObj, size);
+}
+
+void free_memory(void* obj)
+{
+    std::free(obj);
+}
+
+// A struct that holds all the data for one FMI 3.0 model instance.
+struct Instance
+{
+    Instance(
+        fmi3String instanceName,
+        fmi3Boolean loggingOn,
+        fmi3Boolean earlyReturnAllowed,
+        fmi3InstanceEnvironment instanceEnvironment,
+        fmi3LogMessageCallback logMessage)
+        : callbackFunctions{&Instance::log, &allocate_memory, &free_memory, nullptr, nullptr}
+        , memory{callbackFunctions}
+        , loggerSettings{std::make_shared<cppfmu::Logger::Settings>(memory)}
+        , logger{this, cppfmu::CopyString(memory, instanceName), callbackFunctions, loggerSettings}
+        , earlyReturnAllowed{earlyReturnAllowed}
+        , instanceEnvironment{instanceEnvironment}
+        , logMessage{logMessage}
+    {
+        loggerSettings->debugLoggingEnabled = loggingOn;
+    }
+
+    // General
+    cppfmu::FMICallbackFunctions callbackFunctions;
+    cppfmu::Memory memory;
+    std::shared_ptr<cppfmu::Logger::Settings> loggerSettings;
+    cppfmu::Logger logger;
+
+    // Co-simulation
+    cppfmu::UniquePtr<cppfmu::SlaveInstance> slave;
+    bool earlyReturnAllowed;
+
+    fmi3InstanceEnvironment instanceEnvironment;
+    fmi3LogMessageCallback logMessage;
+
+    // Formats the message and forwards it to the fmi3LogMessageCallback of the instance passed by cppfmu::Logger.
+    static void log(fmi2ComponentEnvironment env, fmi2String, fmi2Status status, fmi2String category, fmi2String message, ...)
+    {
+        const auto instance = static_cast<Instance*>(env);
+        if (instance->logMessage == nullptr) {
+            return;
+        }
+        char buffer[1024];
+        va_list args;
+        va_start(args, message);
+        std::vsnprintf(buffer, sizeof(buffer), message, args);
+        va_end(args);
+        instance->logMessage(instance->instanceEnvironment, static_cast<fmi3Status>(status), category, buffer);
+    }
+};
+
+fmi3Status unsupported(fmi3Instance instance, const char* function)
+{
+    reinterpret_cast<Instance*>(instance)->logger.Log(
+        fmi2Error,
+        "cppfmu",
+        "FMI function not supported: %s",
+        function);
+    return fmi3Error;
+}
+
+} // namespace
+
+
+// FMI functions
+extern "C" {
+
+// =============================================================================
+// FMI 3.0 functions
+// =============================================================================
+
+
+const char* fmi3GetVersion()
+{
+    return fmi3Version;
+}
+
+
+fmi3Status fmi3SetDebugLogging(
+    fmi3Instance instance,
+    fmi3Boolean loggingOn,
+    size_t nCategories,
+    const fmi3String categories[])
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+
+    std::vector<cppfmu::String, cppfmu::Allocator<cppfmu::String>> newCategories(
+        cppfmu::Allocator<cppfmu::String>(component->memory));
+    for (size_t i = 0; i < nCategories; ++i) {
+        newCategories.push_back(cppfmu::CopyString(component->memory, categories[i]));
+    }
+
+    component->loggerSettings->debugLoggingEnabled = loggingOn;
+    component->loggerSettings->loggedCategories.swap(newCategories);
+    return fmi3OK;
+}
+
+
+fmi3Instance fmi3InstantiateModelExchange(
+    fmi3String,
+    fmi3String,
+    fmi3String,
+    fmi3Boolean,
+    fmi3Boolean,
+    fmi3InstanceEnvironment instanceEnvironment,
+    fmi3LogMessageCallback logMessage)
+{
+    if (logMessage != nullptr) {
+        logMessage(instanceEnvironment, fmi3Error, "",
+            "Unsupported FMU instance type requested (only co-simulation is supported)");
+    }
+    return nullptr;
+}
+
+
+fmi3Instance fmi3InstantiateCoSimulation(
+    fmi3String instanceName,
+    fmi3String instantiationToken,
+    fmi3String resourcePath,
+    fmi3Boolean visible,
+    fmi3Boolean loggingOn,
+    fmi3Boolean,
+    fmi3Boolean earlyReturnAllowed,
+    const fmi3ValueReference[],
+    size_t,
+    fmi3InstanceEnvironment instanceEnvironment,
+    fmi3LogMessageCallback logMessage,
+    fmi3IntermediateUpdateCallback)
+{
+    auto component = new Instance(instanceName, loggingOn, earlyReturnAllowed, instanceEnvironment, logMessage);
+    try {
+        // unlike the file URI of FMI 2.0, FMI 3.0 passes the resources as a plain path
+        component->slave = CppfmuInstantiateSlave(
+            instanceName,
+            instantiationToken,
+            resourcePath != nullptr ? resourcePath : "",
+            "application/x-fmu-sharedlibrary",
+            0.0,
+            visible ? cppfmu::FMITrue : cppfmu::FMIFalse,
+            cppfmu::FMIFalse,
+            component->memory,
+            component->logger);
+        return component;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+    }
+    delete component;
+    return nullptr;
+}
+
+
+fmi3Instance fmi3InstantiateScheduledExecution(
+    fmi3String,
+    fmi3String,
+    fmi3String,
+    fmi3Boolean,
+    fmi3Boolean,
+    fmi3InstanceEnvironment instanceEnvironment,
+    fmi3LogMessageCallback logMessage,
+    fmi3ClockUpdateCallback,
+    fmi3LockPreemptionCallback,
+    fmi3UnlockPreemptionCallback)
+{
+    if (logMessage != nullptr) {
+        logMessage(instanceEnvironment, fmi3Error, "",
+            "Unsupported FMU instance type requested (only co-simulation is supported)");
+    }
+    return nullptr;
+}
+
+
+void fmi3FreeInstance(fmi3Instance instance)
+{
+    delete reinterpret_cast<Instance*>(instance);
+}
+
+
+fmi3Status fmi3EnterInitializationMode(
+    fmi3Instance instance,
+    fmi3Boolean toleranceDefined,
+    fmi3Float64 tolerance,
+    fmi3Float64 startTime,
+    fmi3Boolean stopTimeDefined,
+    fmi3Float64 stopTime)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        // FMI 3.0 folds fmi2SetupExperiment into fmi3EnterInitializationMode
+        component->slave->SetupExperiment(
+            toleranceDefined ? cppfmu::FMITrue : cppfmu::FMIFalse,
+            tolerance,
+            startTime,
+            stopTimeDefined ? cppfmu::FMITrue : cppfmu::FMIFalse,
+            stopTime);
+        component->slave->EnterInitializationMode();
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3ExitInitializationMode(fmi3Instance instance)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->ExitInitializationMode();
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3EnterStepMode(fmi3Instance)
+{
+    return fmi3OK;
+}
+
+
+fmi3Status fmi3Terminate(fmi3Instance instance)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->Terminate();
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3Reset(fmi3Instance instance)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->Reset();
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3GetFloat64(
+    fmi3Instance instance,
+    const fmi3ValueReference valueReferences[],
+    size_t nValueReferences,
+    fmi3Float64 values[],
+    size_t nValues)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->GetFloat64(valueReferences, nValueReferences, values, nValues);
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3GetInt32(
+    fmi3Instance instance,
+    const fmi3ValueReference valueReferences[],
+    size_t nValueReferences,
+    fmi3Int32 values[],
+    size_t nValues)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->GetInt32(valueReferences, nValueReferences, values, nValues);
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3GetBoolean(
+    fmi3Instance instance,
+    const fmi3ValueReference valueReferences[],
+    size_t nValueReferences,
+    fmi3Boolean values[],
+    size_t nValues)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->GetBool(valueReferences, nValueReferences, values, nValues);
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3GetString(
+    fmi3Instance instance,
+    const fmi3ValueReference valueReferences[],
+    size_t nValueReferences,
+    fmi3String values[],
+    size_t nValues)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->GetUtf8String(valueReferences, nValueReferences, values, nValues);
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3SetFloat64(
+    fmi3Instance instance,
+    const fmi3ValueReference valueReferences[],
+    size_t nValueReferences,
+    const fmi3Float64 values[],
+    size_t nValues)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->SetFloat64(valueReferences, nValueReferences, values, nValues);
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3SetInt32(
+    fmi3Instance instance,
+    const fmi3ValueReference valueReferences[],
+    size_t nValueReferences,
+    const fmi3Int32 values[],
+    size_t nValues)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->SetInt32(valueReferences, nValueReferences, values, nValues);
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3SetBoolean(
+    fmi3Instance instance,
+    const fmi3ValueReference valueReferences[],
+    size_t nValueReferences,
+    const fmi3Boolean values[],
+    size_t nValues)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->SetBool(valueReferences, nValueReferences, values, nValues);
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3SetString(
+    fmi3Instance instance,
+    const fmi3ValueReference valueReferences[],
+    size_t nValueReferences,
+    const fmi3String values[],
+    size_t nValues)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->SetUtf8String(valueReferences, nValueReferences, values, nValues);
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3GetFMUState(
+    fmi3Instance instance,
+    fmi3FMUState* FMUState)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->GetFMUstate(*FMUState);
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3SetFMUState(
+    fmi3Instance instance,
+    fmi3FMUState FMUState)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->SetFMUstate(FMUState);
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3FreeFMUState(
+    fmi3Instance instance,
+    fmi3FMUState* FMUState)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->FreeFMUstate(*FMUState);
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3SerializedFMUStateSize(
+    fmi3Instance instance,
+    fmi3FMUState FMUState,
+    size_t* size)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        *size = component->slave->SerializedFMUstateSize(FMUState);
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3SerializeFMUState(
+    fmi3Instance instance,
+    fmi3FMUState FMUState,
+    fmi3Byte serializedState[],
+    size_t size)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->SerializeFMUstate(FMUState, reinterpret_cast<fmi2Byte*>(serializedState), size);
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3DeserializeFMUState(
+    fmi3Instance instance,
+    const fmi3Byte serializedState[],
+    size_t size,
+    fmi3FMUState* FMUState)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    try {
+        component->slave->DeSerializeFMUstate(reinterpret_cast<const fmi2Byte*>(serializedState), size, *FMUState);
+        return fmi3OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+fmi3Status fmi3DoStep(
+    fmi3Instance instance,
+    fmi3Float64 currentCommunicationPoint,
+    fmi3Float64 communicationStepSize,
+    fmi3Boolean,
+    fmi3Boolean* eventHandlingNeeded,
+    fmi3Boolean* terminateSimulation,
+    fmi3Boolean* earlyReturn,
+    fmi3Float64* lastSuccessfulTime)
+{
+    const auto component = reinterpret_cast<Instance*>(instance);
+    *eventHandlingNeeded = fmi3False;
+    *terminateSimulation = fmi3False;
+    *earlyReturn = fmi3False;
+    try {
+        double endTime = currentCommunicationPoint;
+        const auto ok = component->slave->DoStep(
+            currentCommunicationPoint,
+            communicationStepSize,
+            cppfmu::FMITrue,
+            endTime);
+        if (ok) {
+            *lastSuccessfulTime = currentCommunicationPoint + communicationStepSize;
+            return fmi3OK;
+        }
+        *lastSuccessfulTime = endTime;
+        if (endTime > currentCommunicationPoint && component->earlyReturnAllowed) {
+            // ended early at an event, which FMI 3.0 reports as a successful early return
+            *earlyReturn = fmi3True;
+            return fmi3OK;
+        }
+        return fmi3Discard;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi3Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi3Error;
+    }
+}
+
+
+// =============================================================================
+// Unsupported FMI 3.0 functions
+// =============================================================================
+
+
+fmi3Status fmi3EnterEventMode(
+    fmi3Instance instance)
+{
+    return unsupported(instance, "fmi3EnterEventMode");
+}
+
+
+fmi3Status fmi3GetFloat32(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    fmi3Float32[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetFloat32");
+}
+
+
+fmi3Status fmi3GetInt8(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    fmi3Int8[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetInt8");
+}
+
+
+fmi3Status fmi3GetUInt8(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    fmi3UInt8[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetUInt8");
+}
+
+
+fmi3Status fmi3GetInt16(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    fmi3Int16[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetInt16");
+}
+
+
+fmi3Status fmi3GetUInt16(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    fmi3UInt16[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetUInt16");
+}
+
+
+fmi3Status fmi3GetUInt32(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    fmi3UInt32[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetUInt32");
+}
+
+
+fmi3Status fmi3GetInt64(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    fmi3Int64[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetInt64");
+}
+
+
+fmi3Status fmi3GetUInt64(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    fmi3UInt64[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetUInt64");
+}
+
+
+fmi3Status fmi3GetBinary(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    size_t[],
+    fmi3Binary[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetBinary");
+}
+
+
+fmi3Status fmi3GetClock(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    fmi3Clock[])
+{
+    return unsupported(instance, "fmi3GetClock");
+}
+
+
+fmi3Status fmi3SetFloat32(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3Float32[],
+    size_t)
+{
+    return unsupported(instance, "fmi3SetFloat32");
+}
+
+
+fmi3Status fmi3SetInt8(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3Int8[],
+    size_t)
+{
+    return unsupported(instance, "fmi3SetInt8");
+}
+
+
+fmi3Status fmi3SetUInt8(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3UInt8[],
+    size_t)
+{
+    return unsupported(instance, "fmi3SetUInt8");
+}
+
+
+fmi3Status fmi3SetInt16(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3Int16[],
+    size_t)
+{
+    return unsupported(instance, "fmi3SetInt16");
+}
+
+
+fmi3Status fmi3SetUInt16(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3UInt16[],
+    size_t)
+{
+    return unsupported(instance, "fmi3SetUInt16");
+}
+
+
+fmi3Status fmi3SetUInt32(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3UInt32[],
+    size_t)
+{
+    return unsupported(instance, "fmi3SetUInt32");
+}
+
+
+fmi3Status fmi3SetInt64(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3Int64[],
+    size_t)
+{
+    return unsupported(instance, "fmi3SetInt64");
+}
+
+
+fmi3Status fmi3SetUInt64(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3UInt64[],
+    size_t)
+{
+    return unsupported(instance, "fmi3SetUInt64");
+}
+
+
+fmi3Status fmi3SetBinary(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const size_t[],
+    const fmi3Binary[],
+    size_t)
+{
+    return unsupported(instance, "fmi3SetBinary");
+}
+
+
+fmi3Status fmi3SetClock(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3Clock[])
+{
+    return unsupported(instance, "fmi3SetClock");
+}
+
+
+fmi3Status fmi3GetNumberOfVariableDependencies(
+    fmi3Instance instance,
+    fmi3ValueReference,
+    size_t*)
+{
+    return unsupported(instance, "fmi3GetNumberOfVariableDependencies");
+}
+
+
+fmi3Status fmi3GetVariableDependencies(
+    fmi3Instance instance,
+    fmi3ValueReference,
+    size_t[],
+    fmi3ValueReference[],
+    size_t[],
+    fmi3DependencyKind[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetVariableDependencies");
+}
+
+
+fmi3Status fmi3GetDirectionalDerivative(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3Float64[],
+    size_t,
+    fmi3Float64[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetDirectionalDerivative");
+}
+
+
+fmi3Status fmi3GetAdjointDerivative(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3Float64[],
+    size_t,
+    fmi3Float64[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetAdjointDerivative");
+}
+
+
+fmi3Status fmi3EnterConfigurationMode(
+    fmi3Instance instance)
+{
+    return unsupported(instance, "fmi3EnterConfigurationMode");
+}
+
+
+fmi3Status fmi3ExitConfigurationMode(
+    fmi3Instance instance)
+{
+    return unsupported(instance, "fmi3ExitConfigurationMode");
+}
+
+
+fmi3Status fmi3GetIntervalDecimal(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    fmi3Float64[],
+    fmi3IntervalQualifier[])
+{
+    return unsupported(instance, "fmi3GetIntervalDecimal");
+}
+
+
+fmi3Status fmi3GetIntervalFraction(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    fmi3UInt64[],
+    fmi3UInt64[],
+    fmi3IntervalQualifier[])
+{
+    return unsupported(instance, "fmi3GetIntervalFraction");
+}
+
+
+fmi3Status fmi3GetShiftDecimal(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    fmi3Float64[])
+{
+    return unsupported(instance, "fmi3GetShiftDecimal");
+}
+
+
+fmi3Status fmi3GetShiftFraction(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    fmi3UInt64[],
+    fmi3UInt64[])
+{
+    return unsupported(instance, "fmi3GetShiftFraction");
+}
+
+
+fmi3Status fmi3SetIntervalDecimal(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3Float64[])
+{
+    return unsupported(instance, "fmi3SetIntervalDecimal");
+}
+
+
+fmi3Status fmi3SetIntervalFraction(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3UInt64[],
+    const fmi3UInt64[])
+{
+    return unsupported(instance, "fmi3SetIntervalFraction");
+}
+
+
+fmi3Status fmi3SetShiftDecimal(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3Float64[])
+{
+    return unsupported(instance, "fmi3SetShiftDecimal");
+}
+
+
+fmi3Status fmi3SetShiftFraction(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3UInt64[],
+    const fmi3UInt64[])
+{
+    return unsupported(instance, "fmi3SetShiftFraction");
+}
+
+
+fmi3Status fmi3EvaluateDiscreteStates(
+    fmi3Instance instance)
+{
+    return unsupported(instance, "fmi3EvaluateDiscreteStates");
+}
+
+
+fmi3Status fmi3UpdateDiscreteStates(
+    fmi3Instance instance,
+    fmi3Boolean*,
+    fmi3Boolean*,
+    fmi3Boolean*,
+    fmi3Boolean*,
+    fmi3Boolean*,
+    fmi3Float64*)
+{
+    return unsupported(instance, "fmi3UpdateDiscreteStates");
+}
+
+
+fmi3Status fmi3EnterContinuousTimeMode(
+    fmi3Instance instance)
+{
+    return unsupported(instance, "fmi3EnterContinuousTimeMode");
+}
+
+
+fmi3Status fmi3CompletedIntegratorStep(
+    fmi3Instance instance,
+    fmi3Boolean,
+    fmi3Boolean*,
+    fmi3Boolean*)
+{
+    return unsupported(instance, "fmi3CompletedIntegratorStep");
+}
+
+
+fmi3Status fmi3SetTime(
+    fmi3Instance instance,
+    fmi3Float64)
+{
+    return unsupported(instance, "fmi3SetTime");
+}
+
+
+fmi3Status fmi3SetContinuousStates(
+    fmi3Instance instance,
+    const fmi3Float64[],
+    size_t)
+{
+    return unsupported(instance, "fmi3SetContinuousStates");
+}
+
+
+fmi3Status fmi3GetContinuousStateDerivatives(
+    fmi3Instance instance,
+    fmi3Float64[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetContinuousStateDerivatives");
+}
+
+
+fmi3Status fmi3GetEventIndicators(
+    fmi3Instance instance,
+    fmi3Float64[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetEventIndicators");
+}
+
+
+fmi3Status fmi3GetContinuousStates(
+    fmi3Instance instance,
+    fmi3Float64[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetContinuousStates");
+}
+
+
+fmi3Status fmi3GetNominalsOfContinuousStates(
+    fmi3Instance instance,
+    fmi3Float64[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetNominalsOfContinuousStates");
+}
+
+
+fmi3Status fmi3GetNumberOfEventIndicators(
+    fmi3Instance instance,
+    size_t*)
+{
+    return unsupported(instance, "fmi3GetNumberOfEventIndicators");
+}
+
+
+fmi3Status fmi3GetNumberOfContinuousStates(
+    fmi3Instance instance,
+    size_t*)
+{
+    return unsupported(instance, "fmi3GetNumberOfContinuousStates");
+}
+
+
+fmi3Status fmi3GetOutputDerivatives(
+    fmi3Instance instance,
+    const fmi3ValueReference[],
+    size_t,
+    const fmi3Int32[],
+    fmi3Float64[],
+    size_t)
+{
+    return unsupported(instance, "fmi3GetOutputDerivatives");
+}
+
+
+fmi3Status fmi3ActivateModelPartition(
+    fmi3Instance instance,
+    fmi3ValueReference,
+    fmi3Float64)
+{
+    return unsupported(instance, "fmi3ActivateModelPartition");
+}
+
+}
@@ -4,9 +4,12 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 #include "cppfmu/cppfmu_cs.hpp"
+#include "fmu4j/OutputHistory.hpp"
+#include "fmu4j/RollbackRing.hpp"
 
 #include <exception>
 #include <limits>
+#include <unordered_map>
 
 
 namespace
@@ -34,6 +37,10 @@ struct Component
     // Co-simulation
     cppfmu::UniquePtr<cppfmu::SlaveInstance> slave;
     cppfmu::FMIReal lastSuccessfulTime;
+    fmu4j::RollbackRing rollback;
+    fmu4j::OutputHistory outputHistory;
+    // lastSuccessfulTime of the FMU states handed out by fmi2GetFMUstate, restored by fmi2SetFMUstate
+    std::unordered_map<cppfmu::FMIFMUstate, cppfmu::FMIReal> stateTimes;
 };
 } // namespace
 
@@ -68,8 +75,8 @@ fmi2Component fmi2Instantiate(
     fmi2Boolean loggingOn)
 {
     try {
-        if (fmuType != fmi2CoSimulation) {
-            throw std::logic_error("Unsupported FMU instance type requested (only co-simulation is supported)");
+        if (fmuType != fmi2CoSimulation && fmuType != fmi2ModelExchange) {
+            throw std::logic_error("Unsupported FMU instance type requested");
         }
         auto component = cppfmu::AllocateUnique<Component>(cppfmu::Memory{*functions},
             instanceName,
@@ -99,6 +106,11 @@ fmi2Component fmi2Instantiate(
 void fmi2FreeInstance(fmi2Component c)
 {
     const auto component = reinterpret_cast<Component*>(c);
+    try {
+        component->rollback.clear(*component->slave);
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Warning, "", e.what());
+    }
     // The Component object was allocated using cppfmu::AllocateUnique(),
     // which uses cppfmu::New() internally, so we use cppfmu::Delete() to
     // release it again.
@@ -205,6 +217,8 @@ fmi2Status fmi2Reset(fmi2Component c)
 {
     const auto component = reinterpret_cast<Component*>(c);
     try {
+        component->rollback.clear(*component->slave);
+        component->outputHistory.clear();
         component->slave->Reset();
         return fmi2OK;
     } catch (const cppfmu::FatalError& e) {
@@ -314,6 +328,100 @@ fmi2Status fmi2GetAll(
 }
 
 
+fmi2Status fmi2GetInstantiationTimings(
+    fmi2Component c,
+    fmi2Real timings[],
+    size_t nTimings)
+{
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        component->slave->GetInstantiationTimings(timings, nTimings);
+        return fmi2OK;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
+}
+
+
+fmi2Status fmi2GetPreferredStepSize(
+    fmi2Component c,
+    fmi2Real* stepSize)
+{
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        *stepSize = component->slave->GetPreferredStepSize();
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
+}
+
+
+fmi2Status fmi2GetRealSources(
+    fmi2Component c,
+    const fmi2ValueReference vr[],
+    size_t nvr,
+    void* sources[])
+{
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        component->slave->GetRealSources(vr, nvr, sources);
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
+}
+
+
+fmi2Status fmi2ConnectReal(
+    fmi2Component c,
+    const fmi2ValueReference vr[],
+    size_t nvr,
+    void* const sources[])
+{
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        component->slave->ConnectReal(vr, nvr, sources);
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
+}
+
+
+fmi2Status fmi2RollbackTo(
+    fmi2Component c,
+    fmi2Real time)
+{
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        component->rollback.rollback(*component->slave, time);
+        component->outputHistory.truncate(time);
+        component->lastSuccessfulTime = time;
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
+}
+
+
 fmi2Status fmi2SetReal(
     fmi2Component c,
     const fmi2ValueReference vr[],
@@ -413,128 +521,220 @@ fmi2Status fmi2SetAll(
 
 fmi2Status fmi2GetFMUstate(
     fmi2Component c,
-    fmi2FMUstate*)
+    fmi2FMUstate* state)
 {
-    reinterpret_cast<Component*>(c)->logger.Log(
-        fmi2Error,
-        "cppfmu",
-        "FMI function not supported: fmi2GetFMUstate");
-    return fmi2Error;
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        const auto previous = *state;
+        component->slave->GetFMUstate(*state);
+        if (previous != nullptr && previous != *state) {
+            component->stateTimes.erase(previous);
+        }
+        component->stateTimes[*state] = component->lastSuccessfulTime;
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
 }
 
 fmi2Status fmi2SetFMUstate(
     fmi2Component c,
-    fmi2FMUstate)
+    fmi2FMUstate state)
 {
-    reinterpret_cast<Component*>(c)->logger.Log(
-        fmi2Error,
-        "cppfmu",
-        "FMI function not supported: fmi2SetFMUstate");
-    return fmi2Error;
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        component->slave->SetFMUstate(state);
+        const auto it = component->stateTimes.find(state);
+        if (it != component->stateTimes.end()) {
+            component->lastSuccessfulTime = it->second;
+            component->outputHistory.rewind(it->second);
+        } else {
+            // deserialized, the time it was captured at is unknown
+            component->lastSuccessfulTime = std::numeric_limits<cppfmu::FMIReal>::quiet_NaN();
+            component->outputHistory.clear();
+        }
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
 }
 
 fmi2Status fmi2FreeFMUstate(
     fmi2Component c,
-    fmi2FMUstate*)
+    fmi2FMUstate* state)
 {
-    reinterpret_cast<Component*>(c)->logger.Log(
-        fmi2Error,
-        "cppfmu",
-        "FMI function not supported: fmi2FreeFMUstate");
-    return fmi2Error;
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        component->stateTimes.erase(*state);
+        component->slave->FreeFMUstate(*state);
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
 }
 
 fmi2Status fmi2SerializedFMUstateSize(
     fmi2Component c,
-    fmi2FMUstate,
-    size_t*)
+    fmi2FMUstate state,
+    size_t* size)
 {
-    reinterpret_cast<Component*>(c)->logger.Log(
-        fmi2Error,
-        "cppfmu",
-        "FMI function not supported: fmi2SerializedFMUstateSize");
-    return fmi2Error;
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        *size = component->slave->SerializedFMUstateSize(state);
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
 }
 
 fmi2Status fmi2SerializeFMUstate(
     fmi2Component c,
-    fmi2FMUstate,
-    fmi2Byte[],
-    size_t)
+    fmi2FMUstate state,
+    fmi2Byte data[],
+    size_t size)
 {
-    reinterpret_cast<Component*>(c)->logger.Log(
-        fmi2Error,
-        "cppfmu",
-        "FMI function not supported: fmi2SerializeFMUstate");
-    return fmi2Error;
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        component->slave->SerializeFMUstate(state, data, size);
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
 }
 
 fmi2Status fmi2DeSerializeFMUstate(
     fmi2Component c,
-    const fmi2Byte[],
-    size_t,
-    fmi2FMUstate*)
+    const fmi2Byte data[],
+    size_t size,
+    fmi2FMUstate* state)
 {
-    reinterpret_cast<Component*>(c)->logger.Log(
-        fmi2Error,
-        "cppfmu",
-        "FMI function not supported: fmi2DeSerializeFMUstate");
-    return fmi2Error;
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        // an existing state is freed and replaced, its time does not carry over
+        component->stateTimes.erase(*state);
+        component->slave->DeSerializeFMUstate(data, size, *state);
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
 }
 
 
 fmi2Status fmi2GetDirectionalDerivative(
     fmi2Component c,
-    const fmi2ValueReference[],
-    size_t,
-    const fmi2ValueReference[],
-    size_t,
-    const fmi2Real[],
-    fmi2Real[])
+    const fmi2ValueReference vUnknown_ref[],
+    size_t nUnknown,
+    const fmi2ValueReference vKnown_ref[],
+    size_t nKnown,
+    const fmi2Real dvKnown[],
+    fmi2Real dvUnknown[])
 {
-    reinterpret_cast<Component*>(c)->logger.Log(
-        fmi2Error,
-        "cppfmu",
-        "FMI function not supported: fmi2GetDirectionalDerivative");
-    return fmi2Error;
+    return fmi2GetDirectionalDerivatives(c, vUnknown_ref, nUnknown, vKnown_ref, nKnown, dvKnown, 1, dvUnknown);
+}
+
+fmi2Status fmi2GetDirectionalDerivatives(
+    fmi2Component c,
+    const fmi2ValueReference vUnknown_ref[],
+    size_t nUnknown,
+    const fmi2ValueReference vKnown_ref[],
+    size_t nKnown,
+    const fmi2Real dvKnown[],
+    size_t nSeeds,
+    fmi2Real dvUnknown[])
+{
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        component->slave->GetDirectionalDerivatives(
+            vUnknown_ref, nUnknown, vKnown_ref, nKnown, dvKnown, nSeeds, dvUnknown);
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
 }
 
 fmi2Status fmi2SetRealInputDerivatives(
     fmi2Component c,
-    const fmi2ValueReference[],
-    size_t,
-    const fmi2Integer[],
-    const fmi2Real[])
+    const fmi2ValueReference vr[],
+    size_t nvr,
+    const fmi2Integer order[],
+    const fmi2Real value[])
 {
-    reinterpret_cast<Component*>(c)->logger.Log(
-        fmi2Error,
-        "cppfmu",
-        "FMI function not supported: fmi2SetRealInputDerivatives");
-    return fmi2Error;
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        component->slave->SetRealInputDerivatives(vr, nvr, order, value);
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
 }
 
 fmi2Status fmi2GetRealOutputDerivatives(
     fmi2Component c,
-    const fmi2ValueReference[],
-    size_t,
-    const fmi2Integer[],
-    fmi2Real[])
+    const fmi2ValueReference vr[],
+    size_t nvr,
+    const fmi2Integer order[],
+    fmi2Real value[])
 {
-    reinterpret_cast<Component*>(c)->logger.Log(
-        fmi2Error,
-        "cppfmu",
-        "FMI function not supported: fmiGetRealOutputDerivatives");
-    return fmi2Error;
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        if (!component->slave->GetRealOutputDerivatives(vr, nvr, order, value)) {
+            component->outputHistory.derivatives(
+                *component->slave, component->lastSuccessfulTime, vr, nvr, order, value);
+        }
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
 }
 
 fmi2Status fmi2DoStep(
     fmi2Component c,
     fmi2Real currentCommunicationPoint,
     fmi2Real communicationStepSize,
-    fmi2Boolean /*noSetFMUStatePriorToCurrentPoint*/)
+    fmi2Boolean noSetFMUStatePriorToCurrentPoint)
 {
     const auto component = reinterpret_cast<Component*>(c);
     try {
+        if (component->rollback.enabled() &&
+            !component->rollback.capture(*component->slave, currentCommunicationPoint, noSetFMUStatePriorToCurrentPoint == fmi2True)) {
+            component->logger.Log(fmi2Warning, "", "[FMU4j native] Rollback disabled, the slave does not declare canGetAndSetFMUstate.");
+        }
         double endTime = currentCommunicationPoint;
         const auto ok = component->slave->DoStep(
             currentCommunicationPoint,
@@ -544,9 +744,14 @@ fmi2Status fmi2DoStep(
         if (ok) {
             component->lastSuccessfulTime =
                 currentCommunicationPoint + communicationStepSize;
+            component->outputHistory.record(*component->slave, component->lastSuccessfulTime);
             return fmi2OK;
         } else {
             component->lastSuccessfulTime = endTime;
+            if (endTime > currentCommunicationPoint) {
+                // ended early at an event, the outputs are valid at endTime
+                component->outputHistory.record(*component->slave, endTime);
+            }
             return fmi2Discard;
         }
     } catch (const cppfmu::FatalError& e) {
@@ -634,4 +839,149 @@ fmi2Status fmi2GetStringStatus(
         "FMI function not supported: fmi2GetStringStatus");
     return fmi2Error;
 }
+
+
+/* Model Exchange */
+fmi2Status fmi2EnterEventMode(fmi2Component)
+{
+    return fmi2OK;
+}
+
+fmi2Status fmi2NewDiscreteStates(
+    fmi2Component c,
+    fmi2EventInfo* eventInfo)
+{
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        eventInfo->newDiscreteStatesNeeded = fmi2False;
+        eventInfo->terminateSimulation = fmi2False;
+        eventInfo->nominalsOfContinuousStatesChanged = fmi2False;
+        eventInfo->valuesOfContinuousStatesChanged =
+            component->slave->NewDiscreteStates() ? fmi2True : fmi2False;
+        eventInfo->nextEventTimeDefined = fmi2False;
+        eventInfo->nextEventTime = 0.0;
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
+}
+
+fmi2Status fmi2EnterContinuousTimeMode(fmi2Component)
+{
+    return fmi2OK;
+}
+
+fmi2Status fmi2CompletedIntegratorStep(
+    fmi2Component,
+    fmi2Boolean,
+    fmi2Boolean* enterEventMode,
+    fmi2Boolean* terminateSimulation)
+{
+    // declared completedIntegratorStepNotNeeded, state events are found using the event indicators
+    *enterEventMode = fmi2False;
+    *terminateSimulation = fmi2False;
+    return fmi2OK;
+}
+
+fmi2Status fmi2SetTime(fmi2Component c, fmi2Real time)
+{
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        component->slave->SetTime(time);
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
+}
+
+fmi2Status fmi2SetContinuousStates(
+    fmi2Component c,
+    const fmi2Real x[],
+    size_t nx)
+{
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        component->slave->SetContinuousStates(x, nx);
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
+}
+
+fmi2Status fmi2GetDerivatives(
+    fmi2Component c,
+    fmi2Real derivatives[],
+    size_t nx)
+{
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        component->slave->GetDerivatives(derivatives, nx);
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
+}
+
+fmi2Status fmi2GetEventIndicators(
+    fmi2Component c,
+    fmi2Real eventIndicators[],
+    size_t ni)
+{
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        component->slave->GetEventIndicators(eventIndicators, ni);
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
+}
+
+fmi2Status fmi2GetContinuousStates(
+    fmi2Component c,
+    fmi2Real x[],
+    size_t nx)
+{
+    const auto component = reinterpret_cast<Component*>(c);
+    try {
+        component->slave->GetContinuousStates(x, nx);
+        return fmi2OK;
+    } catch (const cppfmu::FatalError& e) {
+        component->logger.Log(fmi2Fatal, "", e.what());
+        return fmi2Fatal;
+    } catch (const std::exception& e) {
+        component->logger.Log(fmi2Error, "", e.what());
+        return fmi2Error;
+    }
+}
+
+fmi2Status fmi2GetNominalsOfContinuousStates(
+    fmi2Component,
+    fmi2Real x_nominal[],
+    size_t nx)
+{
+    for (size_t i = 0; i < nx; ++i) {
+        x_nominal[i] = 1.0;
+    }
+    return fmi2OK;
+}
 }
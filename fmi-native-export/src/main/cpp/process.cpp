@@ -0,0 +1,349 @@
+#include <fmu4j/process.hpp>
+
+#include <cppfmu/cppfmu_cs.hpp>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#    include <windows.h>
+#else
+#    include <dlfcn.h>
+#    include <fcntl.h>
+#    include <signal.h>
+#    include <sys/stat.h>
+#    include <sys/wait.h>
+#    include <unistd.h>
+#endif
+
+namespace fmu4j
+{
+
+#ifdef _WIN32
+const char PATH_SEPARATOR = ';';
+#else
+const char PATH_SEPARATOR = ':';
+#endif
+
+std::string java_executable()
+{
+    if (const char* java = std::getenv("FMU4J_JAVA")) {
+        return java;
+    }
+    if (const char* javaHome = std::getenv("JAVA_HOME")) {
+#ifdef _WIN32
+        return std::string(javaHome) + "/bin/java.exe";
+#else
+        return std::string(javaHome) + "/bin/java";
+#endif
+    }
+    return "java";
+}
+
+std::string fmu_classpath(const std::string& resources)
+{
+    std::string classpath = resources + "/model.jar";
+    std::string runtime = resources + "/fmu4j-runtime.jar";
+    if (std::ifstream(runtime)) {
+        classpath += PATH_SEPARATOR + runtime;
+    }
+    return classpath;
+}
+
+std::string stable_classpath(const std::string& resources)
+{
+    std::string classpath = stable_copy(resources + "/model.jar");
+    std::string runtime = resources + "/fmu4j-runtime.jar";
+    if (std::ifstream(runtime)) {
+        classpath += PATH_SEPARATOR + stable_copy(runtime);
+    }
+    return classpath;
+}
+
+std::string stable_copy(const std::string& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+        std::string msg = "[FMU4j native] Unable to read '" + file + "'!";
+        throw cppfmu::FatalError(msg.c_str());
+    }
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : content) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    char digest[17];
+    std::snprintf(digest, sizeof(digest), "%016llx", static_cast<unsigned long long>(hash));
+
+    auto slash = file.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? file : file.substr(slash + 1);
+    std::string dir = user_directory() + "/jars";
+#ifdef _WIN32
+    CreateDirectoryA(dir.c_str(), nullptr);
+#else
+    mkdir(dir.c_str(), 0700);
+#endif
+    std::string copy = dir + "/" + digest + "-" + std::to_string(content.size()) + "-" + name;
+    if (std::ifstream(copy)) {
+        return copy;
+    }
+
+    // written aside and renamed, so that concurrent instantiations never see a partial jar
+    std::string tmp = copy + "." + std::to_string(current_process_id()) + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        out.write(content.data(), static_cast<std::streamsize>(content.size()));
+        if (!out) {
+            std::string msg = "[FMU4j native] Unable to write '" + tmp + "'!";
+            throw cppfmu::FatalError(msg.c_str());
+        }
+    }
+    if (std::rename(tmp.c_str(), copy.c_str()) != 0) {
+        // another process got there first
+        std::remove(tmp.c_str());
+    }
+    return copy;
+}
+
+std::vector<std::string> split_options(const char* options)
+{
+    std::vector<std::string> result;
+    if (options != nullptr) {
+        std::istringstream stream(options);
+        std::string option;
+        while (stream >> option) {
+            result.push_back(option);
+        }
+    }
+    return result;
+}
+
+std::string temp_directory()
+{
+#ifdef _WIN32
+    char path[MAX_PATH + 1];
+    DWORD size = GetTempPathA(sizeof(path), path);
+    std::string dir(path, size);
+    if (!dir.empty() && (dir.back() == '\\' || dir.back() == '/')) {
+        dir.pop_back();
+    }
+    return dir;
+#else
+    const char* dir = std::getenv("TMPDIR");
+    return dir != nullptr ? dir : "/tmp";
+#endif
+}
+
+#ifdef _WIN32
+
+std::string user_directory()
+{
+    const char* appData = std::getenv("LOCALAPPDATA");
+    std::string dir = (appData != nullptr ? std::string(appData) : temp_directory()) + "/fmu4j";
+    CreateDirectoryA(dir.c_str(), nullptr);
+    return dir;
+}
+
+bool is_private_file(const std::string& path)
+{
+    // the profile directory is only accessible to its user
+    return std::ifstream(path).good();
+}
+
+long spawn_process(const std::vector<std::string>& args, bool detached)
+{
+    std::string commandLine;
+    for (const auto& arg : args) {
+        if (!commandLine.empty()) {
+            commandLine += ' ';
+        }
+        commandLine += '"';
+        for (char c : arg) {
+            if (c == '"') {
+                commandLine += '\\';
+            }
+            commandLine += c;
+        }
+        commandLine += '"';
+    }
+
+    STARTUPINFOA si{};
+    si.cb = sizeof(si);
+    PROCESS_INFORMATION pi{};
+    DWORD flags = detached ? (DETACHED_PROCESS | CREATE_NEW_PROCESS_GROUP) : CREATE_NO_WINDOW;
+    if (!CreateProcessA(nullptr, &commandLine[0], nullptr, nullptr, FALSE, flags, nullptr, nullptr, &si, &pi)) {
+        std::string msg = "[FMU4j native] Unable to launch '" + args.front() + "'!";
+        throw cppfmu::FatalError(msg.c_str());
+    }
+    CloseHandle(pi.hThread);
+    CloseHandle(pi.hProcess);
+    return detached ? 0 : static_cast<long>(pi.dwProcessId);
+}
+
+long current_process_id()
+{
+    return static_cast<long>(GetCurrentProcessId());
+}
+
+bool process_alive(long pid)
+{
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(pid));
+    if (process == nullptr) {
+        return false;
+    }
+    bool alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+    CloseHandle(process);
+    return alive;
+}
+
+bool wait_process(long pid, int timeoutMs)
+{
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(pid));
+    if (process == nullptr) {
+        return true;
+    }
+    bool exited = WaitForSingleObject(process, static_cast<DWORD>(timeoutMs)) != WAIT_TIMEOUT;
+    CloseHandle(process);
+    return exited;
+}
+
+void kill_process(long pid)
+{
+    HANDLE process = OpenProcess(PROCESS_TERMINATE | SYNCHRONIZE, FALSE, static_cast<DWORD>(pid));
+    if (process == nullptr) {
+        return;
+    }
+    TerminateProcess(process, 1);
+    WaitForSingleObject(process, INFINITE);
+    CloseHandle(process);
+}
+
+std::string library_path()
+{
+    HMODULE module = nullptr;
+    GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+        reinterpret_cast<LPCSTR>(&library_path), &module);
+    char path[MAX_PATH + 1];
+    DWORD size = GetModuleFileNameA(module, path, sizeof(path));
+    return std::string(path, size);
+}
+
+#else
+
+std::string user_directory()
+{
+    std::string dir;
+    if (const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR")) {
+        dir = std::string(runtimeDir) + "/fmu4j";
+    } else {
+        dir = temp_directory() + "/fmu4j-" + std::to_string(geteuid());
+    }
+    if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+        std::string msg = "[FMU4j native] Unable to create '" + dir + "'!";
+        throw cppfmu::FatalError(msg.c_str());
+    }
+    // lstat, so that a symlink planted by another user is rejected rather than followed
+    struct stat st{};
+    if (lstat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != geteuid() || (st.st_mode & 077) != 0) {
+        std::string msg = "[FMU4j native] '" + dir + "' must be a directory owned by the current user with mode 0700!";
+        throw cppfmu::FatalError(msg.c_str());
+    }
+    return dir;
+}
+
+bool is_private_file(const std::string& path)
+{
+    struct stat st{};
+    return lstat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) && st.st_uid == geteuid() && (st.st_mode & 077) == 0;
+}
+
+long spawn_process(const std::vector<std::string>& args, bool detached)
+{
+    // prepared up front, only async-signal-safe calls are allowed in the child
+    std::vector<char*> argv;
+    for (const auto& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        throw cppfmu::FatalError("[FMU4j native] Unable to fork!");
+    }
+    if (pid == 0) {
+        if (detached) {
+            // double fork, so that the daemon is reparented and never becomes our zombie
+            setsid();
+            if (fork() != 0) {
+                _exit(0);
+            }
+        }
+        int devNull = open("/dev/null", O_RDWR);
+        if (devNull >= 0) {
+            dup2(devNull, STDIN_FILENO);
+        }
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+    if (detached) {
+        waitpid(pid, nullptr, 0);
+        return 0;
+    }
+    return static_cast<long>(pid);
+}
+
+long current_process_id()
+{
+    return static_cast<long>(getpid());
+}
+
+bool process_alive(long pid)
+{
+    int status;
+    if (waitpid(static_cast<pid_t>(pid), &status, WNOHANG) == static_cast<pid_t>(pid)) {
+        return false;
+    }
+    return kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+}
+
+bool wait_process(long pid, int timeoutMs)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    do {
+        if (!process_alive(pid)) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    } while (std::chrono::steady_clock::now() < deadline);
+    return false;
+}
+
+void kill_process(long pid)
+{
+    // never 0 or negative, which would signal a whole process group
+    if (pid > 0 && kill(static_cast<pid_t>(pid), SIGKILL) == 0) {
+        waitpid(static_cast<pid_t>(pid), nullptr, 0);
+    }
+}
+
+std::string library_path()
+{
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(&library_path), &info) == 0 || info.dli_fname == nullptr) {
+        throw cppfmu::FatalError("[FMU4j native] Unable to locate the native library!");
+    }
+    return info.dli_fname;
+}
+
+#endif
+
+} // namespace fmu4j
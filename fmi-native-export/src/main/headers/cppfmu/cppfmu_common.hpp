@@ -45,6 +45,7 @@ typedef fmi2Component FMIComponent;
 typedef fmi2ComponentEnvironment FMIComponentEnvironment;
 typedef fmi2Status FMIStatus;
 typedef fmi2ValueReference FMIValueReference;
+typedef fmi2FMUstate FMIFMUstate;
 
 const FMIBoolean FMIFalse = fmi2False;
 const FMIBoolean FMITrue = fmi2True;
@@ -8,6 +8,7 @@
 
 #include "cppfmu_common.hpp"
 
+#include <cstdint>
 #include <vector>
 
 namespace cppfmu
@@ -115,6 +116,193 @@ public:
         const FMIValueReference strVr[], std::size_t nStrvr, FMIString strValue[]) const;
 
 
+    /* Called from fmi3SetFloat64(), fmi3SetInt32(), fmi3SetBoolean() and fmi3SetString() (FMI 3.0).
+     * Array variables take a single value reference, and 'nValues' counts their elements.
+     * Throws std::logic_error by default.
+     */
+    virtual void SetFloat64(
+        const FMIValueReference vr[],
+        std::size_t nvr,
+        const double values[],
+        std::size_t nValues);
+    virtual void SetInt32(
+        const FMIValueReference vr[],
+        std::size_t nvr,
+        const std::int32_t values[],
+        std::size_t nValues);
+    virtual void SetBool(
+        const FMIValueReference vr[],
+        std::size_t nvr,
+        const bool values[],
+        std::size_t nValues);
+    virtual void SetUtf8String(
+        const FMIValueReference vr[],
+        std::size_t nvr,
+        const char* const values[],
+        std::size_t nValues);
+
+    /* Called from fmi3GetFloat64(), fmi3GetInt32(), fmi3GetBoolean() and fmi3GetString() (FMI 3.0).
+     * Writes the elements of array variables consecutively, 'nValues' in total.
+     * Throws std::logic_error by default.
+     */
+    virtual void GetFloat64(
+        const FMIValueReference vr[],
+        std::size_t nvr,
+        double values[],
+        std::size_t nValues) const;
+    virtual void GetInt32(
+        const FMIValueReference vr[],
+        std::size_t nvr,
+        std::int32_t values[],
+        std::size_t nValues) const;
+    virtual void GetBool(
+        const FMIValueReference vr[],
+        std::size_t nvr,
+        bool values[],
+        std::size_t nValues) const;
+    virtual void GetUtf8String(
+        const FMIValueReference vr[],
+        std::size_t nvr,
+        const char* values[],
+        std::size_t nValues) const;
+
+    /* Called from fmi2GetFMUstate(). Captures the current state into 'state',
+     * updating it in place if it already holds a state of this instance.
+     * Throws std::logic_error by default.
+     */
+    virtual void GetFMUstate(FMIFMUstate& state);
+
+    /* Called from fmi2SetFMUstate().
+     * Throws std::logic_error by default.
+     */
+    virtual void SetFMUstate(FMIFMUstate state);
+
+    /* Called from fmi2FreeFMUstate(). Releases 'state' and sets it to null.
+     * Throws std::logic_error by default.
+     */
+    virtual void FreeFMUstate(FMIFMUstate& state);
+
+    /* Called from fmi2SerializedFMUstateSize(). Always followed by SerializeFMUstate() of the same state.
+     * Throws std::logic_error by default.
+     */
+    virtual std::size_t SerializedFMUstateSize(FMIFMUstate state);
+
+    /* Called from fmi2SerializeFMUstate(). Writes exactly 'size' bytes, as returned by SerializedFMUstateSize().
+     * Throws std::logic_error by default.
+     */
+    virtual void SerializeFMUstate(
+        FMIFMUstate state,
+        fmi2Byte data[],
+        std::size_t size);
+
+    /* Called from fmi2DeSerializeFMUstate(). Sets 'state' to a new state, to be released by FreeFMUstate().
+     * Throws std::logic_error by default.
+     */
+    virtual void DeSerializeFMUstate(
+        const fmi2Byte data[],
+        std::size_t size,
+        FMIFMUstate& state);
+
+    /* Called from fmi2SetRealInputDerivatives(). The derivatives apply to the following steps.
+     * Throws std::logic_error by default.
+     */
+    virtual void SetRealInputDerivatives(
+        const FMIValueReference vr[],
+        std::size_t nvr,
+        const FMIInteger order[],
+        const FMIReal value[]);
+
+    /* Called from fmi2GetRealOutputDerivatives(). Returns false if the derivatives are not
+     * provided by the model, leaving it to the caller to estimate them.
+     * Returns false by default.
+     */
+    virtual bool GetRealOutputDerivatives(
+        const FMIValueReference vr[],
+        std::size_t nvr,
+        const FMIInteger order[],
+        FMIReal value[]);
+
+    /* Called from fmi2GetDirectionalDerivative() with a single seed, and from
+     * fmi2GetDirectionalDerivatives() (vendor extension) with 'nSeeds' seeds of 'nKnown' values each.
+     * Writes 'nUnknown' derivatives per seed.
+     * Throws std::logic_error by default.
+     */
+    virtual void GetDirectionalDerivatives(
+        const FMIValueReference unknownVr[],
+        std::size_t nUnknown,
+        const FMIValueReference knownVr[],
+        std::size_t nKnown,
+        const FMIReal seeds[],
+        std::size_t nSeeds,
+        FMIReal derivatives[]);
+
+    /* Model Exchange (FMI 2.0). Called from fmi2SetTime() and fmi2SetContinuousStates().
+     * Throws std::logic_error by default.
+     */
+    virtual void SetTime(FMIReal time);
+    virtual void SetContinuousStates(
+        const FMIReal x[],
+        std::size_t nx);
+
+    /* Called from fmi2GetContinuousStates(), fmi2GetDerivatives() and fmi2GetEventIndicators(),
+     * evaluated at the time and states set last.
+     * Throws std::logic_error by default.
+     */
+    virtual void GetContinuousStates(
+        FMIReal x[],
+        std::size_t nx);
+    virtual void GetDerivatives(
+        FMIReal derivatives[],
+        std::size_t nx);
+    virtual void GetEventIndicators(
+        FMIReal eventIndicators[],
+        std::size_t ni);
+
+    /* Called from fmi2NewDiscreteStates(). Returns true if the values of the continuous states have changed.
+     * Returns false by default.
+     */
+    virtual bool NewDiscreteStates();
+
+    /* Called from fmi2GetRealSources() (vendor extension).
+     * Writes an opaque handle per variable, which fmi2ConnectReal() of another
+     * instance in the same process accepts. Valid until the instance is freed.
+     * Throws std::logic_error by default.
+     */
+    virtual void GetRealSources(
+        const FMIValueReference vr[],
+        std::size_t nvr,
+        void* sources[]);
+
+    /* Called from fmi2ConnectReal() (vendor extension).
+     * Connects the real inputs 'vr' to the handles obtained from fmi2GetRealSources(),
+     * or disconnects them where the handle is null.
+     * Throws std::logic_error by default.
+     */
+    virtual void ConnectReal(
+        const FMIValueReference vr[],
+        std::size_t nvr,
+        void* const sources[]);
+
+    /* Called from fmi2GetPreferredStepSize() (vendor extension).
+     * Returns the size of the next communication step suggested by the model during the last step.
+     * Returns NaN, meaning no preference, by default.
+     */
+    virtual FMIReal GetPreferredStepSize();
+
+    /* Called from fmi2GetInstantiationTimings() (vendor extension).
+     * Writes the duration in seconds of up to 'n' instantiation phases.
+     * Writes zeros by default.
+     */
+    virtual void GetInstantiationTimings(
+        FMIReal timings[],
+        std::size_t n) const;
+
+    /* Whether the model declares canGetAndSetFMUstate, which the rollback ring
+     * behind fmi2RollbackTo() (vendor extension) requires.
+     * Returns false by default.
+     */
+    virtual bool CanGetAndSetFMUstate() const;
+
     // Called from fmi2DoStep()/fmiDoStep(). Must be implemented in model code.
     virtual bool DoStep(
         FMIReal currentCommunicationPoint,
@@ -198,6 +198,32 @@ typedef fmi2Status fmi2SetAllTYPE(fmi2Component,
     const fmi2ValueReference[], size_t, const fmi2Boolean[],
     const fmi2ValueReference[], size_t, const fmi2String[]);
 
+/* Duration in seconds of the phases of fmi2Instantiate (vendor extension): JVM, runtime classloader,
+   classloader, find class, method lookup, constructor and define. Unknown phases are zero filled. */
+typedef fmi2Status fmi2GetInstantiationTimingsTYPE(fmi2Component, fmi2Real[], size_t);
+
+/* Restores the state captured before the step from communication point 'time' (vendor extension).
+   Requires FMU4J_ROLLBACK_DEPTH > 0 and a slave supporting FMU states. Later communication points are discarded. */
+typedef fmi2Status fmi2RollbackToTYPE(fmi2Component, fmi2Real);
+
+/* Size of the next communication step suggested by the slave during the last step, NaN if none (vendor extension). */
+typedef fmi2Status fmi2GetPreferredStepSizeTYPE(fmi2Component, fmi2Real*);
+
+/* Connections between fmu4j instances running in the same process (vendor extension). fmi2GetRealSources writes
+   an opaque handle per real variable of the source instance, valid until it is freed. fmi2ConnectReal connects
+   real inputs of another instance to these handles (disconnecting them where null), after which the inputs are read
+   within the JVM at the beginning of each fmi2DoStep of that instance, instead of being set by the master.
+   Inputs must be disconnected before their source is freed, and are disconnected by fmi2Reset. */
+typedef fmi2Status fmi2GetRealSourcesTYPE(fmi2Component, const fmi2ValueReference[], size_t, void*[]);
+typedef fmi2Status fmi2ConnectRealTYPE(fmi2Component, const fmi2ValueReference[], size_t, void* const[]);
+
+/* Evaluates 'nSeeds' directional derivatives in one call (vendor extension), e.g. the columns of a Jacobian.
+   The seeds are 'nKnown' consecutive values each, and 'nUnknown' consecutive derivatives are written per seed. */
+typedef fmi2Status fmi2GetDirectionalDerivativesTYPE(fmi2Component,
+    const fmi2ValueReference[], size_t,
+    const fmi2ValueReference[], size_t,
+    const fmi2Real[], size_t, fmi2Real[]);
+
 /* Getting and setting the internal FMU state */
 typedef fmi2Status fmi2GetFMUstateTYPE(fmi2Component, fmi2FMUstate*);
 typedef fmi2Status fmi2SetFMUstateTYPE(fmi2Component, fmi2FMUstate);
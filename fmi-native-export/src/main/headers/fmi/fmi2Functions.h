@@ -205,6 +205,12 @@ Common Functions
 #define fmi2SetBoolean               fmi2FullName(fmi2SetBoolean)
 #define fmi2SetString                fmi2FullName(fmi2SetString)
 #define fmi2SetAll                   fmi2FullName(fmi2SetAll)
+#define fmi2GetInstantiationTimings  fmi2FullName(fmi2GetInstantiationTimings)
+#define fmi2RollbackTo               fmi2FullName(fmi2RollbackTo)
+#define fmi2GetDirectionalDerivatives fmi2FullName(fmi2GetDirectionalDerivatives)
+#define fmi2GetPreferredStepSize     fmi2FullName(fmi2GetPreferredStepSize)
+#define fmi2GetRealSources           fmi2FullName(fmi2GetRealSources)
+#define fmi2ConnectReal              fmi2FullName(fmi2ConnectReal)
 #define fmi2GetFMUstate              fmi2FullName(fmi2GetFMUstate)
 #define fmi2SetFMUstate              fmi2FullName(fmi2SetFMUstate)
 #define fmi2FreeFMUstate             fmi2FullName(fmi2FreeFMUstate)
@@ -279,6 +285,13 @@ Common Functions
    FMI2_Export fmi2SetStringTYPE  fmi2SetString;
    FMI2_Export fmi2SetAllTYPE     fmi2SetAll;
 
+   FMI2_Export fmi2GetInstantiationTimingsTYPE fmi2GetInstantiationTimings;
+   FMI2_Export fmi2RollbackToTYPE              fmi2RollbackTo;
+   FMI2_Export fmi2GetDirectionalDerivativesTYPE fmi2GetDirectionalDerivatives;
+   FMI2_Export fmi2GetPreferredStepSizeTYPE    fmi2GetPreferredStepSize;
+   FMI2_Export fmi2GetRealSourcesTYPE          fmi2GetRealSources;
+   FMI2_Export fmi2ConnectRealTYPE             fmi2ConnectReal;
+
 /* Getting and setting the internal FMU state */
    FMI2_Export fmi2GetFMUstateTYPE            fmi2GetFMUstate;
    FMI2_Export fmi2SetFMUstateTYPE            fmi2SetFMUstate;
@@ -0,0 +1,19 @@
+
+#ifndef FMU4J_DAEMON_HPP
+#define FMU4J_DAEMON_HPP
+
+#include <fmu4j/remote.hpp>
+
+#include <memory>
+#include <string>
+
+namespace fmu4j
+{
+
+// Opens a session for the FMU located at 'resources' on the per-user fmu4j daemon (FMU4J_MODE=daemon),
+// spawning the daemon if it is not already running.
+std::unique_ptr<Channel> connect_daemon(const std::string& resources);
+
+} // namespace fmu4j
+
+#endif
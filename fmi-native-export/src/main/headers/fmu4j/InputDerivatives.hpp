@@ -0,0 +1,52 @@
+
+#ifndef FMU4J_INPUTDERIVATIVES_HPP
+#define FMU4J_INPUTDERIVATIVES_HPP
+
+#include <cppfmu/cppfmu_common.hpp>
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace fmu4j
+{
+
+// Time derivatives of real inputs set by fmi2SetRealInputDerivatives, kept natively
+// and handed to the slave in one batch before the next step that follows a change.
+// Derivatives apply until overwritten, a zero value removes them.
+class InputDerivatives
+{
+public:
+    struct Entry
+    {
+        cppfmu::FMIValueReference vr;
+        cppfmu::FMIInteger order;
+        cppfmu::FMIReal value;
+    };
+
+    // Throws std::logic_error for orders below 1.
+    void set(const cppfmu::FMIValueReference* vr, std::size_t nvr,
+        const cppfmu::FMIInteger* order, const cppfmu::FMIReal* value);
+
+    // Drops all derivatives, e.g. on fmi2Reset.
+    void clear();
+
+    // True if the derivatives changed since the last call to take().
+    bool dirty() const
+    {
+        return dirty_;
+    }
+
+    // All non-zero derivatives, ordered by value reference and order.
+    const std::vector<Entry>& take();
+
+private:
+    std::map<std::pair<cppfmu::FMIValueReference, cppfmu::FMIInteger>, cppfmu::FMIReal> derivatives_;
+    std::vector<Entry> entries_;
+    bool dirty_ = false;
+};
+
+} // namespace fmu4j
+
+#endif
@@ -0,0 +1,32 @@
+
+#ifndef FMU4J_INSTANCEPOOL_HPP
+#define FMU4J_INSTANCEPOOL_HPP
+
+#include <fmu4j/SlaveClass.hpp>
+
+#include <jni.h>
+
+#include <memory>
+
+namespace fmu4j
+{
+
+// Maximum number of parked instances per FMU, read from FMU4J_INSTANCE_POOL_SIZE.
+// Pooling is disabled when zero (the default).
+std::size_t instance_pool_capacity();
+
+// Parks a freed slave instance (a global ref) for later reuse.
+// Returns false if the pool for this FMU is full, in which case the caller keeps ownership.
+bool park_instance(const std::shared_ptr<const SlaveClass>& slaveClass, jobject instance);
+
+// Takes a parked instance of the given FMU, or nullptr if none is available.
+// Ownership of the returned global ref is transferred to the caller.
+jobject take_instance(const std::shared_ptr<const SlaveClass>& slaveClass);
+
+// Closes and releases all parked instances, along with the SlaveClass handles only they were keeping alive.
+// Invoked when the FMU library is unloaded.
+void drain_instance_pool();
+
+} // namespace fmu4j
+
+#endif
@@ -0,0 +1,63 @@
+
+#ifndef FMU4J_INSTANTIATIONTIMINGS_HPP
+#define FMU4J_INSTANTIATIONTIMINGS_HPP
+
+#include <cppfmu/cppfmu_common.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace fmu4j
+{
+
+// Phases of fmi2Instantiate, in the order reported by fmi2GetInstantiationTimings.
+// Class level phases are only spent by the first instance of an FMU, later instances find them cached.
+enum class Phase : std::size_t
+{
+    jvm, // creating or attaching to the JVM, or connecting to a daemon/worker
+    runtimeClassLoader, // shared runtime classloader (--shared-runtime)
+    classLoader, // classloader over model.jar
+    findClass, // loading the slave class
+    methodLookup, // resolving method ids
+    constructor, // slave constructor, or reuse of a pooled instance
+    define, // __define__ or __defineFromIndex__
+    count
+};
+
+struct InstantiationTimings
+{
+    std::array<double, static_cast<std::size_t>(Phase::count)> seconds{};
+
+    void add(Phase phase, std::chrono::steady_clock::duration duration);
+
+    double total() const;
+
+    // Copies up to 'n' phase durations in seconds, zero filling any phases beyond those known.
+    void copy_to(cppfmu::FMIReal timings[], std::size_t n) const;
+
+    // One line breakdown in milliseconds, for the FMI logger.
+    std::string format() const;
+};
+
+// Measures consecutive phases, each ending when the next one starts or the timer goes out of scope.
+// Does nothing if 'timings' is null.
+class PhaseTimer
+{
+public:
+    PhaseTimer(InstantiationTimings* timings, Phase phase);
+
+    void next(Phase phase);
+
+    ~PhaseTimer();
+
+private:
+    InstantiationTimings* timings_;
+    Phase phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace fmu4j
+
+#endif
@@ -0,0 +1,58 @@
+
+#ifndef FMU4J_OUTPUTHISTORY_HPP
+#define FMU4J_OUTPUTHISTORY_HPP
+
+#include <cppfmu/cppfmu_cs.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace fmu4j
+{
+
+// Values of real outputs at the last few communication points, serving fmi2GetRealOutputDerivatives
+// by backward differences for slaves not providing derivatives themselves.
+// Outputs are only recorded once their derivatives have been requested, so unused it costs nothing.
+class OutputHistory
+{
+public:
+    // highest derivative order supported by the differences
+    static const cppfmu::FMIInteger MAX_ORDER = 2;
+
+    // Records the tracked outputs at 'time', after a successful step.
+    void record(cppfmu::SlaveInstance& slave, cppfmu::FMIReal time);
+
+    // Writes the derivatives of the given outputs, zero while too few points are recorded,
+    // and starts tracking outputs not seen before.
+    // Throws std::logic_error for orders outside [1, MAX_ORDER].
+    void derivatives(cppfmu::SlaveInstance& slave, cppfmu::FMIReal time,
+        const cppfmu::FMIValueReference* vr, std::size_t nvr,
+        const cppfmu::FMIInteger* order, cppfmu::FMIReal* value);
+
+    // Drops the points after 'time', e.g. after a rollback.
+    void truncate(cppfmu::FMIReal time);
+
+    // Drops the points after 'time', and all points unless one was recorded at 'time',
+    // e.g. after restoring an FMU state captured at 'time', which may not lie on the recorded trajectory.
+    void rewind(cppfmu::FMIReal time);
+
+    void clear();
+
+private:
+    struct Point
+    {
+        cppfmu::FMIReal time;
+        std::vector<cppfmu::FMIReal> values;
+    };
+
+    std::vector<cppfmu::FMIValueReference> tracked_;
+    std::unordered_map<cppfmu::FMIValueReference, std::size_t> index_;
+    // newest first, at most MAX_ORDER + 1 points
+    std::deque<Point> points_;
+};
+
+} // namespace fmu4j
+
+#endif
@@ -0,0 +1,110 @@
+
+#ifndef FMU4J_REMOTESLAVEINSTANCE_HPP
+#define FMU4J_REMOTESLAVEINSTANCE_HPP
+
+#include <cppfmu/cppfmu_cs.hpp>
+#include <fmu4j/InputDerivatives.hpp>
+#include <fmu4j/InstantiationTimings.hpp>
+#include <fmu4j/remote.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fmu4j
+{
+
+// Proxies a slave instance living in another JVM process, see no.ntnu.ais.fmu4j.export.remote.SlaveSession.
+class RemoteSlaveInstance : public cppfmu::SlaveInstance
+{
+
+public:
+    RemoteSlaveInstance(std::unique_ptr<Channel> channel, const std::string& instanceName,
+        const cppfmu::Logger& logger, InstantiationTimings timings = {});
+
+    void SetupExperiment(cppfmu::FMIBoolean toleranceDefined, cppfmu::FMIReal tolerance, cppfmu::FMIReal tStart, cppfmu::FMIBoolean stopTimeDefined, cppfmu::FMIReal tStop) override;
+    void EnterInitializationMode() override;
+    void ExitInitializationMode() override;
+
+    bool DoStep(cppfmu::FMIReal currentCommunicationPoint, cppfmu::FMIReal communicationStepSize, cppfmu::FMIBoolean newStep, cppfmu::FMIReal& endOfStep) override;
+    void Reset() override;
+    void Terminate() override;
+
+    void GetReal(const cppfmu::FMIValueReference* vr, std::size_t nvr, cppfmu::FMIReal* value) const override;
+    void SetReal(const cppfmu::FMIValueReference* vr, std::size_t nvr, const cppfmu::FMIReal* value) override;
+    void SetInteger(const cppfmu::FMIValueReference* vr, std::size_t nvr, const cppfmu::FMIInteger* value) override;
+    void SetBoolean(const cppfmu::FMIValueReference* vr, std::size_t nvr, const cppfmu::FMIBoolean* value) override;
+    void SetString(const cppfmu::FMIValueReference* vr, std::size_t nvr, cppfmu::FMIString const* value) override;
+    void SetAll(
+        const cppfmu::FMIValueReference* intVr, std::size_t nIntvr, const cppfmu::FMIInteger* intValue,
+        const cppfmu::FMIValueReference* realVr, std::size_t nRealvr, const cppfmu::FMIReal* realValue,
+        const cppfmu::FMIValueReference* boolVr, std::size_t nBoolvr, const cppfmu::FMIBoolean* boolValue,
+        const cppfmu::FMIValueReference* strVr, std::size_t nStrvr, const cppfmu::FMIString* strValue) override;
+
+    void GetInteger(const cppfmu::FMIValueReference* vr, std::size_t nvr, cppfmu::FMIInteger* value) const override;
+    void GetBoolean(const cppfmu::FMIValueReference* vr, std::size_t nvr, cppfmu::FMIBoolean* value) const override;
+    void GetString(const cppfmu::FMIValueReference* vr, std::size_t nvr, cppfmu::FMIString* value) const override;
+    void GetAll(
+        const cppfmu::FMIValueReference* intVr, std::size_t nIntvr, cppfmu::FMIInteger* intValue,
+        const cppfmu::FMIValueReference* realVr, std::size_t nRealvr, cppfmu::FMIReal* realValue,
+        const cppfmu::FMIValueReference* boolVr, std::size_t nBoolvr, cppfmu::FMIBoolean* boolValue,
+        const cppfmu::FMIValueReference* strVr, std::size_t nStrvr, cppfmu::FMIString* strValue) const override;
+
+    // FMU states live in the remote session, the handles encode their ids
+    void GetFMUstate(cppfmu::FMIFMUstate& state) override;
+    void SetFMUstate(cppfmu::FMIFMUstate state) override;
+    void FreeFMUstate(cppfmu::FMIFMUstate& state) override;
+    // the size request fetches the serialized state, which is then copied by SerializeFMUstate
+    std::size_t SerializedFMUstateSize(cppfmu::FMIFMUstate state) override;
+    void SerializeFMUstate(cppfmu::FMIFMUstate state, fmi2Byte* data, std::size_t size) override;
+    void DeSerializeFMUstate(const fmi2Byte* data, std::size_t size, cppfmu::FMIFMUstate& state) override;
+
+    // false unless the slave overrides Fmi2Slave.getRealOutputDerivatives
+    bool GetRealOutputDerivatives(const cppfmu::FMIValueReference* vr, std::size_t nvr,
+        const cppfmu::FMIInteger* order, cppfmu::FMIReal* value) override;
+
+    // stored natively until the next step
+    void SetRealInputDerivatives(const cppfmu::FMIValueReference* vr, std::size_t nvr,
+        const cppfmu::FMIInteger* order, const cppfmu::FMIReal* value) override;
+
+    void GetDirectionalDerivatives(
+        const cppfmu::FMIValueReference* unknownVr, std::size_t nUnknown,
+        const cppfmu::FMIValueReference* knownVr, std::size_t nKnown,
+        const cppfmu::FMIReal* seeds, std::size_t nSeeds, cppfmu::FMIReal* derivatives) override;
+
+    cppfmu::FMIReal GetPreferredStepSize() override;
+
+    // The remote constructor and define are reported together, as the constructor phase.
+    void GetInstantiationTimings(cppfmu::FMIReal* timings, std::size_t n) const override;
+
+    bool CanGetAndSetFMUstate() const override
+    {
+        return canGetAndSetFMUstate_;
+    }
+
+    ~RemoteSlaveInstance() override;
+
+private:
+    std::unique_ptr<Channel> channel_;
+    cppfmu::Logger logger_;
+    InstantiationTimings timings_;
+    InputDerivatives inputDerivatives_;
+    bool canGetAndSetFMUstate_{};
+
+    mutable MessageWriter request_;
+    mutable std::vector<uint8_t> reply_;
+    mutable std::vector<std::string> strBuffer_;
+
+    cppfmu::FMIFMUstate serializedState_{};
+    std::string serialized_;
+
+    // Sends the pending request and returns a reader positioned after the status of the reply.
+    // Throws if the remote side reported an error.
+    MessageReader call() const;
+
+    MessageWriter& begin(int32_t operation, const cppfmu::FMIValueReference* vr, std::size_t nvr) const;
+};
+
+} // namespace fmu4j
+
+#endif
@@ -0,0 +1,65 @@
+
+#ifndef FMU4J_ROLLBACKRING_HPP
+#define FMU4J_ROLLBACKRING_HPP
+
+#include <cppfmu/cppfmu_cs.hpp>
+
+#include <cstddef>
+#include <deque>
+
+namespace fmu4j
+{
+
+// Maximum number of communication points kept for rollback, read from FMU4J_ROLLBACK_DEPTH.
+// Rollback is disabled when zero (the default).
+std::size_t rollback_depth();
+
+// The FMU states of the last few communication points of a slave, captured before each step,
+// so that a master rejecting a step can return to any of them through fmi2RollbackTo.
+// States are only ever created and released through the FMU state functions of the slave,
+// and are updated in place when possible.
+class RollbackRing
+{
+public:
+    explicit RollbackRing(std::size_t depth = rollback_depth());
+
+    // Captures the state at 'time', right before stepping from it.
+    // Points before 'time' are released if the master will not return to them,
+    // later points are dropped as they are about to be recomputed.
+    // Disables the ring (returning false) if the slave does not declare canGetAndSetFMUstate,
+    // after which rollback() fails.
+    bool capture(cppfmu::SlaveInstance& slave, cppfmu::FMIReal time, bool noSetFMUStatePriorToCurrentPoint);
+
+    // Restores the state captured at 'time', discarding all later points.
+    // Throws std::logic_error if no such point is held.
+    void rollback(cppfmu::SlaveInstance& slave, cppfmu::FMIReal time);
+
+    // Releases all states. Must be called before the slave is freed.
+    void clear(cppfmu::SlaveInstance& slave);
+
+    bool enabled() const
+    {
+        return depth_ > 0;
+    }
+
+private:
+    struct Point
+    {
+        cppfmu::FMIReal time;
+        cppfmu::FMIFMUstate state;
+    };
+
+    std::size_t depth_;
+    // whether the capability of the slave has been checked, and found missing
+    bool checked_{};
+    bool unsupported_{};
+    std::deque<Point> points_;
+    // a released state, reused by the next capture
+    cppfmu::FMIFMUstate spare_{};
+
+    void release(cppfmu::SlaveInstance& slave, cppfmu::FMIFMUstate state);
+};
+
+} // namespace fmu4j
+
+#endif
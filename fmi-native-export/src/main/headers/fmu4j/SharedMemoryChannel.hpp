@@ -0,0 +1,65 @@
+
+#ifndef FMU4J_SHAREDMEMORYCHANNEL_HPP
+#define FMU4J_SHAREDMEMORYCHANNEL_HPP
+
+#include <fmu4j/remote.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace fmu4j
+{
+
+struct SharedRegion;
+
+// A pair of lock-free single-producer/single-consumer byte rings in shared memory,
+// connecting the simulation process (master) to a worker JVM.
+// Blocked readers and writers spin briefly, then sleep on a futex (polling with back-off on Windows).
+// The Java end (export/remote/SharedMemoryChannel.kt) drives the same code through JNI.
+class SharedMemoryChannel : public Channel
+{
+public:
+    // Creates a new region with rings of 'capacity' bytes each, owned by the master.
+    static std::unique_ptr<SharedMemoryChannel> create(const std::string& name, std::size_t capacity);
+
+    // Attaches the worker to a region created by the master.
+    static std::unique_ptr<SharedMemoryChannel> open(const std::string& name);
+
+    void send(const std::vector<uint8_t>& message) override;
+    void receive(std::vector<uint8_t>& message) override;
+
+    void send(const void* data, std::size_t size);
+
+    // Receives the next message into 'dst'. Returns its size, or the negated size if it does not fit
+    // within 'capacity', in which case the message is kept for the next call.
+    int64_t receive(void* dst, std::size_t capacity);
+
+    // Watches the process at the other end, normally registered by the peer itself once it has attached.
+    // Waiting on a peer that has exited fails instead of blocking forever.
+    void watch(long pid);
+
+    // Removes the name of the region once the peer has attached, so nothing is left behind on a crash.
+    void unlink();
+
+    // Marks the channel as closed and wakes up the peer.
+    void close();
+
+    ~SharedMemoryChannel() override;
+
+private:
+    SharedMemoryChannel(std::string name, SharedRegion* region, bool master);
+
+    std::string name_;
+    SharedRegion* region_;
+    bool master_;
+    bool linked_;
+    int64_t pending_ = -1;
+
+    void read(void* dst, std::size_t size);
+    void check_peer() const;
+};
+
+} // namespace fmu4j
+
+#endif
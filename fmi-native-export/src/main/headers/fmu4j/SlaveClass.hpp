@@ -0,0 +1,133 @@
+
+#ifndef FMU4J_SLAVECLASS_HPP
+#define FMU4J_SLAVECLASS_HPP
+
+#include <fmu4j/InstantiationTimings.hpp>
+
+#include <jni.h>
+
+#include <memory>
+#include <string>
+
+namespace fmu4j
+{
+
+// Classloader over the fmu4j runtime (fmi-export and its dependencies).
+// Shared between all FMUs built with a byte-identical runtime, see FmuBuilder --shared-runtime.
+struct RuntimeClassLoader
+{
+    JavaVM* jvm{};
+
+    std::string digest;
+    jobject classLoader{};
+};
+
+// Class level JNI handles shared by every instance of the same FMU.
+// Resolved once per resource location and released together with the last instance using them.
+struct SlaveClass
+{
+    JavaVM* jvm{};
+
+    std::string slaveName;
+    std::string resources;
+
+    std::shared_ptr<const RuntimeClassLoader> runtime;
+    jobject classLoader{};
+    jclass slaveCls{};
+
+    jclass mapCls{};
+    jmethodID mapCtorId{};
+    jmethodID mapPutId{};
+
+    jmethodID ctorId{};
+    jmethodID defineId{};
+
+    // path to resources/variables.bin, empty if absent or unsupported by the runtime
+    std::string variableIndex;
+    jmethodID defineFromIndexId{};
+
+    // optional, only present in slaves built against a runtime supporting pooling and in-place reset
+    jmethodID recycleId{};
+    jmethodID reuseId{};
+    jmethodID resetId{};
+    jmethodID warmupId{};
+    jmethodID warmupReferencesId{};
+    jmethodID valueReferencesId{};
+    jmethodID directionalDerivativesId{};
+    jmethodID setRealInputDerivativesId{};
+    jmethodID getRealOutputDerivativesId{};
+
+    // state hooks backing fmi2GetFMUstate/fmi2SetFMUstate, null in runtimes predating them
+    jmethodID saveStateId{};
+    jmethodID saveStateIntoId{};
+    jmethodID restoreStateId{};
+    // backing fmi2SerializeFMUstate/fmi2DeSerializeFMUstate
+    jmethodID serializedStateSizeId{};
+    jmethodID serializeStateId{};
+    jmethodID deserializeStateId{};
+
+    jmethodID setupExperimentId{};
+    // optional, tracking the simulation time for FMI 3.0
+    jmethodID setupId{};
+    jmethodID enterInitialisationModeId{};
+    jmethodID exitInitializationModeId{};
+
+    jmethodID doStepId{};
+    // optional, reporting the time reached by the step
+    jmethodID stepId{};
+    jmethodID preferredStepSizeId{};
+    // optional, the canGetAndSetFMUstate capability declared in @SlaveInfo
+    jmethodID canGetAndSetFMUstateId{};
+    jmethodID terminateId{};
+    jmethodID closeId{};
+
+    jmethodID getRealId{};
+    jmethodID setRealId{};
+
+    jmethodID getIntegerId{};
+    jmethodID setIntegerId{};
+
+    jmethodID getBooleanId{};
+    jmethodID setBooleanId{};
+
+    jmethodID getStringId{};
+    jmethodID setStringId{};
+
+    // optional, backing Model Exchange
+    jmethodID numberOfContinuousStatesId{};
+    jmethodID numberOfEventIndicatorsId{};
+    jmethodID getContinuousStatesId{};
+    jmethodID setContinuousStatesId{};
+    jmethodID derivativesId{};
+    jmethodID eventIndicatorsId{};
+    jmethodID handleEventId{};
+
+    // optional, backing connections between slaves
+    jmethodID realSourceId{};
+    jmethodID connectRealId{};
+    jmethodID releaseRealSourcesId{};
+
+    // optional, backing the FMI 3.0 accessors
+    jmethodID getFloat64Id{};
+    jmethodID setFloat64Id{};
+    jmethodID getInt32Id{};
+    jmethodID setInt32Id{};
+    jmethodID getBoolean3Id{};
+    jmethodID setBoolean3Id{};
+    jmethodID getString3Id{};
+    jmethodID setString3Id{};
+
+    jmethodID getAllId{};
+    jmethodID setAllId{};
+
+    bool canGetSetAll = false;
+};
+
+// Returns the cached class handles for the FMU located at 'resources',
+// loading model.jar and resolving all method ids on first use.
+// The class level phases are added to 'timings' when loaded by this call.
+std::shared_ptr<const SlaveClass> acquire_slave_class(JNIEnv* env, const std::string& resources, InstantiationTimings* timings = nullptr);
+
+} // namespace fmu4j
+
+#endif
@@ -3,10 +3,17 @@
 #define FMU4J_SLAVEINSTANCE_HPP
 
 #include <cppfmu/cppfmu_cs.hpp>
+#include <fmu4j/InputDerivatives.hpp>
+#include <fmu4j/InstantiationTimings.hpp>
+#include <fmu4j/SlaveClass.hpp>
+#include <fmu4j/ValueReferenceTable.hpp>
 
 #include <jni.h>
 
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace fmu4j
 {
@@ -21,7 +28,7 @@ class SlaveInstance : public cppfmu::SlaveInstance
 {
 
 public:
-    SlaveInstance(JNIEnv* env, std::string instanceName, std::string resources);
+    SlaveInstance(JNIEnv* env, std::string instanceName, std::string resources, const cppfmu::Logger& logger, InstantiationTimings timings = {});
 
     void SetupExperiment(cppfmu::FMIBoolean toleranceDefined, cppfmu::FMIReal tolerance, cppfmu::FMIReal tStart, cppfmu::FMIBoolean stopTimeDefined, cppfmu::FMIReal tStop) override;
     void EnterInitializationMode() override;
@@ -51,53 +58,135 @@ public:
         const cppfmu::FMIValueReference* boolVr, std::size_t nBoolvr, cppfmu::FMIBoolean* boolValue,
         const cppfmu::FMIValueReference* strVr, std::size_t nStrvr, cppfmu::FMIString* strValue) const override;
 
+    // FMI 3.0, served by the Fmi2Slave.__getFloat64__ family
+    void GetFloat64(const cppfmu::FMIValueReference* vr, std::size_t nvr, double* values, std::size_t nValues) const override;
+    void SetFloat64(const cppfmu::FMIValueReference* vr, std::size_t nvr, const double* values, std::size_t nValues) override;
+    void GetInt32(const cppfmu::FMIValueReference* vr, std::size_t nvr, std::int32_t* values, std::size_t nValues) const override;
+    void SetInt32(const cppfmu::FMIValueReference* vr, std::size_t nvr, const std::int32_t* values, std::size_t nValues) override;
+    void GetBool(const cppfmu::FMIValueReference* vr, std::size_t nvr, bool* values, std::size_t nValues) const override;
+    void SetBool(const cppfmu::FMIValueReference* vr, std::size_t nvr, const bool* values, std::size_t nValues) override;
+    void GetUtf8String(const cppfmu::FMIValueReference* vr, std::size_t nvr, const char** values, std::size_t nValues) const override;
+    void SetUtf8String(const cppfmu::FMIValueReference* vr, std::size_t nvr, const char* const* values, std::size_t nValues) override;
+
+    // FMU states are global refs to the objects returned by Fmi2Slave.saveState
+    void GetFMUstate(cppfmu::FMIFMUstate& state) override;
+    void SetFMUstate(cppfmu::FMIFMUstate state) override;
+    void FreeFMUstate(cppfmu::FMIFMUstate& state) override;
+    // serialized in place, the host buffer is handed to Fmi2Slave.serializeState as a direct ByteBuffer
+    std::size_t SerializedFMUstateSize(cppfmu::FMIFMUstate state) override;
+    void SerializeFMUstate(cppfmu::FMIFMUstate state, fmi2Byte* data, std::size_t size) override;
+    void DeSerializeFMUstate(const fmi2Byte* data, std::size_t size, cppfmu::FMIFMUstate& state) override;
+
+    // false unless the slave overrides Fmi2Slave.getRealOutputDerivatives
+    bool GetRealOutputDerivatives(const cppfmu::FMIValueReference* vr, std::size_t nvr,
+        const cppfmu::FMIInteger* order, cppfmu::FMIReal* value) override;
+
+    // stored natively until the next step
+    void SetRealInputDerivatives(const cppfmu::FMIValueReference* vr, std::size_t nvr,
+        const cppfmu::FMIInteger* order, const cppfmu::FMIReal* value) override;
+
+    // all seeds are evaluated by a single call to Fmi2Slave.__directionalDerivatives__
+    void GetDirectionalDerivatives(
+        const cppfmu::FMIValueReference* unknownVr, std::size_t nUnknown,
+        const cppfmu::FMIValueReference* knownVr, std::size_t nKnown,
+        const cppfmu::FMIReal* seeds, std::size_t nSeeds, cppfmu::FMIReal* derivatives) override;
+
+    // Model Exchange. The time and states set by the solver are kept natively, and handed to the slave
+    // together with the next evaluation, so that each evaluation is a single call into the JVM
+    void SetTime(cppfmu::FMIReal time) override;
+    void SetContinuousStates(const cppfmu::FMIReal* x, std::size_t nx) override;
+    void GetContinuousStates(cppfmu::FMIReal* x, std::size_t nx) override;
+    void GetDerivatives(cppfmu::FMIReal* derivatives, std::size_t nx) override;
+    void GetEventIndicators(cppfmu::FMIReal* eventIndicators, std::size_t ni) override;
+    bool NewDiscreteStates() override;
+
+    // the handles are global refs to suppliers of the variables, so connected inputs
+    // are read within the JVM by Fmi2Slave.__doStep__ rather than passing through the master
+    void GetRealSources(const cppfmu::FMIValueReference* vr, std::size_t nvr, void** sources) override;
+    void ConnectReal(const cppfmu::FMIValueReference* vr, std::size_t nvr, void* const* sources) override;
+
+    cppfmu::FMIReal GetPreferredStepSize() override;
+
+    void GetInstantiationTimings(cppfmu::FMIReal* timings, std::size_t n) const override;
+
+    bool CanGetAndSetFMUstate() const override;
+
     ~SlaveInstance() override;
 
 
 private:
     JavaVM* jvm_{};
 
-    jobject classLoader_;
+    std::shared_ptr<const SlaveClass> class_;
     jobject slaveInstance_{};
 
-    std::string slaveName_;
     const std::string resources_;
     const std::string instanceName_;
 
-    jmethodID ctorId_;
-
-    jmethodID setupExperimentId_;
-    jmethodID enterInitialisationModeId_;
-    jmethodID exitInitializationModeId_;
-
-    jmethodID doStepId_;
-    jmethodID terminateId_;
-    jmethodID closeId_;
-
-    jmethodID getRealId_;
-    jmethodID setRealId_;
-
-    jmethodID getIntegerId_;
-    jmethodID setIntegerId_;
-
-    jmethodID getBooleanId_;
-    jmethodID setBooleanId_;
-
-    jmethodID getStringId_;
-    jmethodID setStringId_;
-
-    jmethodID getAllId_;
-    jmethodID setAllId_;
-
-    jmethodID bulkIntValuesId_;
-    jmethodID bulkRealValuesId_;
-    jmethodID bulkBoolValuesId_;
-    jmethodID bulkStrValuesId_;
-
-    bool canGetSetAll_ = false;
-
-    void initialize();
+    cppfmu::Logger logger_;
+    double startTime_{};
+    InstantiationTimings timings_;
+    InputDerivatives inputDerivatives_;
+
+    // Model Exchange
+    double time_{};
+    std::vector<double> states_;
+    // declared by the slave, known once the arrays below are allocated
+    std::size_t nStates_{};
+    std::size_t nIndicators_{};
+    mutable bool timeDirty_ = false;
+    mutable bool statesDirty_ = false;
+    // reused across evaluations, allocated on first use
+    jdoubleArray statesArray_{};
+    jdoubleArray derivativesArray_{};
+    jdoubleArray indicatorsArray_{};
+
+    // value references of the variables of each type, so that unknown ones are rejected before calling the slave
+    ValueReferenceTable intSlots_, realSlots_, boolSlots_, strSlots_;
+
+    // whether GetRealSources handed out handles, which are released with the instance
+    bool realSourcesHandedOut_ = false;
+
+    // Java arrays reused by the scalar getters and setters, by length, so that a
+    // steady state of get/set calls does not allocate on the Java heap.
+    // Value references are cached per type, as GetAll/SetAll pass them at once.
+    using array_cache = std::unordered_map<std::size_t, jarray>;
+    mutable array_cache intVrArrays_, realVrArrays_, boolVrArrays_, strVrArrays_;
+    mutable array_cache intArrays_, realArrays_, boolArrays_, strArrays_;
+    mutable std::vector<jlong> vrBuffer_;
+    mutable std::vector<jint> intBuffer_;
+    mutable std::vector<jboolean> boolBuffer_;
+
+    // the array of 'cache' with n elements, created using 'create' on first use
+    jarray cachedArray(JNIEnv* env, array_cache& cache, std::size_t n, jarray (*create)(JNIEnv*, jsize)) const;
+    // the array of 'cache' holding vr, after checking them against 'slots'
+    jlongArray cachedVrArray(JNIEnv* env, const ValueReferenceTable& slots, array_cache& cache, const cppfmu::FMIValueReference* vr, std::size_t nvr) const;
+    jintArray writeIntegers(JNIEnv* env, array_cache& cache, const cppfmu::FMIInteger* values, std::size_t n);
+    jdoubleArray writeReals(JNIEnv* env, array_cache& cache, const cppfmu::FMIReal* values, std::size_t n);
+    jbooleanArray writeBooleans(JNIEnv* env, array_cache& cache, const cppfmu::FMIBoolean* values, std::size_t n);
+    // the strings are kept alive in strBuffer
+    jobjectArray writeStrings(JNIEnv* env, array_cache& cache, const cppfmu::FMIString* values, std::size_t n);
+    void readIntegers(JNIEnv* env, jintArray array, cppfmu::FMIInteger* values, std::size_t n) const;
+    void readBooleans(JNIEnv* env, jbooleanArray array, cppfmu::FMIBoolean* values, std::size_t n) const;
+    // the characters are released with strBuffer
+    void readStrings(JNIEnv* env, jobjectArray array, cppfmu::FMIString* values, std::size_t n) const;
+
+    void initialize(InstantiationTimings* timings = nullptr);
+    // fills the value reference tables from Fmi2Slave.__valueReferences__
+    void loadValueReferences(JNIEnv* env);
+    void requireModelExchange() const;
+    void allocateModelExchange(JNIEnv* env);
+    // as above, attaching to the JVM if not allocated yet
+    void allocateModelExchange();
+    // the pending states copied into statesArray_, or null if unchanged
+    jdoubleArray takeStates(JNIEnv* env);
+    // hands pending time and states to Fmi2Slave.__setContinuousStates__ before variables are read
+    void flushStates(JNIEnv* env) const;
+    // hands the pending input derivatives to Fmi2Slave.__setRealInputDerivatives__
+    void flushInputDerivatives(JNIEnv* env);
+    void warmup();
     void onClose();
+    bool park();
 
     mutable std::vector<jstring_ref> strBuffer;
 
@@ -0,0 +1,55 @@
+
+#ifndef FMU4J_VALUEREFERENCETABLE_HPP
+#define FMU4J_VALUEREFERENCETABLE_HPP
+
+#include <cppfmu/cppfmu_common.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fmu4j
+{
+
+// Maps the value references of one variable type to their slot, the position of the variable
+// in registration order, as exported by Fmi2Slave.__valueReferences__.
+// Scalars below DENSE_LIMIT are looked up in a vector. Arrays and sparse (overridden) scalars
+// are kept as ranges of value references, found using a binary search.
+class ValueReferenceTable
+{
+public:
+    static const cppfmu::FMIValueReference DENSE_LIMIT = 1 << 16;
+
+    // Replaces the table by 'ranges', the first value reference and the number of value references
+    // of each slot, ordered by slot.
+    void assign(const std::vector<cppfmu::FMIValueReference>& ranges);
+
+    // True once assigned, tables of runtimes not exporting their value references stay empty.
+    bool loaded() const
+    {
+        return loaded_;
+    }
+
+    // The slot of 'vr', or -1 if no variable has it.
+    long slot(cppfmu::FMIValueReference vr) const;
+
+    // Throws std::logic_error for the first value reference without a variable, if loaded.
+    void check(const cppfmu::FMIValueReference* vr, std::size_t nvr) const;
+
+private:
+    struct range
+    {
+        std::uint64_t start;
+        std::uint64_t end;
+        long slot;
+    };
+
+    std::vector<long> dense_;
+    // disjoint, sorted by start
+    std::vector<range> ranges_;
+    bool loaded_ = false;
+};
+
+} // namespace fmu4j
+
+#endif
@@ -0,0 +1,22 @@
+
+#ifndef FMU4J_WORKER_HPP
+#define FMU4J_WORKER_HPP
+
+#include <fmu4j/remote.hpp>
+
+#include <memory>
+#include <string>
+
+namespace fmu4j
+{
+
+// Opens a session for the FMU located at 'resources' in a child JVM (FMU4J_MODE=worker),
+// spawning a new worker unless one of this FMU has room for another instance (FMU4J_WORKER_GROUP_SIZE).
+std::unique_ptr<Channel> connect_worker(const std::string& resources);
+
+// True if the FMU located at 'resources' asks for worker mode, i.e. it was built with worker-options.txt.
+bool prefers_worker(const std::string& resources);
+
+} // namespace fmu4j
+
+#endif
@@ -27,10 +27,14 @@ inline void jvm_invoke(JavaVM* jvm, const std::function<void(JNIEnv*)>& f)
     }
 }
 
-jmethodID GetMethodID(JNIEnv* env, jclass cls, const char* name, const char* sig)
+jmethodID GetMethodID(JNIEnv* env, jclass cls, const char* name, const char* sig, bool throwOnFailure = true)
 {
     jmethodID id = env->GetMethodID(cls, name, sig);
     if (id == nullptr) {
+        if (!throwOnFailure) {
+            env->ExceptionClear();
+            return nullptr;
+        }
         std::string msg = "[FMU4j native] Unable to locate method '" + std::string(name) + "'!";
         throw cppfmu::FatalError(msg.c_str());
     }
@@ -70,7 +74,7 @@ jclass FindClass(JNIEnv* env, jobject classLoaderInstance, const std::string& na
     return cls;
 }
 
-jobject create_classloader(JNIEnv* env, const std::string& classpath)
+jobject create_classloader(JNIEnv* env, const std::string& classpath, jobject parent = nullptr)
 {
     std::string path = classpath;
     if (classpath.rfind('/', 0) == 0) {
@@ -92,7 +96,7 @@ jobject create_classloader(JNIEnv* env, const std::string& classpath)
 
     env->DeleteLocalRef(jClasspath);
 
-    return env->NewObject(classLoaderCls, classLoaderCtor, urls, nullptr);
+    return env->NewObject(classLoaderCls, classLoaderCtor, urls, parent);
 }
 
 JNIEnv* get_or_create_jvm(JavaVM** jvm)
@@ -0,0 +1,55 @@
+
+#ifndef FMU4J_PROCESS_HPP
+#define FMU4J_PROCESS_HPP
+
+#include <string>
+#include <vector>
+
+namespace fmu4j
+{
+
+// The java launcher used for out-of-process JVMs: FMU4J_JAVA, JAVA_HOME/bin/java or java on the PATH.
+std::string java_executable();
+
+// Classpath of the FMU located at 'resources', model.jar followed by the shared runtime (if any).
+std::string fmu_classpath(const std::string& resources);
+
+// Classpath of the FMU located at 'resources' made of copies in the user directory, for processes and classloaders
+// outliving the extracted FMU. The copies are named by content, so that identical jars are copied only once.
+std::string stable_classpath(const std::string& resources);
+
+// Copies 'file' to the jars folder of the user directory, returning the path of the copy.
+std::string stable_copy(const std::string& file);
+
+// Splits a whitespace separated list of JVM options, as found in environment variables.
+std::vector<std::string> split_options(const char* options);
+
+std::string temp_directory();
+
+// Directory private to the current user, $XDG_RUNTIME_DIR/fmu4j or <temp>/fmu4j-<uid> (%LOCALAPPDATA%/fmu4j on Windows).
+// Created with mode 0700 if missing, and rejected unless owned by the user and inaccessible to others.
+std::string user_directory();
+
+// True if 'path' is a regular file owned by the current user and neither readable nor writable by others.
+bool is_private_file(const std::string& path);
+
+// Starts a new process. Detached processes outlive the caller and are not waited for, in which case 0 is returned.
+long spawn_process(const std::vector<std::string>& args, bool detached);
+
+long current_process_id();
+
+// False once the process has exited. Exited child processes are reaped.
+bool process_alive(long pid);
+
+// Waits for a child process to exit, returning false if it is still running after 'timeoutMs'.
+bool wait_process(long pid, int timeoutMs);
+
+// Kills a child process and reaps it.
+void kill_process(long pid);
+
+// Absolute path of this shared library, loaded by out-of-process JVMs for their end of the shared-memory channels.
+std::string library_path();
+
+} // namespace fmu4j
+
+#endif
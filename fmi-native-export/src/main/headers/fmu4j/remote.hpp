@@ -0,0 +1,151 @@
+
+#ifndef FMU4J_REMOTE_HPP
+#define FMU4J_REMOTE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fmu4j
+{
+
+// Operations understood by no.ntnu.ais.fmu4j.export.remote.SlaveSession, keep in sync with Protocol.kt.
+namespace op
+{
+const int32_t HELLO = 0;
+
+// replies whether the slave declares canGetAndSetFMUstate
+const int32_t INSTANTIATE = 1;
+const int32_t SETUP_EXPERIMENT = 2;
+const int32_t ENTER_INITIALIZATION_MODE = 3;
+const int32_t EXIT_INITIALIZATION_MODE = 4;
+// replies the time reached, which is before the end of the step if the slave ended it early
+const int32_t DO_STEP = 5;
+const int32_t RESET = 6;
+const int32_t TERMINATE = 7;
+const int32_t FREE = 8;
+
+const int32_t GET_INTEGER = 10;
+const int32_t GET_REAL = 11;
+const int32_t GET_BOOLEAN = 12;
+const int32_t GET_STRING = 13;
+
+const int32_t SET_INTEGER = 20;
+const int32_t SET_REAL = 21;
+const int32_t SET_BOOLEAN = 22;
+const int32_t SET_STRING = 23;
+
+// control channel of a worker JVM, see SlaveWorker.kt
+const int32_t OPEN_SESSION = 30;
+const int32_t SHUTDOWN = 31;
+
+// FMU states are kept by the session, and referred to by id
+const int32_t GET_FMU_STATE = 40;
+const int32_t SET_FMU_STATE = 41;
+const int32_t FREE_FMU_STATE = 42;
+const int32_t SERIALIZE_FMU_STATE = 43;
+const int32_t DESERIALIZE_FMU_STATE = 44;
+
+const int32_t GET_DIRECTIONAL_DERIVATIVES = 50;
+// sent ahead of DO_STEP when the input derivatives changed
+const int32_t SET_REAL_INPUT_DERIVATIVES = 51;
+// replies 0 if the slave leaves the derivatives to the native history, 1 followed by the values otherwise
+const int32_t GET_REAL_OUTPUT_DERIVATIVES = 52;
+const int32_t GET_PREFERRED_STEP_SIZE = 53;
+} // namespace op
+
+const int32_t STATUS_OK = 0;
+const int32_t STATUS_ERROR = 1;
+
+// An error reported by the remote slave, as opposed to a failing transport (cppfmu::FatalError).
+class RemoteError : public std::runtime_error
+{
+public:
+    explicit RemoteError(const std::string& msg)
+        : std::runtime_error(msg)
+    { }
+};
+
+// Composes a message in native byte order, matching the ByteBuffers used on the Java side.
+class MessageWriter
+{
+public:
+    std::vector<uint8_t> data;
+
+    MessageWriter& begin(int32_t operation)
+    {
+        data.clear();
+        return put(operation);
+    }
+
+    template<typename T>
+    MessageWriter& put(T value)
+    {
+        auto offset = data.size();
+        data.resize(offset + sizeof(T));
+        std::memcpy(data.data() + offset, &value, sizeof(T));
+        return *this;
+    }
+
+    MessageWriter& put(const std::string& value)
+    {
+        put(static_cast<int32_t>(value.size()));
+        data.insert(data.end(), value.begin(), value.end());
+        return *this;
+    }
+};
+
+// Reads a message composed by MessageWriter or its Java counterpart.
+class MessageReader
+{
+public:
+    explicit MessageReader(const std::vector<uint8_t>& data)
+        : data_(data)
+    { }
+
+    template<typename T>
+    T get()
+    {
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, data_.data() + position_, sizeof(T));
+        position_ += sizeof(T);
+        return value;
+    }
+
+    std::string getString()
+    {
+        auto size = static_cast<std::size_t>(get<int32_t>());
+        require(size);
+        std::string value(reinterpret_cast<const char*>(data_.data() + position_), size);
+        position_ += size;
+        return value;
+    }
+
+private:
+    const std::vector<uint8_t>& data_;
+    std::size_t position_ = 0;
+
+    void require(std::size_t size) const
+    {
+        if (position_ + size > data_.size()) {
+            throw std::runtime_error("[FMU4j native] Truncated message!");
+        }
+    }
+};
+
+// Bidirectional, message oriented transport to a remote slave session.
+class Channel
+{
+public:
+    virtual void send(const std::vector<uint8_t>& message) = 0;
+    virtual void receive(std::vector<uint8_t>& message) = 0;
+
+    virtual ~Channel() = default;
+};
+
+} // namespace fmu4j
+
+#endif
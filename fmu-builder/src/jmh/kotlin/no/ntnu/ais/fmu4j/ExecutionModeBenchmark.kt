@@ -0,0 +1,65 @@
+package no.ntnu.ais.fmu4j
+
+import no.ntnu.ihb.fmi4j.importer.fmi2.CoSimulationFmu
+import no.ntnu.ihb.fmi4j.importer.fmi2.CoSimulationSlave
+import no.ntnu.ihb.fmi4j.importer.fmi2.Fmu
+import no.ntnu.ihb.fmi4j.readReal
+import org.openjdk.jmh.annotations.*
+import java.io.File
+import java.nio.file.Files
+import java.util.concurrent.TimeUnit
+
+/**
+ * Round-trip cost of reading a real and stepping a slave running in-process over JNI (`jni`),
+ * compared to a slave running in a child JVM behind the shared-memory channel (`worker`).
+ * Run using `./gradlew :fmu-builder:jmh`.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+open class ExecutionModeBenchmark {
+
+    @Param("jni", "worker")
+    var mode = "jni"
+
+    private lateinit var dir: File
+    private lateinit var fmu: CoSimulationFmu
+    private lateinit var slave: CoSimulationSlave
+    private var t = 0.0
+
+    @Setup
+    fun setup() {
+        val root = File(System.getProperty("fmu4j.rootDir", ".."))
+        val version = File(root, "VERSION").readLines().first()
+        val jar = File(root, "fmu-slaves/build/libs/fmu-slaves-$version.jar")
+
+        dir = Files.createTempDirectory("fmu4j-benchmark").toFile()
+        val args = mutableListOf("-m", "no.ntnu.ais.fmu4j.slaves.JavaTestFmi2Slave", "-f", jar.absolutePath, "-d", dir.absolutePath)
+        if (mode == "worker") {
+            args.addAll(listOf("--jvm-option", "-Xmx64m"))
+        }
+        FmuBuilder.main(args.toTypedArray())
+
+        fmu = Fmu.from(File(dir, "Test.fmu")).asCoSimulationFmu()
+        slave = fmu.newInstance()
+        check(slave.simpleSetup())
+    }
+
+    @TearDown
+    fun tearDown() {
+        slave.close()
+        fmu.close()
+        dir.deleteRecursively()
+    }
+
+    @Benchmark
+    fun readReal(): Double = slave.readReal("realOut").value
+
+    @Benchmark
+    fun doStep(): Boolean {
+        val ok = slave.doStep(t, 1e-3)
+        t += 1e-3
+        return ok
+    }
+
+}
@@ -3,20 +3,61 @@ package no.ntnu.ais.fmu4j
 
 import picocli.CommandLine
 import java.io.BufferedOutputStream
+import java.io.ByteArrayOutputStream
 import java.io.File
 import java.io.FileInputStream
 import java.io.FileOutputStream
 import java.net.URLClassLoader
 import java.nio.file.Files
+import java.security.MessageDigest
 import java.util.zip.ZipEntry
+import java.util.zip.ZipFile
 import java.util.zip.ZipOutputStream
 
 private const val DUMMY_INSTANCE_NAME = "dummyInstance"
 
-class FmuBuilder(
+private const val RUNTIME_JAR = "fmu4j-runtime.jar"
+private const val RUNTIME_DIGEST = "runtime.txt"
+private const val WORKER_OPTIONS = "worker-options.txt"
+private const val VARIABLE_INDEX = "variables.bin"
+
+/**
+ * Native libraries bundled with the builder, by resource path,
+ * with the platform folders they are packaged into for FMI 2.0 and FMI 3.0 respectively.
+ */
+private val BINARIES = listOf(
+        Triple("binaries/win32/fmi4j-export.dll", "win32", "x86-windows"),
+        Triple("binaries/win64/fmi4j-export.dll", "win64", "x86_64-windows"),
+        Triple("binaries/linux64/libfmi4j-export.so", "linux64", "x86_64-linux")
+)
+
+/**
+ * Packages making up the fmu4j runtime, i.e. fmi-export and its dependencies.
+ * Stripped from model.jar when building with a shared runtime.
+ */
+private val RUNTIME_PACKAGES = listOf(
+        "no/ntnu/ais/fmu4j/export/",
+        "no/ntnu/ais/fmu4j/modeldescription/",
+        "kotlin/",
+        "org/jetbrains/annotations/",
+        "org/intellij/lang/annotations/",
+        "javax/xml/bind/",
+        "javax/activation/",
+        "com/sun/activation/",
+        "com/sun/istack/",
+        "com/sun/xml/",
+        "org/glassfish/jaxb/",
+        "org/jvnet/"
+)
+
+class FmuBuilder @JvmOverloads constructor(
         private val mainClass: String,
         private val jarFile: File,
-        private val resources: Array<File>?
+        private val resources: Array<File>?,
+        private val sharedRuntime: Boolean = false,
+        private val workerOptions: List<String>? = null,
+        private val probeDependencies: Boolean = false,
+        private val fmi3: Boolean = false
 ) {
 
     @JvmOverloads
@@ -24,6 +65,7 @@ class FmuBuilder(
 
         require(jarFile.exists()) { "No such File '${jarFile.absoluteFile}'" }
         require(jarFile.name.endsWith(".jar")) { "File $jarFile is not a .jar!" }
+        require(!fmi3 || workerOptions == null) { "FMI 3.0 FMUs cannot run their slaves in a worker JVM!" }
 
         var tempResourcesDir: File? = null
 
@@ -51,12 +93,23 @@ class FmuBuilder(
         val mdClass = classLoader.loadClass("no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2ModelDescription")
         val mdCsClass = classLoader.loadClass("no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2ModelDescription\$CoSimulation")
         val mdCsMethod = mdClass.getMethod("getCoSimulation")
-        val toXml = superClass.getMethod("getModelDescriptionXml")
+        val toXml = if (fmi3) {
+            superClass.methods.firstOrNull { it.name == "getFmi3ModelDescriptionXml" }
+                    ?: throw IllegalStateException("The fmi-export version used by '$jarFile' cannot export FMI 3.0!")
+        } else {
+            superClass.getMethod("getModelDescriptionXml")
+        }
         val mdCsModelIdentifierMethod = mdCsClass.getMethod("getModelIdentifier")
 
         val define = superClass.getDeclaredMethod("__define__")
         define.invoke(instance)
 
+        if (probeDependencies) {
+            val probe = superClass.methods.firstOrNull { it.name == "__probeDependencies__" }
+                    ?: throw IllegalStateException("The fmi-export version used by '$jarFile' cannot probe dependencies!")
+            probe.invoke(instance)
+        }
+
         val getModelDescription = superClass.getDeclaredMethod("getModelDescription")
         val md = getModelDescription.invoke(instance)
         val mdCs = mdCsMethod.invoke(md)
@@ -64,6 +117,15 @@ class FmuBuilder(
 
         val xml = toXml.invoke(instance) as String
 
+        // absent when building against an older fmi-export.
+        // Not used for FMI 3.0, as the array variables are derived from the full model description
+        val variableIndex = if (fmi3) null else superClass.methods.firstOrNull { it.name == "writeVariableIndex" }?.let { write ->
+            ByteArrayOutputStream().use { baos ->
+                write.invoke(instance, baos)
+                baos.toByteArray()
+            }
+        }
+
         val close = superClass.getDeclaredMethod("close")
         close.invoke(instance)
 
@@ -83,10 +145,28 @@ class FmuBuilder(
 
             zos.putNextEntry(ZipEntry("resources/"))
 
-            zos.putNextEntry(ZipEntry("resources/model.jar"))
-            FileInputStream(jarFile).buffered().use { fis ->
-                zos.write(fis.readBytes())
+            if (sharedRuntime) {
+
+                val split = splitRuntime(jarFile)
+
+                zos.putNextEntry(ZipEntry("resources/model.jar"))
+                zos.write(split.model)
+                zos.closeEntry()
+
+                zos.putNextEntry(ZipEntry("resources/$RUNTIME_JAR"))
+                zos.write(split.runtime)
+                zos.closeEntry()
+
+                zos.putNextEntry(ZipEntry("resources/$RUNTIME_DIGEST"))
+                zos.write(split.digest.toByteArray())
                 zos.closeEntry()
+
+            } else {
+                zos.putNextEntry(ZipEntry("resources/model.jar"))
+                FileInputStream(jarFile).buffered().use { fis ->
+                    zos.write(fis.readBytes())
+                    zos.closeEntry()
+                }
             }
 
             resources?.forEach { file ->
@@ -101,32 +181,32 @@ class FmuBuilder(
             zos.write(mainClass.toByteArray())
             zos.closeEntry()
 
-            zos.closeEntry() //resources
-
-            zos.putNextEntry(ZipEntry("binaries/"))
-
-            FmuBuilder::class.java.classLoader.getResourceAsStream("binaries/win32/fmi4j-export.dll")?.use { `is` ->
-                zos.putNextEntry(ZipEntry("binaries/win32/"))
-                zos.putNextEntry(ZipEntry("binaries/win32/$modelIdentifier.dll"))
-                zos.write(`is`.readBytes())
-                zos.closeEntry()
+            if (variableIndex != null) {
+                zos.putNextEntry(ZipEntry("resources/$VARIABLE_INDEX"))
+                zos.write(variableIndex)
                 zos.closeEntry()
             }
 
-            FmuBuilder::class.java.classLoader.getResourceAsStream("binaries/win64/fmi4j-export.dll")?.buffered()?.use { `is` ->
-                zos.putNextEntry(ZipEntry("binaries/win64/"))
-                zos.putNextEntry(ZipEntry("binaries/win64/$modelIdentifier.dll"))
-                zos.write(`is`.readBytes())
-                zos.closeEntry()
+            // the presence of this file makes the native layer run the slaves in a child JVM
+            if (workerOptions != null) {
+                zos.putNextEntry(ZipEntry("resources/$WORKER_OPTIONS"))
+                zos.write(workerOptions.joinToString("\n").toByteArray())
                 zos.closeEntry()
             }
 
-            FmuBuilder::class.java.classLoader.getResourceAsStream("binaries/linux64/libfmi4j-export.so")?.buffered()?.use { `is` ->
-                zos.putNextEntry(ZipEntry("binaries/linux64/"))
-                zos.putNextEntry(ZipEntry("binaries/linux64/$modelIdentifier.so"))
-                zos.write(`is`.readBytes())
-                zos.closeEntry()
-                zos.closeEntry()
+            zos.closeEntry() //resources
+
+            zos.putNextEntry(ZipEntry("binaries/"))
+
+            for ((library, fmi2Platform, fmi3Platform) in BINARIES) {
+                FmuBuilder::class.java.classLoader.getResourceAsStream(library)?.buffered()?.use { `is` ->
+                    val platform = if (fmi3) fmi3Platform else fmi2Platform
+                    zos.putNextEntry(ZipEntry("binaries/$platform/"))
+                    zos.putNextEntry(ZipEntry("binaries/$platform/$modelIdentifier.${library.substringAfterLast('.')}"))
+                    zos.write(`is`.readBytes())
+                    zos.closeEntry()
+                    zos.closeEntry()
+                }
             }
 
             zos.closeEntry() //binaries
@@ -159,13 +239,85 @@ class FmuBuilder(
         @CommandLine.Option(names = ["-r", "--res"], arity = "0..*", description = ["resources."], required = false)
         var resources: Array<File>? = null
 
+        @CommandLine.Option(names = ["-s", "--shared-runtime"], description = ["Package the fmu4j runtime separately, so that it can be shared between FMUs loaded into the same process."], required = false)
+        var sharedRuntime = false
+
+        @CommandLine.Option(names = ["-w", "--worker"], description = ["Run the slaves in a child JVM per FMU, communicating over shared memory."], required = false)
+        var worker = false
+
+        @CommandLine.Option(names = ["--jvm-option"], description = ["Option passed to the worker JVM, implies --worker. May be repeated."], required = false)
+        var jvmOptions: Array<String>? = null
+
+        @CommandLine.Option(names = ["--probe-dependencies"], description = ["Detect the inputs each output depends on directly, for outputs without declared dependencies."], required = false)
+        var probeDependencies = false
+
+        @CommandLine.Option(names = ["--fmi3"], description = ["Export an FMI 3.0 co-simulation FMU, with array fields as array variables."], required = false)
+        var fmi3 = false
+
         override fun run() {
-            FmuBuilder(mainClass, jarFile, resources).build(destFile)
+            val workerOptions = if (worker || jvmOptions != null) jvmOptions?.toList() ?: emptyList() else null
+            FmuBuilder(mainClass, jarFile, resources, sharedRuntime, workerOptions, probeDependencies, fmi3).build(destFile)
         }
 
     }
 
+    private class SplitJar(
+            val model: ByteArray,
+            val runtime: ByteArray,
+            val digest: String
+    )
+
     companion object {
+
+        private fun isRuntimeEntry(name: String): Boolean {
+            return RUNTIME_PACKAGES.any { name.startsWith(it) }
+        }
+
+        /**
+         * Splits the fat jar into the model classes and the fmu4j runtime.
+         * META-INF is kept in both, so that service registrations (e.g. for JAXB) are visible to the runtime.
+         * The digest identifies the runtime contents and is used by the native layer to decide which FMUs may share it.
+         */
+        private fun splitRuntime(jarFile: File): SplitJar {
+
+            val model = ByteArrayOutputStream()
+            val runtime = ByteArrayOutputStream()
+            val md = MessageDigest.getInstance("SHA-256")
+
+            ZipFile(jarFile).use { zip ->
+                ZipOutputStream(model).use { modelZos ->
+                    ZipOutputStream(runtime).use { runtimeZos ->
+
+                        zip.entries().toList().sortedBy { it.name }.forEach { entry ->
+
+                            val bytes = zip.getInputStream(entry).use { it.readBytes() }
+                            val isMeta = entry.name.startsWith("META-INF/")
+                            val isRuntime = isRuntimeEntry(entry.name)
+
+                            if (isRuntime || isMeta) {
+                                runtimeZos.putNextEntry(ZipEntry(entry.name))
+                                runtimeZos.write(bytes)
+                                runtimeZos.closeEntry()
+                                if (isRuntime) {
+                                    md.update(entry.name.toByteArray())
+                                    md.update(bytes)
+                                }
+                            }
+                            if (!isRuntime) {
+                                modelZos.putNextEntry(ZipEntry(entry.name))
+                                modelZos.write(bytes)
+                                modelZos.closeEntry()
+                            }
+
+                        }
+                    }
+                }
+            }
+
+            val digest = md.digest().joinToString("") { "%02x".format(it) }
+            return SplitJar(model.toByteArray(), runtime.toByteArray(), digest)
+        }
+
         @JvmStatic
         fun main(args: Array<String>) {
             CommandLine(Args()).execute(*args)
@@ -0,0 +1,143 @@
+package no.ntnu.ais.fmu4j
+
+import com.sun.jna.Callback
+import com.sun.jna.NativeLibrary
+import com.sun.jna.Platform
+import com.sun.jna.Pointer
+import com.sun.jna.Structure
+import com.sun.jna.ptr.DoubleByReference
+import java.io.Closeable
+import java.io.File
+import java.nio.file.Files
+import java.util.zip.ZipFile
+
+/**
+ * Calls the FMI 2.0 functions of an FMU binary directly, for the vendor functions and Model Exchange
+ * that the fmi4j importer does not reach.
+ */
+internal class NativeFmu(fmuFile: File) : Closeable {
+
+    private val dir = Files.createTempDirectory("fmu4j-native").toFile()
+    private val library: NativeLibrary
+    private val callbacks = CallbackFunctions()
+
+    val messages: MutableList<String> = mutableListOf()
+
+    init {
+        ZipFile(fmuFile).use { zip ->
+            zip.entries().asSequence().filter { !it.isDirectory }.forEach { entry ->
+                val file = File(dir, entry.name).apply { parentFile.mkdirs() }
+                zip.getInputStream(entry).use { input -> file.outputStream().use { input.copyTo(it) } }
+            }
+        }
+        val platform = if (Platform.isWindows()) "win64" else "linux64"
+        val binary = File(dir, "binaries/$platform").listFiles()!!.first()
+        library = NativeLibrary.getInstance(binary.absolutePath)
+
+        val libc = NativeLibrary.getInstance(Platform.C_LIBRARY_NAME)
+        callbacks.logger = object : Logger {
+            override fun invoke(env: Pointer?, instanceName: String?, status: Int, category: String?, message: String?) {
+                messages.add(message ?: "")
+            }
+        }
+        callbacks.allocateMemory = libc.getFunction("calloc")
+        callbacks.freeMemory = libc.getFunction("free")
+        callbacks.write()
+    }
+
+    fun instantiate(instanceName: String, type: Int = CO_SIMULATION): Pointer {
+        // a plain path, the native layer strips file: prefixes inconsistently
+        val resources = File(dir, "resources").absolutePath
+        return library.getFunction("fmi2Instantiate").invokePointer(
+            arrayOf(instanceName, type, "", resources, callbacks, FALSE, FALSE)
+        ) ?: throw IllegalStateException("fmi2Instantiate failed: $messages")
+    }
+
+    /**
+     * Invokes [function], returning its fmi2Status.
+     */
+    fun call(function: String, vararg args: Any?): Int {
+        return library.getFunction(function).invokeInt(args)
+    }
+
+    fun setup(c: Pointer, startTime: Double = 0.0) {
+        check(call("fmi2SetupExperiment", c, FALSE, 0.0, startTime, FALSE, 0.0) == OK)
+        check(call("fmi2EnterInitializationMode", c) == OK)
+        check(call("fmi2ExitInitializationMode", c) == OK)
+    }
+
+    fun getReal(c: Pointer, vr: Long): Double {
+        val value = DoubleArray(1)
+        check(call("fmi2GetReal", c, intArrayOf(vr.toInt()), 1L, value) == OK)
+        return value[0]
+    }
+
+    fun setReal(c: Pointer, vr: Long, value: Double): Int {
+        return call("fmi2SetReal", c, intArrayOf(vr.toInt()), 1L, doubleArrayOf(value))
+    }
+
+    fun doStep(c: Pointer, t: Double, dt: Double): Int {
+        return call("fmi2DoStep", c, t, dt, TRUE)
+    }
+
+    fun lastSuccessfulTime(c: Pointer): Double {
+        val time = DoubleByReference()
+        check(call("fmi2GetRealStatus", c, LAST_SUCCESSFUL_TIME, time) == OK)
+        return time.value
+    }
+
+    fun free(c: Pointer) {
+        library.getFunction("fmi2FreeInstance").invokeVoid(arrayOf(c))
+    }
+
+    override fun close() {
+        library.dispose()
+        dir.deleteRecursively()
+    }
+
+    interface Logger : Callback {
+        fun invoke(env: Pointer?, instanceName: String?, status: Int, category: String?, message: String?)
+    }
+
+    @Structure.FieldOrder("logger", "allocateMemory", "freeMemory", "stepFinished", "componentEnvironment")
+    class CallbackFunctions : Structure() {
+        @JvmField
+        var logger: Logger? = null
+        @JvmField
+        var allocateMemory: Pointer? = null
+        @JvmField
+        var freeMemory: Pointer? = null
+        @JvmField
+        var stepFinished: Pointer? = null
+        @JvmField
+        var componentEnvironment: Pointer? = null
+    }
+
+    companion object {
+        const val MODEL_EXCHANGE = 0
+        const val CO_SIMULATION = 1
+
+        const val OK = 0
+        const val WARNING = 1
+        const val DISCARD = 2
+        const val ERROR = 3
+
+        const val FALSE = 0
+        const val TRUE = 1
+
+        private const val LAST_SUCCESSFUL_TIME = 2
+
+        /**
+         * Sets an environment variable of this process, read by FMU binaries loaded afterwards.
+         */
+        fun setenv(name: String, value: String?) {
+            val libc = NativeLibrary.getInstance(Platform.C_LIBRARY_NAME)
+            if (value != null) {
+                libc.getFunction("setenv").invokeInt(arrayOf(name, value, 1))
+            } else {
+                libc.getFunction("unsetenv").invokeInt(arrayOf(name))
+            }
+        }
+    }
+
+}
@@ -1,9 +1,11 @@
 package no.ntnu.ais.fmu4j
 
+import com.sun.jna.ptr.PointerByReference
 import no.ntnu.ihb.fmi4j.importer.fmi2.Fmu
 import no.ntnu.ihb.fmi4j.modeldescription.StringArray
 import no.ntnu.ihb.fmi4j.modeldescription.stringArrayOf
 import no.ntnu.ihb.fmi4j.readBoolean
+import no.ntnu.ihb.fmi4j.readInteger
 import no.ntnu.ihb.fmi4j.readReal
 import no.ntnu.ihb.fmi4j.readString
 import org.junit.jupiter.api.Assertions
@@ -213,6 +215,49 @@ internal class TestBuilder {
         }
     }
 
+    @Test
+    fun testSharedRuntime() {
+
+        val sharedDest = File(dest, "shared")
+        FmuBuilder.main(
+            arrayOf(
+                "-m", "$group.KotlinTestFmi2Slave",
+                "-f", jar,
+                "-d", sharedDest.absolutePath,
+                "-s"
+            )
+        )
+        FmuBuilder.main(
+            arrayOf(
+                "-m", "$group.Identity",
+                "-f", jar,
+                "-d", sharedDest.absolutePath,
+                "-s"
+            )
+        )
+
+        Fmu.from(File(sharedDest, "KotlinTestFmi2Slave.fmu")).asCoSimulationFmu().use { fmu1 ->
+            Fmu.from(File(sharedDest, "Identity.fmu")).asCoSimulationFmu().use { fmu2 ->
+
+                fmu1.newInstance().use { slave1 ->
+                    fmu2.newInstance().use { slave2 ->
+
+                        Assertions.assertTrue(slave1.simpleSetup())
+                        Assertions.assertTrue(slave2.simpleSetup())
+
+                        Assertions.assertTrue(slave1.doStep(0.0, 0.1))
+                        Assertions.assertTrue(slave2.doStep(0.0, 0.1))
+
+                        Assertions.assertEquals(-1.0, slave1.readReal("speed").value)
+
+                    }
+                }
+
+            }
+        }
+
+    }
+
     @Test
     fun testParallelInstantiate() {
 
@@ -237,4 +282,169 @@ internal class TestBuilder {
 
     }
 
+    @Test
+    fun testRollback() {
+
+        FmuBuilder.main(arrayOf("-m", "$group.Counter", "-f", jar, "-d", dest))
+        FmuBuilder.main(arrayOf("-m", "$group.KotlinTestFmi2Slave", "-f", jar, "-d", dest))
+
+        // read when the FMU binaries are loaded below
+        NativeFmu.setenv("FMU4J_ROLLBACK_DEPTH", "3")
+        try {
+
+            NativeFmu(File(dest, "Counter.fmu")).use { fmu ->
+                val c = fmu.instantiate("counter")
+                fmu.setup(c)
+                for (i in 0 until 5) {
+                    Assertions.assertEquals(NativeFmu.OK, fmu.doStep(c, i * 0.1, 0.1))
+                }
+                Assertions.assertEquals(5.0, fmu.getReal(c, 0))
+
+                // the states before the steps from 0.2, 0.3 and 0.4 are held
+                Assertions.assertEquals(NativeFmu.OK, fmu.call("fmi2RollbackTo", c, 0.3))
+                Assertions.assertEquals(3.0, fmu.getReal(c, 0))
+                Assertions.assertEquals(0.3, fmu.lastSuccessfulTime(c), 1e-12)
+                Assertions.assertEquals(NativeFmu.ERROR, fmu.call("fmi2RollbackTo", c, 0.4))
+                Assertions.assertEquals(NativeFmu.ERROR, fmu.call("fmi2RollbackTo", c, 0.1))
+
+                Assertions.assertEquals(NativeFmu.OK, fmu.doStep(c, 0.3, 0.1))
+                Assertions.assertEquals(4.0, fmu.getReal(c, 0))
+                Assertions.assertEquals(NativeFmu.OK, fmu.call("fmi2RollbackTo", c, 0.2))
+                Assertions.assertEquals(2.0, fmu.getReal(c, 0))
+                fmu.free(c)
+            }
+
+            // without canGetAndSetFMUstate, the ring is disabled rather than restoring a partial state
+            NativeFmu(File(dest, "KotlinTestFmi2Slave.fmu")).use { fmu ->
+                val c = fmu.instantiate("stateless")
+                fmu.setup(c)
+                Assertions.assertEquals(NativeFmu.OK, fmu.doStep(c, 0.0, 0.1))
+                Assertions.assertEquals(NativeFmu.ERROR, fmu.call("fmi2RollbackTo", c, 0.0))
+                Assertions.assertTrue(fmu.messages.any { it.contains("canGetAndSetFMUstate") })
+                fmu.free(c)
+            }
+
+        } finally {
+            NativeFmu.setenv("FMU4J_ROLLBACK_DEPTH", null)
+        }
+
+    }
+
+    @Test
+    fun testSetFMUstate() {
+
+        FmuBuilder.main(arrayOf("-m", "$group.Counter", "-f", jar, "-d", dest))
+
+        NativeFmu(File(dest, "Counter.fmu")).use { fmu ->
+            val c = fmu.instantiate("counter")
+            fmu.setup(c)
+            for (i in 0 until 2) {
+                Assertions.assertEquals(NativeFmu.OK, fmu.doStep(c, i * 0.1, 0.1))
+            }
+            val state = PointerByReference()
+            Assertions.assertEquals(NativeFmu.OK, fmu.call("fmi2GetFMUstate", c, state))
+            for (i in 2 until 4) {
+                Assertions.assertEquals(NativeFmu.OK, fmu.doStep(c, i * 0.1, 0.1))
+            }
+            Assertions.assertEquals(0.4, fmu.lastSuccessfulTime(c), 1e-12)
+
+            // the time reached is restored along with the state
+            Assertions.assertEquals(NativeFmu.OK, fmu.call("fmi2SetFMUstate", c, state.value))
+            Assertions.assertEquals(2.0, fmu.getReal(c, 0))
+            Assertions.assertEquals(0.2, fmu.lastSuccessfulTime(c), 1e-12)
+            Assertions.assertEquals(NativeFmu.OK, fmu.call("fmi2FreeFMUstate", c, state))
+            fmu.free(c)
+        }
+
+    }
+
+    @Test
+    fun testModelExchange() {
+
+        FmuBuilder.main(arrayOf("-m", "$group.Oscillator", "-f", jar, "-d", dest))
+
+        NativeFmu(File(dest, "Oscillator.fmu")).use { fmu ->
+            val c = fmu.instantiate("oscillator", NativeFmu.MODEL_EXCHANGE)
+            fmu.setup(c, startTime = 2.0)
+            Assertions.assertEquals(NativeFmu.OK, fmu.call("fmi2EnterContinuousTimeMode", c))
+
+            // evaluated at the start time until the solver sets the time
+            val x = DoubleArray(2)
+            val dx = DoubleArray(2)
+            Assertions.assertEquals(NativeFmu.OK, fmu.call("fmi2GetContinuousStates", c, x, 2L))
+            Assertions.assertArrayEquals(doubleArrayOf(1.0, 0.0), x)
+            Assertions.assertEquals(NativeFmu.OK, fmu.call("fmi2GetDerivatives", c, dx, 2L))
+            Assertions.assertArrayEquals(doubleArrayOf(0.0, -4.0), dx)
+            Assertions.assertEquals(2.0, fmu.getReal(c, 0))
+
+            // explicit Euler until t = 2.5, x = cos(2 (t - 2))
+            val h = 1e-4
+            for (i in 1..5000) {
+                for (j in x.indices) {
+                    x[j] += h * dx[j]
+                }
+                Assertions.assertEquals(NativeFmu.OK, fmu.call("fmi2SetTime", c, 2.0 + i * h))
+                Assertions.assertEquals(NativeFmu.OK, fmu.call("fmi2SetContinuousStates", c, x, 2L))
+                Assertions.assertEquals(NativeFmu.OK, fmu.call("fmi2GetDerivatives", c, dx, 2L))
+            }
+            Assertions.assertEquals(2.5, fmu.getReal(c, 0), 1e-9)
+            Assertions.assertEquals(Math.cos(1.0), x[0], 1e-3)
+
+            val indicators = DoubleArray(2)
+            Assertions.assertEquals(NativeFmu.OK, fmu.call("fmi2GetEventIndicators", c, indicators, 1L))
+            Assertions.assertEquals(x[0], indicators[0])
+
+            // another number of states or indicators than declared is rejected, leaving the instance usable
+            Assertions.assertEquals(NativeFmu.ERROR, fmu.call("fmi2SetContinuousStates", c, DoubleArray(3), 3L))
+            Assertions.assertEquals(NativeFmu.ERROR, fmu.call("fmi2GetContinuousStates", c, DoubleArray(3), 3L))
+            Assertions.assertEquals(NativeFmu.ERROR, fmu.call("fmi2GetDerivatives", c, DoubleArray(1), 1L))
+            Assertions.assertEquals(NativeFmu.ERROR, fmu.call("fmi2GetEventIndicators", c, indicators, 2L))
+            Assertions.assertEquals(NativeFmu.OK, fmu.call("fmi2GetContinuousStates", c, x, 2L))
+            Assertions.assertEquals(Math.cos(1.0), x[0], 1e-3)
+            fmu.free(c)
+        }
+
+    }
+
+    @Test
+    fun testWorkerMode() {
+
+        val modes = listOf("jni", "worker")
+        modes.forEach { mode ->
+            val args = mutableListOf("-m", "$group.JavaTestFmi2Slave", "-f", jar, "-d", File(dest, mode).absolutePath)
+            if (mode == "worker") {
+                args.addAll(listOf("--jvm-option", "-Xmx64m"))
+            }
+            FmuBuilder.main(args.toTypedArray())
+        }
+
+        // the worker runs the same slave behind the shared-memory channel, so the two are stepped side by side
+        // and must report identical outputs. Latencies are measured by ExecutionModeBenchmark
+        val fmus = modes.map { mode -> Fmu.from(File(File(dest, mode), "Test.fmu")).asCoSimulationFmu() }
+        try {
+            val (jni, worker) = fmus.map { it.newInstance() }
+            jni.use {
+                worker.use {
+                    Assertions.assertTrue(jni.simpleSetup())
+                    Assertions.assertTrue(worker.simpleSetup())
+
+                    var t = 0.0
+                    repeat(100) {
+                        Assertions.assertTrue(jni.doStep(t, 1e-3))
+                        Assertions.assertTrue(worker.doStep(t, 1e-3))
+                        t += 1e-3
+                        for (name in listOf("realOut", "param", "speed")) {
+                            Assertions.assertEquals(jni.readReal(name).value, worker.readReal(name).value, name)
+                        }
+                        Assertions.assertEquals(jni.readInteger("intOut").value, worker.readInteger("intOut").value)
+                        Assertions.assertEquals(jni.readString("testContent").value, worker.readString("testContent").value)
+                    }
+                }
+            }
+        } finally {
+            fmus.forEach { it.close() }
+        }
+
+    }
+
 }
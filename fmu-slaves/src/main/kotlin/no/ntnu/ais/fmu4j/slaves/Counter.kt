@@ -0,0 +1,23 @@
+package no.ntnu.ais.fmu4j.slaves
+
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2Slave
+import no.ntnu.ais.fmu4j.export.fmi2.ScalarVariable
+import no.ntnu.ais.fmu4j.export.fmi2.SlaveInfo
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2Causality
+
+@SlaveInfo(
+    modelName = "Counter",
+    canGetAndSetFMUstate = true
+)
+class Counter(
+    args: Map<String, Any>
+) : Fmi2Slave(args) {
+
+    @ScalarVariable(causality = Fmi2Causality.output)
+    var count = 0.0
+
+    override fun doStep(currentTime: Double, dt: Double) {
+        count += 1.0
+    }
+
+}
@@ -0,0 +1,46 @@
+package no.ntnu.ais.fmu4j.slaves
+
+import no.ntnu.ais.fmu4j.export.fmi2.Fmi2Slave
+import no.ntnu.ais.fmu4j.export.fmi2.ScalarVariable
+import no.ntnu.ais.fmu4j.export.fmi2.SlaveInfo
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2Causality
+import no.ntnu.ais.fmu4j.modeldescription.fmi2.Fmi2Variability
+
+/**
+ * A harmonic oscillator for Model Exchange, with the position as event indicator.
+ */
+@SlaveInfo(modelName = "Oscillator")
+class Oscillator(
+    args: Map<String, Any>
+) : Fmi2Slave(args) {
+
+    // the time of the last evaluation of the derivatives
+    @ScalarVariable(causality = Fmi2Causality.output)
+    var evaluatedAt = Double.NaN
+
+    @ScalarVariable(causality = Fmi2Causality.parameter, variability = Fmi2Variability.fixed)
+    var stiffness = 4.0
+
+    // position and velocity
+    val x = doubleArrayOf(1.0, 0.0)
+    val dx = DoubleArray(2)
+
+    override val numberOfEventIndicators = 1
+
+    override fun registerVariables() {
+        registerContinuousStates("x", x, dx)
+    }
+
+    override fun computeDerivatives(time: Double) {
+        evaluatedAt = time
+        dx[0] = x[1]
+        dx[1] = -stiffness * x[0]
+    }
+
+    override fun eventIndicators(time: Double, indicators: DoubleArray) {
+        indicators[0] = x[0]
+    }
+
+    override fun doStep(currentTime: Double, dt: Double) {}
+
+}